@@ -0,0 +1,216 @@
+#include "arena.h"
+
+#include <string.h>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// internal
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+typedef struct arena_chunk
+{
+    struct arena_chunk* prev;
+    size_t capacity;
+    size_t offset;
+    size_t padding; // keeps the data that follows the header aligned to 16 bytes
+} arena_chunk;
+
+struct arena
+{
+    arena_chunk* first;
+    arena_chunk* current;
+    size_t chunkSize;
+    size_t reserved;
+    ctoolbox_memfuncs memfuncs;
+};
+
+static inline char* arena_chunk_data(arena_chunk* chunk)
+{
+    return (char*)(chunk + 1);
+}
+
+static arena_chunk* arena_chunk_create(arena* a, size_t capacity)
+{
+    arena_chunk* chunk = ctoolbox_custom_malloc(&a->memfuncs, sizeof(arena_chunk) + capacity);
+    if (!chunk) return NULL;
+
+    chunk->prev = a->current;
+    chunk->capacity = capacity;
+    chunk->offset = 0;
+    chunk->padding = 0;
+
+    a->current = chunk;
+    a->reserved += capacity;
+    return chunk;
+}
+
+// returns where an allocation would start inside the chunk, or SIZE_MAX if it doesn't fit
+static inline size_t arena_chunk_fit(arena_chunk* chunk, size_t size, size_t alignment)
+{
+    uintptr_t base = (uintptr_t)arena_chunk_data(chunk);
+    uintptr_t start = (base + chunk->offset + (alignment - 1)) & ~(uintptr_t)(alignment - 1);
+    size_t offset = (size_t)(start - base);
+
+    if (offset > chunk->capacity || size > chunk->capacity - offset) return SIZE_MAX;
+    return offset;
+}
+
+static void* arena_ctx_alloc(void* user, size_t size, size_t alignment)
+{
+    return arena_alloc((arena*)user, size, alignment);
+}
+
+static void* arena_ctx_realloc(void* user, void* ptr, size_t oldSize, size_t newSize, size_t alignment)
+{
+    // without the old size there is no telling how much to copy
+    if (ptr && oldSize == 0) return NULL;
+
+    arena* a = (arena*)user;
+    arena_chunk* chunk = a->current;
+
+    // the last block handed out can grow or shrink in place
+    if (ptr && (char*)ptr + oldSize == arena_chunk_data(chunk) + chunk->offset) {
+        size_t start = (size_t)((char*)ptr - arena_chunk_data(chunk));
+        if (newSize <= chunk->capacity - start) {
+            chunk->offset = start + newSize;
+            return ptr;
+        }
+    }
+
+    void* newPtr = arena_alloc(a, newSize, alignment);
+    if (newPtr && ptr) memcpy(newPtr, ptr, oldSize < newSize ? oldSize : newSize);
+    return newPtr;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// external
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+CTOOLBOX_API arena* arena_init(size_t chunkSize)
+{
+    return arena_init_memfuncs(chunkSize, &CTOOLBOX_DEFAULT_MEMFUNCS);
+}
+
+CTOOLBOX_API arena* arena_init_memfuncs(size_t chunkSize, const ctoolbox_memfuncs* memfuncs)
+{
+    arena* outArena = ctoolbox_custom_malloc(memfuncs ? memfuncs : &CTOOLBOX_DEFAULT_MEMFUNCS, sizeof(arena));
+    if (!outArena) return NULL;
+
+    memset(outArena, 0, sizeof(arena));
+    outArena->chunkSize = chunkSize > 0 ? chunkSize : ARENA_CHUNK_SIZE;
+
+    if (memfuncs) outArena->memfuncs = *memfuncs;
+    else outArena->memfuncs = CTOOLBOX_DEFAULT_MEMFUNCS;
+
+    outArena->first = arena_chunk_create(outArena, outArena->chunkSize);
+    if (!outArena->first) {
+        ctoolbox_custom_free_sized(&outArena->memfuncs, outArena, sizeof(arena));
+        return NULL;
+    }
+
+    return outArena;
+}
+
+CTOOLBOX_API void arena_destroy(arena* a)
+{
+    if (!a) return;
+
+    arena_chunk* chunk = a->current;
+    while (chunk) {
+        arena_chunk* prev = chunk->prev;
+        ctoolbox_custom_free_sized(&a->memfuncs, chunk, sizeof(arena_chunk) + chunk->capacity);
+        chunk = prev;
+    }
+    ctoolbox_custom_free_sized(&a->memfuncs, a, sizeof(arena));
+}
+
+CTOOLBOX_API void* arena_alloc(arena* a, size_t size, size_t alignment)
+{
+    if (!a) return NULL;
+    if (alignment == 0) alignment = CTOOLBOX_DEFAULT_ALIGNMENT;
+    if ((alignment & (alignment - 1)) != 0) return NULL;
+
+    size_t offset = arena_chunk_fit(a->current, size, alignment);
+
+    // doesn't fit, open a new chunk big enough for the request
+    if (offset == SIZE_MAX) {
+        if (size > SIZE_MAX - alignment - sizeof(arena_chunk)) return NULL;
+
+        size_t capacity = size + alignment > a->chunkSize ? size + alignment : a->chunkSize;
+        if (!arena_chunk_create(a, capacity)) return NULL;
+
+        offset = arena_chunk_fit(a->current, size, alignment);
+    }
+
+    a->current->offset = offset + size;
+    return arena_chunk_data(a->current) + offset;
+}
+
+CTOOLBOX_API void* arena_calloc(arena* a, size_t num, size_t size)
+{
+    if (size != 0 && num > SIZE_MAX / size) return NULL;
+
+    void* ptr = arena_alloc(a, num * size, 0);
+    if (ptr) memset(ptr, 0, num * size);
+    return ptr;
+}
+
+CTOOLBOX_API arena_marker arena_mark(const arena* a)
+{
+    arena_marker marker = { NULL, 0 };
+    if (!a) return marker;
+
+    marker.chunk = a->current;
+    marker.offset = a->current->offset;
+    return marker;
+}
+
+CTOOLBOX_API void arena_rollback(arena* a, arena_marker marker)
+{
+    if (!a || !marker.chunk) return;
+
+    // release every chunk opened after the marker
+    while (a->current != (arena_chunk*)marker.chunk && a->current != a->first) {
+        arena_chunk* prev = a->current->prev;
+        a->reserved -= a->current->capacity;
+        ctoolbox_custom_free_sized(&a->memfuncs, a->current, sizeof(arena_chunk) + a->current->capacity);
+        a->current = prev;
+    }
+
+    if (a->current == (arena_chunk*)marker.chunk && marker.offset < a->current->offset) {
+        a->current->offset = marker.offset;
+    }
+}
+
+CTOOLBOX_API void arena_reset(arena* a)
+{
+    if (!a) return;
+
+    arena_marker marker = { a->first, 0 };
+    arena_rollback(a, marker);
+}
+
+CTOOLBOX_API size_t arena_used(const arena* a)
+{
+    if (!a) return 0;
+
+    size_t used = 0;
+    for (const arena_chunk* chunk = a->current; chunk; chunk = chunk->prev) {
+        used += chunk->offset;
+    }
+    return used;
+}
+
+CTOOLBOX_API size_t arena_reserved(const arena* a)
+{
+    return a ? a->reserved : 0;
+}
+
+CTOOLBOX_API ctoolbox_memfuncs arena_memfuncs(arena* a)
+{
+    ctoolbox_memfuncs memfuncs = { 0 };
+    memfuncs.alloc_ctx_fn = arena_ctx_alloc;
+    memfuncs.realloc_ctx_fn = arena_ctx_realloc;
+    memfuncs.free_ctx_fn = NULL;
+    memfuncs.user = a;
+    return memfuncs;
+}
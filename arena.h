@@ -0,0 +1,68 @@
+#ifndef ARENA_INCLUDED
+#define ARENA_INCLUDED
+
+#include "context.h"
+
+/// @brief default amount of bytes each arena chunk holds
+#ifndef ARENA_CHUNK_SIZE
+    #define ARENA_CHUNK_SIZE 65536
+#endif
+
+/// @brief opaque arena (bump) allocator structure
+typedef struct arena arena;
+
+/// @brief position inside the arena, everything allocated after it can be released with arena_rollback
+typedef struct arena_marker
+{
+    void* chunk;
+    size_t offset;
+} arena_marker;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// functions
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// @brief creates the arena, chunkSize of 0 uses ARENA_CHUNK_SIZE
+CTOOLBOX_API arena* arena_init(size_t chunkSize);
+
+/// @brief creates the arena with custom memory allocation functions for its chunks
+CTOOLBOX_API arena* arena_init_memfuncs(size_t chunkSize, const ctoolbox_memfuncs* memfuncs);
+
+/// @brief destroys the arena and everything allocated from it
+CTOOLBOX_API void arena_destroy(arena* a);
+
+/// @brief bumps a block of size bytes with the given power of two alignment, 0 uses CTOOLBOX_DEFAULT_ALIGNMENT
+CTOOLBOX_API void* arena_alloc(arena* a, size_t size, size_t alignment);
+
+/// @brief bumps a zero-initialized block of num * size bytes
+CTOOLBOX_API void* arena_calloc(arena* a, size_t num, size_t size);
+
+/// @brief returns the current position of the arena
+CTOOLBOX_API arena_marker arena_mark(const arena* a);
+
+/// @brief releases everything allocated after the marker was taken
+CTOOLBOX_API void arena_rollback(arena* a, arena_marker marker);
+
+/// @brief releases everything allocated from the arena, keeping its first chunk around
+CTOOLBOX_API void arena_reset(arena* a);
+
+/// @brief returns how many bytes were handed out, including alignment padding
+CTOOLBOX_API size_t arena_used(const arena* a);
+
+/// @brief returns how many bytes the arena currently holds in chunks
+CTOOLBOX_API size_t arena_reserved(const arena* a);
+
+/// @brief returns memory functions that allocate from the arena, to be used with the *_init_memfuncs calls
+/// @brief frees are no-ops, containers living in the arena are released by arena_reset/arena_destroy without being destroyed
+/// @brief reallocs must carry the old size (ctoolbox_custom_realloc_sized), as the library containers do
+CTOOLBOX_API ctoolbox_memfuncs arena_memfuncs(arena* a);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ARENA_INCLUDED
@@ -0,0 +1,277 @@
+#include "cdarray.h"
+#include "cthread.h"
+
+#include <string.h>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// internal
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#define CDARRAY_FIRST_SEGMENT ((uint64_t)1 << CDARRAY_FIRST_SEGMENT_SHIFT)
+#define CDARRAY_MAX_SEGMENTS (sizeof(size_t) * 8 - CDARRAY_FIRST_SEGMENT_SHIFT)
+#define CDARRAY_ABANDONED ((void*)(uintptr_t)1)    // a segment that couldn't be allocated, its slots are skipped
+
+// segment k holds CDARRAY_FIRST_SEGMENT << k elements followed by a bitmap of the published ones
+struct cdarray
+{
+    void* volatile segments[CDARRAY_MAX_SEGMENTS];
+    volatile uint64_t claimed;      // next slot handed out
+    volatile uint64_t committed;    // published prefix last seen by cdarray_committed
+    size_t elementSize;
+    cthread_mutex lock;             // only taken to add segments, guards stats
+    ctoolbox_memfuncs memfuncs;
+    ctoolbox_memstats stats;
+};
+
+static inline size_t cdarray_log2(uint64_t value)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return index;
+#else
+    return 63 - (size_t)__builtin_clzll(value);
+#endif
+}
+
+static inline size_t cdarray_ctz(uint64_t value)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index;
+    _BitScanForward64(&index, value);
+    return index;
+#else
+    return (size_t)__builtin_ctzll(value);
+#endif
+}
+
+static inline size_t cdarray_segment_length(size_t segment)
+{
+    return (size_t)CDARRAY_FIRST_SEGMENT << segment;
+}
+
+// elements come first, the bitmap starts at the next 8 bytes boundary
+static inline size_t cdarray_bitmap_offset(const cdarray* array, size_t segment)
+{
+    return (cdarray_segment_length(segment) * array->elementSize + 7) & ~(size_t)7;
+}
+
+static inline size_t cdarray_segment_bytes(const cdarray* array, size_t segment)
+{
+    return cdarray_bitmap_offset(array, segment) + cdarray_segment_length(segment) / 8;
+}
+
+static inline void cdarray_locate(uint64_t index, size_t* segmentOut, size_t* offsetOut)
+{
+    uint64_t position = index + CDARRAY_FIRST_SEGMENT;
+    size_t segment = cdarray_log2(position) - CDARRAY_FIRST_SEGMENT_SHIFT;
+    *segmentOut = segment;
+    *offsetOut = (size_t)(position - ((uint64_t)CDARRAY_FIRST_SEGMENT << segment));
+}
+
+static inline volatile uint64_t* cdarray_bitmap(const cdarray* array, char* segment, size_t segmentIndex)
+{
+    return (volatile uint64_t*)(segment + cdarray_bitmap_offset(array, segmentIndex));
+}
+
+// returns the segment, adding it under the lock the first time it is needed, CDARRAY_ABANDONED if that failed
+static char* cdarray_segment(cdarray* array, size_t segmentIndex)
+{
+    char* segment = cthread_atomic_load_ptr(&array->segments[segmentIndex]);
+    if (segment) return segment;
+
+    cthread_mutex_lock(&array->lock);
+    segment = cthread_atomic_load_ptr(&array->segments[segmentIndex]);
+    if (!segment) {
+        size_t length = cdarray_segment_length(segmentIndex);
+        if (length <= (SIZE_MAX - 8 - length / 8) / array->elementSize) {
+            size_t bytes = cdarray_segment_bytes(array, segmentIndex);
+            segment = ctoolbox_custom_malloc(&array->memfuncs, bytes);
+            if (segment) {
+                memset(segment + cdarray_bitmap_offset(array, segmentIndex), 0, length / 8);
+                ctoolbox_memstats_on_alloc(&array->stats, bytes);
+            }
+        }
+
+        // slots may already be claimed in it, so a failed segment is given up rather than tried again later
+        if (!segment) segment = CDARRAY_ABANDONED;
+        cthread_atomic_store_ptr(&array->segments[segmentIndex], segment);
+    }
+    cthread_mutex_unlock(&array->lock);
+    return segment;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// external
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+CTOOLBOX_API cdarray* cdarray_init(size_t elementSize)
+{
+    return cdarray_init_memfuncs(elementSize, &CTOOLBOX_DEFAULT_MEMFUNCS);
+}
+
+CTOOLBOX_API cdarray* cdarray_init_memfuncs(size_t elementSize, const ctoolbox_memfuncs* memfuncs)
+{
+    if (elementSize == 0) return NULL;
+
+    cdarray* outArray = ctoolbox_custom_malloc(memfuncs ? memfuncs : &CTOOLBOX_DEFAULT_MEMFUNCS, sizeof(cdarray));
+    if (!outArray) return NULL;
+
+    memset(outArray, 0, sizeof(cdarray));
+    outArray->elementSize = elementSize;
+    cthread_mutex_init(&outArray->lock);
+
+    if (memfuncs) outArray->memfuncs = *memfuncs;
+    else outArray->memfuncs = CTOOLBOX_DEFAULT_MEMFUNCS;
+
+    ctoolbox_memstats_on_alloc(&outArray->stats, sizeof(cdarray));
+
+    return outArray;
+}
+
+CTOOLBOX_API void cdarray_destroy(cdarray* array)
+{
+    if (!array) return;
+
+    for (size_t i = 0; i < CDARRAY_MAX_SEGMENTS; i++) {
+        if (!array->segments[i] || array->segments[i] == CDARRAY_ABANDONED) continue;
+        ctoolbox_custom_free_sized(&array->memfuncs, array->segments[i], cdarray_segment_bytes(array, i));
+    }
+    cthread_mutex_destroy(&array->lock);
+    ctoolbox_custom_free_sized(&array->memfuncs, array, sizeof(cdarray));
+}
+
+CTOOLBOX_API ctoolbox_result cdarray_push_back(cdarray* array, const void* element, size_t* indexOut)
+{
+    if (!array || !element) return CTOOLBOX_ERROR_INVALID_PARAM;
+
+    size_t index;
+    void* slot = cdarray_claim(array, &index);
+    if (!slot) return CTOOLBOX_ERROR_MEMORY_ALLOC;
+
+    memcpy(slot, element, array->elementSize);
+    cdarray_commit(array, index);
+
+    if (indexOut) *indexOut = index;
+    return CTOOLBOX_SUCCESS;
+}
+
+CTOOLBOX_API void* cdarray_claim(cdarray* array, size_t* indexOut)
+{
+    if (!array) return NULL;
+
+    for (;;) {
+        uint64_t index = cthread_atomic_fetch_add(&array->claimed, 1);
+        if (index > SIZE_MAX - CDARRAY_FIRST_SEGMENT) return NULL;
+
+        size_t segmentIndex, offset;
+        cdarray_locate(index, &segmentIndex, &offset);
+
+        // the rest of a segment given up earlier is skipped at once, instead of failing once per slot
+        char* segment = cthread_atomic_load_ptr(&array->segments[segmentIndex]);
+        if (segment == CDARRAY_ABANDONED) {
+            uint64_t end = index - offset + cdarray_segment_length(segmentIndex);
+            uint64_t current = index + 1;
+            while (current < end && !cthread_atomic_compare_exchange(&array->claimed, &current, end));
+            continue;
+        }
+
+        // this slot is abandoned with its segment when the segment can't be allocated
+        if (!segment) segment = cdarray_segment(array, segmentIndex);
+        if (segment == CDARRAY_ABANDONED) return NULL;
+
+        if (indexOut) *indexOut = (size_t)index;
+        return segment + offset * array->elementSize;
+    }
+}
+
+CTOOLBOX_API void cdarray_commit(cdarray* array, size_t index)
+{
+    if (!array || index > SIZE_MAX - CDARRAY_FIRST_SEGMENT) return;
+
+    size_t segmentIndex, offset;
+    cdarray_locate(index, &segmentIndex, &offset);
+
+    char* segment = cthread_atomic_load_ptr(&array->segments[segmentIndex]);
+    if (!segment || segment == CDARRAY_ABANDONED) return;
+
+    // the element's bytes are written before its bit is visible
+    cthread_atomic_fetch_or(cdarray_bitmap(array, segment, segmentIndex) + offset / 64, (uint64_t)1 << (offset % 64));
+}
+
+CTOOLBOX_API size_t cdarray_committed(cdarray* array)
+{
+    if (!array) return 0;
+
+    // walk the published bits past the last known prefix, a word at a time
+    uint64_t start = cthread_atomic_load(&array->committed);
+    uint64_t committed = start;
+    uint64_t claimed = cthread_atomic_load(&array->claimed);
+    while (committed < claimed) {
+        size_t segmentIndex, offset;
+        cdarray_locate(committed, &segmentIndex, &offset);
+
+        char* segment = cthread_atomic_load_ptr(&array->segments[segmentIndex]);
+        if (!segment) break;
+
+        // nothing in a given up segment will ever be published, the prefix steps over it
+        if (segment == CDARRAY_ABANDONED) {
+            committed += cdarray_segment_length(segmentIndex) - offset;
+            continue;
+        }
+
+        uint64_t word = cthread_atomic_load(cdarray_bitmap(array, segment, segmentIndex) + offset / 64);
+        uint64_t unpublished = ~word >> (offset % 64);
+        size_t run = unpublished ? cdarray_ctz(unpublished) : 64 - offset % 64;
+        if (run == 0) break;
+
+        committed += run;
+    }
+    if (committed > claimed) committed = claimed;
+
+    // readers racing here only ever move the prefix forward
+    while (start < committed && !cthread_atomic_compare_exchange(&array->committed, &start, committed));
+    return (size_t)(start > committed ? start : committed);
+}
+
+CTOOLBOX_API const void* cdarray_const_peek(const cdarray* array, size_t index)
+{
+    if (!array || index > SIZE_MAX - CDARRAY_FIRST_SEGMENT) return NULL;
+
+    size_t segmentIndex, offset;
+    cdarray_locate(index, &segmentIndex, &offset);
+
+    char* segment = cthread_atomic_load_ptr(&array->segments[segmentIndex]);
+    if (!segment || segment == CDARRAY_ABANDONED) return NULL;
+
+    uint64_t word = cthread_atomic_load(cdarray_bitmap(array, segment, segmentIndex) + offset / 64);
+    if (!(word & ((uint64_t)1 << (offset % 64)))) return NULL;
+
+    return segment + offset * array->elementSize;
+}
+
+CTOOLBOX_API ctoolbox_result cdarray_get(const cdarray* array, size_t index, void* elementOut)
+{
+    if (!array || !elementOut) return CTOOLBOX_ERROR_INVALID_PARAM;
+
+    const void* element = cdarray_const_peek(array, index);
+    if (!element) return CTOOLBOX_ERROR_NOT_FOUND;
+
+    memcpy(elementOut, element, array->elementSize);
+    return CTOOLBOX_SUCCESS;
+}
+
+CTOOLBOX_API size_t cdarray_size(const cdarray* array)
+{
+    return array ? (size_t)cthread_atomic_load(&array->claimed) : 0;
+}
+
+CTOOLBOX_API ctoolbox_result cdarray_memory_usage(cdarray* array, ctoolbox_memstats* statsOut)
+{
+    if (!array || !statsOut) return CTOOLBOX_ERROR_INVALID_PARAM;
+
+    cthread_mutex_lock(&array->lock);
+    *statsOut = array->stats;
+    cthread_mutex_unlock(&array->lock);
+    return CTOOLBOX_SUCCESS;
+}
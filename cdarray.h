@@ -0,0 +1,62 @@
+#ifndef CDARRAY_INCLUDED
+#define CDARRAY_INCLUDED
+
+#include "context.h"
+
+/// @brief log2 of the element count of the first segment, each following segment doubles the previous one, at least 6
+#ifndef CDARRAY_FIRST_SEGMENT_SHIFT
+    #define CDARRAY_FIRST_SEGMENT_SHIFT 8
+#endif
+
+/// @brief opaque concurrent append-only array structure
+typedef struct cdarray cdarray;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// functions
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// @brief initializes the concurrent array, appends and reads may come from any thread, elements never move
+CTOOLBOX_API cdarray* cdarray_init(size_t elementSize);
+
+/// @brief initializes the concurrent array with custom memory allocation functions, which must be thread-safe
+CTOOLBOX_API cdarray* cdarray_init_memfuncs(size_t elementSize, const ctoolbox_memfuncs* memfuncs);
+
+/// @brief destroys the concurrent array, no other thread may be using it
+CTOOLBOX_API void cdarray_destroy(cdarray* array);
+
+/// @brief appends a copy of the element and publishes it, writing its index into indexOut if not NULL
+CTOOLBOX_API ctoolbox_result cdarray_push_back(cdarray* array, const void* element, size_t* indexOut);
+
+/// @brief claims the next slot with an atomic fetch-and-add and returns its address to be written in place
+/// @brief NULL when the segment holding the slot can't be allocated, the segment is then given up: its slots are never readable
+/// @brief and cdarray_committed steps over them, later claims move on to the next segment
+/// @brief the slot stays invisible to readers until cdarray_commit is called with its index
+CTOOLBOX_API void* cdarray_claim(cdarray* array, size_t* indexOut);
+
+/// @brief publishes a slot returned by cdarray_claim
+CTOOLBOX_API void cdarray_commit(cdarray* array, size_t index);
+
+/// @brief returns how many elements from the front are published, every index below it can be read safely unless its segment was given up
+CTOOLBOX_API size_t cdarray_committed(cdarray* array);
+
+/// @brief returns the address of the element at the index, NULL if it isn't published
+CTOOLBOX_API const void* cdarray_const_peek(const cdarray* array, size_t index);
+
+/// @brief copies the element at the index into elementOut, CTOOLBOX_ERROR_NOT_FOUND if it isn't published
+CTOOLBOX_API ctoolbox_result cdarray_get(const cdarray* array, size_t index, void* elementOut);
+
+/// @brief returns how many slots were claimed, published, unpublished or given up
+CTOOLBOX_API size_t cdarray_size(const cdarray* array);
+
+/// @brief returns the memory the array allocated, its header included
+CTOOLBOX_API ctoolbox_result cdarray_memory_usage(cdarray* array, ctoolbox_memstats* statsOut);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CDARRAY_INCLUDED
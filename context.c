@@ -1,30 +1,268 @@
+// posix_memalign is hidden by strict c modes unless posix is asked for
+#if !defined(_WIN32) && !defined(_WIN64) && !defined(_POSIX_C_SOURCE)
+    #define _POSIX_C_SOURCE 200112L
+#endif
+
 #include "context.h"
 #include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32) || defined(_WIN64)
+    #include <malloc.h>
+#endif
+
+// the plain callbacks are the c library ones, so the platform aligned allocator may be used instead
+static inline bool ctoolbox_is_libc(const ctoolbox_memfuncs* fun)
+{
+    return (!fun->malloc_fn || fun->malloc_fn == malloc) && (!fun->free_fn || fun->free_fn == free);
+}
 
 CTOOLBOX_API const ctoolbox_memfuncs CTOOLBOX_DEFAULT_MEMFUNCS =
 {
     .malloc_fn = malloc,
     .calloc_fn = calloc,
     .free_fn = free,
-    .realloc_fn = realloc
+    .realloc_fn = realloc,
+    .aligned_malloc_fn = NULL,
+    .aligned_free_fn = NULL,
+    .free_sized_fn = NULL,
+    .alloc_ctx_fn = NULL,
+    .realloc_ctx_fn = NULL,
+    .free_ctx_fn = NULL,
+    .user = NULL
 };
 
 CTOOLBOX_API void* ctoolbox_custom_malloc(const ctoolbox_memfuncs* fun, size_t size)
 {
+    if (fun->alloc_ctx_fn) return fun->alloc_ctx_fn(fun->user, size, CTOOLBOX_DEFAULT_ALIGNMENT);
     return fun->malloc_fn ? fun->malloc_fn(size) : malloc(size);
 }
 
 CTOOLBOX_API void* ctoolbox_custom_calloc(const ctoolbox_memfuncs* fun, size_t num, size_t size)
 {
+    if (fun->alloc_ctx_fn) {
+        if (size != 0 && num > SIZE_MAX / size) return NULL;
+
+        void* ptr = fun->alloc_ctx_fn(fun->user, num * size, CTOOLBOX_DEFAULT_ALIGNMENT);
+        if (ptr) memset(ptr, 0, num * size);
+        return ptr;
+    }
     return fun->calloc_fn ? fun->calloc_fn(num, size) : calloc(num, size);
 }
 
 CTOOLBOX_API void ctoolbox_custom_free(const ctoolbox_memfuncs* fun, void* ptr)
 {
+    ctoolbox_custom_free_sized(fun, ptr, 0);
+}
+
+CTOOLBOX_API void ctoolbox_custom_free_sized(const ctoolbox_memfuncs* fun, void* ptr, size_t size)
+{
+    // an allocator without a free callback (e.g. a bump allocator) releases everything at once on its own
+    if (fun->alloc_ctx_fn) {
+        if (ptr && fun->free_ctx_fn) fun->free_ctx_fn(fun->user, ptr, size);
+        return;
+    }
+
+    if (ptr && size && fun->free_sized_fn) {
+        fun->free_sized_fn(ptr, size);
+        return;
+    }
     fun->free_fn ? fun->free_fn(ptr) : free(ptr);
 }
 
 CTOOLBOX_API void* ctoolbox_custom_realloc(const ctoolbox_memfuncs* fun, void* ptr, size_t newSize)
 {
+    return ctoolbox_custom_realloc_sized(fun, ptr, 0, newSize);
+}
+
+CTOOLBOX_API void* ctoolbox_custom_realloc_sized(const ctoolbox_memfuncs* fun, void* ptr, size_t oldSize, size_t newSize)
+{
+    if (fun->alloc_ctx_fn) {
+        if (fun->realloc_ctx_fn) return fun->realloc_ctx_fn(fun->user, ptr, oldSize, newSize, CTOOLBOX_DEFAULT_ALIGNMENT);
+
+        // fallback: allocate, copy and free, which takes knowing how much to copy
+        if (ptr && oldSize == 0) return NULL;
+        void* newPtr = fun->alloc_ctx_fn(fun->user, newSize, CTOOLBOX_DEFAULT_ALIGNMENT);
+        if (!newPtr) return NULL;
+
+        if (ptr) {
+            memcpy(newPtr, ptr, oldSize < newSize ? oldSize : newSize);
+            if (fun->free_ctx_fn) fun->free_ctx_fn(fun->user, ptr, oldSize);
+        }
+        return newPtr;
+    }
     return fun->realloc_fn ? fun->realloc_fn(ptr, newSize) : realloc(ptr, newSize);
 }
+
+CTOOLBOX_API void* ctoolbox_custom_aligned_malloc(const ctoolbox_memfuncs* fun, size_t size, size_t alignment)
+{
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0) return NULL;
+    if (fun->alloc_ctx_fn) return fun->alloc_ctx_fn(fun->user, size, alignment);
+    if (alignment <= CTOOLBOX_DEFAULT_ALIGNMENT) return ctoolbox_custom_malloc(fun, size);
+    if (fun->aligned_malloc_fn && fun->aligned_free_fn) return fun->aligned_malloc_fn(size, alignment);
+
+    if (ctoolbox_is_libc(fun)) {
+#if defined(_WIN32) || defined(_WIN64)
+        return _aligned_malloc(size, alignment);
+#else
+        void* ptr = NULL;
+        return posix_memalign(&ptr, alignment, size) == 0 ? ptr : NULL;
+#endif
+    }
+
+    // fallback: over-allocate and keep the original pointer right before the aligned block
+    if (size > SIZE_MAX - alignment - sizeof(void*)) return NULL;
+
+    void* raw = ctoolbox_custom_malloc(fun, size + alignment + sizeof(void*));
+    if (!raw) return NULL;
+
+    uintptr_t aligned = ((uintptr_t)raw + sizeof(void*) + (alignment - 1)) & ~(uintptr_t)(alignment - 1);
+    ((void**)aligned)[-1] = raw;
+    return (void*)aligned;
+}
+
+CTOOLBOX_API void ctoolbox_custom_aligned_free(const ctoolbox_memfuncs* fun, void* ptr, size_t alignment)
+{
+    ctoolbox_custom_aligned_free_sized(fun, ptr, 0, alignment);
+}
+
+CTOOLBOX_API void ctoolbox_custom_aligned_free_sized(const ctoolbox_memfuncs* fun, void* ptr, size_t size, size_t alignment)
+{
+    if (!ptr) return;
+    if (fun->alloc_ctx_fn || alignment <= CTOOLBOX_DEFAULT_ALIGNMENT) {
+        ctoolbox_custom_free_sized(fun, ptr, size);
+        return;
+    }
+
+    if (fun->aligned_malloc_fn && fun->aligned_free_fn) {
+        fun->aligned_free_fn(ptr);
+        return;
+    }
+
+    if (ctoolbox_is_libc(fun)) {
+#if defined(_WIN32) || defined(_WIN64)
+        _aligned_free(ptr);
+#else
+        free(ptr);
+#endif
+        return;
+    }
+
+    ctoolbox_custom_free_sized(fun, ((void**)ptr)[-1], size ? size + alignment + sizeof(void*) : 0);
+}
+
+CTOOLBOX_API void* ctoolbox_custom_aligned_realloc(const ctoolbox_memfuncs* fun, void* ptr, size_t oldSize, size_t newSize, size_t alignment)
+{
+    if (fun->realloc_ctx_fn) return fun->realloc_ctx_fn(fun->user, ptr, oldSize, newSize, alignment);
+    if (alignment <= CTOOLBOX_DEFAULT_ALIGNMENT && (fun->realloc_fn || fun->alloc_ctx_fn)) {
+        return ctoolbox_custom_realloc_sized(fun, ptr, oldSize, newSize);
+    }
+
+    // fallback: allocate, copy and free
+    void* newPtr = ctoolbox_custom_aligned_malloc(fun, newSize, alignment);
+    if (!newPtr) return NULL;
+
+    if (ptr) {
+        memcpy(newPtr, ptr, oldSize < newSize ? oldSize : newSize);
+        ctoolbox_custom_aligned_free_sized(fun, ptr, oldSize, alignment);
+    }
+    return newPtr;
+}
+
+CTOOLBOX_API void ctoolbox_memstats_on_alloc(ctoolbox_memstats* stats, size_t bytes)
+{
+    stats->liveBytes += bytes;
+    stats->allocCount++;
+    if (stats->liveBytes > stats->peakBytes) stats->peakBytes = stats->liveBytes;
+}
+
+CTOOLBOX_API void ctoolbox_memstats_on_realloc(ctoolbox_memstats* stats, size_t oldBytes, size_t newBytes)
+{
+    stats->liveBytes = stats->liveBytes - oldBytes + newBytes;
+    stats->reallocCount++;
+    if (stats->liveBytes > stats->peakBytes) stats->peakBytes = stats->liveBytes;
+}
+
+CTOOLBOX_API void ctoolbox_memstats_on_free(ctoolbox_memstats* stats, size_t bytes)
+{
+    stats->liveBytes -= bytes;
+    stats->freeCount++;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// tracker
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// every tracked block is preceded by a header of max(alignment, 16) bytes ending with its alignment and size
+static inline size_t ctoolbox_tracker_header(size_t alignment)
+{
+    return alignment > 2 * sizeof(size_t) ? alignment : 2 * sizeof(size_t);
+}
+
+static void* ctoolbox_tracker_alloc(void* user, size_t size, size_t alignment)
+{
+    ctoolbox_tracker* tracker = (ctoolbox_tracker*)user;
+    size_t header = ctoolbox_tracker_header(alignment);
+    if (size > SIZE_MAX - header) return NULL;
+
+    char* raw = ctoolbox_custom_aligned_malloc(&tracker->inner, header + size, alignment);
+    if (!raw) return NULL;
+
+    size_t* info = (size_t*)(raw + header) - 2;
+    info[0] = alignment;
+    info[1] = size;
+
+    ctoolbox_memstats_on_alloc(&tracker->stats, size);
+    return raw + header;
+}
+
+static void* ctoolbox_tracker_realloc(void* user, void* ptr, size_t oldSize, size_t newSize, size_t alignment)
+{
+    (void)oldSize;
+    if (!ptr) return ctoolbox_tracker_alloc(user, newSize, alignment);
+
+    ctoolbox_tracker* tracker = (ctoolbox_tracker*)user;
+    size_t* info = (size_t*)ptr - 2;
+    size_t blockAlignment = info[0];
+    size_t blockSize = info[1];
+    size_t header = ctoolbox_tracker_header(blockAlignment);
+    if (newSize > SIZE_MAX - header) return NULL;
+
+    char* raw = ctoolbox_custom_aligned_realloc(&tracker->inner, (char*)ptr - header, header + blockSize, header + newSize, blockAlignment);
+    if (!raw) return NULL;
+
+    info = (size_t*)(raw + header) - 2;
+    info[1] = newSize;
+
+    ctoolbox_memstats_on_realloc(&tracker->stats, blockSize, newSize);
+    return raw + header;
+}
+
+static void ctoolbox_tracker_free(void* user, void* ptr, size_t size)
+{
+    (void)size;
+    ctoolbox_tracker* tracker = (ctoolbox_tracker*)user;
+    size_t* info = (size_t*)ptr - 2;
+    size_t header = ctoolbox_tracker_header(info[0]);
+
+    ctoolbox_memstats_on_free(&tracker->stats, info[1]);
+    ctoolbox_custom_aligned_free_sized(&tracker->inner, (char*)ptr - header, header + info[1], info[0]);
+}
+
+CTOOLBOX_API void ctoolbox_tracker_init(ctoolbox_tracker* tracker, const ctoolbox_memfuncs* inner)
+{
+    if (!tracker) return;
+
+    memset(tracker, 0, sizeof(ctoolbox_tracker));
+    tracker->inner = inner ? *inner : CTOOLBOX_DEFAULT_MEMFUNCS;
+}
+
+CTOOLBOX_API ctoolbox_memfuncs ctoolbox_tracker_memfuncs(ctoolbox_tracker* tracker)
+{
+    ctoolbox_memfuncs memfuncs = { 0 };
+    memfuncs.alloc_ctx_fn = ctoolbox_tracker_alloc;
+    memfuncs.realloc_ctx_fn = ctoolbox_tracker_realloc;
+    memfuncs.free_ctx_fn = ctoolbox_tracker_free;
+    memfuncs.user = tracker;
+    return memfuncs;
+}
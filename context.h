@@ -31,7 +31,9 @@ typedef enum ctoolbox_result
     CTOOLBOX_ERROR_OUT_OF_BOUNDS,
     CTOOLBOX_ERROR_EMPTY,
     CTOOLBOX_ERROR_NOT_FOUND,
-    CTOOLBOX_ERROR_FULL
+    CTOOLBOX_ERROR_FULL,
+    CTOOLBOX_ERROR_UNSUPPORTED,
+    CTOOLBOX_ERROR_IO
 } ctoolbox_result;
 
 /// @brief callback for custom allocation memories
@@ -39,19 +41,57 @@ typedef void* (*malloc_func)(size_t size);
 typedef void* (*calloc_func)(size_t num, size_t size);
 typedef void (*free_func)(void* ptr);
 typedef void* (*realloc_func)(void* ptr, size_t newSize);
+typedef void* (*aligned_malloc_func)(size_t size, size_t alignment);
+typedef void (*aligned_free_func)(void* ptr);
+typedef void (*free_sized_func)(void* ptr, size_t size);
 
-/// @brief bundle-up the memory functions into one structure
+/// @brief alignment requested by the library when it has no stricter requirement
+#ifndef CTOOLBOX_DEFAULT_ALIGNMENT
+    #define CTOOLBOX_DEFAULT_ALIGNMENT (2 * sizeof(void*))
+#endif
+
+/// @brief context-carrying callbacks, user is the pointer stored in ctoolbox_memfuncs and alignment is a power of two
+/// @brief size on free and oldSize on realloc are the size of the block when the caller knows it, 0 otherwise
+typedef void* (*alloc_ctx_func)(void* user, size_t size, size_t alignment);
+typedef void* (*realloc_ctx_func)(void* user, void* ptr, size_t oldSize, size_t newSize, size_t alignment);
+typedef void (*free_ctx_func)(void* user, void* ptr, size_t size);
+
+/// @brief bundle-up the memory functions into one structure, context-carrying callbacks take precedence when set
 typedef struct ctoolbox_memfuncs
 {
     malloc_func malloc_fn;
     calloc_func calloc_fn;
     free_func free_fn;
     realloc_func realloc_fn;
+    aligned_malloc_func aligned_malloc_fn;
+    aligned_free_func aligned_free_fn;
+    free_sized_func free_sized_fn;      // sdallocx/free_sized style, used instead of free_fn when the size is known
+    alloc_ctx_func alloc_ctx_fn;
+    realloc_ctx_func realloc_ctx_fn;
+    free_ctx_func free_ctx_fn;
+    void* user;
 } ctoolbox_memfuncs;
 
 /// @brief export memory functions
 CTOOLBOX_API extern const ctoolbox_memfuncs CTOOLBOX_DEFAULT_MEMFUNCS;
 
+/// @brief memory accounting of an allocator or a container
+typedef struct ctoolbox_memstats
+{
+    size_t liveBytes;       // bytes currently allocated
+    size_t peakBytes;       // highest liveBytes seen
+    size_t allocCount;      // allocations made
+    size_t reallocCount;    // reallocations made
+    size_t freeCount;       // blocks released
+} ctoolbox_memstats;
+
+/// @brief tracking allocator, accounts everything allocated through the memory functions it wraps
+typedef struct ctoolbox_tracker
+{
+    ctoolbox_memfuncs inner;
+    ctoolbox_memstats stats;
+} ctoolbox_tracker;
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // functions
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -69,9 +109,44 @@ CTOOLBOX_API void* ctoolbox_custom_calloc(const ctoolbox_memfuncs* fun, size_t n
 /// @brief custom free call, overrides default free with an optional custom function provided by the user
 CTOOLBOX_API void ctoolbox_custom_free(const ctoolbox_memfuncs* fun, void* ptr);
 
+/// @brief custom sized free call, size must be the one the block was allocated with, 0 when unknown
+CTOOLBOX_API void ctoolbox_custom_free_sized(const ctoolbox_memfuncs* fun, void* ptr, size_t size);
+
 /// @brief custom realloc call, overrides default realloc with an optional custom function provided by the user
+/// @brief context-carrying callbacks get no old size, those unable to find it on their own fail, see ctoolbox_custom_realloc_sized
 CTOOLBOX_API void* ctoolbox_custom_realloc(const ctoolbox_memfuncs* fun, void* ptr, size_t newSize);
 
+/// @brief custom sized realloc call, oldSize must be the size the block was allocated with, 0 when unknown
+/// @brief oldSize is only forwarded to context-carrying callbacks, which need it to move the block themselves
+CTOOLBOX_API void* ctoolbox_custom_realloc_sized(const ctoolbox_memfuncs* fun, void* ptr, size_t oldSize, size_t newSize);
+
+/// @brief custom aligned malloc call, alignment must be a power of two and the block released with ctoolbox_custom_aligned_free
+CTOOLBOX_API void* ctoolbox_custom_aligned_malloc(const ctoolbox_memfuncs* fun, size_t size, size_t alignment);
+
+/// @brief custom aligned free call, alignment must match the one used to allocate the block
+CTOOLBOX_API void ctoolbox_custom_aligned_free(const ctoolbox_memfuncs* fun, void* ptr, size_t alignment);
+
+/// @brief custom aligned sized free call, size and alignment must be the ones the block was allocated with
+CTOOLBOX_API void ctoolbox_custom_aligned_free_sized(const ctoolbox_memfuncs* fun, void* ptr, size_t size, size_t alignment);
+
+/// @brief custom aligned realloc call, the new block keeps the alignment, falls back to allocate, copy and free
+CTOOLBOX_API void* ctoolbox_custom_aligned_realloc(const ctoolbox_memfuncs* fun, void* ptr, size_t oldSize, size_t newSize, size_t alignment);
+
+/// @brief accounts an allocation of bytes into stats
+CTOOLBOX_API void ctoolbox_memstats_on_alloc(ctoolbox_memstats* stats, size_t bytes);
+
+/// @brief accounts a reallocation from oldBytes to newBytes into stats
+CTOOLBOX_API void ctoolbox_memstats_on_realloc(ctoolbox_memstats* stats, size_t oldBytes, size_t newBytes);
+
+/// @brief accounts the release of bytes into stats
+CTOOLBOX_API void ctoolbox_memstats_on_free(ctoolbox_memstats* stats, size_t bytes);
+
+/// @brief initializes the tracker on top of the inner memory functions, NULL wraps the default ones
+CTOOLBOX_API void ctoolbox_tracker_init(ctoolbox_tracker* tracker, const ctoolbox_memfuncs* inner);
+
+/// @brief returns memory functions that allocate through the tracker, which must outlive whatever uses them
+CTOOLBOX_API ctoolbox_memfuncs ctoolbox_tracker_memfuncs(ctoolbox_tracker* tracker);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,261 @@
+#include "csimd.h"
+
+#include <string.h>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// internal
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// element sizes the vector kernels handle, they evenly divide a vector so no element straddles two
+static inline bool csimd_vector_size(size_t elementSize)
+{
+    return elementSize == 1 || elementSize == 2 || elementSize == 4 || elementSize == 8;
+}
+
+static size_t csimd_find_scalar(const char* data, size_t count, size_t elementSize, const void* value)
+{
+    for (size_t i = 0; i < count; i++) {
+        if (memcmp(data + i * elementSize, value, elementSize) == 0) return i;
+    }
+    return count;
+}
+
+static size_t csimd_count_scalar(const char* data, size_t count, size_t elementSize, const void* value)
+{
+    size_t matches = 0;
+    for (size_t i = 0; i < count; i++) {
+        matches += memcmp(data + i * elementSize, value, elementSize) == 0;
+    }
+    return matches;
+}
+
+#if defined(CSIMD_X86)
+static inline uint32_t csimd_popcount(uint32_t value)
+{
+    value = value - ((value >> 1) & 0x55555555u);
+    value = (value & 0x33333333u) + ((value >> 2) & 0x33333333u);
+    return (((value + (value >> 4)) & 0x0f0f0f0fu) * 0x01010101u) >> 24;
+}
+
+static inline uint32_t csimd_ctz(uint32_t value)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index;
+    _BitScanForward(&index, value);
+    return (uint32_t)index;
+#else
+    return (uint32_t)__builtin_ctz(value);
+#endif
+}
+
+// reduces a byte equality mask to one bit per fully equal element, set on the element's first byte
+static inline uint32_t csimd_element_mask(uint32_t mask, size_t elementSize)
+{
+    switch (elementSize)
+    {
+        case 2: mask &= mask >> 1; return mask & 0x55555555u;
+        case 4: mask &= mask >> 1; mask &= mask >> 2; return mask & 0x11111111u;
+        case 8: mask &= mask >> 1; mask &= mask >> 2; mask &= mask >> 4; return mask & 0x01010101u;
+        default: return mask;
+    }
+}
+
+// value repeated across a whole vector
+static inline void csimd_pattern(unsigned char* pattern, size_t patternSize, size_t elementSize, const void* value)
+{
+    for (size_t i = 0; i < patternSize; i += elementSize) memcpy(pattern + i, value, elementSize);
+}
+
+static bool csimd_has_avx2(void)
+{
+    static volatile int supported = -1;
+    if (supported >= 0) return supported != 0;
+
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    bool avx2 = false;
+    if (info[0] >= 7) {
+        __cpuid(info, 1);
+        bool osxsave = (info[2] & (1 << 27)) != 0;
+        __cpuidex(info, 7, 0);
+        avx2 = osxsave && (info[1] & (1 << 5)) != 0 && (_xgetbv(0) & 6) == 6;
+    }
+    supported = avx2;
+#else
+    __builtin_cpu_init();
+    supported = __builtin_cpu_supports("avx2") != 0;
+#endif
+    return supported != 0;
+}
+
+static size_t csimd_find_sse2(const char* data, size_t count, size_t elementSize, const void* value)
+{
+    unsigned char pattern[16];
+    csimd_pattern(pattern, sizeof(pattern), elementSize, value);
+    const __m128i needle = _mm_loadu_si128((const __m128i*)pattern);
+
+    size_t bytes = count * elementSize;
+    size_t i = 0;
+    for (; i + 16 <= bytes; i += 16) {
+        __m128i block = _mm_loadu_si128((const __m128i*)(data + i));
+        uint32_t mask = csimd_element_mask((uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(block, needle)), elementSize);
+        if (mask) return (i + csimd_ctz(mask)) / elementSize;
+    }
+    return i / elementSize + csimd_find_scalar(data + i, count - i / elementSize, elementSize, value);
+}
+
+static size_t csimd_count_sse2(const char* data, size_t count, size_t elementSize, const void* value)
+{
+    unsigned char pattern[16];
+    csimd_pattern(pattern, sizeof(pattern), elementSize, value);
+    const __m128i needle = _mm_loadu_si128((const __m128i*)pattern);
+
+    size_t bytes = count * elementSize;
+    size_t matches = 0;
+    size_t i = 0;
+    for (; i + 16 <= bytes; i += 16) {
+        __m128i block = _mm_loadu_si128((const __m128i*)(data + i));
+        matches += csimd_popcount(csimd_element_mask((uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(block, needle)), elementSize));
+    }
+    return matches + csimd_count_scalar(data + i, count - i / elementSize, elementSize, value);
+}
+
+static void csimd_fill_sse2(char* data, size_t count, size_t elementSize, const void* value)
+{
+    unsigned char pattern[16];
+    csimd_pattern(pattern, sizeof(pattern), elementSize, value);
+    const __m128i fill = _mm_loadu_si128((const __m128i*)pattern);
+
+    size_t bytes = count * elementSize;
+    size_t i = 0;
+    for (; i + 16 <= bytes; i += 16) _mm_storeu_si128((__m128i*)(data + i), fill);
+    memcpy(data + i, pattern, bytes - i);
+}
+
+static bool csimd_equal_sse2(const char* a, const char* b, size_t bytes)
+{
+    size_t i = 0;
+    for (; i + 16 <= bytes; i += 16) {
+        __m128i left = _mm_loadu_si128((const __m128i*)(a + i));
+        __m128i right = _mm_loadu_si128((const __m128i*)(b + i));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(left, right)) != 0xffff) return false;
+    }
+    return memcmp(a + i, b + i, bytes - i) == 0;
+}
+
+CSIMD_TARGET_AVX2 static size_t csimd_find_avx2(const char* data, size_t count, size_t elementSize, const void* value)
+{
+    unsigned char pattern[32];
+    csimd_pattern(pattern, sizeof(pattern), elementSize, value);
+    const __m256i needle = _mm256_loadu_si256((const __m256i*)pattern);
+
+    size_t bytes = count * elementSize;
+    size_t i = 0;
+    for (; i + 32 <= bytes; i += 32) {
+        __m256i block = _mm256_loadu_si256((const __m256i*)(data + i));
+        uint32_t mask = csimd_element_mask((uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, needle)), elementSize);
+        if (mask) return (i + csimd_ctz(mask)) / elementSize;
+    }
+    return i / elementSize + csimd_find_sse2(data + i, count - i / elementSize, elementSize, value);
+}
+
+CSIMD_TARGET_AVX2 static size_t csimd_count_avx2(const char* data, size_t count, size_t elementSize, const void* value)
+{
+    unsigned char pattern[32];
+    csimd_pattern(pattern, sizeof(pattern), elementSize, value);
+    const __m256i needle = _mm256_loadu_si256((const __m256i*)pattern);
+
+    size_t bytes = count * elementSize;
+    size_t matches = 0;
+    size_t i = 0;
+    for (; i + 32 <= bytes; i += 32) {
+        __m256i block = _mm256_loadu_si256((const __m256i*)(data + i));
+        matches += csimd_popcount(csimd_element_mask((uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, needle)), elementSize));
+    }
+    return matches + csimd_count_sse2(data + i, count - i / elementSize, elementSize, value);
+}
+
+CSIMD_TARGET_AVX2 static void csimd_fill_avx2(char* data, size_t count, size_t elementSize, const void* value)
+{
+    unsigned char pattern[32];
+    csimd_pattern(pattern, sizeof(pattern), elementSize, value);
+    const __m256i fill = _mm256_loadu_si256((const __m256i*)pattern);
+
+    size_t bytes = count * elementSize;
+    size_t i = 0;
+    for (; i + 32 <= bytes; i += 32) _mm256_storeu_si256((__m256i*)(data + i), fill);
+    memcpy(data + i, pattern, bytes - i);
+}
+
+CSIMD_TARGET_AVX2 static bool csimd_equal_avx2(const char* a, const char* b, size_t bytes)
+{
+    size_t i = 0;
+    for (; i + 32 <= bytes; i += 32) {
+        __m256i left = _mm256_loadu_si256((const __m256i*)(a + i));
+        __m256i right = _mm256_loadu_si256((const __m256i*)(b + i));
+        if ((uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(left, right)) != 0xffffffffu) return false;
+    }
+    return csimd_equal_sse2(a + i, b + i, bytes - i);
+}
+#endif
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// external
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+size_t csimd_find(const void* data, size_t count, size_t elementSize, const void* value)
+{
+#if defined(CSIMD_X86)
+    if (csimd_vector_size(elementSize)) {
+        if (csimd_has_avx2()) return csimd_find_avx2((const char*)data, count, elementSize, value);
+        return csimd_find_sse2((const char*)data, count, elementSize, value);
+    }
+#endif
+    return csimd_find_scalar((const char*)data, count, elementSize, value);
+}
+
+size_t csimd_count(const void* data, size_t count, size_t elementSize, const void* value)
+{
+#if defined(CSIMD_X86)
+    if (csimd_vector_size(elementSize)) {
+        if (csimd_has_avx2()) return csimd_count_avx2((const char*)data, count, elementSize, value);
+        return csimd_count_sse2((const char*)data, count, elementSize, value);
+    }
+#endif
+    return csimd_count_scalar((const char*)data, count, elementSize, value);
+}
+
+void csimd_fill(void* data, size_t count, size_t elementSize, const void* value)
+{
+    if (count == 0) return;
+
+#if defined(CSIMD_X86)
+    if (csimd_vector_size(elementSize)) {
+        if (csimd_has_avx2()) csimd_fill_avx2((char*)data, count, elementSize, value);
+        else csimd_fill_sse2((char*)data, count, elementSize, value);
+        return;
+    }
+#endif
+
+    // other sizes double the filled prefix on each copy
+    char* bytes = (char*)data;
+    size_t total = count * elementSize;
+    size_t filled = elementSize;
+    memcpy(bytes, value, elementSize);
+    while (filled < total) {
+        size_t chunk = filled < total - filled ? filled : total - filled;
+        memcpy(bytes + filled, bytes, chunk);
+        filled += chunk;
+    }
+}
+
+bool csimd_equal(const void* a, const void* b, size_t bytes)
+{
+#if defined(CSIMD_X86)
+    if (csimd_has_avx2()) return csimd_equal_avx2((const char*)a, (const char*)b, bytes);
+    return csimd_equal_sse2((const char*)a, (const char*)b, bytes);
+#else
+    return memcmp(a, b, bytes) == 0;
+#endif
+}
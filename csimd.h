@@ -0,0 +1,34 @@
+#ifndef CSIMD_INCLUDED
+#define CSIMD_INCLUDED
+
+#include "context.h"
+
+/// @brief internal vectorised kernels for the containers, SSE2/AVX2 picked at runtime on x86 with a scalar fallback elsewhere
+#if defined(__x86_64__) || defined(_M_X64) || (defined(__i386__) && defined(__SSE2__))
+    #include <immintrin.h>
+    #define CSIMD_X86 1
+    #if defined(_MSC_VER) && !defined(__clang__)
+        #include <intrin.h>
+        #define CSIMD_TARGET_AVX2
+    #else
+        #define CSIMD_TARGET_AVX2 __attribute__((target("avx2")))
+    #endif
+#endif
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// functions
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// @brief returns the index of the first of count elements equal to value byte for byte, or count if there is none
+size_t csimd_find(const void* data, size_t count, size_t elementSize, const void* value);
+
+/// @brief returns how many of count elements are equal to value byte for byte
+size_t csimd_count(const void* data, size_t count, size_t elementSize, const void* value);
+
+/// @brief copies value into each of the count elements
+void csimd_fill(void* data, size_t count, size_t elementSize, const void* value);
+
+/// @brief returns whether both buffers hold the same bytes
+bool csimd_equal(const void* a, const void* b, size_t bytes);
+
+#endif // CSIMD_INCLUDED
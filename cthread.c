@@ -0,0 +1,275 @@
+#include "cthread.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// mutex
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void cthread_mutex_init(cthread_mutex* mutex)
+{
+#if defined(_WIN32) || defined(_WIN64)
+    InitializeSRWLock(mutex);
+#else
+    pthread_mutex_init(mutex, NULL);
+#endif
+}
+
+void cthread_mutex_destroy(cthread_mutex* mutex)
+{
+#if defined(_WIN32) || defined(_WIN64)
+    (void)mutex; // slim locks hold no resources
+#else
+    pthread_mutex_destroy(mutex);
+#endif
+}
+
+void cthread_mutex_lock(cthread_mutex* mutex)
+{
+#if defined(_WIN32) || defined(_WIN64)
+    AcquireSRWLockExclusive(mutex);
+#else
+    pthread_mutex_lock(mutex);
+#endif
+}
+
+void cthread_mutex_unlock(cthread_mutex* mutex)
+{
+#if defined(_WIN32) || defined(_WIN64)
+    ReleaseSRWLockExclusive(mutex);
+#else
+    pthread_mutex_unlock(mutex);
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// condition variables
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void cthread_cond_init(cthread_cond* cond)
+{
+#if defined(_WIN32) || defined(_WIN64)
+    InitializeConditionVariable(cond);
+#else
+    pthread_cond_init(cond, NULL);
+#endif
+}
+
+void cthread_cond_destroy(cthread_cond* cond)
+{
+#if defined(_WIN32) || defined(_WIN64)
+    (void)cond; // condition variables hold no resources
+#else
+    pthread_cond_destroy(cond);
+#endif
+}
+
+void cthread_cond_wait(cthread_cond* cond, cthread_mutex* mutex)
+{
+#if defined(_WIN32) || defined(_WIN64)
+    SleepConditionVariableSRW(cond, mutex, INFINITE, 0);
+#else
+    pthread_cond_wait(cond, mutex);
+#endif
+}
+
+void cthread_cond_signal(cthread_cond* cond)
+{
+#if defined(_WIN32) || defined(_WIN64)
+    WakeConditionVariable(cond);
+#else
+    pthread_cond_signal(cond);
+#endif
+}
+
+void cthread_cond_broadcast(cthread_cond* cond)
+{
+#if defined(_WIN32) || defined(_WIN64)
+    WakeAllConditionVariable(cond);
+#else
+    pthread_cond_broadcast(cond);
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// threads
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#if defined(_WIN32) || defined(_WIN64)
+static DWORD WINAPI cthread_entry(LPVOID arg)
+{
+    cthread_thread* thread = (cthread_thread*)arg;
+    thread->func(thread->arg);
+    return 0;
+}
+#else
+static void* cthread_entry(void* arg)
+{
+    cthread_thread* thread = (cthread_thread*)arg;
+    thread->func(thread->arg);
+    return NULL;
+}
+#endif
+
+bool cthread_create(cthread_thread* thread, cthread_func func, void* arg)
+{
+    thread->func = func;
+    thread->arg = arg;
+
+#if defined(_WIN32) || defined(_WIN64)
+    thread->handle = CreateThread(NULL, 0, cthread_entry, thread, 0, NULL);
+    return thread->handle != NULL;
+#else
+    return pthread_create(&thread->handle, NULL, cthread_entry, thread) == 0;
+#endif
+}
+
+void cthread_join(cthread_thread* thread)
+{
+#if defined(_WIN32) || defined(_WIN64)
+    WaitForSingleObject(thread->handle, INFINITE);
+    CloseHandle(thread->handle);
+#else
+    pthread_join(thread->handle, NULL);
+#endif
+}
+
+void cthread_yield(void)
+{
+#if defined(_WIN32) || defined(_WIN64)
+    SwitchToThread();
+#else
+    sched_yield();
+#endif
+}
+
+bool cthread_key_create(cthread_key* key, cthread_key_destructor destructor)
+{
+#if defined(_WIN32) || defined(_WIN64)
+    // fiber local storage, unlike TlsAlloc, calls back on thread exit
+    *key = FlsAlloc(destructor);
+    return *key != FLS_OUT_OF_INDEXES;
+#else
+    return pthread_key_create(key, destructor) == 0;
+#endif
+}
+
+void cthread_key_set(cthread_key key, void* value)
+{
+#if defined(_WIN32) || defined(_WIN64)
+    FlsSetValue(key, value);
+#else
+    pthread_setspecific(key, value);
+#endif
+}
+
+size_t cthread_hardware_concurrency(void)
+{
+#if defined(_WIN32) || defined(_WIN64)
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? (size_t)info.dwNumberOfProcessors : 1;
+#elif defined(_SC_NPROCESSORS_ONLN)
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (size_t)count : 1;
+#else
+    return 1;
+#endif
+}
+
+size_t cthread_cache_size(void)
+{
+    size_t bytes = 0;
+#if defined(_WIN32) || defined(_WIN64)
+    SYSTEM_LOGICAL_PROCESSOR_INFORMATION info[256];
+    DWORD length = sizeof(info);
+    if (GetLogicalProcessorInformation(info, &length)) {
+        for (DWORD i = 0; i < length / sizeof(info[0]); i++) {
+            if (info[i].Relationship == RelationCache && info[i].Cache.Level == 2) bytes = info[i].Cache.Size;
+        }
+    }
+#elif defined(_SC_LEVEL2_CACHE_SIZE)
+    long size = sysconf(_SC_LEVEL2_CACHE_SIZE);
+    if (size > 0) bytes = (size_t)size;
+#endif
+    return bytes ? bytes : CTHREAD_DEFAULT_CACHE_SIZE;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// atomics
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+uint64_t cthread_atomic_increment(volatile uint64_t* value)
+{
+#if defined(_MSC_VER)
+    return (uint64_t)InterlockedIncrement64((volatile LONG64*)value);
+#else
+    return __atomic_add_fetch(value, 1, __ATOMIC_SEQ_CST);
+#endif
+}
+
+uint64_t cthread_atomic_fetch_add(volatile uint64_t* value, uint64_t amount)
+{
+#if defined(_MSC_VER)
+    return (uint64_t)InterlockedExchangeAdd64((volatile LONG64*)value, (LONG64)amount);
+#else
+    return __atomic_fetch_add(value, amount, __ATOMIC_SEQ_CST);
+#endif
+}
+
+uint64_t cthread_atomic_fetch_or(volatile uint64_t* value, uint64_t bits)
+{
+#if defined(_MSC_VER)
+    return (uint64_t)InterlockedOr64((volatile LONG64*)value, (LONG64)bits);
+#else
+    return __atomic_fetch_or(value, bits, __ATOMIC_SEQ_CST);
+#endif
+}
+
+bool cthread_atomic_compare_exchange(volatile uint64_t* value, uint64_t* expected, uint64_t desired)
+{
+#if defined(_MSC_VER)
+    uint64_t previous = (uint64_t)InterlockedCompareExchange64((volatile LONG64*)value, (LONG64)desired, (LONG64)*expected);
+    if (previous == *expected) return true;
+    *expected = previous;
+    return false;
+#else
+    return __atomic_compare_exchange_n(value, expected, desired, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+#endif
+}
+
+uint64_t cthread_atomic_load(const volatile uint64_t* value)
+{
+#if defined(_MSC_VER)
+    // or-ing 0 leaves the value as it is, the interlocked call only provides the barrier
+    return (uint64_t)InterlockedOr64((volatile LONG64*)value, 0);
+#else
+    return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+#endif
+}
+
+void cthread_atomic_store(volatile uint64_t* value, uint64_t desired)
+{
+#if defined(_MSC_VER)
+    InterlockedExchange64((volatile LONG64*)value, (LONG64)desired);
+#else
+    __atomic_store_n(value, desired, __ATOMIC_RELEASE);
+#endif
+}
+
+void* cthread_atomic_load_ptr(void* const volatile* ptr)
+{
+#if defined(_MSC_VER)
+    // exchanging NULL for NULL leaves the pointer as it is, the interlocked call only provides the barrier
+    return InterlockedCompareExchangePointer((void* volatile*)ptr, NULL, NULL);
+#else
+    return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+#endif
+}
+
+void cthread_atomic_store_ptr(void* volatile* ptr, void* desired)
+{
+#if defined(_MSC_VER)
+    InterlockedExchangePointer(ptr, desired);
+#else
+    __atomic_store_n(ptr, desired, __ATOMIC_RELEASE);
+#endif
+}
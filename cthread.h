@@ -0,0 +1,126 @@
+#ifndef CTHREAD_INCLUDED
+#define CTHREAD_INCLUDED
+
+#include "context.h"
+
+/// @brief internal threading primitives for the modules that need them, not part of the public interface
+#if defined(_WIN32) || defined(_WIN64)
+    #include <windows.h>
+    typedef SRWLOCK cthread_mutex;
+    typedef CONDITION_VARIABLE cthread_cond;
+    typedef DWORD cthread_key;
+    #define CTHREAD_LOCAL __declspec(thread)
+    #define CTHREAD_MUTEX_INITIALIZER SRWLOCK_INIT
+    #define CTHREAD_CALLBACK NTAPI
+#else
+    #include <pthread.h>
+    #include <sched.h>
+    #include <unistd.h>
+    typedef pthread_mutex_t cthread_mutex;
+    typedef pthread_cond_t cthread_cond;
+    typedef pthread_key_t cthread_key;
+    #define CTHREAD_LOCAL _Thread_local
+    #define CTHREAD_MUTEX_INITIALIZER PTHREAD_MUTEX_INITIALIZER
+    #define CTHREAD_CALLBACK
+#endif
+
+/// @brief level 2 cache size assumed when it can't be queried
+#ifndef CTHREAD_DEFAULT_CACHE_SIZE
+    #define CTHREAD_DEFAULT_CACHE_SIZE (256 * 1024)
+#endif
+
+/// @brief function run by a thread
+typedef void (*cthread_func)(void* arg);
+
+/// @brief function run by an exiting thread on its value of a key
+typedef void (CTHREAD_CALLBACK *cthread_key_destructor)(void* value);
+
+/// @brief a running thread, must stay alive until joined since the thread reads func and arg from it
+typedef struct cthread_thread
+{
+#if defined(_WIN32) || defined(_WIN64)
+    HANDLE handle;
+#else
+    pthread_t handle;
+#endif
+    cthread_func func;
+    void* arg;
+} cthread_thread;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// functions
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// @brief initializes the mutex
+void cthread_mutex_init(cthread_mutex* mutex);
+
+/// @brief releases the mutex resources
+void cthread_mutex_destroy(cthread_mutex* mutex);
+
+/// @brief locks the mutex, blocking until it is available
+void cthread_mutex_lock(cthread_mutex* mutex);
+
+/// @brief unlocks the mutex
+void cthread_mutex_unlock(cthread_mutex* mutex);
+
+/// @brief initializes the condition variable
+void cthread_cond_init(cthread_cond* cond);
+
+/// @brief releases the condition variable resources
+void cthread_cond_destroy(cthread_cond* cond);
+
+/// @brief atomically unlocks the mutex and waits for a signal, locking it again before returning, may wake up spuriously
+void cthread_cond_wait(cthread_cond* cond, cthread_mutex* mutex);
+
+/// @brief wakes up one waiting thread
+void cthread_cond_signal(cthread_cond* cond);
+
+/// @brief wakes up every waiting thread
+void cthread_cond_broadcast(cthread_cond* cond);
+
+/// @brief starts a thread running func(arg), returns false if it couldn't be created
+bool cthread_create(cthread_thread* thread, cthread_func func, void* arg);
+
+/// @brief waits for the thread to finish
+void cthread_join(cthread_thread* thread);
+
+/// @brief gives the rest of the time slice to other threads
+void cthread_yield(void);
+
+/// @brief creates a thread-local key, destructor runs on every exiting thread whose value isn't NULL, returns false if none is left
+bool cthread_key_create(cthread_key* key, cthread_key_destructor destructor);
+
+/// @brief sets the calling thread's value of the key
+void cthread_key_set(cthread_key key, void* value);
+
+/// @brief returns the number of logical processors, at least 1
+size_t cthread_hardware_concurrency(void);
+
+/// @brief bytes of level 2 cache of a core, CTHREAD_DEFAULT_CACHE_SIZE when the platform doesn't tell
+size_t cthread_cache_size(void);
+
+/// @brief atomically increments the value, returning the incremented value
+uint64_t cthread_atomic_increment(volatile uint64_t* value);
+
+/// @brief atomically adds amount to the value, returning the previous value
+uint64_t cthread_atomic_fetch_add(volatile uint64_t* value, uint64_t amount);
+
+/// @brief atomically ors bits into the value, returning the previous value
+uint64_t cthread_atomic_fetch_or(volatile uint64_t* value, uint64_t bits);
+
+/// @brief atomically replaces the value with desired if it still equals *expected, otherwise loads it into *expected
+bool cthread_atomic_compare_exchange(volatile uint64_t* value, uint64_t* expected, uint64_t desired);
+
+/// @brief reads the value, later reads can't be reordered before it
+uint64_t cthread_atomic_load(const volatile uint64_t* value);
+
+/// @brief writes the value, earlier writes can't be reordered after it
+void cthread_atomic_store(volatile uint64_t* value, uint64_t desired);
+
+/// @brief reads the pointer, later reads can't be reordered before it
+void* cthread_atomic_load_ptr(void* const volatile* ptr);
+
+/// @brief writes the pointer, earlier writes can't be reordered after it
+void cthread_atomic_store_ptr(void* volatile* ptr, void* desired);
+
+#endif // CTHREAD_INCLUDED
@@ -1,7 +1,32 @@
 #include "darray.h"
+#include "csimd.h"
+#include "threadpool.h"
+#include "cthread.h"
 
 #include <stdlib.h>
 #include <string.h>
+#include <stdio.h>
+
+#if defined(_WIN32) || defined(_WIN64)
+    #include <windows.h>
+#elif defined(__unix__) || defined(__APPLE__)
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+#if defined(__linux__)
+    #ifndef MREMAP_MAYMOVE
+        // only declared with _GNU_SOURCE, which can't be relied upon in the header-only build
+        #define MREMAP_MAYMOVE 1
+        extern void* mremap(void* oldAddress, size_t oldSize, size_t newSize, int flags, ...);
+    #endif
+    #ifndef MAP_ANONYMOUS
+        #define MAP_ANONYMOUS 0x20
+    #endif
+    #define DARRAY_MREMAP 1
+#endif
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // internal
@@ -13,9 +38,573 @@ struct darray
     size_t size;
     size_t capacity;
     size_t elementSize;
+    size_t alignment;
+    darray_growth growth;
+    size_t growthValue;
+    size_t mapThreshold;    // storage growing past this many bytes moves to an anonymous mapping, 0 disables it
+    size_t mappedBytes;     // size of the mapping when the storage lives in one, 0 otherwise
+    size_t inlineCapacity;  // elements stored right after the header, used until the array outgrows them
+    void* file;             // whole file mapping when the elements were opened with darray_open_mapped, NULL otherwise
+    size_t fileBytes;
     ctoolbox_memfuncs memfuncs;
+    ctoolbox_memstats stats;
 };  
 
+// the typed wrappers in darray.h read the leading fields through darray_header
+_Static_assert(offsetof(darray, data) == offsetof(darray_header, data), "darray_header out of sync");
+_Static_assert(offsetof(darray, size) == offsetof(darray_header, size), "darray_header out of sync");
+_Static_assert(offsetof(darray, capacity) == offsetof(darray_header, capacity), "darray_header out of sync");
+_Static_assert(offsetof(darray, elementSize) == offsetof(darray_header, elementSize), "darray_header out of sync");
+
+#define DARRAY_HEADER_SIZE ((sizeof(darray) + (CTOOLBOX_DEFAULT_ALIGNMENT - 1)) & ~(size_t)(CTOOLBOX_DEFAULT_ALIGNMENT - 1))
+
+static inline void* darray_inline_data(const darray* array)
+{
+    return (char*)array + DARRAY_HEADER_SIZE;
+}
+
+static inline bool darray_is_inline(const darray* array)
+{
+    return array->inlineCapacity > 0 && array->data == darray_inline_data(array);
+}
+
+// the header allocation, inline storage included
+static inline size_t darray_header_bytes(const darray* array)
+{
+    return DARRAY_HEADER_SIZE + array->inlineCapacity * array->elementSize;
+}
+
+static size_t darray_page_size(void)
+{
+#if defined(__unix__) || defined(__APPLE__)
+    long pageSize = sysconf(_SC_PAGESIZE);
+    return pageSize > 0 ? (size_t)pageSize : 4096;
+#else
+    return 4096;
+#endif
+}
+
+// rounds bytes up to whole pages, 0 on overflow
+static inline size_t darray_page_round(size_t bytes, size_t pageSize)
+{
+    if (bytes > SIZE_MAX - (pageSize - 1)) return 0;
+    return (bytes + (pageSize - 1)) & ~(pageSize - 1);
+}
+
+// grows the storage following the array's growth policy so it holds at least minCapacity elements
+static ctoolbox_result darray_grow(darray* array, size_t minCapacity)
+{
+    if (minCapacity <= array->capacity) return CTOOLBOX_SUCCESS;
+
+    size_t newCapacity = array->capacity;
+    switch (array->growth)
+    {
+        case DARRAY_GROWTH_LINEAR:
+        {
+            size_t steps = (minCapacity - newCapacity + (array->growthValue - 1)) / array->growthValue;
+            if (steps > (SIZE_MAX - newCapacity) / array->growthValue) newCapacity = minCapacity;
+            else newCapacity += steps * array->growthValue;
+            break;
+        }
+
+        case DARRAY_GROWTH_PAGE:
+        {
+            size_t pageSize = darray_page_size();
+            size_t step = array->growthValue > 0 ? array->growthValue : pageSize;
+            size_t bytes = newCapacity * array->elementSize;
+            bytes = bytes > SIZE_MAX - step ? SIZE_MAX : bytes + step;
+
+            if (minCapacity > SIZE_MAX / array->elementSize) return CTOOLBOX_ERROR_MEMORY_ALLOC;
+            if (bytes < minCapacity * array->elementSize) bytes = minCapacity * array->elementSize;
+
+            bytes = darray_page_round(bytes, pageSize);
+            newCapacity = bytes > 0 ? bytes / array->elementSize : minCapacity;
+            break;
+        }
+
+        default:
+        {
+            if (newCapacity == 0) newCapacity = 1;
+            while (newCapacity < minCapacity) {
+                if (newCapacity > SIZE_MAX / array->growthValue) {
+                    newCapacity = minCapacity;
+                    break;
+                }
+
+                size_t next = newCapacity * array->growthValue / 100;
+                newCapacity = next > newCapacity ? next : newCapacity + 1;
+            }
+            break;
+        }
+    }
+
+    return darray_reserve(array, newCapacity);
+}
+
+// read-only file maps keep a capacity of 0, under their size, so the elements move to the heap before anything writes them
+static inline ctoolbox_result darray_make_writable(darray* array)
+{
+    return array->size > array->capacity ? darray_reserve(array, array->size) : CTOOLBOX_SUCCESS;
+}
+
+#define DARRAY_FILE_MAGIC "CTBXDARR"
+#define DARRAY_FILE_VERSION 1
+#define DARRAY_FILE_BYTE_ORDER 0x01020304u
+#define DARRAY_FILE_TEMP_SUFFIX ".tmp"
+
+// on-disk layout written by darray_save, the elements follow at dataOffset
+typedef struct darray_file_header
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;     // written natively, a mismatch means the file was saved on a machine of the other endianness
+    uint64_t elementSize;
+    uint64_t size;
+    uint64_t alignment;
+    uint64_t dataOffset;    // multiple of alignment and at least a cache line
+} darray_file_header;
+
+// maps the whole file, shared and read-only or private and copy-on-write, NULL on failure
+static void* darray_file_map(const char* path, bool copyOnWrite, size_t* bytesOut)
+{
+#if defined(_WIN32) || defined(_WIN64)
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) return NULL;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0 || (uint64_t)fileSize.QuadPart > SIZE_MAX) {
+        CloseHandle(file);
+        return NULL;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, NULL, copyOnWrite ? PAGE_WRITECOPY : PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file);
+    if (!mapping) return NULL;
+
+    // the view keeps the mapping alive
+    void* view = MapViewOfFile(mapping, copyOnWrite ? FILE_MAP_COPY : FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (!view) return NULL;
+
+    *bytesOut = (size_t)fileSize.QuadPart;
+    return view;
+#elif defined(__unix__) || defined(__APPLE__)
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return NULL;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size <= 0 || (uint64_t)info.st_size > SIZE_MAX) {
+        close(fd);
+        return NULL;
+    }
+
+    void* view = mmap(NULL, (size_t)info.st_size, copyOnWrite ? (PROT_READ | PROT_WRITE) : PROT_READ, copyOnWrite ? MAP_PRIVATE : MAP_SHARED, fd, 0);
+    close(fd);
+    if (view == MAP_FAILED) return NULL;
+
+    *bytesOut = (size_t)info.st_size;
+    return view;
+#else
+    (void)path; (void)copyOnWrite; (void)bytesOut;
+    return NULL;
+#endif
+}
+
+// moves the file at from over the one at to, replacing it in one step
+static bool darray_file_replace(const char* from, const char* to)
+{
+#if defined(_WIN32) || defined(_WIN64)
+    return MoveFileExA(from, to, MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    return rename(from, to) == 0;
+#endif
+}
+
+static void darray_file_unmap(void* view, size_t bytes)
+{
+#if defined(_WIN32) || defined(_WIN64)
+    (void)bytes;
+    UnmapViewOfFile(view);
+#elif defined(__unix__) || defined(__APPLE__)
+    munmap(view, bytes);
+#else
+    (void)view; (void)bytes;
+#endif
+}
+
+// releases the storage wherever it lives, inline storage goes away with the header
+static void darray_storage_release(darray* array)
+{
+    if (darray_is_inline(array)) return;
+
+    if (array->file) {
+        darray_file_unmap(array->file, array->fileBytes);
+        ctoolbox_memstats_on_free(&array->stats, array->fileBytes);
+        array->file = NULL;
+        array->fileBytes = 0;
+        return;
+    }
+
+#if defined(DARRAY_MREMAP)
+    if (array->mappedBytes > 0) {
+        munmap(array->data, array->mappedBytes);
+        ctoolbox_memstats_on_free(&array->stats, array->mappedBytes);
+        array->mappedBytes = 0;
+        return;
+    }
+#endif
+    ctoolbox_custom_aligned_free_sized(&array->memfuncs, array->data, array->capacity * array->elementSize, array->alignment);
+    if (array->data) ctoolbox_memstats_on_free(&array->stats, array->capacity * array->elementSize);
+}
+
+#if defined(DARRAY_MREMAP)
+// moves the storage into an anonymous mapping, or grows/shrinks the one it lives in, without copying pages
+static ctoolbox_result darray_map_reserve(darray* array, size_t newCapacity)
+{
+    size_t newBytes = darray_page_round(newCapacity * array->elementSize, darray_page_size());
+    if (newBytes == 0) return CTOOLBOX_ERROR_MEMORY_ALLOC;
+
+    void* newData = NULL;
+    if (array->mappedBytes > 0) {
+        newData = mremap(array->data, array->mappedBytes, newBytes, MREMAP_MAYMOVE);
+        if (newData == MAP_FAILED) return CTOOLBOX_ERROR_MEMORY_ALLOC;
+
+        ctoolbox_memstats_on_realloc(&array->stats, array->mappedBytes, newBytes);
+    }
+    else {
+        newData = mmap(NULL, newBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (newData == MAP_FAILED) return CTOOLBOX_ERROR_MEMORY_ALLOC;
+
+        if (array->data) {
+            memcpy(newData, array->data, array->size * array->elementSize);
+            darray_storage_release(array);
+        }
+        ctoolbox_memstats_on_alloc(&array->stats, newBytes);
+    }
+
+    array->data = newData;
+    array->mappedBytes = newBytes;
+    array->capacity = newBytes / array->elementSize;
+    return CTOOLBOX_SUCCESS;
+}
+#endif
+
+// scratch buffers for the sorts, accounted so peakBytes shows them
+static void* darray_scratch_alloc(darray* array, size_t bytes)
+{
+    void* scratch = ctoolbox_custom_aligned_malloc(&array->memfuncs, bytes, array->alignment);
+    if (scratch) ctoolbox_memstats_on_alloc(&array->stats, bytes);
+    return scratch;
+}
+
+static void darray_scratch_free(darray* array, void* scratch, size_t bytes)
+{
+    ctoolbox_custom_aligned_free_sized(&array->memfuncs, scratch, bytes, array->alignment);
+    ctoolbox_memstats_on_free(&array->stats, bytes);
+}
+
+// sorts data[lo, hi) by insertion, spare holds one element
+static void darray_insertion_sort(char* data, size_t lo, size_t hi, size_t elementSize, darray_compare_func compare, char* spare)
+{
+    for (size_t i = lo + 1; i < hi; i++) {
+        size_t j = i;
+        while (j > lo && compare(data + (j - 1) * elementSize, data + i * elementSize) > 0) j--;
+        if (j == i) continue;
+
+        memcpy(spare, data + i * elementSize, elementSize);
+        memmove(data + (j + 1) * elementSize, data + j * elementSize, (i - j) * elementSize);
+        memcpy(data + j * elementSize, spare, elementSize);
+    }
+}
+
+// stable merge of src[lo, mid) and src[mid, hi) into dst[lo, hi)
+static void darray_merge(const char* src, char* dst, size_t lo, size_t mid, size_t hi, size_t elementSize, darray_compare_func compare)
+{
+    size_t i = lo, j = mid, k = lo;
+    while (i < mid && j < hi) {
+        if (compare(src + j * elementSize, src + i * elementSize) < 0) memcpy(dst + (k++) * elementSize, src + (j++) * elementSize, elementSize);
+        else memcpy(dst + (k++) * elementSize, src + (i++) * elementSize, elementSize);
+    }
+
+    memcpy(dst + k * elementSize, src + i * elementSize, (mid - i) * elementSize);
+    k += mid - i;
+    memcpy(dst + k * elementSize, src + j * elementSize, (hi - j) * elementSize);
+}
+
+// stable bottom-up merge sort of data[lo, hi), the result is left in data, scratch is indexed like data
+static void darray_merge_sort(char* data, char* scratch, size_t lo, size_t hi, size_t elementSize, darray_compare_func compare)
+{
+    for (size_t run = lo; run < hi; run += DARRAY_SORT_RUN) {
+        darray_insertion_sort(data, run, hi - run > DARRAY_SORT_RUN ? run + DARRAY_SORT_RUN : hi, elementSize, compare, scratch + lo * elementSize);
+    }
+
+    char* src = data;
+    char* dst = scratch;
+    for (size_t width = DARRAY_SORT_RUN; width < hi - lo; width *= 2) {
+        for (size_t left = lo; left < hi; left += 2 * width) {
+            size_t mid = hi - left > width ? left + width : hi;
+            size_t right = hi - left > 2 * width ? left + 2 * width : hi;
+            darray_merge(src, dst, left, mid, right, elementSize, compare);
+        }
+
+        char* swap = src;
+        src = dst;
+        dst = swap;
+    }
+
+    if (src != data) memcpy(data + lo * elementSize, src + lo * elementSize, (hi - lo) * elementSize);
+}
+
+// swaps two elements, the common sizes move as whole words instead of going through a byte loop
+static inline void darray_swap(char* a, char* b, size_t elementSize)
+{
+    switch (elementSize)
+    {
+        case 4: { uint32_t t; memcpy(&t, a, 4); memcpy(a, b, 4); memcpy(b, &t, 4); return; }
+        case 8: { uint64_t t; memcpy(&t, a, 8); memcpy(a, b, 8); memcpy(b, &t, 8); return; }
+        case 16: { uint64_t t[2]; memcpy(t, a, 16); memcpy(a, b, 16); memcpy(b, t, 16); return; }
+        default: break;
+    }
+
+    size_t i = 0;
+    for (; i + 8 <= elementSize; i += 8) {
+        uint64_t t;
+        memcpy(&t, a + i, 8);
+        memcpy(a + i, b + i, 8);
+        memcpy(b + i, &t, 8);
+    }
+    for (; i < elementSize; i++) {
+        char t = a[i];
+        a[i] = b[i];
+        b[i] = t;
+    }
+}
+
+// heapsort of data[lo, hi), the fallback once quicksort partitions badly too many times
+static void darray_heap_sort(char* data, size_t lo, size_t hi, size_t elementSize, darray_compare_func compare)
+{
+    char* base = data + lo * elementSize;
+    size_t count = hi - lo;
+
+    for (size_t end = count, start = count / 2; end > 1;) {
+        if (start > 0) start--;
+        else darray_swap(base, base + (--end) * elementSize, elementSize);
+
+        // sift the root of the heap [start, end) down
+        size_t root = start;
+        for (size_t child = 2 * root + 1; child < end; child = 2 * root + 1) {
+            if (child + 1 < end && compare(base + child * elementSize, base + (child + 1) * elementSize) < 0) child++;
+            if (compare(base + root * elementSize, base + child * elementSize) >= 0) break;
+
+            darray_swap(base + root * elementSize, base + child * elementSize, elementSize);
+            root = child;
+        }
+    }
+}
+
+// unstable introsort of data[lo, hi): median of three quicksort, heapsort past depth partitions and insertion sort for short ranges
+static void darray_intro_sort(char* data, size_t lo, size_t hi, size_t depth, size_t elementSize, darray_compare_func compare)
+{
+    while (hi - lo > DARRAY_SORT_RUN) {
+        if (depth-- == 0) {
+            darray_heap_sort(data, lo, hi, elementSize, compare);
+            return;
+        }
+
+        // the median of the first, middle and last elements becomes the pivot at lo, the last one bounds the forward scan
+        char* first = data + lo * elementSize;
+        char* middle = data + (lo + (hi - lo) / 2) * elementSize;
+        char* last = data + (hi - 1) * elementSize;
+        if (compare(middle, first) < 0) darray_swap(middle, first, elementSize);
+        if (compare(last, middle) < 0) {
+            darray_swap(last, middle, elementSize);
+            if (compare(middle, first) < 0) darray_swap(middle, first, elementSize);
+        }
+        darray_swap(first, middle, elementSize);
+
+        size_t i = lo + 1, j = hi - 1;
+        for (;;) {
+            while (compare(data + i * elementSize, first) < 0) i++;
+            while (compare(first, data + j * elementSize) < 0) j--;
+            if (i >= j) break;
+
+            darray_swap(data + i * elementSize, data + j * elementSize, elementSize);
+            i++;
+            j--;
+        }
+        darray_swap(first, data + j * elementSize, elementSize);
+
+        // recursing into the smaller side keeps the stack logarithmic
+        if (j - lo < hi - j - 1) {
+            darray_intro_sort(data, lo, j, depth, elementSize, compare);
+            lo = j + 1;
+        }
+        else {
+            darray_intro_sort(data, j + 1, hi, depth, elementSize, compare);
+            hi = j;
+        }
+    }
+
+    for (size_t i = lo + 1; i < hi; i++) {
+        for (size_t j = i; j > lo && compare(data + (j - 1) * elementSize, data + j * elementSize) > 0; j--) {
+            darray_swap(data + (j - 1) * elementSize, data + j * elementSize, elementSize);
+        }
+    }
+}
+
+// a chunk sorted or a pair of chunks merged by darray_parallel_sort
+typedef struct darray_sort_task
+{
+    char* src;
+    char* dst;
+    size_t lo;
+    size_t mid;
+    size_t hi;
+    size_t elementSize;
+    darray_compare_func compare;
+} darray_sort_task;
+
+static ctoolbox_result darray_sort_range(void* context, size_t begin, size_t end)
+{
+    darray_sort_task* tasks = context;
+    for (size_t i = begin; i < end; i++) darray_merge_sort(tasks[i].src, tasks[i].dst, tasks[i].lo, tasks[i].hi, tasks[i].elementSize, tasks[i].compare);
+    return CTOOLBOX_SUCCESS;
+}
+
+static ctoolbox_result darray_merge_range(void* context, size_t begin, size_t end)
+{
+    darray_sort_task* tasks = context;
+    for (size_t i = begin; i < end; i++) darray_merge(tasks[i].src, tasks[i].dst, tasks[i].lo, tasks[i].mid, tasks[i].hi, tasks[i].elementSize, tasks[i].compare);
+    return CTOOLBOX_SUCCESS;
+}
+
+// reads the integer key at the start of element as an unsigned value that orders like the key
+static inline uint64_t darray_radix_key(const char* element, size_t keySize, bool keySigned)
+{
+    uint64_t key = 0;
+    switch (keySize)
+    {
+        case 1: { uint8_t k; memcpy(&k, element, 1); key = k; break; }
+        case 2: { uint16_t k; memcpy(&k, element, 2); key = k; break; }
+        case 4: { uint32_t k; memcpy(&k, element, 4); key = k; break; }
+        default: { memcpy(&key, element, 8); break; }
+    }
+
+    if (keySigned) key ^= (uint64_t)1 << (keySize * 8 - 1);
+    return key;
+}
+
+// drops the elements whose predicate result equals dropWhen, survivors move once, in blocks, keeping their order
+static size_t darray_compact(darray* array, darray_predicate_func predicate, void* user, bool dropWhen)
+{
+    char* data = (char*)array->data;
+    const size_t elementSize = array->elementSize;
+    size_t write = 0;
+    size_t runStart = 0;
+    bool inRun = false;
+
+    // each element is tested once, survivors are moved a whole run at a time when the run ends
+    for (size_t read = 0; read <= array->size; read++) {
+        bool keep = read < array->size && predicate(data + read * elementSize, user) != dropWhen;
+        if (keep == inRun) continue;
+
+        if (keep) runStart = read;
+        else {
+            if (write != runStart) memmove(data + write * elementSize, data + runStart * elementSize, (read - runStart) * elementSize);
+            write += read - runStart;
+        }
+        inRun = keep;
+    }
+
+    size_t removed = array->size - write;
+    array->size = write;
+    return removed;
+}
+
+// what the darray_parallel_* calls hand to each range the pool runs
+typedef struct darray_parallel_context
+{
+    char* data;
+    char* output;
+    size_t size;
+    size_t elementSize;
+    size_t outputElementSize;
+    size_t chunk;
+    char* partials;                 // one element per chunk
+    const void* identity;
+    darray_element_func each;
+    darray_transform_func transform;
+    darray_combine_func combine;
+    void* user;
+} darray_parallel_context;
+
+// whether spreading size elements over the pool pays off
+static inline bool darray_parallel_worth(const threadpool* pool, size_t size)
+{
+    return pool && size >= DARRAY_PARALLEL_THRESHOLD && threadpool_thread_count(pool) > 1;
+}
+
+// half a core's L2 cache of elements, the other half is left to a transform's output and the callback's own data,
+// cut down so every thread of the pool gets a chunk when the array is smaller than that many caches
+static size_t darray_parallel_chunk(const threadpool* pool, size_t size, size_t elementSize)
+{
+    size_t bytes = DARRAY_PARALLEL_CHUNK_BYTES ? DARRAY_PARALLEL_CHUNK_BYTES : cthread_cache_size() / 2;
+    size_t chunk = elementSize >= bytes ? 1 : bytes / elementSize;
+
+    size_t threads = threadpool_thread_count(pool);
+    size_t share = size / threads + (size % threads != 0);
+    return chunk < share ? chunk : share;
+}
+
+static ctoolbox_result darray_each_range(void* context, size_t begin, size_t end)
+{
+    darray_parallel_context* ctx = context;
+    for (size_t i = begin; i < end; i++) ctx->each(ctx->data + i * ctx->elementSize, ctx->user);
+    return CTOOLBOX_SUCCESS;
+}
+
+static ctoolbox_result darray_transform_range(void* context, size_t begin, size_t end)
+{
+    darray_parallel_context* ctx = context;
+    for (size_t i = begin; i < end; i++) {
+        ctx->transform(ctx->data + i * ctx->elementSize, ctx->output + i * ctx->outputElementSize, ctx->user);
+    }
+    return CTOOLBOX_SUCCESS;
+}
+
+// folds each chunk of [begin, end) into its partial
+static ctoolbox_result darray_reduce_range(void* context, size_t begin, size_t end)
+{
+    darray_parallel_context* ctx = context;
+    for (size_t c = begin; c < end; c++) {
+        char* accumulator = ctx->partials + c * ctx->elementSize;
+        size_t first = c * ctx->chunk;
+        size_t last = ctx->size - first < ctx->chunk ? ctx->size : first + ctx->chunk;
+
+        memcpy(accumulator, ctx->identity, ctx->elementSize);
+        for (size_t i = first; i < last; i++) ctx->combine(accumulator, ctx->data + i * ctx->elementSize, ctx->user);
+    }
+    return CTOOLBOX_SUCCESS;
+}
+
+// scans each chunk of [begin, end) in place, starting from its partial which holds the fold of every element before the chunk
+static ctoolbox_result darray_scan_range(void* context, size_t begin, size_t end)
+{
+    darray_parallel_context* ctx = context;
+    for (size_t c = begin; c < end; c++) {
+        char* running = ctx->partials + c * ctx->elementSize;
+        size_t first = c * ctx->chunk;
+        size_t last = ctx->size - first < ctx->chunk ? ctx->size : first + ctx->chunk;
+
+        for (size_t i = first; i < last; i++) {
+            char* element = ctx->data + i * ctx->elementSize;
+            ctx->combine(running, element, ctx->user);
+            memcpy(element, running, ctx->elementSize);
+        }
+    }
+    return CTOOLBOX_SUCCESS;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // external
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -26,8 +615,15 @@ CTOOLBOX_API darray* darray_init(size_t elementSize, size_t initialCapacity)
 }
 
 CTOOLBOX_API darray* darray_init_memfuncs(size_t elementSize, size_t initialCapacity, const ctoolbox_memfuncs* memfuncs)
+{
+    return darray_init_aligned(elementSize, initialCapacity, CTOOLBOX_DEFAULT_ALIGNMENT, memfuncs);
+}
+
+CTOOLBOX_API darray* darray_init_aligned(size_t elementSize, size_t initialCapacity, size_t alignment, const ctoolbox_memfuncs* memfuncs)
 {
     if (elementSize == 0) return NULL;
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0) return NULL;
+    if (alignment < CTOOLBOX_DEFAULT_ALIGNMENT) alignment = CTOOLBOX_DEFAULT_ALIGNMENT;
 
     darray* outArray = ctoolbox_custom_malloc(memfuncs ? memfuncs : &CTOOLBOX_DEFAULT_MEMFUNCS, sizeof(darray));
     if (!outArray) return NULL;
@@ -36,12 +632,54 @@ CTOOLBOX_API darray* darray_init_memfuncs(size_t elementSize, size_t initialCapa
     outArray->size = 0;
     outArray->elementSize = elementSize;
     outArray->capacity = initialCapacity > 0 ? initialCapacity : 1;
+    outArray->alignment = alignment;
+    outArray->growth = DARRAY_GROWTH_FACTOR;
+    outArray->growthValue = 200;
+
+    if (memfuncs) outArray->memfuncs = *memfuncs;
+    else outArray->memfuncs = CTOOLBOX_DEFAULT_MEMFUNCS;
+
+    if (alignment == CTOOLBOX_DEFAULT_ALIGNMENT) {
+        outArray->data = ctoolbox_custom_calloc(&outArray->memfuncs, outArray->capacity, elementSize);
+    }
+    else if (outArray->capacity <= SIZE_MAX / elementSize) {
+        outArray->data = ctoolbox_custom_aligned_malloc(&outArray->memfuncs, outArray->capacity * elementSize, alignment);
+        if (outArray->data) memset(outArray->data, 0, outArray->capacity * elementSize);
+    }
+
+    if (!outArray->data) {
+        ctoolbox_custom_free_sized(&outArray->memfuncs, outArray, sizeof(darray));
+        return NULL;
+    }
+
+    ctoolbox_memstats_on_alloc(&outArray->stats, sizeof(darray));
+    ctoolbox_memstats_on_alloc(&outArray->stats, outArray->capacity * elementSize);
+
+    return outArray;
+}
+
+CTOOLBOX_API darray* darray_init_inline(size_t elementSize, size_t inlineCapacity, const ctoolbox_memfuncs* memfuncs)
+{
+    if (elementSize == 0 || inlineCapacity == 0) return NULL;
+    if (inlineCapacity > (SIZE_MAX - DARRAY_HEADER_SIZE) / elementSize) return NULL;
+
+    size_t headerBytes = DARRAY_HEADER_SIZE + inlineCapacity * elementSize;
+    darray* outArray = ctoolbox_custom_malloc(memfuncs ? memfuncs : &CTOOLBOX_DEFAULT_MEMFUNCS, headerBytes);
+    if (!outArray) return NULL;
+
+    memset(outArray, 0, headerBytes);
+    outArray->elementSize = elementSize;
+    outArray->alignment = CTOOLBOX_DEFAULT_ALIGNMENT;
+    outArray->growth = DARRAY_GROWTH_FACTOR;
+    outArray->growthValue = 200;
+    outArray->inlineCapacity = inlineCapacity;
+    outArray->capacity = inlineCapacity;
+    outArray->data = darray_inline_data(outArray);
 
     if (memfuncs) outArray->memfuncs = *memfuncs;
     else outArray->memfuncs = CTOOLBOX_DEFAULT_MEMFUNCS;
 
-    outArray->data = ctoolbox_custom_calloc(&outArray->memfuncs, outArray->capacity, elementSize);
-    if (!outArray->data) return NULL;
+    ctoolbox_memstats_on_alloc(&outArray->stats, headerBytes);
 
     return outArray;
 }
@@ -49,8 +687,8 @@ CTOOLBOX_API darray* darray_init_memfuncs(size_t elementSize, size_t initialCapa
 CTOOLBOX_API void darray_destroy(darray* array)
 {
     if(!array) return;
-    ctoolbox_custom_free(&array->memfuncs, array->data);
-    ctoolbox_custom_free(&array->memfuncs, array);
+    darray_storage_release(array);
+    ctoolbox_custom_free_sized(&array->memfuncs, array, darray_header_bytes(array));
 }
 
 CTOOLBOX_API ctoolbox_result darray_push_back(darray* array, const void* element)
@@ -59,7 +697,7 @@ CTOOLBOX_API ctoolbox_result darray_push_back(darray* array, const void* element
 
     // ensure capacity
     if (array->size >= array->capacity) {
-        ctoolbox_result res = darray_reserve(array, array->capacity * 2);
+        ctoolbox_result res = darray_grow(array, array->size + 1);
         if (res != CTOOLBOX_SUCCESS) return res;
     }
 
@@ -79,6 +717,48 @@ CTOOLBOX_API ctoolbox_result darray_pop_back(darray* array, void* elementOut)
     return CTOOLBOX_SUCCESS;
 }
 
+CTOOLBOX_API void* darray_emplace_back(darray* array)
+{
+    return darray_emplace_back_n(array, 1);
+}
+
+CTOOLBOX_API void* darray_emplace_back_n(darray* array, size_t count)
+{
+    if (!array || count == 0 || count > SIZE_MAX - array->size) return NULL;
+    if (darray_grow(array, array->size + count) != CTOOLBOX_SUCCESS) return NULL;
+
+    void* slot = (char*)array->data + (array->size * array->elementSize);
+    array->size += count;
+    return slot;
+}
+
+CTOOLBOX_API void* darray_emplace_at(darray* array, size_t index)
+{
+    if (!array || index > array->size) return NULL;
+    if (darray_grow(array, array->size + 1) != CTOOLBOX_SUCCESS) return NULL;
+
+    // shift elements to make space
+    char* data = (char*)array->data;
+    if (index < array->size) {
+        memmove(data + ((index + 1) * array->elementSize), data + (index * array->elementSize), (array->size - index) * array->elementSize);
+    }
+
+    array->size++;
+    return data + (index * array->elementSize);
+}
+
+CTOOLBOX_API void* darray_peek(darray* array, size_t index)
+{
+    if (!array || index >= array->size || darray_make_writable(array) != CTOOLBOX_SUCCESS) return NULL;
+    return (char*)array->data + (index * array->elementSize);
+}
+
+CTOOLBOX_API void* darray_data(darray* array)
+{
+    if (!array || darray_make_writable(array) != CTOOLBOX_SUCCESS) return NULL;
+    return array->data;
+}
+
 CTOOLBOX_API const void* darray_const_peek(const darray* array, size_t index)
 {
     if (!array || index >= array->size) return NULL;
@@ -100,6 +780,10 @@ CTOOLBOX_API ctoolbox_result darray_get(const darray *array, size_t index, void*
 CTOOLBOX_API ctoolbox_result darray_set(darray* array, size_t index, const void* element)
  {
     if (!array || !element || index >= array->size) return CTOOLBOX_ERROR_INVALID_PARAM;
+
+    ctoolbox_result res = darray_make_writable(array);
+    if (res != CTOOLBOX_SUCCESS) return res;
+
     memcpy((char*)array->data + (index * array->elementSize), element, array->elementSize);
     return CTOOLBOX_SUCCESS;
 }
@@ -110,7 +794,7 @@ CTOOLBOX_API ctoolbox_result darray_insert_at(darray* array, size_t index, const
 
     // ensure capacity
     if (array->size >= array->capacity) {
-        ctoolbox_result result = darray_reserve(array, array->capacity * 2);
+        ctoolbox_result result = darray_grow(array, array->size + 1);
         if (result != CTOOLBOX_SUCCESS) return result;
     }
 
@@ -136,6 +820,9 @@ CTOOLBOX_API ctoolbox_result darray_remove_at(darray* array, size_t index, void*
         return CTOOLBOX_ERROR_EMPTY;
     }
 
+    ctoolbox_result res = darray_make_writable(array);
+    if (res != CTOOLBOX_SUCCESS) return res;
+
     // if the caller wants the removed element, copy it first
     if (elementOut) {
         memcpy(elementOut, (char*)array->data + (index * array->elementSize), array->elementSize);
@@ -151,6 +838,103 @@ CTOOLBOX_API ctoolbox_result darray_remove_at(darray* array, size_t index, void*
     return CTOOLBOX_SUCCESS;
 }
 
+CTOOLBOX_API ctoolbox_result darray_swap_remove(darray* array, size_t index, void* elementOut)
+{
+    if (!array || index >= array->size) return CTOOLBOX_ERROR_INVALID_PARAM;
+
+    ctoolbox_result res = darray_make_writable(array);
+    if (res != CTOOLBOX_SUCCESS) return res;
+
+    char* data = (char*)array->data;
+    if (elementOut) memcpy(elementOut, data + (index * array->elementSize), array->elementSize);
+
+    // the last element fills the hole
+    if (index < array->size - 1) memcpy(data + (index * array->elementSize), data + ((array->size - 1) * array->elementSize), array->elementSize);
+
+    array->size--;
+    return CTOOLBOX_SUCCESS;
+}
+
+CTOOLBOX_API size_t darray_remove_if(darray* array, darray_predicate_func predicate, void* user)
+{
+    if (!array || !predicate || darray_make_writable(array) != CTOOLBOX_SUCCESS) return 0;
+    return darray_compact(array, predicate, user, true);
+}
+
+CTOOLBOX_API size_t darray_retain(darray* array, darray_predicate_func predicate, void* user)
+{
+    if (!array || !predicate || darray_make_writable(array) != CTOOLBOX_SUCCESS) return 0;
+    return darray_compact(array, predicate, user, false);
+}
+
+CTOOLBOX_API ctoolbox_result darray_append(darray* array, const void* elements, size_t count)
+{
+    if (!array || (!elements && count > 0)) return CTOOLBOX_ERROR_INVALID_PARAM;
+    if (count == 0) return CTOOLBOX_SUCCESS;
+    if (count > SIZE_MAX - array->size) return CTOOLBOX_ERROR_MEMORY_ALLOC;
+
+    // elements may come from the array itself, which growing could move
+    const char* data = (const char*)array->data;
+    bool fromSelf = data && (const char*)elements >= data && (const char*)elements < data + array->size * array->elementSize;
+    size_t selfOffset = fromSelf ? (size_t)((const char*)elements - data) : 0;
+
+    ctoolbox_result result = darray_grow(array, array->size + count);
+    if (result != CTOOLBOX_SUCCESS) return result;
+
+    if (fromSelf) elements = (const char*)array->data + selfOffset;
+    memcpy((char*)array->data + (array->size * array->elementSize), elements, count * array->elementSize);
+    array->size += count;
+
+    return CTOOLBOX_SUCCESS;
+}
+
+CTOOLBOX_API ctoolbox_result darray_append_darray(darray* array, const darray* other)
+{
+    if (!array || !other || array->elementSize != other->elementSize) return CTOOLBOX_ERROR_INVALID_PARAM;
+    return darray_append(array, other->data, other->size);
+}
+
+CTOOLBOX_API ctoolbox_result darray_insert_range(darray* array, size_t index, const void* elements, size_t count)
+{
+    if (!array || (!elements && count > 0) || index > array->size) return CTOOLBOX_ERROR_INVALID_PARAM;
+    if (count == 0) return CTOOLBOX_SUCCESS;
+    if (count > SIZE_MAX - array->size) return CTOOLBOX_ERROR_MEMORY_ALLOC;
+
+    ctoolbox_result result = darray_grow(array, array->size + count);
+    if (result != CTOOLBOX_SUCCESS) return result;
+
+    // shift the tail once to make space for the whole block
+    char* data = (char*)array->data;
+    if (index < array->size) {
+        memmove(data + ((index + count) * array->elementSize), data + (index * array->elementSize), (array->size - index) * array->elementSize);
+    }
+
+    memcpy(data + (index * array->elementSize), elements, count * array->elementSize);
+    array->size += count;
+    return CTOOLBOX_SUCCESS;
+}
+
+CTOOLBOX_API ctoolbox_result darray_remove_range(darray* array, size_t index, size_t count, void* elementsOut)
+{
+    if (!array || index > array->size || count > array->size - index) return CTOOLBOX_ERROR_INVALID_PARAM;
+    if (count == 0) return CTOOLBOX_SUCCESS;
+
+    ctoolbox_result res = darray_make_writable(array);
+    if (res != CTOOLBOX_SUCCESS) return res;
+
+    char* data = (char*)array->data;
+    if (elementsOut) memcpy(elementsOut, data + (index * array->elementSize), count * array->elementSize);
+
+    // shift the tail once over the removed block
+    size_t tail = array->size - index - count;
+    if (tail > 0) {
+        memmove(data + (index * array->elementSize), data + ((index + count) * array->elementSize), tail * array->elementSize);
+    }
+
+    array->size -= count;
+    return CTOOLBOX_SUCCESS;
+}
+
 CTOOLBOX_API ctoolbox_result darray_resize(darray* array, size_t newSize)
 {
     if (!array) return CTOOLBOX_ERROR_INVALID_PARAM;
@@ -168,26 +952,37 @@ CTOOLBOX_API ctoolbox_result darray_reserve(darray* array, size_t newCapacity)
     if (!array) return CTOOLBOX_ERROR_INVALID_PARAM;
     if (newCapacity <= array->capacity) return CTOOLBOX_SUCCESS;
 
-    size_t newSizeBytes = newCapacity * array->elementSize;
-    size_t oldSizeBytes = array->size * array->elementSize;
-
-    void* newData = NULL;
+    // a read-only map holds more elements than its capacity, none of them may be dropped
+    if (newCapacity < array->size) newCapacity = array->size;
+    if (newCapacity > SIZE_MAX / array->elementSize) return CTOOLBOX_ERROR_MEMORY_ALLOC;
 
-    // try realloc directly
-    if (array->memfuncs.realloc_fn) {
-        newData = ctoolbox_custom_realloc(&array->memfuncs, array->data, newSizeBytes);
-        if (!newData) return CTOOLBOX_ERROR_MEMORY_ALLOC;
-    } 
+#if defined(DARRAY_MREMAP)
+    if (array->mappedBytes > 0 || (array->mapThreshold > 0 && newCapacity * array->elementSize > array->mapThreshold && array->alignment <= darray_page_size())) {
+        return darray_map_reserve(array, newCapacity);
+    }
+#endif
 
-    // fallback: allocate, copy and free
-    else {
-        newData = ctoolbox_custom_malloc(&array->memfuncs, newSizeBytes);
+    // inline and file storage can't be reallocated, the elements spill to the heap instead
+    if (darray_is_inline(array) || array->file) {
+        void* newData = ctoolbox_custom_aligned_malloc(&array->memfuncs, newCapacity * array->elementSize, array->alignment);
         if (!newData) return CTOOLBOX_ERROR_MEMORY_ALLOC;
 
-        memcpy(newData, array->data, oldSizeBytes);
-        ctoolbox_custom_free(&array->memfuncs, array->data);
+        memcpy(newData, array->data, array->size * array->elementSize);
+        darray_storage_release(array);
+        ctoolbox_memstats_on_alloc(&array->stats, newCapacity * array->elementSize);
+        array->data = newData;
+        array->capacity = newCapacity;
+        return CTOOLBOX_SUCCESS;
     }
 
+    // realloc when the allocator has it, otherwise allocate, copy and free, always keeping the alignment
+    size_t oldSizeBytes = array->capacity * array->elementSize;
+    void* newData = ctoolbox_custom_aligned_realloc(&array->memfuncs, array->data, oldSizeBytes, newCapacity * array->elementSize, array->alignment);
+    if (!newData) return CTOOLBOX_ERROR_MEMORY_ALLOC;
+
+    if (array->data) ctoolbox_memstats_on_realloc(&array->stats, oldSizeBytes, newCapacity * array->elementSize);
+    else ctoolbox_memstats_on_alloc(&array->stats, newCapacity * array->elementSize);
+
     array->data = newData;
     array->capacity = newCapacity;
 
@@ -197,20 +992,40 @@ CTOOLBOX_API ctoolbox_result darray_reserve(darray* array, size_t newCapacity)
 CTOOLBOX_API ctoolbox_result darray_shrink_to_fit(darray* array)
 {
     if (!array) return CTOOLBOX_ERROR_INVALID_PARAM;
-    if (array->size == array->capacity) return CTOOLBOX_SUCCESS;
+    if (array->size == array->capacity || darray_is_inline(array) || array->file) return CTOOLBOX_SUCCESS;
+
+    // elements that fit move back into the inline storage
+    if (array->inlineCapacity > 0 && array->size <= array->inlineCapacity) {
+        void* inlineData = darray_inline_data(array);
+        memcpy(inlineData, array->data, array->size * array->elementSize);
+        darray_storage_release(array);
+        array->data = inlineData;
+        array->capacity = array->inlineCapacity;
+        return CTOOLBOX_SUCCESS;
+    }
 
     if (array->size == 0) {
-        ctoolbox_custom_free(&array->memfuncs, array->data);
+        darray_storage_release(array);
         array->data = NULL;
         array->capacity = 0;
         return CTOOLBOX_SUCCESS;
     }
 
-    void* newData = ctoolbox_custom_malloc(&array->memfuncs, array->size * array->elementSize);
+#if defined(DARRAY_MREMAP)
+    // mappings shrink in place down to whole pages
+    if (array->mappedBytes > 0) {
+        if (darray_page_round(array->size * array->elementSize, darray_page_size()) == array->mappedBytes) return CTOOLBOX_SUCCESS;
+        return darray_map_reserve(array, array->size);
+    }
+#endif
+
+    void* newData = ctoolbox_custom_aligned_malloc(&array->memfuncs, array->size * array->elementSize, array->alignment);
     if (!newData) return CTOOLBOX_ERROR_MEMORY_ALLOC;
 
     memcpy(newData, array->data, array->size * array->elementSize);
-    ctoolbox_custom_free(&array->memfuncs, array->data);
+    ctoolbox_custom_aligned_free_sized(&array->memfuncs, array->data, array->capacity * array->elementSize, array->alignment);
+    ctoolbox_memstats_on_alloc(&array->stats, array->size * array->elementSize);
+    ctoolbox_memstats_on_free(&array->stats, array->capacity * array->elementSize);
     array->data = newData;
     array->capacity = array->size;
     return CTOOLBOX_SUCCESS;
@@ -230,3 +1045,494 @@ CTOOLBOX_API bool darray_empty(const darray *array)
  {
     return array ? (array->size == 0) : true;
 }
+
+CTOOLBOX_API size_t darray_alignment(const darray* array)
+{
+    return array ? array->alignment : 0;
+}
+
+CTOOLBOX_API ctoolbox_result darray_set_growth(darray* array, darray_growth policy, size_t value)
+{
+    if (!array) return CTOOLBOX_ERROR_INVALID_PARAM;
+    if (policy == DARRAY_GROWTH_FACTOR && value <= 100) return CTOOLBOX_ERROR_INVALID_PARAM;
+    if (policy == DARRAY_GROWTH_LINEAR && value == 0) return CTOOLBOX_ERROR_INVALID_PARAM;
+    if (policy != DARRAY_GROWTH_FACTOR && policy != DARRAY_GROWTH_LINEAR && policy != DARRAY_GROWTH_PAGE) return CTOOLBOX_ERROR_INVALID_PARAM;
+
+    array->growth = policy;
+    array->growthValue = value;
+    return CTOOLBOX_SUCCESS;
+}
+
+CTOOLBOX_API ctoolbox_result darray_set_mapped(darray* array, size_t thresholdBytes)
+{
+    if (!array) return CTOOLBOX_ERROR_INVALID_PARAM;
+
+#if defined(DARRAY_MREMAP)
+    array->mapThreshold = thresholdBytes;
+    return CTOOLBOX_SUCCESS;
+#else
+    (void)thresholdBytes;
+    return CTOOLBOX_ERROR_UNSUPPORTED;
+#endif
+}
+
+CTOOLBOX_API ctoolbox_result darray_sort(darray* array, darray_compare_func compare)
+{
+    if (!array || !compare) return CTOOLBOX_ERROR_INVALID_PARAM;
+
+    ctoolbox_result res = darray_make_writable(array);
+    if (res != CTOOLBOX_SUCCESS) return res;
+
+    size_t depth = 0;
+    for (size_t n = array->size; n > 1; n >>= 1) depth += 2;
+    darray_intro_sort((char*)array->data, 0, array->size, depth, array->elementSize, compare);
+    return CTOOLBOX_SUCCESS;
+}
+
+CTOOLBOX_API ctoolbox_result darray_stable_sort(darray* array, darray_compare_func compare)
+{
+    if (!array || !compare) return CTOOLBOX_ERROR_INVALID_PARAM;
+    if (array->size < 2) return CTOOLBOX_SUCCESS;
+
+    ctoolbox_result res = darray_make_writable(array);
+    if (res != CTOOLBOX_SUCCESS) return res;
+
+    size_t bytes = array->size * array->elementSize;
+    char* scratch = darray_scratch_alloc(array, bytes);
+    if (!scratch) return CTOOLBOX_ERROR_MEMORY_ALLOC;
+
+    darray_merge_sort((char*)array->data, scratch, 0, array->size, array->elementSize, compare);
+    darray_scratch_free(array, scratch, bytes);
+    return CTOOLBOX_SUCCESS;
+}
+
+CTOOLBOX_API ctoolbox_result darray_parallel_sort(darray* array, threadpool* pool, darray_compare_func compare)
+{
+    if (!array || !compare) return CTOOLBOX_ERROR_INVALID_PARAM;
+
+    // a chunk per thread of the pool
+    size_t chunks = pool ? threadpool_thread_count(pool) : 1;
+    if (chunks > DARRAY_SORT_MAX_THREADS) chunks = DARRAY_SORT_MAX_THREADS;
+    if (chunks > array->size / DARRAY_SORT_RUN) chunks = array->size / DARRAY_SORT_RUN;
+    if (chunks < 2 || array->size < DARRAY_PARALLEL_SORT_THRESHOLD) return darray_stable_sort(array, compare);
+
+    ctoolbox_result res = darray_make_writable(array);
+    if (res != CTOOLBOX_SUCCESS) return res;
+
+    size_t bytes = array->size * array->elementSize;
+    char* scratch = darray_scratch_alloc(array, bytes);
+    if (!scratch) return CTOOLBOX_ERROR_MEMORY_ALLOC;
+
+    // every chunk is sorted on its own
+    size_t bounds[DARRAY_SORT_MAX_THREADS + 1];
+    darray_sort_task tasks[DARRAY_SORT_MAX_THREADS];
+    for (size_t i = 0; i <= chunks; i++) bounds[i] = array->size / chunks * i + (array->size % chunks) * i / chunks;
+
+    for (size_t i = 0; i < chunks; i++) {
+        darray_sort_task task = { (char*)array->data, scratch, bounds[i], bounds[i], bounds[i + 1], array->elementSize, compare };
+        tasks[i] = task;
+    }
+    res = threadpool_parallel_for(pool, chunks, 1, darray_sort_range, tasks);
+
+    // then adjacent chunks are merged pairwise, each pass halving the chunk count
+    char* src = (char*)array->data;
+    char* dst = scratch;
+    while (res == CTOOLBOX_SUCCESS && chunks > 1) {
+        size_t pairs = chunks / 2;
+        for (size_t i = 0; i < pairs; i++) {
+            darray_sort_task task = { src, dst, bounds[2 * i], bounds[2 * i + 1], bounds[2 * i + 2], array->elementSize, compare };
+            tasks[i] = task;
+        }
+
+        // an odd chunk out is carried over as is
+        if (chunks % 2) {
+            darray_sort_task task = { src, dst, bounds[chunks - 1], bounds[chunks], bounds[chunks], array->elementSize, compare };
+            tasks[pairs] = task;
+        }
+        res = threadpool_parallel_for(pool, pairs + chunks % 2, 1, darray_merge_range, tasks);
+        if (res != CTOOLBOX_SUCCESS) break;
+
+        for (size_t i = 0; i <= pairs; i++) bounds[i] = bounds[2 * i < chunks ? 2 * i : chunks];
+        bounds[pairs + chunks % 2] = array->size;
+        chunks = pairs + chunks % 2;
+
+        char* swap = src;
+        src = dst;
+        dst = swap;
+    }
+
+    // src holds every element even when a pass failed, only the order is lost
+    if (src != array->data) memcpy(array->data, src, bytes);
+    darray_scratch_free(array, scratch, bytes);
+    return res;
+}
+
+CTOOLBOX_API ctoolbox_result darray_radix_sort(darray* array, size_t keyOffset, size_t keySize, bool keySigned)
+{
+    if (!array) return CTOOLBOX_ERROR_INVALID_PARAM;
+    if (keySize != 1 && keySize != 2 && keySize != 4 && keySize != 8) return CTOOLBOX_ERROR_INVALID_PARAM;
+    if (keyOffset > array->elementSize || keySize > array->elementSize - keyOffset) return CTOOLBOX_ERROR_INVALID_PARAM;
+    if (array->size < 2) return CTOOLBOX_SUCCESS;
+
+    ctoolbox_result res = darray_make_writable(array);
+    if (res != CTOOLBOX_SUCCESS) return res;
+
+    // a single pass histograms every byte of the key
+    size_t counts[8][256];
+    memset(counts, 0, sizeof(counts[0]) * keySize);
+
+    const size_t elementSize = array->elementSize;
+    const char* data = (const char*)array->data;
+    for (size_t i = 0; i < array->size; i++) {
+        uint64_t key = darray_radix_key(data + i * elementSize + keyOffset, keySize, keySigned);
+        for (size_t b = 0; b < keySize; b++) counts[b][(key >> (b * 8)) & 0xff]++;
+    }
+
+    size_t bytes = array->size * elementSize;
+    char* scratch = NULL;
+    char* src = (char*)array->data;
+    char* dst = NULL;
+
+    for (size_t b = 0; b < keySize; b++) {
+        // bytes every key shares don't reorder anything
+        size_t offsets[256];
+        size_t total = 0;
+        bool skip = false;
+        for (size_t d = 0; d < 256; d++) {
+            if (counts[b][d] == array->size) skip = true;
+            offsets[d] = total;
+            total += counts[b][d];
+        }
+        if (skip) continue;
+
+        if (!scratch) {
+            scratch = darray_scratch_alloc(array, bytes);
+            if (!scratch) return CTOOLBOX_ERROR_MEMORY_ALLOC;
+            dst = scratch;
+        }
+
+        for (size_t i = 0; i < array->size; i++) {
+            const char* element = src + i * elementSize;
+            size_t digit = (darray_radix_key(element + keyOffset, keySize, keySigned) >> (b * 8)) & 0xff;
+            memcpy(dst + (offsets[digit]++) * elementSize, element, elementSize);
+        }
+
+        char* swap = src;
+        src = dst;
+        dst = swap;
+    }
+
+    if (!scratch) return CTOOLBOX_SUCCESS;
+    if (src != array->data) memcpy(array->data, src, bytes);
+    darray_scratch_free(array, scratch, bytes);
+    return CTOOLBOX_SUCCESS;
+}
+
+CTOOLBOX_API size_t darray_lower_bound(const darray* array, const void* key, darray_compare_func compare)
+{
+    if (!array || !key || !compare) return 0;
+
+    size_t lo = 0, hi = array->size;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (compare((const char*)array->data + mid * array->elementSize, key) < 0) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+CTOOLBOX_API size_t darray_upper_bound(const darray* array, const void* key, darray_compare_func compare)
+{
+    if (!array || !key || !compare) return 0;
+
+    size_t lo = 0, hi = array->size;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (compare((const char*)array->data + mid * array->elementSize, key) <= 0) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+CTOOLBOX_API ctoolbox_result darray_binary_search(const darray* array, const void* key, darray_compare_func compare, size_t* indexOut)
+{
+    if (!array || !key || !compare) return CTOOLBOX_ERROR_INVALID_PARAM;
+
+    size_t index = darray_lower_bound(array, key, compare);
+    if (index == array->size || compare((const char*)array->data + index * array->elementSize, key) != 0) return CTOOLBOX_ERROR_NOT_FOUND;
+
+    if (indexOut) *indexOut = index;
+    return CTOOLBOX_SUCCESS;
+}
+
+CTOOLBOX_API ctoolbox_result darray_find(const darray* array, const void* value, size_t* indexOut)
+{
+    if (!array || !value) return CTOOLBOX_ERROR_INVALID_PARAM;
+
+    size_t index = csimd_find(array->data, array->size, array->elementSize, value);
+    if (index == array->size) return CTOOLBOX_ERROR_NOT_FOUND;
+
+    if (indexOut) *indexOut = index;
+    return CTOOLBOX_SUCCESS;
+}
+
+CTOOLBOX_API size_t darray_count(const darray* array, const void* value)
+{
+    if (!array || !value) return 0;
+    return csimd_count(array->data, array->size, array->elementSize, value);
+}
+
+CTOOLBOX_API bool darray_contains(const darray* array, const void* value)
+{
+    if (!array || !value) return false;
+    return csimd_find(array->data, array->size, array->elementSize, value) < array->size;
+}
+
+CTOOLBOX_API ctoolbox_result darray_fill(darray* array, const void* value)
+{
+    if (!array || !value) return CTOOLBOX_ERROR_INVALID_PARAM;
+
+    ctoolbox_result res = darray_make_writable(array);
+    if (res != CTOOLBOX_SUCCESS) return res;
+
+    csimd_fill(array->data, array->size, array->elementSize, value);
+    return CTOOLBOX_SUCCESS;
+}
+
+CTOOLBOX_API bool darray_equal(const darray* a, const darray* b)
+{
+    if (!a || !b) return a == b;
+    if (a->elementSize != b->elementSize || a->size != b->size) return false;
+    return csimd_equal(a->data, b->data, a->size * a->elementSize);
+}
+
+CTOOLBOX_API ctoolbox_result darray_parallel_for_each(darray* array, threadpool* pool, darray_element_func func, void* user)
+{
+    if (!array || !func) return CTOOLBOX_ERROR_INVALID_PARAM;
+
+    ctoolbox_result res = darray_make_writable(array);
+    if (res != CTOOLBOX_SUCCESS) return res;
+
+    darray_parallel_context ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.data = (char*)array->data;
+    ctx.elementSize = array->elementSize;
+    ctx.each = func;
+    ctx.user = user;
+
+    if (!darray_parallel_worth(pool, array->size)) return darray_each_range(&ctx, 0, array->size);
+    return threadpool_parallel_for(pool, array->size, darray_parallel_chunk(pool, array->size, array->elementSize), darray_each_range, &ctx);
+}
+
+CTOOLBOX_API ctoolbox_result darray_parallel_transform(const darray* source, darray* destination, threadpool* pool, darray_transform_func func, void* user)
+{
+    if (!source || !destination || !func) return CTOOLBOX_ERROR_INVALID_PARAM;
+
+    ctoolbox_result res = darray_resize(destination, source->size);
+    if (res != CTOOLBOX_SUCCESS) return res;
+
+    darray_parallel_context ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.data = (char*)source->data;
+    ctx.output = (char*)destination->data;
+    ctx.elementSize = source->elementSize;
+    ctx.outputElementSize = destination->elementSize;
+    ctx.transform = func;
+    ctx.user = user;
+
+    if (!darray_parallel_worth(pool, source->size)) return darray_transform_range(&ctx, 0, source->size);
+
+    // chunks are sized on the wider of the two element types so both sides stay cached
+    size_t widest = source->elementSize > destination->elementSize ? source->elementSize : destination->elementSize;
+    return threadpool_parallel_for(pool, source->size, darray_parallel_chunk(pool, source->size, widest), darray_transform_range, &ctx);
+}
+
+CTOOLBOX_API ctoolbox_result darray_parallel_reduce(const darray* array, threadpool* pool, const void* identity, darray_combine_func combine, void* user, void* resultOut)
+{
+    if (!array || !identity || !combine || !resultOut) return CTOOLBOX_ERROR_INVALID_PARAM;
+
+    darray_parallel_context ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.data = (char*)array->data;
+    ctx.size = array->size;
+    ctx.elementSize = array->elementSize;
+    ctx.identity = identity;
+    ctx.combine = combine;
+    ctx.user = user;
+
+    // a single chunk folds straight into the result
+    if (!darray_parallel_worth(pool, array->size)) {
+        ctx.chunk = array->size;
+        ctx.partials = resultOut;
+        return darray_reduce_range(&ctx, 0, 1);
+    }
+
+    ctx.chunk = darray_parallel_chunk(pool, array->size, array->elementSize);
+    size_t chunkCount = array->size / ctx.chunk + (array->size % ctx.chunk != 0);
+    size_t bytes = chunkCount * array->elementSize;
+
+    // the partials aren't charged to the array's stats, a const array may be reduced from several threads at once
+    ctx.partials = ctoolbox_custom_aligned_malloc(&array->memfuncs, bytes, array->alignment);
+    if (!ctx.partials) return CTOOLBOX_ERROR_MEMORY_ALLOC;
+
+    ctoolbox_result res = threadpool_parallel_for(pool, chunkCount, 1, darray_reduce_range, &ctx);
+    if (res == CTOOLBOX_SUCCESS) {
+        memcpy(resultOut, identity, array->elementSize);
+        for (size_t c = 0; c < chunkCount; c++) combine(resultOut, ctx.partials + c * array->elementSize, user);
+    }
+
+    ctoolbox_custom_aligned_free_sized(&array->memfuncs, ctx.partials, bytes, array->alignment);
+    return res;
+}
+
+CTOOLBOX_API ctoolbox_result darray_parallel_scan(darray* array, threadpool* pool, const void* identity, darray_combine_func combine, void* user)
+{
+    if (!array || !identity || !combine) return CTOOLBOX_ERROR_INVALID_PARAM;
+    if (array->size == 0) return CTOOLBOX_SUCCESS;
+
+    ctoolbox_result res = darray_make_writable(array);
+    if (res != CTOOLBOX_SUCCESS) return res;
+
+    darray_parallel_context ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.data = (char*)array->data;
+    ctx.size = array->size;
+    ctx.elementSize = array->elementSize;
+    ctx.identity = identity;
+    ctx.combine = combine;
+    ctx.user = user;
+
+    bool parallel = darray_parallel_worth(pool, array->size);
+    ctx.chunk = parallel ? darray_parallel_chunk(pool, array->size, array->elementSize) : array->size;
+    size_t chunkCount = array->size / ctx.chunk + (array->size % ctx.chunk != 0);
+
+    // a partial per chunk plus the running carry and a spare element
+    size_t bytes = (chunkCount + 2) * array->elementSize;
+    ctx.partials = darray_scratch_alloc(array, bytes);
+    if (!ctx.partials) return CTOOLBOX_ERROR_MEMORY_ALLOC;
+
+    if (parallel) {
+        // first pass: each chunk's own fold, then serially what comes before each chunk
+        res = threadpool_parallel_for(pool, chunkCount, 1, darray_reduce_range, &ctx);
+        if (res != CTOOLBOX_SUCCESS) {
+            darray_scratch_free(array, ctx.partials, bytes);
+            return res;
+        }
+
+        char* carry = ctx.partials + chunkCount * array->elementSize;
+        char* total = carry + array->elementSize;
+        memcpy(carry, identity, array->elementSize);
+        for (size_t c = 0; c < chunkCount; c++) {
+            char* partial = ctx.partials + c * array->elementSize;
+            memcpy(total, partial, array->elementSize);
+            memcpy(partial, carry, array->elementSize);
+            combine(carry, total, user);
+        }
+
+        // second pass: every chunk scanned from its carry
+        res = threadpool_parallel_for(pool, chunkCount, 1, darray_scan_range, &ctx);
+    }
+    else {
+        memcpy(ctx.partials, identity, array->elementSize);
+        res = darray_scan_range(&ctx, 0, 1);
+    }
+
+    darray_scratch_free(array, ctx.partials, bytes);
+    return res;
+}
+
+CTOOLBOX_API ctoolbox_result darray_save(const darray* array, const char* path)
+{
+    if (!array || !path) return CTOOLBOX_ERROR_INVALID_PARAM;
+
+    darray_file_header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, DARRAY_FILE_MAGIC, sizeof(header.magic));
+    header.version = DARRAY_FILE_VERSION;
+    header.byteOrder = DARRAY_FILE_BYTE_ORDER;
+    header.elementSize = array->elementSize;
+    header.size = array->size;
+    header.alignment = array->alignment;
+
+    size_t dataAlignment = array->alignment > 64 ? array->alignment : 64;
+    header.dataOffset = (sizeof(header) + dataAlignment - 1) & ~(uint64_t)(dataAlignment - 1);
+
+    // the elements go to a file next to path that replaces it once complete, a failed save leaves path as it was
+    size_t pathLength = strlen(path);
+    size_t tempBytes = pathLength + sizeof(DARRAY_FILE_TEMP_SUFFIX);
+    char* tempPath = ctoolbox_custom_malloc(&array->memfuncs, tempBytes);
+    if (!tempPath) return CTOOLBOX_ERROR_MEMORY_ALLOC;
+
+    memcpy(tempPath, path, pathLength);
+    memcpy(tempPath + pathLength, DARRAY_FILE_TEMP_SUFFIX, sizeof(DARRAY_FILE_TEMP_SUFFIX));
+
+    FILE* file = fopen(tempPath, "wb");
+    bool written = file != NULL;
+    if (written) {
+        written = fwrite(&header, sizeof(header), 1, file) == 1;
+        for (size_t i = sizeof(header); written && i < header.dataOffset; i++) written = fputc(0, file) != EOF;
+        if (written && array->size > 0) written = fwrite(array->data, array->elementSize, array->size, file) == array->size;
+        if (fclose(file) != 0) written = false;
+
+        if (written) written = darray_file_replace(tempPath, path);
+        if (!written) remove(tempPath);
+    }
+
+    ctoolbox_custom_free_sized(&array->memfuncs, tempPath, tempBytes);
+    return written ? CTOOLBOX_SUCCESS : CTOOLBOX_ERROR_IO;
+}
+
+CTOOLBOX_API darray* darray_open_mapped(const char* path, darray_map_mode mode, const ctoolbox_memfuncs* memfuncs)
+{
+    if (!path) return NULL;
+
+    size_t fileBytes = 0;
+    char* file = darray_file_map(path, mode == DARRAY_MAP_COPY_ON_WRITE, &fileBytes);
+    if (!file) return NULL;
+
+    // nothing is deserialised, the header is only checked against the file
+    darray_file_header header;
+    bool valid = fileBytes >= sizeof(header);
+    if (valid) {
+        memcpy(&header, file, sizeof(header));
+        valid = memcmp(header.magic, DARRAY_FILE_MAGIC, sizeof(header.magic)) == 0 && header.version == DARRAY_FILE_VERSION && header.byteOrder == DARRAY_FILE_BYTE_ORDER;
+    }
+    if (valid) {
+        valid = header.elementSize > 0 && header.alignment > 0 && (header.alignment & (header.alignment - 1)) == 0 && header.alignment <= SIZE_MAX
+            && header.dataOffset >= sizeof(header) && header.dataOffset <= fileBytes && header.dataOffset % header.alignment == 0
+            && header.size <= (fileBytes - header.dataOffset) / header.elementSize
+            && ((uintptr_t)(file + header.dataOffset) & (uintptr_t)(header.alignment - 1)) == 0;
+    }
+
+    darray* outArray = valid ? ctoolbox_custom_malloc(memfuncs ? memfuncs : &CTOOLBOX_DEFAULT_MEMFUNCS, sizeof(darray)) : NULL;
+    if (!outArray) {
+        darray_file_unmap(file, fileBytes);
+        return NULL;
+    }
+
+    memset(outArray, 0, sizeof(darray));
+    outArray->data = file + header.dataOffset;
+    outArray->size = (size_t)header.size;
+    outArray->capacity = mode == DARRAY_MAP_COPY_ON_WRITE ? (size_t)header.size : 0;
+    outArray->elementSize = (size_t)header.elementSize;
+    outArray->alignment = header.alignment > CTOOLBOX_DEFAULT_ALIGNMENT ? (size_t)header.alignment : CTOOLBOX_DEFAULT_ALIGNMENT;
+    outArray->growth = DARRAY_GROWTH_FACTOR;
+    outArray->growthValue = 200;
+    outArray->file = file;
+    outArray->fileBytes = fileBytes;
+
+    if (memfuncs) outArray->memfuncs = *memfuncs;
+    else outArray->memfuncs = CTOOLBOX_DEFAULT_MEMFUNCS;
+
+    ctoolbox_memstats_on_alloc(&outArray->stats, sizeof(darray));
+    ctoolbox_memstats_on_alloc(&outArray->stats, fileBytes);
+
+    return outArray;
+}
+
+CTOOLBOX_API ctoolbox_result darray_memory_usage(const darray* array, ctoolbox_memstats* statsOut)
+{
+    if (!array || !statsOut) return CTOOLBOX_ERROR_INVALID_PARAM;
+    *statsOut = array->stats;
+    return CTOOLBOX_SUCCESS;
+}
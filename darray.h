@@ -2,10 +2,75 @@
 #define DARRAY_INCLUDED
 
 #include "context.h"
+#include "threadpool.h"
+
+/// @brief arrays with fewer elements are sorted on the calling thread by darray_parallel_sort
+#ifndef DARRAY_PARALLEL_SORT_THRESHOLD
+    #define DARRAY_PARALLEL_SORT_THRESHOLD 65536
+#endif
+
+/// @brief most chunks darray_parallel_sort splits the work into, one per thread of the pool
+#ifndef DARRAY_SORT_MAX_THREADS
+    #define DARRAY_SORT_MAX_THREADS 64
+#endif
+
+/// @brief runs shorter than this are insertion sorted before merging
+#ifndef DARRAY_SORT_RUN
+    #define DARRAY_SORT_RUN 16
+#endif
+
+/// @brief arrays with fewer elements are processed on the calling thread by darray_parallel_for_each, transform, reduce and scan
+#ifndef DARRAY_PARALLEL_THRESHOLD
+    #define DARRAY_PARALLEL_THRESHOLD 16384
+#endif
+
+/// @brief bytes of elements each parallel task works on, 0 to use half of a core's L2 cache as queried at run time
+#ifndef DARRAY_PARALLEL_CHUNK_BYTES
+    #define DARRAY_PARALLEL_CHUNK_BYTES 0
+#endif
 
 /// @brief opaque dynamic array structure
 typedef struct darray darray;
 
+/// @brief how the array grows when it runs out of capacity
+typedef enum darray_growth
+{
+    DARRAY_GROWTH_FACTOR = 0,   // multiplies the capacity by value percent, 200 (doubling) by default
+    DARRAY_GROWTH_LINEAR,       // adds value elements at a time
+    DARRAY_GROWTH_PAGE          // adds value bytes at a time (a page if 0), keeping the storage a whole number of pages
+} darray_growth;
+
+/// @brief how darray_open_mapped maps the file
+typedef enum darray_map_mode
+{
+    DARRAY_MAP_READ_ONLY = 0,   // pages are shared with the file, the first write moves the elements to the heap
+    DARRAY_MAP_COPY_ON_WRITE    // written pages become private copies, the file is never modified
+} darray_map_mode;
+
+/// @brief compares two elements like qsort's comparator, negative when a goes before b
+typedef int (*darray_compare_func)(const void* a, const void* b);
+
+/// @brief tests an element, user is passed through untouched
+typedef bool (*darray_predicate_func)(const void* element, void* user);
+
+/// @brief visits an element in place, user is passed through untouched
+typedef void (*darray_element_func)(void* element, void* user);
+
+/// @brief writes the transformed element into elementOut, user is passed through untouched
+typedef void (*darray_transform_func)(const void* element, void* elementOut, void* user);
+
+/// @brief folds element into accumulator, both of the array's element type, must be associative
+typedef void (*darray_combine_func)(void* accumulator, const void* element, void* user);
+
+/// @brief leading fields of every darray, exposed only so the typed wrappers below can inline their fast paths
+typedef struct darray_header
+{
+    void* data;
+    size_t size;
+    size_t capacity;
+    size_t elementSize;
+} darray_header;
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // functions
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -20,6 +85,12 @@ CTOOLBOX_API darray* darray_init(size_t elementSize, size_t initialCapacity);
 /// @brief initializes the dynamic array with custom memory allocation functions
 CTOOLBOX_API darray* darray_init_memfuncs(size_t elementSize, size_t initialCapacity, const ctoolbox_memfuncs* memfuncs);
 
+/// @brief initializes the dynamic array with its storage aligned to alignment bytes (power of two) across growth
+CTOOLBOX_API darray* darray_init_aligned(size_t elementSize, size_t initialCapacity, size_t alignment, const ctoolbox_memfuncs* memfuncs);
+
+/// @brief initializes a darray whose first inlineCapacity elements live in the same allocation as the container, spilling to the heap once outgrown
+CTOOLBOX_API darray* darray_init_inline(size_t elementSize, size_t inlineCapacity, const ctoolbox_memfuncs* memfuncs);
+
 /// @brief destroys the dynamic array, but not the content itself, be-warned
 CTOOLBOX_API void darray_destroy(darray* array);
 
@@ -29,6 +100,22 @@ CTOOLBOX_API ctoolbox_result darray_push_back(darray* array, const void* element
 /// @brief removes an item from the array's back, not freeing it
 CTOOLBOX_API ctoolbox_result darray_pop_back(darray* array, void* elementOut);
 
+/// @brief reserves a slot at the array's back and returns it uninitialized for in-place construction, NULL on failure
+CTOOLBOX_API void* darray_emplace_back(darray* array);
+
+/// @brief reserves count contiguous slots at the array's back and returns the first one uninitialized, NULL on failure
+CTOOLBOX_API void* darray_emplace_back_n(darray* array, size_t count);
+
+/// @brief opens a slot at a given position, shifting the tail, and returns it uninitialized, NULL on failure
+CTOOLBOX_API void* darray_emplace_at(darray* array, size_t index);
+
+/// @brief writable access to the element at a given index, valid until the array grows or shrinks
+CTOOLBOX_API void* darray_peek(darray* array, size_t index);
+
+/// @brief writable access to the data underneath the array, valid until the array grows or shrinks
+/// @brief a read-only mapped array moves to the heap first, the const accessors read it in place
+CTOOLBOX_API void* darray_data(darray* array);
+
 /// @brief sees what is underneath a given index on the array
 CTOOLBOX_API const void* darray_const_peek(const darray* array, size_t index);
 
@@ -47,6 +134,27 @@ CTOOLBOX_API ctoolbox_result darray_insert_at(darray* array, size_t index, const
 /// @brief removes an item from a given position on the array
 CTOOLBOX_API ctoolbox_result darray_remove_at(darray* array, size_t index, void* elementOut);
 
+/// @brief removes the element at the index in O(1) by moving the last element into its place, the order isn't kept
+CTOOLBOX_API ctoolbox_result darray_swap_remove(darray* array, size_t index, void* elementOut);
+
+/// @brief removes every element the predicate accepts in a single pass keeping the order of the rest, returns how many were removed
+CTOOLBOX_API size_t darray_remove_if(darray* array, darray_predicate_func predicate, void* user);
+
+/// @brief keeps only the elements the predicate accepts in a single pass keeping their order, returns how many were removed
+CTOOLBOX_API size_t darray_retain(darray* array, darray_predicate_func predicate, void* user);
+
+/// @brief appends count elements to the array's back, growing the storage at most once
+CTOOLBOX_API ctoolbox_result darray_append(darray* array, const void* elements, size_t count);
+
+/// @brief appends every element of other to the array's back, both must have the same element size
+CTOOLBOX_API ctoolbox_result darray_append_darray(darray* array, const darray* other);
+
+/// @brief inserts count elements at a given position, shifting the tail once, elements must not point into the array
+CTOOLBOX_API ctoolbox_result darray_insert_range(darray* array, size_t index, const void* elements, size_t count);
+
+/// @brief removes count elements starting at a given position, copying them into elementsOut if provided
+CTOOLBOX_API ctoolbox_result darray_remove_range(darray* array, size_t index, size_t count, void* elementsOut);
+
 /// @brief resizes the array to a new size
 CTOOLBOX_API ctoolbox_result darray_resize(darray* array, size_t newSize);
 
@@ -59,13 +167,234 @@ CTOOLBOX_API ctoolbox_result darray_shrink_to_fit(darray* array);
 /// @brief returns the array's current size
 CTOOLBOX_API size_t darray_size(const darray* array);
 
-/// @brief returns the array's current max capacity
+/// @brief returns the array's current max capacity, 0 for an array still mapped read-only
 CTOOLBOX_API size_t darray_capacity(const darray* array);
 
 /// @brief returns if the array is currently empty
 CTOOLBOX_API bool darray_empty(const darray* array);
 
+/// @brief returns the alignment of the array's storage
+CTOOLBOX_API size_t darray_alignment(const darray* array);
+
+/// @brief sets how the array grows from now on, value is interpreted as described in darray_growth
+CTOOLBOX_API ctoolbox_result darray_set_growth(darray* array, darray_growth policy, size_t value);
+
+/// @brief once the storage grows past thresholdBytes it moves to an anonymous mapping grown with mremap, pages are remapped instead of copied
+/// @brief mapped storage bypasses the memory functions, 0 disables it for future growth, linux only, CTOOLBOX_ERROR_UNSUPPORTED elsewhere
+CTOOLBOX_API ctoolbox_result darray_set_mapped(darray* array, size_t thresholdBytes);
+
+/// @brief sorts the array in place without allocating, equal elements may be reordered
+/// @brief introsort with whole-word swaps for 4, 8 and 16 bytes elements, heapsort bounds the worst case to O(n log n)
+CTOOLBOX_API ctoolbox_result darray_sort(darray* array, darray_compare_func compare);
+
+/// @brief sorts the array keeping equal elements in order, using a scratch buffer as big as the array
+CTOOLBOX_API ctoolbox_result darray_stable_sort(darray* array, darray_compare_func compare);
+
+/// @brief stable sort split across the threads of the pool, arrays under DARRAY_PARALLEL_SORT_THRESHOLD or without a pool are sorted on the caller
+CTOOLBOX_API ctoolbox_result darray_parallel_sort(darray* array, threadpool* pool, darray_compare_func compare);
+
+/// @brief stable LSD radix sort on the 1, 2, 4 or 8 bytes integer key found keyOffset bytes into each element, no comparator involved
+CTOOLBOX_API ctoolbox_result darray_radix_sort(darray* array, size_t keyOffset, size_t keySize, bool keySigned);
+
+/// @brief returns the index of the first element of the sorted array not ordered before key, or the size if there is none
+CTOOLBOX_API size_t darray_lower_bound(const darray* array, const void* key, darray_compare_func compare);
+
+/// @brief returns the index of the first element of the sorted array ordered after key, or the size if there is none
+CTOOLBOX_API size_t darray_upper_bound(const darray* array, const void* key, darray_compare_func compare);
+
+/// @brief finds an element equal to key in the sorted array, CTOOLBOX_ERROR_NOT_FOUND if there is none
+CTOOLBOX_API ctoolbox_result darray_binary_search(const darray* array, const void* key, darray_compare_func compare, size_t* indexOut);
+
+/// @brief finds the first element equal to value byte for byte, vectorised for 1, 2, 4 and 8 bytes elements, CTOOLBOX_ERROR_NOT_FOUND if there is none
+CTOOLBOX_API ctoolbox_result darray_find(const darray* array, const void* value, size_t* indexOut);
+
+/// @brief returns how many elements are equal to value byte for byte
+CTOOLBOX_API size_t darray_count(const darray* array, const void* value);
+
+/// @brief returns whether an element is equal to value byte for byte
+CTOOLBOX_API bool darray_contains(const darray* array, const void* value);
+
+/// @brief copies value into every element of the array
+CTOOLBOX_API ctoolbox_result darray_fill(darray* array, const void* value);
+
+/// @brief returns whether both arrays hold the same number of elements with the same bytes
+CTOOLBOX_API bool darray_equal(const darray* a, const darray* b);
+
+/// @brief calls func on every element, split in cache sized chunks across the pool, on the caller if pool is NULL
+CTOOLBOX_API ctoolbox_result darray_parallel_for_each(darray* array, threadpool* pool, darray_element_func func, void* user);
+
+/// @brief resizes destination to the size of source and writes func of every source element at the same index, in parallel like darray_parallel_for_each
+CTOOLBOX_API ctoolbox_result darray_parallel_transform(const darray* source, darray* destination, threadpool* pool, darray_transform_func func, void* user);
+
+/// @brief folds every element into resultOut starting from identity, each chunk is reduced on its own then the chunk results in order
+/// @brief the chunk results come from the array's memory functions but aren't counted in its darray_memory_usage, the array is only read
+CTOOLBOX_API ctoolbox_result darray_parallel_reduce(const darray* array, threadpool* pool, const void* identity, darray_combine_func combine, void* user, void* resultOut);
+
+/// @brief replaces every element with the fold of the elements up to it (inclusive prefix scan) in two parallel passes over the chunks
+CTOOLBOX_API ctoolbox_result darray_parallel_scan(darray* array, threadpool* pool, const void* identity, darray_combine_func combine, void* user);
+
+/// @brief writes the elements to path in a versioned format with the data aligned like the array, elements must be plain data
+/// @brief path is only replaced once the whole file is written, CTOOLBOX_ERROR_IO when it can't be
+CTOOLBOX_API ctoolbox_result darray_save(const darray* array, const char* path);
+
+/// @brief opens a file written by darray_save as a darray backed by the file pages themselves, loaded on demand without deserialising
+/// @brief growing the array or, when mapped read-only, writing to it moves the elements to the heap, returns NULL if the file can't be mapped or isn't valid
+CTOOLBOX_API darray* darray_open_mapped(const char* path, darray_map_mode mode, const ctoolbox_memfuncs* memfuncs);
+
+/// @brief returns the memory the array allocated, its header included
+CTOOLBOX_API ctoolbox_result darray_memory_usage(const darray* array, ctoolbox_memstats* statsOut);
+
+#ifdef __cplusplus
+}
+#endif
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// typed arrays
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// @brief generates darray_<name>_* functions with a compile time element size, e.g. DARRAY_DEFINE(u32, uint32_t)
+/// @brief the fast paths are inlined, growth and errors go through darray.c so the results match the untyped calls
+/// @brief at() doesn't check its arguments
+#define DARRAY_DEFINE(name, type)                                                                                   \
+    static inline darray* darray_##name##_init(size_t initialCapacity)                                              \
+    {                                                                                                               \
+        return darray_init(sizeof(type), initialCapacity);                                                          \
+    }                                                                                                               \
+                                                                                                                    \
+    static inline type* darray_##name##_data(darray* array)                                                         \
+    {                                                                                                               \
+        return (type*)darray_data(array);                                                                           \
+    }                                                                                                               \
+                                                                                                                    \
+    static inline type darray_##name##_at(const darray* array, size_t index)                                        \
+    {                                                                                                               \
+        return ((const type*)((const darray_header*)array)->data)[index];                                           \
+    }                                                                                                               \
+                                                                                                                    \
+    static inline ctoolbox_result darray_##name##_push_back(darray* array, type value)                              \
+    {                                                                                                               \
+        darray_header* header = (darray_header*)array;                                                              \
+        if (header && header->size < header->capacity) {                                                            \
+            ((type*)header->data)[header->size++] = value;                                                          \
+            return CTOOLBOX_SUCCESS;                                                                                \
+        }                                                                                                           \
+                                                                                                                    \
+        return darray_push_back(array, &value);                                                                     \
+    }                                                                                                               \
+                                                                                                                    \
+    static inline ctoolbox_result darray_##name##_pop_back(darray* array, type* elementOut)                         \
+    {                                                                                                               \
+        darray_header* header = (darray_header*)array;                                                              \
+        if (!header || header->size == 0) return darray_pop_back(array, elementOut);                                \
+        header->size--;                                                                                             \
+        if (elementOut) *elementOut = ((type*)header->data)[header->size];                                          \
+        return CTOOLBOX_SUCCESS;                                                                                    \
+    }                                                                                                               \
+                                                                                                                    \
+    static inline ctoolbox_result darray_##name##_get(const darray* array, size_t index, type* elementOut)          \
+    {                                                                                                               \
+        const darray_header* header = (const darray_header*)array;                                                  \
+        if (!header || !elementOut || index >= header->size) return darray_get(array, index, elementOut);           \
+        *elementOut = ((const type*)header->data)[index];                                                           \
+        return CTOOLBOX_SUCCESS;                                                                                    \
+    }                                                                                                               \
+                                                                                                                    \
+    static inline ctoolbox_result darray_##name##_set(darray* array, size_t index, type value)                      \
+    {                                                                                                               \
+        darray_header* header = (darray_header*)array;                                                              \
+        if (!header || index >= header->size || index >= header->capacity) {                                        \
+            return darray_set(array, index, &value);                                                                \
+        }                                                                                                           \
+        ((type*)header->data)[index] = value;                                                                       \
+        return CTOOLBOX_SUCCESS;                                                                                    \
+    }
+
 #ifdef __cplusplus
+#include <type_traits>
+
+namespace ctoolbox
+{
+    /// @brief owning darray of trivially copyable T, with the element size known at compile time
+    template<typename T>
+    class typed_darray
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "darray moves elements with memcpy");
+
+    public:
+
+        explicit typed_darray(size_t initialCapacity = 0, const ctoolbox_memfuncs* memfuncs = nullptr)
+            : mArray(darray_init_aligned(sizeof(T), initialCapacity, alignof(T), memfuncs)) {}
+
+        ~typed_darray() { darray_destroy(mArray); }
+
+        typed_darray(const typed_darray&) = delete;
+        typed_darray& operator=(const typed_darray&) = delete;
+
+        typed_darray(typed_darray&& other) noexcept : mArray(other.mArray) { other.mArray = nullptr; }
+
+        typed_darray& operator=(typed_darray&& other) noexcept
+        {
+            if (this != &other) {
+                darray_destroy(mArray);
+                mArray = other.mArray;
+                other.mArray = nullptr;
+            }
+            return *this;
+        }
+
+        /// @brief false when the underlying darray couldn't be allocated
+        bool valid() const { return mArray != nullptr; }
+
+        /// @brief the underlying darray, for the C api
+        darray* handle() const { return mArray; }
+
+        ctoolbox_result push_back(const T& value)
+        {
+            darray_header* header = reinterpret_cast<darray_header*>(mArray);
+            if (header && header->size < header->capacity) {
+                static_cast<T*>(header->data)[header->size++] = value;
+                return CTOOLBOX_SUCCESS;
+            }
+
+            return darray_push_back(mArray, &value);
+        }
+
+        ctoolbox_result pop_back(T* elementOut = nullptr)
+        {
+            darray_header* header = reinterpret_cast<darray_header*>(mArray);
+            if (!header || header->size == 0) return darray_pop_back(mArray, elementOut);
+            header->size--;
+            if (elementOut) *elementOut = static_cast<T*>(header->data)[header->size];
+            return CTOOLBOX_SUCCESS;
+        }
+
+        ctoolbox_result reserve(size_t newCapacity) { return darray_reserve(mArray, newCapacity); }
+        ctoolbox_result resize(size_t newSize) { return darray_resize(mArray, newSize); }
+
+        size_t size() const { return mArray ? header()->size : 0; }
+        size_t capacity() const { return mArray ? header()->capacity : 0; }
+        bool empty() const { return size() == 0; }
+
+        /// @brief unchecked element access
+        T& operator[](size_t index) { return data()[index]; }
+        const T& operator[](size_t index) const { return data()[index]; }
+
+        T* data() { return mArray ? static_cast<T*>(header()->data) : nullptr; }
+        const T* data() const { return mArray ? static_cast<const T*>(header()->data) : nullptr; }
+
+        T* begin() { return data(); }
+        T* end() { return data() + size(); }
+        const T* begin() const { return data(); }
+        const T* end() const { return data() + size(); }
+
+    private:
+
+        const darray_header* header() const { return reinterpret_cast<const darray_header*>(mArray); }
+
+    private:
+
+        darray* mArray;
+    };
 }
 #endif
 
@@ -0,0 +1,262 @@
+#include "deque.h"
+#include "darray.h"
+
+#include <string.h>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// internal
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// the darray is always resized to its whole capacity, the ring lives in it from head, wrapping at the end
+struct deque
+{
+    darray* buffer;
+    size_t head;
+    size_t count;
+    size_t elementSize;
+    ctoolbox_memfuncs memfuncs;
+};
+
+static inline char* deque_data(const deque* d)
+{
+    return (char*)((const darray_header*)d->buffer)->data;
+}
+
+static inline size_t deque_ring_capacity(const deque* d)
+{
+    return ((const darray_header*)d->buffer)->size;
+}
+
+// position in the buffer of the element at the index counted from the front
+static inline size_t deque_slot(const deque* d, size_t index)
+{
+    size_t slot = d->head + index;
+    size_t capacity = deque_ring_capacity(d);
+    return slot >= capacity ? slot - capacity : slot;
+}
+
+// grows the ring so it holds at least minCapacity elements, unwrapping it once
+static ctoolbox_result deque_grow(deque* d, size_t minCapacity)
+{
+    size_t oldCapacity = deque_ring_capacity(d);
+    if (minCapacity <= oldCapacity) return CTOOLBOX_SUCCESS;
+
+    size_t newCapacity = oldCapacity > SIZE_MAX / 2 ? minCapacity : oldCapacity * 2;
+    if (newCapacity < minCapacity) newCapacity = minCapacity;
+
+    ctoolbox_result res = darray_reserve(d->buffer, newCapacity);
+    if (res != CTOOLBOX_SUCCESS) return res;
+
+    // take whatever capacity the darray ended up with
+    newCapacity = darray_capacity(d->buffer);
+    darray_resize(d->buffer, newCapacity);
+
+    // the front part of a wrapped ring moves to the end of the grown buffer
+    if (d->head + d->count > oldCapacity) {
+        size_t frontCount = oldCapacity - d->head;
+        size_t newHead = newCapacity - frontCount;
+        char* data = deque_data(d);
+        memmove(data + newHead * d->elementSize, data + d->head * d->elementSize, frontCount * d->elementSize);
+        d->head = newHead;
+    }
+    return CTOOLBOX_SUCCESS;
+}
+
+// copies count elements starting at the slot into out, following the wrap
+static void deque_copy_out(const deque* d, size_t slot, void* out, size_t count)
+{
+    size_t capacity = deque_ring_capacity(d);
+    size_t first = capacity - slot < count ? capacity - slot : count;
+    memcpy(out, deque_data(d) + slot * d->elementSize, first * d->elementSize);
+    memcpy((char*)out + first * d->elementSize, deque_data(d), (count - first) * d->elementSize);
+}
+
+// copies count elements from in to the slot onwards, following the wrap
+static void deque_copy_in(deque* d, size_t slot, const void* in, size_t count)
+{
+    size_t capacity = deque_ring_capacity(d);
+    size_t first = capacity - slot < count ? capacity - slot : count;
+    memcpy(deque_data(d) + slot * d->elementSize, in, first * d->elementSize);
+    memcpy(deque_data(d), (const char*)in + first * d->elementSize, (count - first) * d->elementSize);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// external
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+CTOOLBOX_API deque* deque_init(size_t elementSize, size_t initialCapacity)
+{
+    return deque_init_memfuncs(elementSize, initialCapacity, &CTOOLBOX_DEFAULT_MEMFUNCS);
+}
+
+CTOOLBOX_API deque* deque_init_memfuncs(size_t elementSize, size_t initialCapacity, const ctoolbox_memfuncs* memfuncs)
+{
+    if (elementSize == 0) return NULL;
+
+    deque* outDeque = ctoolbox_custom_malloc(memfuncs ? memfuncs : &CTOOLBOX_DEFAULT_MEMFUNCS, sizeof(deque));
+    if (!outDeque) return NULL;
+
+    memset(outDeque, 0, sizeof(deque));
+    outDeque->elementSize = elementSize;
+
+    if (memfuncs) outDeque->memfuncs = *memfuncs;
+    else outDeque->memfuncs = CTOOLBOX_DEFAULT_MEMFUNCS;
+
+    outDeque->buffer = darray_init_memfuncs(elementSize, initialCapacity, &outDeque->memfuncs);
+    if (!outDeque->buffer) {
+        ctoolbox_custom_free_sized(&outDeque->memfuncs, outDeque, sizeof(deque));
+        return NULL;
+    }
+    darray_resize(outDeque->buffer, darray_capacity(outDeque->buffer));
+
+    return outDeque;
+}
+
+CTOOLBOX_API void deque_destroy(deque* d)
+{
+    if (!d) return;
+
+    darray_destroy(d->buffer);
+    ctoolbox_custom_free_sized(&d->memfuncs, d, sizeof(deque));
+}
+
+CTOOLBOX_API ctoolbox_result deque_push_back(deque* d, const void* element)
+{
+    if (!d || !element) return CTOOLBOX_ERROR_INVALID_PARAM;
+
+    ctoolbox_result res = deque_grow(d, d->count + 1);
+    if (res != CTOOLBOX_SUCCESS) return res;
+
+    memcpy(deque_data(d) + deque_slot(d, d->count) * d->elementSize, element, d->elementSize);
+    d->count++;
+    return CTOOLBOX_SUCCESS;
+}
+
+CTOOLBOX_API ctoolbox_result deque_push_front(deque* d, const void* element)
+{
+    if (!d || !element) return CTOOLBOX_ERROR_INVALID_PARAM;
+
+    ctoolbox_result res = deque_grow(d, d->count + 1);
+    if (res != CTOOLBOX_SUCCESS) return res;
+
+    d->head = d->head == 0 ? deque_ring_capacity(d) - 1 : d->head - 1;
+    memcpy(deque_data(d) + d->head * d->elementSize, element, d->elementSize);
+    d->count++;
+    return CTOOLBOX_SUCCESS;
+}
+
+CTOOLBOX_API ctoolbox_result deque_pop_back(deque* d, void* elementOut)
+{
+    if (!d || d->count == 0) return CTOOLBOX_ERROR_EMPTY;
+
+    d->count--;
+    if (elementOut) memcpy(elementOut, deque_data(d) + deque_slot(d, d->count) * d->elementSize, d->elementSize);
+    return CTOOLBOX_SUCCESS;
+}
+
+CTOOLBOX_API ctoolbox_result deque_pop_front(deque* d, void* elementOut)
+{
+    if (!d || d->count == 0) return CTOOLBOX_ERROR_EMPTY;
+
+    if (elementOut) memcpy(elementOut, deque_data(d) + d->head * d->elementSize, d->elementSize);
+    d->head = deque_slot(d, 1);
+    d->count--;
+    return CTOOLBOX_SUCCESS;
+}
+
+CTOOLBOX_API ctoolbox_result deque_push_back_n(deque* d, const void* elements, size_t count)
+{
+    if (!d || (!elements && count > 0)) return CTOOLBOX_ERROR_INVALID_PARAM;
+    if (count == 0) return CTOOLBOX_SUCCESS;
+    if (count > SIZE_MAX - d->count) return CTOOLBOX_ERROR_MEMORY_ALLOC;
+
+    ctoolbox_result res = deque_grow(d, d->count + count);
+    if (res != CTOOLBOX_SUCCESS) return res;
+
+    deque_copy_in(d, deque_slot(d, d->count), elements, count);
+    d->count += count;
+    return CTOOLBOX_SUCCESS;
+}
+
+CTOOLBOX_API ctoolbox_result deque_pop_front_n(deque* d, void* elementsOut, size_t count)
+{
+    if (!d) return CTOOLBOX_ERROR_INVALID_PARAM;
+    if (count > d->count) return CTOOLBOX_ERROR_OUT_OF_BOUNDS;
+    if (count == 0) return CTOOLBOX_SUCCESS;
+
+    if (elementsOut) deque_copy_out(d, d->head, elementsOut, count);
+    d->head = deque_slot(d, count);
+    d->count -= count;
+    return CTOOLBOX_SUCCESS;
+}
+
+CTOOLBOX_API void* deque_peek(deque* d, size_t index)
+{
+    if (!d || index >= d->count) return NULL;
+    return deque_data(d) + deque_slot(d, index) * d->elementSize;
+}
+
+CTOOLBOX_API const void* deque_const_peek(const deque* d, size_t index)
+{
+    if (!d || index >= d->count) return NULL;
+    return deque_data(d) + deque_slot(d, index) * d->elementSize;
+}
+
+CTOOLBOX_API ctoolbox_result deque_get(const deque* d, size_t index, void* elementOut)
+{
+    if (!d || !elementOut) return CTOOLBOX_ERROR_INVALID_PARAM;
+    if (index >= d->count) return CTOOLBOX_ERROR_OUT_OF_BOUNDS;
+
+    memcpy(elementOut, deque_data(d) + deque_slot(d, index) * d->elementSize, d->elementSize);
+    return CTOOLBOX_SUCCESS;
+}
+
+CTOOLBOX_API ctoolbox_result deque_set(deque* d, size_t index, const void* element)
+{
+    if (!d || !element) return CTOOLBOX_ERROR_INVALID_PARAM;
+    if (index >= d->count) return CTOOLBOX_ERROR_OUT_OF_BOUNDS;
+
+    memcpy(deque_data(d) + deque_slot(d, index) * d->elementSize, element, d->elementSize);
+    return CTOOLBOX_SUCCESS;
+}
+
+CTOOLBOX_API ctoolbox_result deque_reserve(deque* d, size_t newCapacity)
+{
+    if (!d) return CTOOLBOX_ERROR_INVALID_PARAM;
+    return deque_grow(d, newCapacity);
+}
+
+CTOOLBOX_API void deque_clear(deque* d)
+{
+    if (!d) return;
+    d->head = 0;
+    d->count = 0;
+}
+
+CTOOLBOX_API size_t deque_size(const deque* d)
+{
+    return d ? d->count : 0;
+}
+
+CTOOLBOX_API size_t deque_capacity(const deque* d)
+{
+    return d ? deque_ring_capacity(d) : 0;
+}
+
+CTOOLBOX_API bool deque_empty(const deque* d)
+{
+    return d ? d->count == 0 : true;
+}
+
+CTOOLBOX_API ctoolbox_result deque_memory_usage(const deque* d, ctoolbox_memstats* statsOut)
+{
+    if (!d || !statsOut) return CTOOLBOX_ERROR_INVALID_PARAM;
+
+    ctoolbox_result res = darray_memory_usage(d->buffer, statsOut);
+    if (res != CTOOLBOX_SUCCESS) return res;
+
+    statsOut->liveBytes += sizeof(deque);
+    statsOut->peakBytes += sizeof(deque);
+    statsOut->allocCount++;
+    return CTOOLBOX_SUCCESS;
+}
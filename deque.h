@@ -0,0 +1,78 @@
+#ifndef DEQUE_INCLUDED
+#define DEQUE_INCLUDED
+
+#include "context.h"
+
+/// @brief opaque double-ended queue structure
+typedef struct deque deque;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// functions
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// @brief initializes the deque, a ring buffer kept in a darray
+CTOOLBOX_API deque* deque_init(size_t elementSize, size_t initialCapacity);
+
+/// @brief initializes the deque with custom memory allocation functions
+CTOOLBOX_API deque* deque_init_memfuncs(size_t elementSize, size_t initialCapacity, const ctoolbox_memfuncs* memfuncs);
+
+/// @brief destroys the deque, but not the content itself
+CTOOLBOX_API void deque_destroy(deque* d);
+
+/// @brief pushes an element into the deque's back
+CTOOLBOX_API ctoolbox_result deque_push_back(deque* d, const void* element);
+
+/// @brief pushes an element into the deque's front
+CTOOLBOX_API ctoolbox_result deque_push_front(deque* d, const void* element);
+
+/// @brief pops the element at the deque's back, copying it into elementOut if not NULL
+CTOOLBOX_API ctoolbox_result deque_pop_back(deque* d, void* elementOut);
+
+/// @brief pops the element at the deque's front, copying it into elementOut if not NULL
+CTOOLBOX_API ctoolbox_result deque_pop_front(deque* d, void* elementOut);
+
+/// @brief pushes count elements into the deque's back, growing the storage at most once
+CTOOLBOX_API ctoolbox_result deque_push_back_n(deque* d, const void* elements, size_t count);
+
+/// @brief pops count elements from the deque's front in order, copying them into elementsOut if not NULL
+CTOOLBOX_API ctoolbox_result deque_pop_front_n(deque* d, void* elementsOut, size_t count);
+
+/// @brief returns the address of the element at the index counted from the front, NULL if out of bounds
+CTOOLBOX_API void* deque_peek(deque* d, size_t index);
+
+/// @brief returns the address of the element at the index counted from the front, NULL if out of bounds
+CTOOLBOX_API const void* deque_const_peek(const deque* d, size_t index);
+
+/// @brief copies the element at the index counted from the front into elementOut
+CTOOLBOX_API ctoolbox_result deque_get(const deque* d, size_t index, void* elementOut);
+
+/// @brief overwrites the element at the index counted from the front
+CTOOLBOX_API ctoolbox_result deque_set(deque* d, size_t index, const void* element);
+
+/// @brief grows the storage to hold at least newCapacity elements
+CTOOLBOX_API ctoolbox_result deque_reserve(deque* d, size_t newCapacity);
+
+/// @brief removes every element, keeping the storage
+CTOOLBOX_API void deque_clear(deque* d);
+
+/// @brief returns the number of elements
+CTOOLBOX_API size_t deque_size(const deque* d);
+
+/// @brief returns how many elements the storage holds
+CTOOLBOX_API size_t deque_capacity(const deque* d);
+
+/// @brief returns whether the deque holds no element
+CTOOLBOX_API bool deque_empty(const deque* d);
+
+/// @brief returns the memory the deque allocated, its header included
+CTOOLBOX_API ctoolbox_result deque_memory_usage(const deque* d, ctoolbox_memstats* statsOut);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DEQUE_INCLUDED
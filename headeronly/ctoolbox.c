@@ -1,3 +1,7 @@
+#if !defined(_WIN32) && !defined(_WIN64) && !defined(_POSIX_C_SOURCE)
+    #define _POSIX_C_SOURCE 200112L
+#endif
+
 #include "ctoolbox.h"
 #include <stdlib.h>
 #include <string.h>
@@ -6,320 +10,5068 @@
 // Context
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+
+#if defined(_WIN32) || defined(_WIN64)
+    #include <malloc.h>
+#endif
+
+// the plain callbacks are the c library ones, so the platform aligned allocator may be used instead
+static inline bool ctoolbox_is_libc(const ctoolbox_memfuncs* fun)
+{
+    return (!fun->malloc_fn || fun->malloc_fn == malloc) && (!fun->free_fn || fun->free_fn == free);
+}
+
 CTOOLBOX_API const ctoolbox_memfuncs CTOOLBOX_DEFAULT_MEMFUNCS =
 {
     .malloc_fn = malloc,
     .calloc_fn = calloc,
     .free_fn = free,
-    .realloc_fn = realloc
+    .realloc_fn = realloc,
+    .aligned_malloc_fn = NULL,
+    .aligned_free_fn = NULL,
+    .free_sized_fn = NULL,
+    .alloc_ctx_fn = NULL,
+    .realloc_ctx_fn = NULL,
+    .free_ctx_fn = NULL,
+    .user = NULL
 };
 
 CTOOLBOX_API void* ctoolbox_custom_malloc(const ctoolbox_memfuncs* fun, size_t size)
 {
+    if (fun->alloc_ctx_fn) return fun->alloc_ctx_fn(fun->user, size, CTOOLBOX_DEFAULT_ALIGNMENT);
     return fun->malloc_fn ? fun->malloc_fn(size) : malloc(size);
 }
 
 CTOOLBOX_API void* ctoolbox_custom_calloc(const ctoolbox_memfuncs* fun, size_t num, size_t size)
 {
+    if (fun->alloc_ctx_fn) {
+        if (size != 0 && num > SIZE_MAX / size) return NULL;
+
+        void* ptr = fun->alloc_ctx_fn(fun->user, num * size, CTOOLBOX_DEFAULT_ALIGNMENT);
+        if (ptr) memset(ptr, 0, num * size);
+        return ptr;
+    }
     return fun->calloc_fn ? fun->calloc_fn(num, size) : calloc(num, size);
 }
 
 CTOOLBOX_API void ctoolbox_custom_free(const ctoolbox_memfuncs* fun, void* ptr)
 {
+    ctoolbox_custom_free_sized(fun, ptr, 0);
+}
+
+CTOOLBOX_API void ctoolbox_custom_free_sized(const ctoolbox_memfuncs* fun, void* ptr, size_t size)
+{
+    // an allocator without a free callback (e.g. a bump allocator) releases everything at once on its own
+    if (fun->alloc_ctx_fn) {
+        if (ptr && fun->free_ctx_fn) fun->free_ctx_fn(fun->user, ptr, size);
+        return;
+    }
+
+    if (ptr && size && fun->free_sized_fn) {
+        fun->free_sized_fn(ptr, size);
+        return;
+    }
     fun->free_fn ? fun->free_fn(ptr) : free(ptr);
 }
 
 CTOOLBOX_API void* ctoolbox_custom_realloc(const ctoolbox_memfuncs* fun, void* ptr, size_t newSize)
 {
+    return ctoolbox_custom_realloc_sized(fun, ptr, 0, newSize);
+}
+
+CTOOLBOX_API void* ctoolbox_custom_realloc_sized(const ctoolbox_memfuncs* fun, void* ptr, size_t oldSize, size_t newSize)
+{
+    if (fun->alloc_ctx_fn) {
+        if (fun->realloc_ctx_fn) return fun->realloc_ctx_fn(fun->user, ptr, oldSize, newSize, CTOOLBOX_DEFAULT_ALIGNMENT);
+
+        // fallback: allocate, copy and free, which takes knowing how much to copy
+        if (ptr && oldSize == 0) return NULL;
+        void* newPtr = fun->alloc_ctx_fn(fun->user, newSize, CTOOLBOX_DEFAULT_ALIGNMENT);
+        if (!newPtr) return NULL;
+
+        if (ptr) {
+            memcpy(newPtr, ptr, oldSize < newSize ? oldSize : newSize);
+            if (fun->free_ctx_fn) fun->free_ctx_fn(fun->user, ptr, oldSize);
+        }
+        return newPtr;
+    }
     return fun->realloc_fn ? fun->realloc_fn(ptr, newSize) : realloc(ptr, newSize);
 }
 
+CTOOLBOX_API void* ctoolbox_custom_aligned_malloc(const ctoolbox_memfuncs* fun, size_t size, size_t alignment)
+{
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0) return NULL;
+    if (fun->alloc_ctx_fn) return fun->alloc_ctx_fn(fun->user, size, alignment);
+    if (alignment <= CTOOLBOX_DEFAULT_ALIGNMENT) return ctoolbox_custom_malloc(fun, size);
+    if (fun->aligned_malloc_fn && fun->aligned_free_fn) return fun->aligned_malloc_fn(size, alignment);
+
+    if (ctoolbox_is_libc(fun)) {
+#if defined(_WIN32) || defined(_WIN64)
+        return _aligned_malloc(size, alignment);
+#else
+        void* ptr = NULL;
+        return posix_memalign(&ptr, alignment, size) == 0 ? ptr : NULL;
+#endif
+    }
+
+    // fallback: over-allocate and keep the original pointer right before the aligned block
+    if (size > SIZE_MAX - alignment - sizeof(void*)) return NULL;
+
+    void* raw = ctoolbox_custom_malloc(fun, size + alignment + sizeof(void*));
+    if (!raw) return NULL;
+
+    uintptr_t aligned = ((uintptr_t)raw + sizeof(void*) + (alignment - 1)) & ~(uintptr_t)(alignment - 1);
+    ((void**)aligned)[-1] = raw;
+    return (void*)aligned;
+}
+
+CTOOLBOX_API void ctoolbox_custom_aligned_free(const ctoolbox_memfuncs* fun, void* ptr, size_t alignment)
+{
+    ctoolbox_custom_aligned_free_sized(fun, ptr, 0, alignment);
+}
+
+CTOOLBOX_API void ctoolbox_custom_aligned_free_sized(const ctoolbox_memfuncs* fun, void* ptr, size_t size, size_t alignment)
+{
+    if (!ptr) return;
+    if (fun->alloc_ctx_fn || alignment <= CTOOLBOX_DEFAULT_ALIGNMENT) {
+        ctoolbox_custom_free_sized(fun, ptr, size);
+        return;
+    }
+
+    if (fun->aligned_malloc_fn && fun->aligned_free_fn) {
+        fun->aligned_free_fn(ptr);
+        return;
+    }
+
+    if (ctoolbox_is_libc(fun)) {
+#if defined(_WIN32) || defined(_WIN64)
+        _aligned_free(ptr);
+#else
+        free(ptr);
+#endif
+        return;
+    }
+
+    ctoolbox_custom_free_sized(fun, ((void**)ptr)[-1], size ? size + alignment + sizeof(void*) : 0);
+}
+
+CTOOLBOX_API void* ctoolbox_custom_aligned_realloc(const ctoolbox_memfuncs* fun, void* ptr, size_t oldSize, size_t newSize, size_t alignment)
+{
+    if (fun->realloc_ctx_fn) return fun->realloc_ctx_fn(fun->user, ptr, oldSize, newSize, alignment);
+    if (alignment <= CTOOLBOX_DEFAULT_ALIGNMENT && (fun->realloc_fn || fun->alloc_ctx_fn)) {
+        return ctoolbox_custom_realloc_sized(fun, ptr, oldSize, newSize);
+    }
+
+    // fallback: allocate, copy and free
+    void* newPtr = ctoolbox_custom_aligned_malloc(fun, newSize, alignment);
+    if (!newPtr) return NULL;
+
+    if (ptr) {
+        memcpy(newPtr, ptr, oldSize < newSize ? oldSize : newSize);
+        ctoolbox_custom_aligned_free_sized(fun, ptr, oldSize, alignment);
+    }
+    return newPtr;
+}
+
+CTOOLBOX_API void ctoolbox_memstats_on_alloc(ctoolbox_memstats* stats, size_t bytes)
+{
+    stats->liveBytes += bytes;
+    stats->allocCount++;
+    if (stats->liveBytes > stats->peakBytes) stats->peakBytes = stats->liveBytes;
+}
+
+CTOOLBOX_API void ctoolbox_memstats_on_realloc(ctoolbox_memstats* stats, size_t oldBytes, size_t newBytes)
+{
+    stats->liveBytes = stats->liveBytes - oldBytes + newBytes;
+    stats->reallocCount++;
+    if (stats->liveBytes > stats->peakBytes) stats->peakBytes = stats->liveBytes;
+}
+
+CTOOLBOX_API void ctoolbox_memstats_on_free(ctoolbox_memstats* stats, size_t bytes)
+{
+    stats->liveBytes -= bytes;
+    stats->freeCount++;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// tracker
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// every tracked block is preceded by a header of max(alignment, 16) bytes ending with its alignment and size
+static inline size_t ctoolbox_tracker_header(size_t alignment)
+{
+    return alignment > 2 * sizeof(size_t) ? alignment : 2 * sizeof(size_t);
+}
+
+static void* ctoolbox_tracker_alloc(void* user, size_t size, size_t alignment)
+{
+    ctoolbox_tracker* tracker = (ctoolbox_tracker*)user;
+    size_t header = ctoolbox_tracker_header(alignment);
+    if (size > SIZE_MAX - header) return NULL;
+
+    char* raw = ctoolbox_custom_aligned_malloc(&tracker->inner, header + size, alignment);
+    if (!raw) return NULL;
+
+    size_t* info = (size_t*)(raw + header) - 2;
+    info[0] = alignment;
+    info[1] = size;
+
+    ctoolbox_memstats_on_alloc(&tracker->stats, size);
+    return raw + header;
+}
+
+static void* ctoolbox_tracker_realloc(void* user, void* ptr, size_t oldSize, size_t newSize, size_t alignment)
+{
+    (void)oldSize;
+    if (!ptr) return ctoolbox_tracker_alloc(user, newSize, alignment);
+
+    ctoolbox_tracker* tracker = (ctoolbox_tracker*)user;
+    size_t* info = (size_t*)ptr - 2;
+    size_t blockAlignment = info[0];
+    size_t blockSize = info[1];
+    size_t header = ctoolbox_tracker_header(blockAlignment);
+    if (newSize > SIZE_MAX - header) return NULL;
+
+    char* raw = ctoolbox_custom_aligned_realloc(&tracker->inner, (char*)ptr - header, header + blockSize, header + newSize, blockAlignment);
+    if (!raw) return NULL;
+
+    info = (size_t*)(raw + header) - 2;
+    info[1] = newSize;
+
+    ctoolbox_memstats_on_realloc(&tracker->stats, blockSize, newSize);
+    return raw + header;
+}
+
+static void ctoolbox_tracker_free(void* user, void* ptr, size_t size)
+{
+    (void)size;
+    ctoolbox_tracker* tracker = (ctoolbox_tracker*)user;
+    size_t* info = (size_t*)ptr - 2;
+    size_t header = ctoolbox_tracker_header(info[0]);
+
+    ctoolbox_memstats_on_free(&tracker->stats, info[1]);
+    ctoolbox_custom_aligned_free_sized(&tracker->inner, (char*)ptr - header, header + info[1], info[0]);
+}
+
+CTOOLBOX_API void ctoolbox_tracker_init(ctoolbox_tracker* tracker, const ctoolbox_memfuncs* inner)
+{
+    if (!tracker) return;
+
+    memset(tracker, 0, sizeof(ctoolbox_tracker));
+    tracker->inner = inner ? *inner : CTOOLBOX_DEFAULT_MEMFUNCS;
+}
+
+CTOOLBOX_API ctoolbox_memfuncs ctoolbox_tracker_memfuncs(ctoolbox_tracker* tracker)
+{
+    ctoolbox_memfuncs memfuncs = { 0 };
+    memfuncs.alloc_ctx_fn = ctoolbox_tracker_alloc;
+    memfuncs.realloc_ctx_fn = ctoolbox_tracker_realloc;
+    memfuncs.free_ctx_fn = ctoolbox_tracker_free;
+    memfuncs.user = tracker;
+    return memfuncs;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-// Dynamic Array
+// Threading
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+/// @brief internal threading primitives for the modules that need them, not part of the public interface
+#if defined(_WIN32) || defined(_WIN64)
+    #include <windows.h>
+    typedef SRWLOCK cthread_mutex;
+    typedef CONDITION_VARIABLE cthread_cond;
+    typedef DWORD cthread_key;
+    #define CTHREAD_LOCAL __declspec(thread)
+    #define CTHREAD_MUTEX_INITIALIZER SRWLOCK_INIT
+    #define CTHREAD_CALLBACK NTAPI
+#else
+    #include <pthread.h>
+    #include <sched.h>
+    #include <unistd.h>
+    typedef pthread_mutex_t cthread_mutex;
+    typedef pthread_cond_t cthread_cond;
+    typedef pthread_key_t cthread_key;
+    #define CTHREAD_LOCAL _Thread_local
+    #define CTHREAD_MUTEX_INITIALIZER PTHREAD_MUTEX_INITIALIZER
+    #define CTHREAD_CALLBACK
+#endif
+
+/// @brief level 2 cache size assumed when it can't be queried
+#ifndef CTHREAD_DEFAULT_CACHE_SIZE
+    #define CTHREAD_DEFAULT_CACHE_SIZE (256 * 1024)
+#endif
+
+/// @brief function run by a thread
+typedef void (*cthread_func)(void* arg);
+
+/// @brief function run by an exiting thread on its value of a key
+typedef void (CTHREAD_CALLBACK *cthread_key_destructor)(void* value);
+
+/// @brief a running thread, must stay alive until joined since the thread reads func and arg from it
+typedef struct cthread_thread
+{
+#if defined(_WIN32) || defined(_WIN64)
+    HANDLE handle;
+#else
+    pthread_t handle;
+#endif
+    cthread_func func;
+    void* arg;
+} cthread_thread;
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-// internal
+// functions
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-struct darray
+/// @brief initializes the mutex
+void cthread_mutex_init(cthread_mutex* mutex);
+
+/// @brief releases the mutex resources
+void cthread_mutex_destroy(cthread_mutex* mutex);
+
+/// @brief locks the mutex, blocking until it is available
+void cthread_mutex_lock(cthread_mutex* mutex);
+
+/// @brief unlocks the mutex
+void cthread_mutex_unlock(cthread_mutex* mutex);
+
+/// @brief initializes the condition variable
+void cthread_cond_init(cthread_cond* cond);
+
+/// @brief releases the condition variable resources
+void cthread_cond_destroy(cthread_cond* cond);
+
+/// @brief atomically unlocks the mutex and waits for a signal, locking it again before returning, may wake up spuriously
+void cthread_cond_wait(cthread_cond* cond, cthread_mutex* mutex);
+
+/// @brief wakes up one waiting thread
+void cthread_cond_signal(cthread_cond* cond);
+
+/// @brief wakes up every waiting thread
+void cthread_cond_broadcast(cthread_cond* cond);
+
+/// @brief starts a thread running func(arg), returns false if it couldn't be created
+bool cthread_create(cthread_thread* thread, cthread_func func, void* arg);
+
+/// @brief waits for the thread to finish
+void cthread_join(cthread_thread* thread);
+
+/// @brief gives the rest of the time slice to other threads
+void cthread_yield(void);
+
+/// @brief creates a thread-local key, destructor runs on every exiting thread whose value isn't NULL, returns false if none is left
+bool cthread_key_create(cthread_key* key, cthread_key_destructor destructor);
+
+/// @brief sets the calling thread's value of the key
+void cthread_key_set(cthread_key key, void* value);
+
+/// @brief returns the number of logical processors, at least 1
+size_t cthread_hardware_concurrency(void);
+
+/// @brief bytes of level 2 cache of a core, CTHREAD_DEFAULT_CACHE_SIZE when the platform doesn't tell
+size_t cthread_cache_size(void);
+
+/// @brief atomically increments the value, returning the incremented value
+uint64_t cthread_atomic_increment(volatile uint64_t* value);
+
+/// @brief atomically adds amount to the value, returning the previous value
+uint64_t cthread_atomic_fetch_add(volatile uint64_t* value, uint64_t amount);
+
+/// @brief atomically ors bits into the value, returning the previous value
+uint64_t cthread_atomic_fetch_or(volatile uint64_t* value, uint64_t bits);
+
+/// @brief atomically replaces the value with desired if it still equals *expected, otherwise loads it into *expected
+bool cthread_atomic_compare_exchange(volatile uint64_t* value, uint64_t* expected, uint64_t desired);
+
+/// @brief reads the value, later reads can't be reordered before it
+uint64_t cthread_atomic_load(const volatile uint64_t* value);
+
+/// @brief writes the value, earlier writes can't be reordered after it
+void cthread_atomic_store(volatile uint64_t* value, uint64_t desired);
+
+/// @brief reads the pointer, later reads can't be reordered before it
+void* cthread_atomic_load_ptr(void* const volatile* ptr);
+
+/// @brief writes the pointer, earlier writes can't be reordered after it
+void cthread_atomic_store_ptr(void* volatile* ptr, void* desired);
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// mutex
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void cthread_mutex_init(cthread_mutex* mutex)
 {
-	void* data;
-    size_t size;
-    size_t capacity;
-    size_t elementSize;
-    ctoolbox_memfuncs memfuncs;
-};  
+#if defined(_WIN32) || defined(_WIN64)
+    InitializeSRWLock(mutex);
+#else
+    pthread_mutex_init(mutex, NULL);
+#endif
+}
+
+void cthread_mutex_destroy(cthread_mutex* mutex)
+{
+#if defined(_WIN32) || defined(_WIN64)
+    (void)mutex; // slim locks hold no resources
+#else
+    pthread_mutex_destroy(mutex);
+#endif
+}
+
+void cthread_mutex_lock(cthread_mutex* mutex)
+{
+#if defined(_WIN32) || defined(_WIN64)
+    AcquireSRWLockExclusive(mutex);
+#else
+    pthread_mutex_lock(mutex);
+#endif
+}
+
+void cthread_mutex_unlock(cthread_mutex* mutex)
+{
+#if defined(_WIN32) || defined(_WIN64)
+    ReleaseSRWLockExclusive(mutex);
+#else
+    pthread_mutex_unlock(mutex);
+#endif
+}
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-// external
+// condition variables
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-CTOOLBOX_API darray* darray_init(size_t elementSize, size_t initialCapacity)
+void cthread_cond_init(cthread_cond* cond)
 {
-    return darray_init_memfuncs(elementSize, initialCapacity, &CTOOLBOX_DEFAULT_MEMFUNCS);
+#if defined(_WIN32) || defined(_WIN64)
+    InitializeConditionVariable(cond);
+#else
+    pthread_cond_init(cond, NULL);
+#endif
 }
 
-CTOOLBOX_API darray* darray_init_memfuncs(size_t elementSize, size_t initialCapacity, const ctoolbox_memfuncs* memfuncs)
+void cthread_cond_destroy(cthread_cond* cond)
 {
-    if (elementSize == 0) return NULL;
+#if defined(_WIN32) || defined(_WIN64)
+    (void)cond; // condition variables hold no resources
+#else
+    pthread_cond_destroy(cond);
+#endif
+}
 
-    darray* outArray = ctoolbox_custom_malloc(memfuncs ? memfuncs : &CTOOLBOX_DEFAULT_MEMFUNCS, sizeof(darray));
-    if (!outArray) return NULL;
+void cthread_cond_wait(cthread_cond* cond, cthread_mutex* mutex)
+{
+#if defined(_WIN32) || defined(_WIN64)
+    SleepConditionVariableSRW(cond, mutex, INFINITE, 0);
+#else
+    pthread_cond_wait(cond, mutex);
+#endif
+}
 
-    memset(outArray, 0, sizeof(darray));
-    outArray->size = 0;
-    outArray->elementSize = elementSize;
-    outArray->capacity = initialCapacity > 0 ? initialCapacity : 1;
+void cthread_cond_signal(cthread_cond* cond)
+{
+#if defined(_WIN32) || defined(_WIN64)
+    WakeConditionVariable(cond);
+#else
+    pthread_cond_signal(cond);
+#endif
+}
 
-    if (memfuncs) outArray->memfuncs = *memfuncs;
-    else outArray->memfuncs = CTOOLBOX_DEFAULT_MEMFUNCS;
+void cthread_cond_broadcast(cthread_cond* cond)
+{
+#if defined(_WIN32) || defined(_WIN64)
+    WakeAllConditionVariable(cond);
+#else
+    pthread_cond_broadcast(cond);
+#endif
+}
 
-    outArray->data = ctoolbox_custom_calloc(&outArray->memfuncs, outArray->capacity, elementSize);
-    if (!outArray->data) return NULL;
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// threads
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-    return outArray;
+#if defined(_WIN32) || defined(_WIN64)
+static DWORD WINAPI cthread_entry(LPVOID arg)
+{
+    cthread_thread* thread = (cthread_thread*)arg;
+    thread->func(thread->arg);
+    return 0;
+}
+#else
+static void* cthread_entry(void* arg)
+{
+    cthread_thread* thread = (cthread_thread*)arg;
+    thread->func(thread->arg);
+    return NULL;
 }
+#endif
 
-CTOOLBOX_API void darray_destroy(darray* array)
+bool cthread_create(cthread_thread* thread, cthread_func func, void* arg)
 {
-    if(!array) return;
-    ctoolbox_custom_free(&array->memfuncs, array->data);
-    ctoolbox_custom_free(&array->memfuncs, array);
+    thread->func = func;
+    thread->arg = arg;
+
+#if defined(_WIN32) || defined(_WIN64)
+    thread->handle = CreateThread(NULL, 0, cthread_entry, thread, 0, NULL);
+    return thread->handle != NULL;
+#else
+    return pthread_create(&thread->handle, NULL, cthread_entry, thread) == 0;
+#endif
 }
 
-CTOOLBOX_API ctoolbox_result darray_push_back(darray* array, const void* element)
+void cthread_join(cthread_thread* thread)
 {
-    if (!array) return CTOOLBOX_ERROR_INVALID_PARAM;
+#if defined(_WIN32) || defined(_WIN64)
+    WaitForSingleObject(thread->handle, INFINITE);
+    CloseHandle(thread->handle);
+#else
+    pthread_join(thread->handle, NULL);
+#endif
+}
 
-    // ensure capacity
-    if (array->size >= array->capacity) {
-        ctoolbox_result res = darray_reserve(array, array->capacity * 2);
-        if (res != CTOOLBOX_SUCCESS) return res;
+void cthread_yield(void)
+{
+#if defined(_WIN32) || defined(_WIN64)
+    SwitchToThread();
+#else
+    sched_yield();
+#endif
+}
+
+bool cthread_key_create(cthread_key* key, cthread_key_destructor destructor)
+{
+#if defined(_WIN32) || defined(_WIN64)
+    // fiber local storage, unlike TlsAlloc, calls back on thread exit
+    *key = FlsAlloc(destructor);
+    return *key != FLS_OUT_OF_INDEXES;
+#else
+    return pthread_key_create(key, destructor) == 0;
+#endif
+}
+
+void cthread_key_set(cthread_key key, void* value)
+{
+#if defined(_WIN32) || defined(_WIN64)
+    FlsSetValue(key, value);
+#else
+    pthread_setspecific(key, value);
+#endif
+}
+
+size_t cthread_hardware_concurrency(void)
+{
+#if defined(_WIN32) || defined(_WIN64)
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? (size_t)info.dwNumberOfProcessors : 1;
+#elif defined(_SC_NPROCESSORS_ONLN)
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (size_t)count : 1;
+#else
+    return 1;
+#endif
+}
+
+size_t cthread_cache_size(void)
+{
+    size_t bytes = 0;
+#if defined(_WIN32) || defined(_WIN64)
+    SYSTEM_LOGICAL_PROCESSOR_INFORMATION info[256];
+    DWORD length = sizeof(info);
+    if (GetLogicalProcessorInformation(info, &length)) {
+        for (DWORD i = 0; i < length / sizeof(info[0]); i++) {
+            if (info[i].Relationship == RelationCache && info[i].Cache.Level == 2) bytes = info[i].Cache.Size;
+        }
     }
+#elif defined(_SC_LEVEL2_CACHE_SIZE)
+    long size = sysconf(_SC_LEVEL2_CACHE_SIZE);
+    if (size > 0) bytes = (size_t)size;
+#endif
+    return bytes ? bytes : CTHREAD_DEFAULT_CACHE_SIZE;
+}
 
-    // add new element
-    memcpy((char*)array->data + (array->size * array->elementSize), element, array->elementSize);
-    array->size++;
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// atomics
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-    return CTOOLBOX_SUCCESS;
+uint64_t cthread_atomic_increment(volatile uint64_t* value)
+{
+#if defined(_MSC_VER)
+    return (uint64_t)InterlockedIncrement64((volatile LONG64*)value);
+#else
+    return __atomic_add_fetch(value, 1, __ATOMIC_SEQ_CST);
+#endif
 }
 
-CTOOLBOX_API ctoolbox_result darray_pop_back(darray* array, void* elementOut)
+uint64_t cthread_atomic_fetch_add(volatile uint64_t* value, uint64_t amount)
 {
-    if (!array || array->size == 0) return CTOOLBOX_ERROR_EMPTY;
-    if (elementOut) memcpy(elementOut, (char*)array->data + ((array->size - 1) * array->elementSize), array->elementSize);
+#if defined(_MSC_VER)
+    return (uint64_t)InterlockedExchangeAdd64((volatile LONG64*)value, (LONG64)amount);
+#else
+    return __atomic_fetch_add(value, amount, __ATOMIC_SEQ_CST);
+#endif
+}
 
-    array->size--;
-    return CTOOLBOX_SUCCESS;
+uint64_t cthread_atomic_fetch_or(volatile uint64_t* value, uint64_t bits)
+{
+#if defined(_MSC_VER)
+    return (uint64_t)InterlockedOr64((volatile LONG64*)value, (LONG64)bits);
+#else
+    return __atomic_fetch_or(value, bits, __ATOMIC_SEQ_CST);
+#endif
+}
+
+bool cthread_atomic_compare_exchange(volatile uint64_t* value, uint64_t* expected, uint64_t desired)
+{
+#if defined(_MSC_VER)
+    uint64_t previous = (uint64_t)InterlockedCompareExchange64((volatile LONG64*)value, (LONG64)desired, (LONG64)*expected);
+    if (previous == *expected) return true;
+    *expected = previous;
+    return false;
+#else
+    return __atomic_compare_exchange_n(value, expected, desired, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+#endif
+}
+
+uint64_t cthread_atomic_load(const volatile uint64_t* value)
+{
+#if defined(_MSC_VER)
+    // or-ing 0 leaves the value as it is, the interlocked call only provides the barrier
+    return (uint64_t)InterlockedOr64((volatile LONG64*)value, 0);
+#else
+    return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+#endif
+}
+
+void cthread_atomic_store(volatile uint64_t* value, uint64_t desired)
+{
+#if defined(_MSC_VER)
+    InterlockedExchange64((volatile LONG64*)value, (LONG64)desired);
+#else
+    __atomic_store_n(value, desired, __ATOMIC_RELEASE);
+#endif
+}
+
+void* cthread_atomic_load_ptr(void* const volatile* ptr)
+{
+#if defined(_MSC_VER)
+    // exchanging NULL for NULL leaves the pointer as it is, the interlocked call only provides the barrier
+    return InterlockedCompareExchangePointer((void* volatile*)ptr, NULL, NULL);
+#else
+    return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+#endif
+}
+
+void cthread_atomic_store_ptr(void* volatile* ptr, void* desired)
+{
+#if defined(_MSC_VER)
+    InterlockedExchangePointer(ptr, desired);
+#else
+    __atomic_store_n(ptr, desired, __ATOMIC_RELEASE);
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// SIMD
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// @brief internal vectorised kernels for the containers, SSE2/AVX2 picked at runtime on x86 with a scalar fallback elsewhere
+#if defined(__x86_64__) || defined(_M_X64) || (defined(__i386__) && defined(__SSE2__))
+    #include <immintrin.h>
+    #define CSIMD_X86 1
+    #if defined(_MSC_VER) && !defined(__clang__)
+        #include <intrin.h>
+        #define CSIMD_TARGET_AVX2
+    #else
+        #define CSIMD_TARGET_AVX2 __attribute__((target("avx2")))
+    #endif
+#endif
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// functions
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// @brief returns the index of the first of count elements equal to value byte for byte, or count if there is none
+size_t csimd_find(const void* data, size_t count, size_t elementSize, const void* value);
+
+/// @brief returns how many of count elements are equal to value byte for byte
+size_t csimd_count(const void* data, size_t count, size_t elementSize, const void* value);
+
+/// @brief copies value into each of the count elements
+void csimd_fill(void* data, size_t count, size_t elementSize, const void* value);
+
+/// @brief returns whether both buffers hold the same bytes
+bool csimd_equal(const void* a, const void* b, size_t bytes);
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// internal
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// element sizes the vector kernels handle, they evenly divide a vector so no element straddles two
+static inline bool csimd_vector_size(size_t elementSize)
+{
+    return elementSize == 1 || elementSize == 2 || elementSize == 4 || elementSize == 8;
+}
+
+static size_t csimd_find_scalar(const char* data, size_t count, size_t elementSize, const void* value)
+{
+    for (size_t i = 0; i < count; i++) {
+        if (memcmp(data + i * elementSize, value, elementSize) == 0) return i;
+    }
+    return count;
+}
+
+static size_t csimd_count_scalar(const char* data, size_t count, size_t elementSize, const void* value)
+{
+    size_t matches = 0;
+    for (size_t i = 0; i < count; i++) {
+        matches += memcmp(data + i * elementSize, value, elementSize) == 0;
+    }
+    return matches;
+}
+
+#if defined(CSIMD_X86)
+static inline uint32_t csimd_popcount(uint32_t value)
+{
+    value = value - ((value >> 1) & 0x55555555u);
+    value = (value & 0x33333333u) + ((value >> 2) & 0x33333333u);
+    return (((value + (value >> 4)) & 0x0f0f0f0fu) * 0x01010101u) >> 24;
 }
 
-CTOOLBOX_API const void* darray_const_peek(const darray* array, size_t index)
+static inline uint32_t csimd_ctz(uint32_t value)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index;
+    _BitScanForward(&index, value);
+    return (uint32_t)index;
+#else
+    return (uint32_t)__builtin_ctz(value);
+#endif
+}
+
+// reduces a byte equality mask to one bit per fully equal element, set on the element's first byte
+static inline uint32_t csimd_element_mask(uint32_t mask, size_t elementSize)
+{
+    switch (elementSize)
+    {
+        case 2: mask &= mask >> 1; return mask & 0x55555555u;
+        case 4: mask &= mask >> 1; mask &= mask >> 2; return mask & 0x11111111u;
+        case 8: mask &= mask >> 1; mask &= mask >> 2; mask &= mask >> 4; return mask & 0x01010101u;
+        default: return mask;
+    }
+}
+
+// value repeated across a whole vector
+static inline void csimd_pattern(unsigned char* pattern, size_t patternSize, size_t elementSize, const void* value)
+{
+    for (size_t i = 0; i < patternSize; i += elementSize) memcpy(pattern + i, value, elementSize);
+}
+
+static bool csimd_has_avx2(void)
+{
+    static volatile int supported = -1;
+    if (supported >= 0) return supported != 0;
+
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    bool avx2 = false;
+    if (info[0] >= 7) {
+        __cpuid(info, 1);
+        bool osxsave = (info[2] & (1 << 27)) != 0;
+        __cpuidex(info, 7, 0);
+        avx2 = osxsave && (info[1] & (1 << 5)) != 0 && (_xgetbv(0) & 6) == 6;
+    }
+    supported = avx2;
+#else
+    __builtin_cpu_init();
+    supported = __builtin_cpu_supports("avx2") != 0;
+#endif
+    return supported != 0;
+}
+
+static size_t csimd_find_sse2(const char* data, size_t count, size_t elementSize, const void* value)
+{
+    unsigned char pattern[16];
+    csimd_pattern(pattern, sizeof(pattern), elementSize, value);
+    const __m128i needle = _mm_loadu_si128((const __m128i*)pattern);
+
+    size_t bytes = count * elementSize;
+    size_t i = 0;
+    for (; i + 16 <= bytes; i += 16) {
+        __m128i block = _mm_loadu_si128((const __m128i*)(data + i));
+        uint32_t mask = csimd_element_mask((uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(block, needle)), elementSize);
+        if (mask) return (i + csimd_ctz(mask)) / elementSize;
+    }
+    return i / elementSize + csimd_find_scalar(data + i, count - i / elementSize, elementSize, value);
+}
+
+static size_t csimd_count_sse2(const char* data, size_t count, size_t elementSize, const void* value)
+{
+    unsigned char pattern[16];
+    csimd_pattern(pattern, sizeof(pattern), elementSize, value);
+    const __m128i needle = _mm_loadu_si128((const __m128i*)pattern);
+
+    size_t bytes = count * elementSize;
+    size_t matches = 0;
+    size_t i = 0;
+    for (; i + 16 <= bytes; i += 16) {
+        __m128i block = _mm_loadu_si128((const __m128i*)(data + i));
+        matches += csimd_popcount(csimd_element_mask((uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(block, needle)), elementSize));
+    }
+    return matches + csimd_count_scalar(data + i, count - i / elementSize, elementSize, value);
+}
+
+static void csimd_fill_sse2(char* data, size_t count, size_t elementSize, const void* value)
+{
+    unsigned char pattern[16];
+    csimd_pattern(pattern, sizeof(pattern), elementSize, value);
+    const __m128i fill = _mm_loadu_si128((const __m128i*)pattern);
+
+    size_t bytes = count * elementSize;
+    size_t i = 0;
+    for (; i + 16 <= bytes; i += 16) _mm_storeu_si128((__m128i*)(data + i), fill);
+    memcpy(data + i, pattern, bytes - i);
+}
+
+static bool csimd_equal_sse2(const char* a, const char* b, size_t bytes)
+{
+    size_t i = 0;
+    for (; i + 16 <= bytes; i += 16) {
+        __m128i left = _mm_loadu_si128((const __m128i*)(a + i));
+        __m128i right = _mm_loadu_si128((const __m128i*)(b + i));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(left, right)) != 0xffff) return false;
+    }
+    return memcmp(a + i, b + i, bytes - i) == 0;
+}
+
+CSIMD_TARGET_AVX2 static size_t csimd_find_avx2(const char* data, size_t count, size_t elementSize, const void* value)
+{
+    unsigned char pattern[32];
+    csimd_pattern(pattern, sizeof(pattern), elementSize, value);
+    const __m256i needle = _mm256_loadu_si256((const __m256i*)pattern);
+
+    size_t bytes = count * elementSize;
+    size_t i = 0;
+    for (; i + 32 <= bytes; i += 32) {
+        __m256i block = _mm256_loadu_si256((const __m256i*)(data + i));
+        uint32_t mask = csimd_element_mask((uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, needle)), elementSize);
+        if (mask) return (i + csimd_ctz(mask)) / elementSize;
+    }
+    return i / elementSize + csimd_find_sse2(data + i, count - i / elementSize, elementSize, value);
+}
+
+CSIMD_TARGET_AVX2 static size_t csimd_count_avx2(const char* data, size_t count, size_t elementSize, const void* value)
+{
+    unsigned char pattern[32];
+    csimd_pattern(pattern, sizeof(pattern), elementSize, value);
+    const __m256i needle = _mm256_loadu_si256((const __m256i*)pattern);
+
+    size_t bytes = count * elementSize;
+    size_t matches = 0;
+    size_t i = 0;
+    for (; i + 32 <= bytes; i += 32) {
+        __m256i block = _mm256_loadu_si256((const __m256i*)(data + i));
+        matches += csimd_popcount(csimd_element_mask((uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, needle)), elementSize));
+    }
+    return matches + csimd_count_sse2(data + i, count - i / elementSize, elementSize, value);
+}
+
+CSIMD_TARGET_AVX2 static void csimd_fill_avx2(char* data, size_t count, size_t elementSize, const void* value)
+{
+    unsigned char pattern[32];
+    csimd_pattern(pattern, sizeof(pattern), elementSize, value);
+    const __m256i fill = _mm256_loadu_si256((const __m256i*)pattern);
+
+    size_t bytes = count * elementSize;
+    size_t i = 0;
+    for (; i + 32 <= bytes; i += 32) _mm256_storeu_si256((__m256i*)(data + i), fill);
+    memcpy(data + i, pattern, bytes - i);
+}
+
+CSIMD_TARGET_AVX2 static bool csimd_equal_avx2(const char* a, const char* b, size_t bytes)
+{
+    size_t i = 0;
+    for (; i + 32 <= bytes; i += 32) {
+        __m256i left = _mm256_loadu_si256((const __m256i*)(a + i));
+        __m256i right = _mm256_loadu_si256((const __m256i*)(b + i));
+        if ((uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(left, right)) != 0xffffffffu) return false;
+    }
+    return csimd_equal_sse2(a + i, b + i, bytes - i);
+}
+#endif
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// external
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+size_t csimd_find(const void* data, size_t count, size_t elementSize, const void* value)
+{
+#if defined(CSIMD_X86)
+    if (csimd_vector_size(elementSize)) {
+        if (csimd_has_avx2()) return csimd_find_avx2((const char*)data, count, elementSize, value);
+        return csimd_find_sse2((const char*)data, count, elementSize, value);
+    }
+#endif
+    return csimd_find_scalar((const char*)data, count, elementSize, value);
+}
+
+size_t csimd_count(const void* data, size_t count, size_t elementSize, const void* value)
+{
+#if defined(CSIMD_X86)
+    if (csimd_vector_size(elementSize)) {
+        if (csimd_has_avx2()) return csimd_count_avx2((const char*)data, count, elementSize, value);
+        return csimd_count_sse2((const char*)data, count, elementSize, value);
+    }
+#endif
+    return csimd_count_scalar((const char*)data, count, elementSize, value);
+}
+
+void csimd_fill(void* data, size_t count, size_t elementSize, const void* value)
+{
+    if (count == 0) return;
+
+#if defined(CSIMD_X86)
+    if (csimd_vector_size(elementSize)) {
+        if (csimd_has_avx2()) csimd_fill_avx2((char*)data, count, elementSize, value);
+        else csimd_fill_sse2((char*)data, count, elementSize, value);
+        return;
+    }
+#endif
+
+    // other sizes double the filled prefix on each copy
+    char* bytes = (char*)data;
+    size_t total = count * elementSize;
+    size_t filled = elementSize;
+    memcpy(bytes, value, elementSize);
+    while (filled < total) {
+        size_t chunk = filled < total - filled ? filled : total - filled;
+        memcpy(bytes + filled, bytes, chunk);
+        filled += chunk;
+    }
+}
+
+bool csimd_equal(const void* a, const void* b, size_t bytes)
+{
+#if defined(CSIMD_X86)
+    if (csimd_has_avx2()) return csimd_equal_avx2((const char*)a, (const char*)b, bytes);
+    return csimd_equal_sse2((const char*)a, (const char*)b, bytes);
+#else
+    return memcmp(a, b, bytes) == 0;
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Arena Allocator
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// internal
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+typedef struct arena_chunk
+{
+    struct arena_chunk* prev;
+    size_t capacity;
+    size_t offset;
+    size_t padding; // keeps the data that follows the header aligned to 16 bytes
+} arena_chunk;
+
+struct arena
+{
+    arena_chunk* first;
+    arena_chunk* current;
+    size_t chunkSize;
+    size_t reserved;
+    ctoolbox_memfuncs memfuncs;
+};
+
+static inline char* arena_chunk_data(arena_chunk* chunk)
+{
+    return (char*)(chunk + 1);
+}
+
+static arena_chunk* arena_chunk_create(arena* a, size_t capacity)
+{
+    arena_chunk* chunk = ctoolbox_custom_malloc(&a->memfuncs, sizeof(arena_chunk) + capacity);
+    if (!chunk) return NULL;
+
+    chunk->prev = a->current;
+    chunk->capacity = capacity;
+    chunk->offset = 0;
+    chunk->padding = 0;
+
+    a->current = chunk;
+    a->reserved += capacity;
+    return chunk;
+}
+
+// returns where an allocation would start inside the chunk, or SIZE_MAX if it doesn't fit
+static inline size_t arena_chunk_fit(arena_chunk* chunk, size_t size, size_t alignment)
+{
+    uintptr_t base = (uintptr_t)arena_chunk_data(chunk);
+    uintptr_t start = (base + chunk->offset + (alignment - 1)) & ~(uintptr_t)(alignment - 1);
+    size_t offset = (size_t)(start - base);
+
+    if (offset > chunk->capacity || size > chunk->capacity - offset) return SIZE_MAX;
+    return offset;
+}
+
+static void* arena_ctx_alloc(void* user, size_t size, size_t alignment)
+{
+    return arena_alloc((arena*)user, size, alignment);
+}
+
+static void* arena_ctx_realloc(void* user, void* ptr, size_t oldSize, size_t newSize, size_t alignment)
+{
+    // without the old size there is no telling how much to copy
+    if (ptr && oldSize == 0) return NULL;
+
+    arena* a = (arena*)user;
+    arena_chunk* chunk = a->current;
+
+    // the last block handed out can grow or shrink in place
+    if (ptr && (char*)ptr + oldSize == arena_chunk_data(chunk) + chunk->offset) {
+        size_t start = (size_t)((char*)ptr - arena_chunk_data(chunk));
+        if (newSize <= chunk->capacity - start) {
+            chunk->offset = start + newSize;
+            return ptr;
+        }
+    }
+
+    void* newPtr = arena_alloc(a, newSize, alignment);
+    if (newPtr && ptr) memcpy(newPtr, ptr, oldSize < newSize ? oldSize : newSize);
+    return newPtr;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// external
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+CTOOLBOX_API arena* arena_init(size_t chunkSize)
+{
+    return arena_init_memfuncs(chunkSize, &CTOOLBOX_DEFAULT_MEMFUNCS);
+}
+
+CTOOLBOX_API arena* arena_init_memfuncs(size_t chunkSize, const ctoolbox_memfuncs* memfuncs)
+{
+    arena* outArena = ctoolbox_custom_malloc(memfuncs ? memfuncs : &CTOOLBOX_DEFAULT_MEMFUNCS, sizeof(arena));
+    if (!outArena) return NULL;
+
+    memset(outArena, 0, sizeof(arena));
+    outArena->chunkSize = chunkSize > 0 ? chunkSize : ARENA_CHUNK_SIZE;
+
+    if (memfuncs) outArena->memfuncs = *memfuncs;
+    else outArena->memfuncs = CTOOLBOX_DEFAULT_MEMFUNCS;
+
+    outArena->first = arena_chunk_create(outArena, outArena->chunkSize);
+    if (!outArena->first) {
+        ctoolbox_custom_free_sized(&outArena->memfuncs, outArena, sizeof(arena));
+        return NULL;
+    }
+
+    return outArena;
+}
+
+CTOOLBOX_API void arena_destroy(arena* a)
+{
+    if (!a) return;
+
+    arena_chunk* chunk = a->current;
+    while (chunk) {
+        arena_chunk* prev = chunk->prev;
+        ctoolbox_custom_free_sized(&a->memfuncs, chunk, sizeof(arena_chunk) + chunk->capacity);
+        chunk = prev;
+    }
+    ctoolbox_custom_free_sized(&a->memfuncs, a, sizeof(arena));
+}
+
+CTOOLBOX_API void* arena_alloc(arena* a, size_t size, size_t alignment)
+{
+    if (!a) return NULL;
+    if (alignment == 0) alignment = CTOOLBOX_DEFAULT_ALIGNMENT;
+    if ((alignment & (alignment - 1)) != 0) return NULL;
+
+    size_t offset = arena_chunk_fit(a->current, size, alignment);
+
+    // doesn't fit, open a new chunk big enough for the request
+    if (offset == SIZE_MAX) {
+        if (size > SIZE_MAX - alignment - sizeof(arena_chunk)) return NULL;
+
+        size_t capacity = size + alignment > a->chunkSize ? size + alignment : a->chunkSize;
+        if (!arena_chunk_create(a, capacity)) return NULL;
+
+        offset = arena_chunk_fit(a->current, size, alignment);
+    }
+
+    a->current->offset = offset + size;
+    return arena_chunk_data(a->current) + offset;
+}
+
+CTOOLBOX_API void* arena_calloc(arena* a, size_t num, size_t size)
+{
+    if (size != 0 && num > SIZE_MAX / size) return NULL;
+
+    void* ptr = arena_alloc(a, num * size, 0);
+    if (ptr) memset(ptr, 0, num * size);
+    return ptr;
+}
+
+CTOOLBOX_API arena_marker arena_mark(const arena* a)
+{
+    arena_marker marker = { NULL, 0 };
+    if (!a) return marker;
+
+    marker.chunk = a->current;
+    marker.offset = a->current->offset;
+    return marker;
+}
+
+CTOOLBOX_API void arena_rollback(arena* a, arena_marker marker)
+{
+    if (!a || !marker.chunk) return;
+
+    // release every chunk opened after the marker
+    while (a->current != (arena_chunk*)marker.chunk && a->current != a->first) {
+        arena_chunk* prev = a->current->prev;
+        a->reserved -= a->current->capacity;
+        ctoolbox_custom_free_sized(&a->memfuncs, a->current, sizeof(arena_chunk) + a->current->capacity);
+        a->current = prev;
+    }
+
+    if (a->current == (arena_chunk*)marker.chunk && marker.offset < a->current->offset) {
+        a->current->offset = marker.offset;
+    }
+}
+
+CTOOLBOX_API void arena_reset(arena* a)
+{
+    if (!a) return;
+
+    arena_marker marker = { a->first, 0 };
+    arena_rollback(a, marker);
+}
+
+CTOOLBOX_API size_t arena_used(const arena* a)
+{
+    if (!a) return 0;
+
+    size_t used = 0;
+    for (const arena_chunk* chunk = a->current; chunk; chunk = chunk->prev) {
+        used += chunk->offset;
+    }
+    return used;
+}
+
+CTOOLBOX_API size_t arena_reserved(const arena* a)
+{
+    return a ? a->reserved : 0;
+}
+
+CTOOLBOX_API ctoolbox_memfuncs arena_memfuncs(arena* a)
+{
+    ctoolbox_memfuncs memfuncs = { 0 };
+    memfuncs.alloc_ctx_fn = arena_ctx_alloc;
+    memfuncs.realloc_ctx_fn = arena_ctx_realloc;
+    memfuncs.free_ctx_fn = NULL;
+    memfuncs.user = a;
+    return memfuncs;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Slab Allocator
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// internal
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// slab header, lives at the start of its SLAB_PAGE_SIZE aligned page so objects find it by masking their address
+typedef struct slab_page
+{
+    struct slab_page* prev;
+    struct slab_page* next;
+    void* freeList;         // objects released back into this slab
+    char* bump;             // objects never handed out start here
+    char* end;
+    uint32_t used;
+    uint32_t classIndex;
+} slab_page;
+
+// objects bigger than SLAB_MAX_OBJECT_SIZE, linked so slab_destroy can release them
+typedef struct slab_large
+{
+    struct slab_large* prev;
+    struct slab_large* next;
+    size_t size;
+    size_t padding; // keeps the object that follows the header aligned to 16 bytes
+} slab_large;
+
+typedef struct slab_class
+{
+    slab_page* partial;     // slabs with room for at least one object
+    slab_page* full;
+    size_t slabCount;
+    size_t used;
+} slab_class;
+
+struct slab
+{
+    slab_class classes[SLAB_CLASS_COUNT];
+    slab_large* large;
+    ctoolbox_memfuncs memfuncs;
+    ctoolbox_memstats stats;
+};
+
+#define SLAB_HEADER_SIZE ((sizeof(slab_page) + 15u) & ~(size_t)15u)
+
+static const size_t slab_class_sizes[SLAB_CLASS_COUNT] = { 16, 32, 48, 64, 96, 128, 192, 256 };
+
+// maps (size + 15) / 16 to its size class
+static const uint8_t slab_class_lookup[SLAB_MAX_OBJECT_SIZE / 16 + 1] = { 0, 0, 1, 2, 3, 4, 4, 5, 5, 6, 6, 6, 6, 7, 7, 7, 7 };
+
+static inline size_t slab_class_index(size_t size)
+{
+    return slab_class_lookup[(size + 15) >> 4];
+}
+
+static inline bool slab_page_full(const slab_page* page)
+{
+    return !page->freeList && page->bump >= page->end;
+}
+
+static inline void slab_list_remove(slab_page** list, slab_page* page)
+{
+    if (page->prev) page->prev->next = page->next;
+    else *list = page->next;
+    if (page->next) page->next->prev = page->prev;
+    page->prev = page->next = NULL;
+}
+
+static inline void slab_list_push(slab_page** list, slab_page* page)
+{
+    page->prev = NULL;
+    page->next = *list;
+    if (*list) (*list)->prev = page;
+    *list = page;
+}
+
+static slab_page* slab_page_create(slab* s, size_t classIndex)
+{
+    slab_page* page = ctoolbox_custom_aligned_malloc(&s->memfuncs, SLAB_PAGE_SIZE, SLAB_PAGE_SIZE);
+    if (!page) return NULL;
+
+    size_t objectSize = slab_class_sizes[classIndex];
+    size_t objectCount = (SLAB_PAGE_SIZE - SLAB_HEADER_SIZE) / objectSize;
+
+    page->prev = page->next = NULL;
+    page->freeList = NULL;
+    page->bump = (char*)page + SLAB_HEADER_SIZE;
+    page->end = page->bump + objectCount * objectSize;
+    page->used = 0;
+    page->classIndex = (uint32_t)classIndex;
+
+    slab_list_push(&s->classes[classIndex].partial, page);
+    s->classes[classIndex].slabCount++;
+    ctoolbox_memstats_on_alloc(&s->stats, SLAB_PAGE_SIZE);
+    return page;
+}
+
+// size of a block released or moved without it, large blocks are looked up in their list and anything else is a page object
+static size_t slab_block_size(const slab* s, const void* ptr)
+{
+    for (const slab_large* large = s->large; large; large = large->next) {
+        if (large + 1 == ptr) return large->size;
+    }
+
+    const slab_page* page = (const slab_page*)((uintptr_t)ptr & ~(uintptr_t)(SLAB_PAGE_SIZE - 1));
+    return slab_class_sizes[page->classIndex];
+}
+
+static void* slab_ctx_alloc(void* user, size_t size, size_t alignment)
+{
+    // objects are only 16 bytes aligned
+    if (alignment > 16) return NULL;
+    return slab_alloc((slab*)user, size);
+}
+
+static void* slab_ctx_realloc(void* user, void* ptr, size_t oldSize, size_t newSize, size_t alignment)
+{
+    if (ptr && oldSize == 0) oldSize = slab_block_size((slab*)user, ptr);
+
+    // staying in the same size class keeps the object where it is
+    if (ptr && oldSize <= SLAB_MAX_OBJECT_SIZE && newSize <= SLAB_MAX_OBJECT_SIZE && slab_class_index(oldSize) == slab_class_index(newSize)) {
+        return ptr;
+    }
+
+    void* newPtr = slab_ctx_alloc(user, newSize, alignment);
+    if (!newPtr) return NULL;
+
+    if (ptr) {
+        memcpy(newPtr, ptr, oldSize < newSize ? oldSize : newSize);
+        slab_free((slab*)user, ptr, oldSize);
+    }
+    return newPtr;
+}
+
+// ctoolbox_custom_free passes no size, masking the address of a large block would land on an unrelated page
+static void slab_ctx_free(void* user, void* ptr, size_t size)
+{
+    if (ptr && size == 0) size = slab_block_size((slab*)user, ptr);
+    slab_free((slab*)user, ptr, size);
+}
+
+static void slab_page_list_destroy(slab* s, slab_page* page)
+{
+    while (page) {
+        slab_page* next = page->next;
+        ctoolbox_custom_aligned_free_sized(&s->memfuncs, page, SLAB_PAGE_SIZE, SLAB_PAGE_SIZE);
+        page = next;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// external
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+CTOOLBOX_API slab* slab_init()
+{
+    return slab_init_memfuncs(&CTOOLBOX_DEFAULT_MEMFUNCS);
+}
+
+CTOOLBOX_API slab* slab_init_memfuncs(const ctoolbox_memfuncs* memfuncs)
+{
+    slab* outSlab = ctoolbox_custom_malloc(memfuncs ? memfuncs : &CTOOLBOX_DEFAULT_MEMFUNCS, sizeof(slab));
+    if (!outSlab) return NULL;
+
+    memset(outSlab, 0, sizeof(slab));
+
+    if (memfuncs) outSlab->memfuncs = *memfuncs;
+    else outSlab->memfuncs = CTOOLBOX_DEFAULT_MEMFUNCS;
+
+    ctoolbox_memstats_on_alloc(&outSlab->stats, sizeof(slab));
+
+    return outSlab;
+}
+
+CTOOLBOX_API void slab_destroy(slab* s)
+{
+    if (!s) return;
+
+    for (size_t i = 0; i < SLAB_CLASS_COUNT; i++) {
+        slab_page_list_destroy(s, s->classes[i].partial);
+        slab_page_list_destroy(s, s->classes[i].full);
+    }
+
+    slab_large* large = s->large;
+    while (large) {
+        slab_large* next = large->next;
+        ctoolbox_custom_free_sized(&s->memfuncs, large, sizeof(slab_large) + large->size);
+        large = next;
+    }
+    ctoolbox_custom_free_sized(&s->memfuncs, s, sizeof(slab));
+}
+
+CTOOLBOX_API void* slab_alloc(slab* s, size_t size)
+{
+    if (!s) return NULL;
+
+    if (size > SLAB_MAX_OBJECT_SIZE) {
+        if (size > SIZE_MAX - sizeof(slab_large)) return NULL;
+
+        slab_large* large = ctoolbox_custom_malloc(&s->memfuncs, sizeof(slab_large) + size);
+        if (!large) return NULL;
+
+        ctoolbox_memstats_on_alloc(&s->stats, sizeof(slab_large) + size);
+        large->prev = NULL;
+        large->next = s->large;
+        large->size = size;
+        large->padding = 0;
+        if (s->large) s->large->prev = large;
+        s->large = large;
+        return large + 1;
+    }
+
+    size_t classIndex = slab_class_index(size);
+    slab_class* cls = &s->classes[classIndex];
+
+    slab_page* page = cls->partial;
+    if (!page) {
+        page = slab_page_create(s, classIndex);
+        if (!page) return NULL;
+    }
+
+    void* object;
+    if (page->freeList) {
+        object = page->freeList;
+        page->freeList = *(void**)object;
+    }
+    else {
+        object = page->bump;
+        page->bump += slab_class_sizes[classIndex];
+    }
+
+    page->used++;
+    cls->used++;
+
+    if (slab_page_full(page)) {
+        slab_list_remove(&cls->partial, page);
+        slab_list_push(&cls->full, page);
+    }
+
+    return object;
+}
+
+CTOOLBOX_API void slab_free(slab* s, void* ptr, size_t size)
+{
+    if (!s || !ptr) return;
+
+    if (size > SLAB_MAX_OBJECT_SIZE) {
+        slab_large* large = (slab_large*)ptr - 1;
+        if (large->prev) large->prev->next = large->next;
+        else s->large = large->next;
+        if (large->next) large->next->prev = large->prev;
+
+        ctoolbox_memstats_on_free(&s->stats, sizeof(slab_large) + large->size);
+        ctoolbox_custom_free_sized(&s->memfuncs, large, sizeof(slab_large) + large->size);
+        return;
+    }
+
+    slab_page* page = (slab_page*)((uintptr_t)ptr & ~(uintptr_t)(SLAB_PAGE_SIZE - 1));
+    slab_class* cls = &s->classes[page->classIndex];
+    bool wasFull = slab_page_full(page);
+
+    *(void**)ptr = page->freeList;
+    page->freeList = ptr;
+    page->used--;
+    cls->used--;
+
+    if (wasFull) {
+        slab_list_remove(&cls->full, page);
+        slab_list_push(&cls->partial, page);
+    }
+
+    // release empty slabs, but keep the last one with room around to avoid thrashing
+    else if (page->used == 0 && (page->prev || page->next)) {
+        slab_list_remove(&cls->partial, page);
+        cls->slabCount--;
+        ctoolbox_memstats_on_free(&s->stats, SLAB_PAGE_SIZE);
+        ctoolbox_custom_aligned_free_sized(&s->memfuncs, page, SLAB_PAGE_SIZE, SLAB_PAGE_SIZE);
+    }
+}
+
+CTOOLBOX_API ctoolbox_result slab_get_stats(const slab* s, size_t classIndex, slab_stats* statsOut)
+{
+    if (!s || !statsOut || classIndex >= SLAB_CLASS_COUNT) return CTOOLBOX_ERROR_INVALID_PARAM;
+
+    const slab_class* cls = &s->classes[classIndex];
+    statsOut->objectSize = slab_class_sizes[classIndex];
+    statsOut->objectsPerSlab = (SLAB_PAGE_SIZE - SLAB_HEADER_SIZE) / statsOut->objectSize;
+    statsOut->slabCount = cls->slabCount;
+    statsOut->usedObjects = cls->used;
+    statsOut->occupancy = cls->slabCount ? (float)cls->used / (float)(cls->slabCount * statsOut->objectsPerSlab) : 0.0f;
+
+    return CTOOLBOX_SUCCESS;
+}
+
+CTOOLBOX_API ctoolbox_result slab_memory_usage(const slab* s, ctoolbox_memstats* statsOut)
+{
+    if (!s || !statsOut) return CTOOLBOX_ERROR_INVALID_PARAM;
+    *statsOut = s->stats;
+    return CTOOLBOX_SUCCESS;
+}
+
+CTOOLBOX_API ctoolbox_memfuncs slab_memfuncs(slab* s)
+{
+    ctoolbox_memfuncs memfuncs = { 0 };
+    memfuncs.alloc_ctx_fn = slab_ctx_alloc;
+    memfuncs.realloc_ctx_fn = slab_ctx_realloc;
+    memfuncs.free_ctx_fn = slab_ctx_free;
+    memfuncs.user = s;
+    return memfuncs;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Thread Caching Allocator
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// internal
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// how many caches a thread remembers at once, the least recently looked up one is forgotten first
+#define TCACHE_THREAD_SLOTS 4
+
+// cached blocks are chained through their first bytes
+typedef struct tcache_bin
+{
+    void* head;
+    size_t count;
+} tcache_bin;
+
+// blocks cached by a single thread, each thread owns at most one local per cache and gives it back on exit
+typedef struct tcache_local
+{
+    struct tcache_local* next;
+    uint64_t owner;                         // id of the owning thread, 0 once free for another thread to take
+    tcache_bin bins[TCACHE_CLASS_COUNT];
+} tcache_local;
+
+struct tcache
+{
+    uint64_t id;
+    cthread_mutex lock;                     // guards shared, locals and their owners
+    tcache_bin shared[TCACHE_CLASS_COUNT];
+    tcache_local* locals;                   // every local ever made, looked up by owner
+    struct tcache* prev;                    // live caches, for the threads to reach on exit
+    struct tcache* next;
+    ctoolbox_memfuncs memfuncs;
+};
+
+typedef struct tcache_slot
+{
+    uint64_t id;
+    tcache_local* local;
+} tcache_slot;
+
+// ids are never reused, so a slot left behind by a destroyed cache can't match a new one living at the same address
+static volatile uint64_t tcache_next_id = 0;
+static volatile uint64_t tcache_next_thread = 0;
+static CTHREAD_LOCAL tcache_slot tcache_slots[TCACHE_THREAD_SLOTS];
+static CTHREAD_LOCAL size_t tcache_slot_victim = 0;
+static CTHREAD_LOCAL uint64_t tcache_thread = 0;
+
+// live caches, taken before any cache lock
+static cthread_mutex tcache_registry_lock = CTHREAD_MUTEX_INITIALIZER;
+static tcache* tcache_registry = NULL;
+static cthread_key tcache_exit_key;
+static bool tcache_exit_key_ready = false;
+
+static inline size_t tcache_class_index(size_t size)
+{
+    size_t index = 0;
+    size_t classSize = 16;
+    while (classSize < size) {
+        classSize <<= 1;
+        index++;
+    }
+    return index;
+}
+
+static inline size_t tcache_class_size(size_t classIndex)
+{
+    return (size_t)16 << classIndex;
+}
+
+// detaches up to count blocks from the front of the bin, returning the chain and its last block
+static void* tcache_bin_take(tcache_bin* bin, size_t count, void** lastOut, size_t* takenOut)
+{
+    void* head = bin->head;
+    void* last = NULL;
+    size_t taken = 0;
+
+    for (void* block = head; block && taken < count; block = *(void**)block) {
+        last = block;
+        taken++;
+    }
+
+    if (last) {
+        bin->head = *(void**)last;
+        *(void**)last = NULL;
+    }
+    bin->count -= taken;
+    *lastOut = last;
+    *takenOut = taken;
+    return taken ? head : NULL;
+}
+
+// prepends a chain of count blocks ending at last to the bin
+static inline void tcache_bin_put(tcache_bin* bin, void* head, void* last, size_t count)
+{
+    *(void**)last = bin->head;
+    bin->head = head;
+    bin->count += count;
+}
+
+static void tcache_bin_release(tcache* cache, tcache_bin* bin, size_t classIndex)
+{
+    void* block = bin->head;
+    while (block) {
+        void* next = *(void**)block;
+        ctoolbox_custom_free_sized(&cache->memfuncs, block, tcache_class_size(classIndex));
+        block = next;
+    }
+    bin->head = NULL;
+    bin->count = 0;
+}
+
+// moves the count least recently freed blocks to the shared pool, whatever doesn't fit goes back to the memory functions
+static void tcache_return(tcache* cache, tcache_bin* bin, size_t classIndex, size_t count)
+{
+    // the most recently freed blocks stay, they are the ones still warm in this core's cache
+    tcache_bin cold = *bin;
+    void* last = NULL;
+    size_t kept = 0;
+    bin->head = tcache_bin_take(&cold, bin->count - count, &last, &kept);
+    bin->count = kept;
+    if (!cold.head) return;
+
+    cthread_mutex_lock(&cache->lock);
+    tcache_bin* shared = &cache->shared[classIndex];
+    size_t room = shared->count < TCACHE_SHARED_CAPACITY ? TCACHE_SHARED_CAPACITY - shared->count : 0;
+
+    size_t moved = 0;
+    void* head = tcache_bin_take(&cold, room, &last, &moved);
+    if (head) tcache_bin_put(shared, head, last, moved);
+    cthread_mutex_unlock(&cache->lock);
+
+    tcache_bin_release(cache, &cold, classIndex);
+}
+
+// grabs a batch of blocks from the shared pool into the thread bin
+static void tcache_refill(tcache* cache, tcache_bin* bin, size_t classIndex)
+{
+    void* last = NULL;
+    size_t taken = 0;
+
+    cthread_mutex_lock(&cache->lock);
+    void* head = tcache_bin_take(&cache->shared[classIndex], TCACHE_BIN_CAPACITY / 2, &last, &taken);
+    cthread_mutex_unlock(&cache->lock);
+
+    if (head) tcache_bin_put(bin, head, last, taken);
+}
+
+// moves every block of the local to the shared pool
+static void tcache_local_flush(tcache* cache, tcache_local* local)
+{
+    for (size_t i = 0; i < TCACHE_CLASS_COUNT; i++) {
+        tcache_return(cache, &local->bins[i], i, local->bins[i].count);
+    }
+}
+
+// flushes the local a forgotten slot points to, unless its cache was destroyed in the meantime
+static void tcache_slot_flush(const tcache_slot* slot)
+{
+    cthread_mutex_lock(&tcache_registry_lock);
+    for (tcache* cache = tcache_registry; cache; cache = cache->next) {
+        if (cache->id == slot->id) {
+            tcache_local_flush(cache, slot->local);
+            break;
+        }
+    }
+    cthread_mutex_unlock(&tcache_registry_lock);
+}
+
+// an exiting thread hands its blocks to the shared pools and its locals to the next threads
+static void CTHREAD_CALLBACK tcache_thread_exit(void* value)
+{
+    uint64_t thread = *(const uint64_t*)value;
+
+    // a free called later on during the exit starts over with a new id instead of using a released local
+    for (size_t i = 0; i < TCACHE_THREAD_SLOTS; i++) tcache_slots[i].id = 0;
+    tcache_thread = 0;
+
+    cthread_mutex_lock(&tcache_registry_lock);
+    for (tcache* cache = tcache_registry; cache; cache = cache->next) {
+        cthread_mutex_lock(&cache->lock);
+        tcache_local* local = cache->locals;
+        while (local && local->owner != thread) local = local->next;
+        cthread_mutex_unlock(&cache->lock);
+        if (!local) continue;
+
+        tcache_local_flush(cache, local);
+
+        cthread_mutex_lock(&cache->lock);
+        local->owner = 0;
+        cthread_mutex_unlock(&cache->lock);
+    }
+    cthread_mutex_unlock(&tcache_registry_lock);
+}
+
+// the calling thread's id, the first call registers it to be released on exit
+static uint64_t tcache_thread_id(void)
+{
+    if (tcache_thread == 0) {
+        tcache_thread = cthread_atomic_increment(&tcache_next_thread);
+        cthread_key_set(tcache_exit_key, &tcache_thread);
+    }
+    return tcache_thread;
+}
+
+// the thread slots remember the last caches used, the others are looked up among the cache locals by owner
+static tcache_local* tcache_local_get(tcache* cache)
+{
+    for (size_t i = 0; i < TCACHE_THREAD_SLOTS; i++) {
+        if (tcache_slots[i].id == cache->id) return tcache_slots[i].local;
+    }
+
+    uint64_t thread = tcache_thread_id();
+    tcache_local* local = NULL;
+    tcache_local* idle = NULL;
+
+    cthread_mutex_lock(&cache->lock);
+    for (tcache_local* it = cache->locals; it && !local; it = it->next) {
+        if (it->owner == thread) local = it;
+        else if (!idle && it->owner == 0) idle = it;
+    }
+    if (!local) local = idle;
+    if (local) local->owner = thread;
+    cthread_mutex_unlock(&cache->lock);
+
+    if (!local) {
+        local = ctoolbox_custom_calloc(&cache->memfuncs, 1, sizeof(tcache_local));
+        if (!local) return NULL;
+
+        local->owner = thread;
+        cthread_mutex_lock(&cache->lock);
+        local->next = cache->locals;
+        cache->locals = local;
+        cthread_mutex_unlock(&cache->lock);
+    }
+
+    // the forgotten local stays with this thread, but its blocks go where the other threads can use them
+    tcache_slot* slot = &tcache_slots[tcache_slot_victim];
+    tcache_slot_victim = (tcache_slot_victim + 1) % TCACHE_THREAD_SLOTS;
+    if (slot->id != 0) tcache_slot_flush(slot);
+
+    slot->id = cache->id;
+    slot->local = local;
+    return local;
+}
+
+static void* tcache_ctx_alloc(void* user, size_t size, size_t alignment)
+{
+    // blocks are only 16 bytes aligned
+    if (alignment > 16) return NULL;
+    return tcache_alloc((tcache*)user, size);
+}
+
+static void* tcache_ctx_realloc(void* user, void* ptr, size_t oldSize, size_t newSize, size_t alignment)
+{
+    // the size class of a block can't be told without its size
+    if (ptr && oldSize == 0) return NULL;
+
+    // staying in the same size class keeps the block where it is
+    if (ptr && oldSize <= TCACHE_MAX_BLOCK_SIZE && newSize <= TCACHE_MAX_BLOCK_SIZE && tcache_class_index(oldSize) == tcache_class_index(newSize)) {
+        return ptr;
+    }
+
+    tcache* cache = (tcache*)user;
+    if (ptr && oldSize > TCACHE_MAX_BLOCK_SIZE && newSize > TCACHE_MAX_BLOCK_SIZE) {
+        return ctoolbox_custom_realloc_sized(&cache->memfuncs, ptr, oldSize, newSize);
+    }
+
+    void* newPtr = tcache_ctx_alloc(user, newSize, alignment);
+    if (!newPtr) return NULL;
+
+    if (ptr) {
+        memcpy(newPtr, ptr, oldSize < newSize ? oldSize : newSize);
+        tcache_free(cache, ptr, oldSize);
+    }
+    return newPtr;
+}
+
+static void tcache_ctx_free(void* user, void* ptr, size_t size)
+{
+    tcache_free((tcache*)user, ptr, size);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// external
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+CTOOLBOX_API tcache* tcache_init()
+{
+    return tcache_init_memfuncs(&CTOOLBOX_DEFAULT_MEMFUNCS);
+}
+
+CTOOLBOX_API tcache* tcache_init_memfuncs(const ctoolbox_memfuncs* memfuncs)
+{
+    tcache* outCache = ctoolbox_custom_malloc(memfuncs ? memfuncs : &CTOOLBOX_DEFAULT_MEMFUNCS, sizeof(tcache));
+    if (!outCache) return NULL;
+
+    memset(outCache, 0, sizeof(tcache));
+    outCache->id = cthread_atomic_increment(&tcache_next_id);
+
+    if (memfuncs) outCache->memfuncs = *memfuncs;
+    else outCache->memfuncs = CTOOLBOX_DEFAULT_MEMFUNCS;
+
+    cthread_mutex_lock(&tcache_registry_lock);
+    if (!tcache_exit_key_ready) tcache_exit_key_ready = cthread_key_create(&tcache_exit_key, tcache_thread_exit);
+    if (!tcache_exit_key_ready) {
+        cthread_mutex_unlock(&tcache_registry_lock);
+        ctoolbox_custom_free_sized(&outCache->memfuncs, outCache, sizeof(tcache));
+        return NULL;
+    }
+
+    cthread_mutex_init(&outCache->lock);
+    outCache->next = tcache_registry;
+    if (tcache_registry) tcache_registry->prev = outCache;
+    tcache_registry = outCache;
+    cthread_mutex_unlock(&tcache_registry_lock);
+
+    return outCache;
+}
+
+CTOOLBOX_API void tcache_destroy(tcache* cache)
+{
+    if (!cache) return;
+
+    // exiting threads can't reach the cache anymore once it is off the registry
+    cthread_mutex_lock(&tcache_registry_lock);
+    if (cache->prev) cache->prev->next = cache->next;
+    else tcache_registry = cache->next;
+    if (cache->next) cache->next->prev = cache->prev;
+    cthread_mutex_unlock(&tcache_registry_lock);
+
+    tcache_local* local = cache->locals;
+    while (local) {
+        tcache_local* next = local->next;
+        for (size_t i = 0; i < TCACHE_CLASS_COUNT; i++) {
+            tcache_bin_release(cache, &local->bins[i], i);
+        }
+        ctoolbox_custom_free_sized(&cache->memfuncs, local, sizeof(tcache_local));
+        local = next;
+    }
+
+    for (size_t i = 0; i < TCACHE_CLASS_COUNT; i++) {
+        tcache_bin_release(cache, &cache->shared[i], i);
+    }
+
+    // forget the calling thread's slot, other threads' slots simply never match again
+    for (size_t i = 0; i < TCACHE_THREAD_SLOTS; i++) {
+        if (tcache_slots[i].id == cache->id) tcache_slots[i].id = 0;
+    }
+
+    cthread_mutex_destroy(&cache->lock);
+    ctoolbox_custom_free_sized(&cache->memfuncs, cache, sizeof(tcache));
+}
+
+CTOOLBOX_API void* tcache_alloc(tcache* cache, size_t size)
+{
+    if (!cache) return NULL;
+    if (size > TCACHE_MAX_BLOCK_SIZE) return ctoolbox_custom_malloc(&cache->memfuncs, size);
+
+    size_t classIndex = tcache_class_index(size);
+    tcache_local* local = tcache_local_get(cache);
+
+    if (local) {
+        tcache_bin* bin = &local->bins[classIndex];
+        if (!bin->head) tcache_refill(cache, bin, classIndex);
+
+        if (bin->head) {
+            void* block = bin->head;
+            bin->head = *(void**)block;
+            bin->count--;
+            return block;
+        }
+    }
+
+    return ctoolbox_custom_malloc(&cache->memfuncs, tcache_class_size(classIndex));
+}
+
+CTOOLBOX_API void tcache_free(tcache* cache, void* ptr, size_t size)
+{
+    if (!cache || !ptr) return;
+    if (size > TCACHE_MAX_BLOCK_SIZE) {
+        ctoolbox_custom_free_sized(&cache->memfuncs, ptr, size);
+        return;
+    }
+
+    size_t classIndex = tcache_class_index(size);
+    tcache_local* local = tcache_local_get(cache);
+    if (!local) {
+        ctoolbox_custom_free_sized(&cache->memfuncs, ptr, tcache_class_size(classIndex));
+        return;
+    }
+
+    tcache_bin* bin = &local->bins[classIndex];
+    *(void**)ptr = bin->head;
+    bin->head = ptr;
+    bin->count++;
+
+    if (bin->count > TCACHE_BIN_CAPACITY) tcache_return(cache, bin, classIndex, bin->count / 2);
+}
+
+CTOOLBOX_API void tcache_flush(tcache* cache)
+{
+    if (!cache) return;
+
+    for (size_t i = 0; i < TCACHE_THREAD_SLOTS; i++) {
+        if (tcache_slots[i].id != cache->id) continue;
+
+        tcache_local_flush(cache, tcache_slots[i].local);
+        return;
+    }
+}
+
+CTOOLBOX_API ctoolbox_memfuncs tcache_memfuncs(tcache* cache)
+{
+    ctoolbox_memfuncs memfuncs = { 0 };
+    memfuncs.alloc_ctx_fn = tcache_ctx_alloc;
+    memfuncs.realloc_ctx_fn = tcache_ctx_realloc;
+    memfuncs.free_ctx_fn = tcache_ctx_free;
+    memfuncs.user = cache;
+    return memfuncs;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Thread Pool
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// internal
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// a parallel call, lives on its caller's stack until remaining drops to 0
+typedef struct threadpool_job
+{
+    threadpool_range_func func;
+    void* context;
+    size_t grain;
+    volatile uint64_t remaining;    // indices not processed yet
+    volatile uint64_t result;       // first failure a range reported, CTOOLBOX_SUCCESS until then
+} threadpool_job;
+
+typedef struct threadpool_task
+{
+    threadpool_job* job;
+    size_t begin;
+    size_t end;
+} threadpool_task;
+
+// the owner pushes and pops at the back, thieves take the oldest and biggest ranges at the front
+typedef struct threadpool_queue
+{
+    cthread_mutex lock;
+    size_t head;
+    size_t count;
+    threadpool_task tasks[THREADPOOL_QUEUE_CAPACITY];
+} threadpool_queue;
+
+typedef struct threadpool_worker
+{
+    threadpool* pool;
+    size_t index;
+    cthread_thread thread;
+} threadpool_worker;
+
+// one queue per worker, the last one is shared by the threads calling threadpool_parallel_for
+struct threadpool
+{
+    threadpool_queue* queues;
+    threadpool_worker* workers;
+    size_t workerCount;
+    volatile uint64_t pending;      // tasks sitting in the queues
+    cthread_mutex lock;             // guards stop, taken before waking workers so none misses a push
+    cthread_cond wake;
+    bool stop;
+    ctoolbox_memfuncs memfuncs;
+    ctoolbox_memstats stats;
+};
+
+static bool threadpool_push(threadpool* pool, size_t queueIndex, threadpool_task task)
+{
+    threadpool_queue* queue = &pool->queues[queueIndex];
+
+    cthread_mutex_lock(&queue->lock);
+    bool pushed = queue->count < THREADPOOL_QUEUE_CAPACITY;
+    if (pushed) queue->tasks[(queue->head + queue->count++) % THREADPOOL_QUEUE_CAPACITY] = task;
+    cthread_mutex_unlock(&queue->lock);
+    if (!pushed) return false;
+
+    cthread_atomic_increment(&pool->pending);
+    cthread_mutex_lock(&pool->lock);
+    cthread_cond_signal(&pool->wake);
+    cthread_mutex_unlock(&pool->lock);
+    return true;
+}
+
+static bool threadpool_pop(threadpool_queue* queue, bool back, threadpool_task* taskOut)
+{
+    cthread_mutex_lock(&queue->lock);
+    bool popped = queue->count > 0;
+    if (popped && back) {
+        *taskOut = queue->tasks[(queue->head + --queue->count) % THREADPOOL_QUEUE_CAPACITY];
+    }
+    else if (popped) {
+        *taskOut = queue->tasks[queue->head];
+        queue->head = (queue->head + 1) % THREADPOOL_QUEUE_CAPACITY;
+        queue->count--;
+    }
+    cthread_mutex_unlock(&queue->lock);
+    return popped;
+}
+
+// takes from the thread's own queue first, then steals from the others in turn
+static bool threadpool_take(threadpool* pool, size_t queueIndex, threadpool_task* taskOut)
+{
+    if (cthread_atomic_load(&pool->pending) == 0) return false;
+
+    size_t queueCount = pool->workerCount + 1;
+    for (size_t i = 0; i < queueCount; i++) {
+        if (threadpool_pop(&pool->queues[(queueIndex + i) % queueCount], i > 0, taskOut)) {
+            cthread_atomic_fetch_add(&pool->pending, (uint64_t)0 - 1);
+            return true;
+        }
+    }
+    return false;
+}
+
+// keeps halving the range, leaving the back halves to be stolen, then processes what is left
+static void threadpool_run(threadpool* pool, size_t queueIndex, threadpool_task task)
+{
+    threadpool_job* job = task.job;
+    while (task.end - task.begin > job->grain) {
+        size_t middle = task.begin + (task.end - task.begin) / 2;
+        threadpool_task back = { job, middle, task.end };
+        if (!threadpool_push(pool, queueIndex, back)) break;
+        task.end = middle;
+    }
+
+    // once a range failed the rest of the job is only counted down
+    if (cthread_atomic_load(&job->result) == CTOOLBOX_SUCCESS) {
+        ctoolbox_result res = job->func(job->context, task.begin, task.end);
+        uint64_t expected = CTOOLBOX_SUCCESS;
+        if (res != CTOOLBOX_SUCCESS) cthread_atomic_compare_exchange(&job->result, &expected, (uint64_t)res);
+    }
+
+    // the job may be gone as soon as this reaches 0
+    cthread_atomic_fetch_add(&job->remaining, (uint64_t)0 - (task.end - task.begin));
+}
+
+static void threadpool_worker_main(void* arg)
+{
+    threadpool_worker* worker = arg;
+    threadpool* pool = worker->pool;
+
+    for (;;) {
+        threadpool_task task;
+        if (threadpool_take(pool, worker->index, &task)) {
+            threadpool_run(pool, worker->index, task);
+            continue;
+        }
+
+        cthread_mutex_lock(&pool->lock);
+        while (!pool->stop && cthread_atomic_load(&pool->pending) == 0) cthread_cond_wait(&pool->wake, &pool->lock);
+        bool stop = pool->stop;
+        cthread_mutex_unlock(&pool->lock);
+        if (stop) return;
+    }
+}
+
+static void threadpool_release(threadpool* pool, size_t startedCount)
+{
+    cthread_mutex_lock(&pool->lock);
+    pool->stop = true;
+    cthread_cond_broadcast(&pool->wake);
+    cthread_mutex_unlock(&pool->lock);
+
+    for (size_t i = 0; i < startedCount; i++) cthread_join(&pool->workers[i].thread);
+    for (size_t i = 0; i <= pool->workerCount; i++) cthread_mutex_destroy(&pool->queues[i].lock);
+
+    cthread_cond_destroy(&pool->wake);
+    cthread_mutex_destroy(&pool->lock);
+    ctoolbox_custom_free_sized(&pool->memfuncs, pool->workers, pool->workerCount * sizeof(threadpool_worker));
+    ctoolbox_custom_free_sized(&pool->memfuncs, pool->queues, (pool->workerCount + 1) * sizeof(threadpool_queue));
+    ctoolbox_custom_free_sized(&pool->memfuncs, pool, sizeof(threadpool));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// external
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+CTOOLBOX_API threadpool* threadpool_init(size_t threadCount)
+{
+    return threadpool_init_memfuncs(threadCount, &CTOOLBOX_DEFAULT_MEMFUNCS);
+}
+
+CTOOLBOX_API threadpool* threadpool_init_memfuncs(size_t threadCount, const ctoolbox_memfuncs* memfuncs)
+{
+    if (threadCount == 0) threadCount = cthread_hardware_concurrency() - 1;
+    if (threadCount > SIZE_MAX / sizeof(threadpool_queue) - 1) return NULL;
+
+    threadpool* outPool = ctoolbox_custom_malloc(memfuncs ? memfuncs : &CTOOLBOX_DEFAULT_MEMFUNCS, sizeof(threadpool));
+    if (!outPool) return NULL;
+
+    memset(outPool, 0, sizeof(threadpool));
+    outPool->workerCount = threadCount;
+
+    if (memfuncs) outPool->memfuncs = *memfuncs;
+    else outPool->memfuncs = CTOOLBOX_DEFAULT_MEMFUNCS;
+
+    size_t queueBytes = (threadCount + 1) * sizeof(threadpool_queue);
+    size_t workerBytes = threadCount * sizeof(threadpool_worker);
+    outPool->queues = ctoolbox_custom_malloc(&outPool->memfuncs, queueBytes);
+    outPool->workers = workerBytes ? ctoolbox_custom_malloc(&outPool->memfuncs, workerBytes) : NULL;
+    if (!outPool->queues || (workerBytes && !outPool->workers)) {
+        ctoolbox_custom_free_sized(&outPool->memfuncs, outPool->queues, queueBytes);
+        ctoolbox_custom_free_sized(&outPool->memfuncs, outPool->workers, workerBytes);
+        ctoolbox_custom_free_sized(&outPool->memfuncs, outPool, sizeof(threadpool));
+        return NULL;
+    }
+
+    ctoolbox_memstats_on_alloc(&outPool->stats, sizeof(threadpool));
+    ctoolbox_memstats_on_alloc(&outPool->stats, queueBytes);
+    if (workerBytes) ctoolbox_memstats_on_alloc(&outPool->stats, workerBytes);
+
+    cthread_mutex_init(&outPool->lock);
+    cthread_cond_init(&outPool->wake);
+    for (size_t i = 0; i <= threadCount; i++) {
+        outPool->queues[i].head = 0;
+        outPool->queues[i].count = 0;
+        cthread_mutex_init(&outPool->queues[i].lock);
+    }
+
+    for (size_t i = 0; i < threadCount; i++) {
+        outPool->workers[i].pool = outPool;
+        outPool->workers[i].index = i;
+        if (!cthread_create(&outPool->workers[i].thread, threadpool_worker_main, &outPool->workers[i])) {
+            threadpool_release(outPool, i);
+            return NULL;
+        }
+    }
+
+    return outPool;
+}
+
+CTOOLBOX_API void threadpool_destroy(threadpool* pool)
+{
+    if (!pool) return;
+    threadpool_release(pool, pool->workerCount);
+}
+
+CTOOLBOX_API size_t threadpool_thread_count(const threadpool* pool)
+{
+    return pool ? pool->workerCount + 1 : 0;
+}
+
+CTOOLBOX_API ctoolbox_result threadpool_parallel_for(threadpool* pool, size_t count, size_t grain, threadpool_range_func func, void* context)
+{
+    if (!pool || !func) return CTOOLBOX_ERROR_INVALID_PARAM;
+    if (count == 0) return CTOOLBOX_SUCCESS;
+    if (grain == 0) grain = 1;
+
+    if (pool->workerCount == 0 || count <= grain) return func(context, 0, count);
+
+    threadpool_job job;
+    job.func = func;
+    job.context = context;
+    job.grain = grain;
+    job.remaining = count;
+    job.result = CTOOLBOX_SUCCESS;
+
+    size_t queueIndex = pool->workerCount;
+    threadpool_task task = { &job, 0, count };
+    threadpool_run(pool, queueIndex, task);
+
+    // help with whatever is pending, this job's ranges or another caller's, until every range is done
+    while (cthread_atomic_load(&job.remaining) != 0) {
+        if (threadpool_take(pool, queueIndex, &task)) threadpool_run(pool, queueIndex, task);
+        else cthread_yield();
+    }
+    return (ctoolbox_result)cthread_atomic_load(&job.result);
+}
+
+CTOOLBOX_API ctoolbox_result threadpool_memory_usage(const threadpool* pool, ctoolbox_memstats* statsOut)
+{
+    if (!pool || !statsOut) return CTOOLBOX_ERROR_INVALID_PARAM;
+    *statsOut = pool->stats;
+    return CTOOLBOX_SUCCESS;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Dynamic Array
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <string.h>
+#include <stdio.h>
+
+#if defined(_WIN32) || defined(_WIN64)
+    #include <windows.h>
+#elif defined(__unix__) || defined(__APPLE__)
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+#if defined(__linux__)
+    #ifndef MREMAP_MAYMOVE
+        // only declared with _GNU_SOURCE, which can't be relied upon in the header-only build
+        #define MREMAP_MAYMOVE 1
+        extern void* mremap(void* oldAddress, size_t oldSize, size_t newSize, int flags, ...);
+    #endif
+    #ifndef MAP_ANONYMOUS
+        #define MAP_ANONYMOUS 0x20
+    #endif
+    #define DARRAY_MREMAP 1
+#endif
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// internal
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+struct darray
+{
+	void* data;
+    size_t size;
+    size_t capacity;
+    size_t elementSize;
+    size_t alignment;
+    darray_growth growth;
+    size_t growthValue;
+    size_t mapThreshold;    // storage growing past this many bytes moves to an anonymous mapping, 0 disables it
+    size_t mappedBytes;     // size of the mapping when the storage lives in one, 0 otherwise
+    size_t inlineCapacity;  // elements stored right after the header, used until the array outgrows them
+    void* file;             // whole file mapping when the elements were opened with darray_open_mapped, NULL otherwise
+    size_t fileBytes;
+    ctoolbox_memfuncs memfuncs;
+    ctoolbox_memstats stats;
+};  
+
+// the typed wrappers in darray.h read the leading fields through darray_header
+_Static_assert(offsetof(darray, data) == offsetof(darray_header, data), "darray_header out of sync");
+_Static_assert(offsetof(darray, size) == offsetof(darray_header, size), "darray_header out of sync");
+_Static_assert(offsetof(darray, capacity) == offsetof(darray_header, capacity), "darray_header out of sync");
+_Static_assert(offsetof(darray, elementSize) == offsetof(darray_header, elementSize), "darray_header out of sync");
+
+#define DARRAY_HEADER_SIZE ((sizeof(darray) + (CTOOLBOX_DEFAULT_ALIGNMENT - 1)) & ~(size_t)(CTOOLBOX_DEFAULT_ALIGNMENT - 1))
+
+static inline void* darray_inline_data(const darray* array)
+{
+    return (char*)array + DARRAY_HEADER_SIZE;
+}
+
+static inline bool darray_is_inline(const darray* array)
+{
+    return array->inlineCapacity > 0 && array->data == darray_inline_data(array);
+}
+
+// the header allocation, inline storage included
+static inline size_t darray_header_bytes(const darray* array)
+{
+    return DARRAY_HEADER_SIZE + array->inlineCapacity * array->elementSize;
+}
+
+static size_t darray_page_size(void)
+{
+#if defined(__unix__) || defined(__APPLE__)
+    long pageSize = sysconf(_SC_PAGESIZE);
+    return pageSize > 0 ? (size_t)pageSize : 4096;
+#else
+    return 4096;
+#endif
+}
+
+// rounds bytes up to whole pages, 0 on overflow
+static inline size_t darray_page_round(size_t bytes, size_t pageSize)
+{
+    if (bytes > SIZE_MAX - (pageSize - 1)) return 0;
+    return (bytes + (pageSize - 1)) & ~(pageSize - 1);
+}
+
+// grows the storage following the array's growth policy so it holds at least minCapacity elements
+static ctoolbox_result darray_grow(darray* array, size_t minCapacity)
+{
+    if (minCapacity <= array->capacity) return CTOOLBOX_SUCCESS;
+
+    size_t newCapacity = array->capacity;
+    switch (array->growth)
+    {
+        case DARRAY_GROWTH_LINEAR:
+        {
+            size_t steps = (minCapacity - newCapacity + (array->growthValue - 1)) / array->growthValue;
+            if (steps > (SIZE_MAX - newCapacity) / array->growthValue) newCapacity = minCapacity;
+            else newCapacity += steps * array->growthValue;
+            break;
+        }
+
+        case DARRAY_GROWTH_PAGE:
+        {
+            size_t pageSize = darray_page_size();
+            size_t step = array->growthValue > 0 ? array->growthValue : pageSize;
+            size_t bytes = newCapacity * array->elementSize;
+            bytes = bytes > SIZE_MAX - step ? SIZE_MAX : bytes + step;
+
+            if (minCapacity > SIZE_MAX / array->elementSize) return CTOOLBOX_ERROR_MEMORY_ALLOC;
+            if (bytes < minCapacity * array->elementSize) bytes = minCapacity * array->elementSize;
+
+            bytes = darray_page_round(bytes, pageSize);
+            newCapacity = bytes > 0 ? bytes / array->elementSize : minCapacity;
+            break;
+        }
+
+        default:
+        {
+            if (newCapacity == 0) newCapacity = 1;
+            while (newCapacity < minCapacity) {
+                if (newCapacity > SIZE_MAX / array->growthValue) {
+                    newCapacity = minCapacity;
+                    break;
+                }
+
+                size_t next = newCapacity * array->growthValue / 100;
+                newCapacity = next > newCapacity ? next : newCapacity + 1;
+            }
+            break;
+        }
+    }
+
+    return darray_reserve(array, newCapacity);
+}
+
+// read-only file maps keep a capacity of 0, under their size, so the elements move to the heap before anything writes them
+static inline ctoolbox_result darray_make_writable(darray* array)
+{
+    return array->size > array->capacity ? darray_reserve(array, array->size) : CTOOLBOX_SUCCESS;
+}
+
+#define DARRAY_FILE_MAGIC "CTBXDARR"
+#define DARRAY_FILE_VERSION 1
+#define DARRAY_FILE_BYTE_ORDER 0x01020304u
+#define DARRAY_FILE_TEMP_SUFFIX ".tmp"
+
+// on-disk layout written by darray_save, the elements follow at dataOffset
+typedef struct darray_file_header
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;     // written natively, a mismatch means the file was saved on a machine of the other endianness
+    uint64_t elementSize;
+    uint64_t size;
+    uint64_t alignment;
+    uint64_t dataOffset;    // multiple of alignment and at least a cache line
+} darray_file_header;
+
+// maps the whole file, shared and read-only or private and copy-on-write, NULL on failure
+static void* darray_file_map(const char* path, bool copyOnWrite, size_t* bytesOut)
+{
+#if defined(_WIN32) || defined(_WIN64)
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) return NULL;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0 || (uint64_t)fileSize.QuadPart > SIZE_MAX) {
+        CloseHandle(file);
+        return NULL;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, NULL, copyOnWrite ? PAGE_WRITECOPY : PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file);
+    if (!mapping) return NULL;
+
+    // the view keeps the mapping alive
+    void* view = MapViewOfFile(mapping, copyOnWrite ? FILE_MAP_COPY : FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (!view) return NULL;
+
+    *bytesOut = (size_t)fileSize.QuadPart;
+    return view;
+#elif defined(__unix__) || defined(__APPLE__)
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return NULL;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size <= 0 || (uint64_t)info.st_size > SIZE_MAX) {
+        close(fd);
+        return NULL;
+    }
+
+    void* view = mmap(NULL, (size_t)info.st_size, copyOnWrite ? (PROT_READ | PROT_WRITE) : PROT_READ, copyOnWrite ? MAP_PRIVATE : MAP_SHARED, fd, 0);
+    close(fd);
+    if (view == MAP_FAILED) return NULL;
+
+    *bytesOut = (size_t)info.st_size;
+    return view;
+#else
+    (void)path; (void)copyOnWrite; (void)bytesOut;
+    return NULL;
+#endif
+}
+
+// moves the file at from over the one at to, replacing it in one step
+static bool darray_file_replace(const char* from, const char* to)
+{
+#if defined(_WIN32) || defined(_WIN64)
+    return MoveFileExA(from, to, MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    return rename(from, to) == 0;
+#endif
+}
+
+static void darray_file_unmap(void* view, size_t bytes)
+{
+#if defined(_WIN32) || defined(_WIN64)
+    (void)bytes;
+    UnmapViewOfFile(view);
+#elif defined(__unix__) || defined(__APPLE__)
+    munmap(view, bytes);
+#else
+    (void)view; (void)bytes;
+#endif
+}
+
+// releases the storage wherever it lives, inline storage goes away with the header
+static void darray_storage_release(darray* array)
+{
+    if (darray_is_inline(array)) return;
+
+    if (array->file) {
+        darray_file_unmap(array->file, array->fileBytes);
+        ctoolbox_memstats_on_free(&array->stats, array->fileBytes);
+        array->file = NULL;
+        array->fileBytes = 0;
+        return;
+    }
+
+#if defined(DARRAY_MREMAP)
+    if (array->mappedBytes > 0) {
+        munmap(array->data, array->mappedBytes);
+        ctoolbox_memstats_on_free(&array->stats, array->mappedBytes);
+        array->mappedBytes = 0;
+        return;
+    }
+#endif
+    ctoolbox_custom_aligned_free_sized(&array->memfuncs, array->data, array->capacity * array->elementSize, array->alignment);
+    if (array->data) ctoolbox_memstats_on_free(&array->stats, array->capacity * array->elementSize);
+}
+
+#if defined(DARRAY_MREMAP)
+// moves the storage into an anonymous mapping, or grows/shrinks the one it lives in, without copying pages
+static ctoolbox_result darray_map_reserve(darray* array, size_t newCapacity)
+{
+    size_t newBytes = darray_page_round(newCapacity * array->elementSize, darray_page_size());
+    if (newBytes == 0) return CTOOLBOX_ERROR_MEMORY_ALLOC;
+
+    void* newData = NULL;
+    if (array->mappedBytes > 0) {
+        newData = mremap(array->data, array->mappedBytes, newBytes, MREMAP_MAYMOVE);
+        if (newData == MAP_FAILED) return CTOOLBOX_ERROR_MEMORY_ALLOC;
+
+        ctoolbox_memstats_on_realloc(&array->stats, array->mappedBytes, newBytes);
+    }
+    else {
+        newData = mmap(NULL, newBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (newData == MAP_FAILED) return CTOOLBOX_ERROR_MEMORY_ALLOC;
+
+        if (array->data) {
+            memcpy(newData, array->data, array->size * array->elementSize);
+            darray_storage_release(array);
+        }
+        ctoolbox_memstats_on_alloc(&array->stats, newBytes);
+    }
+
+    array->data = newData;
+    array->mappedBytes = newBytes;
+    array->capacity = newBytes / array->elementSize;
+    return CTOOLBOX_SUCCESS;
+}
+#endif
+
+// scratch buffers for the sorts, accounted so peakBytes shows them
+static void* darray_scratch_alloc(darray* array, size_t bytes)
+{
+    void* scratch = ctoolbox_custom_aligned_malloc(&array->memfuncs, bytes, array->alignment);
+    if (scratch) ctoolbox_memstats_on_alloc(&array->stats, bytes);
+    return scratch;
+}
+
+static void darray_scratch_free(darray* array, void* scratch, size_t bytes)
+{
+    ctoolbox_custom_aligned_free_sized(&array->memfuncs, scratch, bytes, array->alignment);
+    ctoolbox_memstats_on_free(&array->stats, bytes);
+}
+
+// sorts data[lo, hi) by insertion, spare holds one element
+static void darray_insertion_sort(char* data, size_t lo, size_t hi, size_t elementSize, darray_compare_func compare, char* spare)
+{
+    for (size_t i = lo + 1; i < hi; i++) {
+        size_t j = i;
+        while (j > lo && compare(data + (j - 1) * elementSize, data + i * elementSize) > 0) j--;
+        if (j == i) continue;
+
+        memcpy(spare, data + i * elementSize, elementSize);
+        memmove(data + (j + 1) * elementSize, data + j * elementSize, (i - j) * elementSize);
+        memcpy(data + j * elementSize, spare, elementSize);
+    }
+}
+
+// stable merge of src[lo, mid) and src[mid, hi) into dst[lo, hi)
+static void darray_merge(const char* src, char* dst, size_t lo, size_t mid, size_t hi, size_t elementSize, darray_compare_func compare)
+{
+    size_t i = lo, j = mid, k = lo;
+    while (i < mid && j < hi) {
+        if (compare(src + j * elementSize, src + i * elementSize) < 0) memcpy(dst + (k++) * elementSize, src + (j++) * elementSize, elementSize);
+        else memcpy(dst + (k++) * elementSize, src + (i++) * elementSize, elementSize);
+    }
+
+    memcpy(dst + k * elementSize, src + i * elementSize, (mid - i) * elementSize);
+    k += mid - i;
+    memcpy(dst + k * elementSize, src + j * elementSize, (hi - j) * elementSize);
+}
+
+// stable bottom-up merge sort of data[lo, hi), the result is left in data, scratch is indexed like data
+static void darray_merge_sort(char* data, char* scratch, size_t lo, size_t hi, size_t elementSize, darray_compare_func compare)
+{
+    for (size_t run = lo; run < hi; run += DARRAY_SORT_RUN) {
+        darray_insertion_sort(data, run, hi - run > DARRAY_SORT_RUN ? run + DARRAY_SORT_RUN : hi, elementSize, compare, scratch + lo * elementSize);
+    }
+
+    char* src = data;
+    char* dst = scratch;
+    for (size_t width = DARRAY_SORT_RUN; width < hi - lo; width *= 2) {
+        for (size_t left = lo; left < hi; left += 2 * width) {
+            size_t mid = hi - left > width ? left + width : hi;
+            size_t right = hi - left > 2 * width ? left + 2 * width : hi;
+            darray_merge(src, dst, left, mid, right, elementSize, compare);
+        }
+
+        char* swap = src;
+        src = dst;
+        dst = swap;
+    }
+
+    if (src != data) memcpy(data + lo * elementSize, src + lo * elementSize, (hi - lo) * elementSize);
+}
+
+// swaps two elements, the common sizes move as whole words instead of going through a byte loop
+static inline void darray_swap(char* a, char* b, size_t elementSize)
+{
+    switch (elementSize)
+    {
+        case 4: { uint32_t t; memcpy(&t, a, 4); memcpy(a, b, 4); memcpy(b, &t, 4); return; }
+        case 8: { uint64_t t; memcpy(&t, a, 8); memcpy(a, b, 8); memcpy(b, &t, 8); return; }
+        case 16: { uint64_t t[2]; memcpy(t, a, 16); memcpy(a, b, 16); memcpy(b, t, 16); return; }
+        default: break;
+    }
+
+    size_t i = 0;
+    for (; i + 8 <= elementSize; i += 8) {
+        uint64_t t;
+        memcpy(&t, a + i, 8);
+        memcpy(a + i, b + i, 8);
+        memcpy(b + i, &t, 8);
+    }
+    for (; i < elementSize; i++) {
+        char t = a[i];
+        a[i] = b[i];
+        b[i] = t;
+    }
+}
+
+// heapsort of data[lo, hi), the fallback once quicksort partitions badly too many times
+static void darray_heap_sort(char* data, size_t lo, size_t hi, size_t elementSize, darray_compare_func compare)
+{
+    char* base = data + lo * elementSize;
+    size_t count = hi - lo;
+
+    for (size_t end = count, start = count / 2; end > 1;) {
+        if (start > 0) start--;
+        else darray_swap(base, base + (--end) * elementSize, elementSize);
+
+        // sift the root of the heap [start, end) down
+        size_t root = start;
+        for (size_t child = 2 * root + 1; child < end; child = 2 * root + 1) {
+            if (child + 1 < end && compare(base + child * elementSize, base + (child + 1) * elementSize) < 0) child++;
+            if (compare(base + root * elementSize, base + child * elementSize) >= 0) break;
+
+            darray_swap(base + root * elementSize, base + child * elementSize, elementSize);
+            root = child;
+        }
+    }
+}
+
+// unstable introsort of data[lo, hi): median of three quicksort, heapsort past depth partitions and insertion sort for short ranges
+static void darray_intro_sort(char* data, size_t lo, size_t hi, size_t depth, size_t elementSize, darray_compare_func compare)
+{
+    while (hi - lo > DARRAY_SORT_RUN) {
+        if (depth-- == 0) {
+            darray_heap_sort(data, lo, hi, elementSize, compare);
+            return;
+        }
+
+        // the median of the first, middle and last elements becomes the pivot at lo, the last one bounds the forward scan
+        char* first = data + lo * elementSize;
+        char* middle = data + (lo + (hi - lo) / 2) * elementSize;
+        char* last = data + (hi - 1) * elementSize;
+        if (compare(middle, first) < 0) darray_swap(middle, first, elementSize);
+        if (compare(last, middle) < 0) {
+            darray_swap(last, middle, elementSize);
+            if (compare(middle, first) < 0) darray_swap(middle, first, elementSize);
+        }
+        darray_swap(first, middle, elementSize);
+
+        size_t i = lo + 1, j = hi - 1;
+        for (;;) {
+            while (compare(data + i * elementSize, first) < 0) i++;
+            while (compare(first, data + j * elementSize) < 0) j--;
+            if (i >= j) break;
+
+            darray_swap(data + i * elementSize, data + j * elementSize, elementSize);
+            i++;
+            j--;
+        }
+        darray_swap(first, data + j * elementSize, elementSize);
+
+        // recursing into the smaller side keeps the stack logarithmic
+        if (j - lo < hi - j - 1) {
+            darray_intro_sort(data, lo, j, depth, elementSize, compare);
+            lo = j + 1;
+        }
+        else {
+            darray_intro_sort(data, j + 1, hi, depth, elementSize, compare);
+            hi = j;
+        }
+    }
+
+    for (size_t i = lo + 1; i < hi; i++) {
+        for (size_t j = i; j > lo && compare(data + (j - 1) * elementSize, data + j * elementSize) > 0; j--) {
+            darray_swap(data + (j - 1) * elementSize, data + j * elementSize, elementSize);
+        }
+    }
+}
+
+// a chunk sorted or a pair of chunks merged by darray_parallel_sort
+typedef struct darray_sort_task
+{
+    char* src;
+    char* dst;
+    size_t lo;
+    size_t mid;
+    size_t hi;
+    size_t elementSize;
+    darray_compare_func compare;
+} darray_sort_task;
+
+static ctoolbox_result darray_sort_range(void* context, size_t begin, size_t end)
+{
+    darray_sort_task* tasks = context;
+    for (size_t i = begin; i < end; i++) darray_merge_sort(tasks[i].src, tasks[i].dst, tasks[i].lo, tasks[i].hi, tasks[i].elementSize, tasks[i].compare);
+    return CTOOLBOX_SUCCESS;
+}
+
+static ctoolbox_result darray_merge_range(void* context, size_t begin, size_t end)
+{
+    darray_sort_task* tasks = context;
+    for (size_t i = begin; i < end; i++) darray_merge(tasks[i].src, tasks[i].dst, tasks[i].lo, tasks[i].mid, tasks[i].hi, tasks[i].elementSize, tasks[i].compare);
+    return CTOOLBOX_SUCCESS;
+}
+
+// reads the integer key at the start of element as an unsigned value that orders like the key
+static inline uint64_t darray_radix_key(const char* element, size_t keySize, bool keySigned)
+{
+    uint64_t key = 0;
+    switch (keySize)
+    {
+        case 1: { uint8_t k; memcpy(&k, element, 1); key = k; break; }
+        case 2: { uint16_t k; memcpy(&k, element, 2); key = k; break; }
+        case 4: { uint32_t k; memcpy(&k, element, 4); key = k; break; }
+        default: { memcpy(&key, element, 8); break; }
+    }
+
+    if (keySigned) key ^= (uint64_t)1 << (keySize * 8 - 1);
+    return key;
+}
+
+// drops the elements whose predicate result equals dropWhen, survivors move once, in blocks, keeping their order
+static size_t darray_compact(darray* array, darray_predicate_func predicate, void* user, bool dropWhen)
+{
+    char* data = (char*)array->data;
+    const size_t elementSize = array->elementSize;
+    size_t write = 0;
+    size_t runStart = 0;
+    bool inRun = false;
+
+    // each element is tested once, survivors are moved a whole run at a time when the run ends
+    for (size_t read = 0; read <= array->size; read++) {
+        bool keep = read < array->size && predicate(data + read * elementSize, user) != dropWhen;
+        if (keep == inRun) continue;
+
+        if (keep) runStart = read;
+        else {
+            if (write != runStart) memmove(data + write * elementSize, data + runStart * elementSize, (read - runStart) * elementSize);
+            write += read - runStart;
+        }
+        inRun = keep;
+    }
+
+    size_t removed = array->size - write;
+    array->size = write;
+    return removed;
+}
+
+// what the darray_parallel_* calls hand to each range the pool runs
+typedef struct darray_parallel_context
+{
+    char* data;
+    char* output;
+    size_t size;
+    size_t elementSize;
+    size_t outputElementSize;
+    size_t chunk;
+    char* partials;                 // one element per chunk
+    const void* identity;
+    darray_element_func each;
+    darray_transform_func transform;
+    darray_combine_func combine;
+    void* user;
+} darray_parallel_context;
+
+// whether spreading size elements over the pool pays off
+static inline bool darray_parallel_worth(const threadpool* pool, size_t size)
+{
+    return pool && size >= DARRAY_PARALLEL_THRESHOLD && threadpool_thread_count(pool) > 1;
+}
+
+// half a core's L2 cache of elements, the other half is left to a transform's output and the callback's own data,
+// cut down so every thread of the pool gets a chunk when the array is smaller than that many caches
+static size_t darray_parallel_chunk(const threadpool* pool, size_t size, size_t elementSize)
+{
+    size_t bytes = DARRAY_PARALLEL_CHUNK_BYTES ? DARRAY_PARALLEL_CHUNK_BYTES : cthread_cache_size() / 2;
+    size_t chunk = elementSize >= bytes ? 1 : bytes / elementSize;
+
+    size_t threads = threadpool_thread_count(pool);
+    size_t share = size / threads + (size % threads != 0);
+    return chunk < share ? chunk : share;
+}
+
+static ctoolbox_result darray_each_range(void* context, size_t begin, size_t end)
+{
+    darray_parallel_context* ctx = context;
+    for (size_t i = begin; i < end; i++) ctx->each(ctx->data + i * ctx->elementSize, ctx->user);
+    return CTOOLBOX_SUCCESS;
+}
+
+static ctoolbox_result darray_transform_range(void* context, size_t begin, size_t end)
+{
+    darray_parallel_context* ctx = context;
+    for (size_t i = begin; i < end; i++) {
+        ctx->transform(ctx->data + i * ctx->elementSize, ctx->output + i * ctx->outputElementSize, ctx->user);
+    }
+    return CTOOLBOX_SUCCESS;
+}
+
+// folds each chunk of [begin, end) into its partial
+static ctoolbox_result darray_reduce_range(void* context, size_t begin, size_t end)
+{
+    darray_parallel_context* ctx = context;
+    for (size_t c = begin; c < end; c++) {
+        char* accumulator = ctx->partials + c * ctx->elementSize;
+        size_t first = c * ctx->chunk;
+        size_t last = ctx->size - first < ctx->chunk ? ctx->size : first + ctx->chunk;
+
+        memcpy(accumulator, ctx->identity, ctx->elementSize);
+        for (size_t i = first; i < last; i++) ctx->combine(accumulator, ctx->data + i * ctx->elementSize, ctx->user);
+    }
+    return CTOOLBOX_SUCCESS;
+}
+
+// scans each chunk of [begin, end) in place, starting from its partial which holds the fold of every element before the chunk
+static ctoolbox_result darray_scan_range(void* context, size_t begin, size_t end)
+{
+    darray_parallel_context* ctx = context;
+    for (size_t c = begin; c < end; c++) {
+        char* running = ctx->partials + c * ctx->elementSize;
+        size_t first = c * ctx->chunk;
+        size_t last = ctx->size - first < ctx->chunk ? ctx->size : first + ctx->chunk;
+
+        for (size_t i = first; i < last; i++) {
+            char* element = ctx->data + i * ctx->elementSize;
+            ctx->combine(running, element, ctx->user);
+            memcpy(element, running, ctx->elementSize);
+        }
+    }
+    return CTOOLBOX_SUCCESS;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// external
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+CTOOLBOX_API darray* darray_init(size_t elementSize, size_t initialCapacity)
+{
+    return darray_init_memfuncs(elementSize, initialCapacity, &CTOOLBOX_DEFAULT_MEMFUNCS);
+}
+
+CTOOLBOX_API darray* darray_init_memfuncs(size_t elementSize, size_t initialCapacity, const ctoolbox_memfuncs* memfuncs)
+{
+    return darray_init_aligned(elementSize, initialCapacity, CTOOLBOX_DEFAULT_ALIGNMENT, memfuncs);
+}
+
+CTOOLBOX_API darray* darray_init_aligned(size_t elementSize, size_t initialCapacity, size_t alignment, const ctoolbox_memfuncs* memfuncs)
+{
+    if (elementSize == 0) return NULL;
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0) return NULL;
+    if (alignment < CTOOLBOX_DEFAULT_ALIGNMENT) alignment = CTOOLBOX_DEFAULT_ALIGNMENT;
+
+    darray* outArray = ctoolbox_custom_malloc(memfuncs ? memfuncs : &CTOOLBOX_DEFAULT_MEMFUNCS, sizeof(darray));
+    if (!outArray) return NULL;
+
+    memset(outArray, 0, sizeof(darray));
+    outArray->size = 0;
+    outArray->elementSize = elementSize;
+    outArray->capacity = initialCapacity > 0 ? initialCapacity : 1;
+    outArray->alignment = alignment;
+    outArray->growth = DARRAY_GROWTH_FACTOR;
+    outArray->growthValue = 200;
+
+    if (memfuncs) outArray->memfuncs = *memfuncs;
+    else outArray->memfuncs = CTOOLBOX_DEFAULT_MEMFUNCS;
+
+    if (alignment == CTOOLBOX_DEFAULT_ALIGNMENT) {
+        outArray->data = ctoolbox_custom_calloc(&outArray->memfuncs, outArray->capacity, elementSize);
+    }
+    else if (outArray->capacity <= SIZE_MAX / elementSize) {
+        outArray->data = ctoolbox_custom_aligned_malloc(&outArray->memfuncs, outArray->capacity * elementSize, alignment);
+        if (outArray->data) memset(outArray->data, 0, outArray->capacity * elementSize);
+    }
+
+    if (!outArray->data) {
+        ctoolbox_custom_free_sized(&outArray->memfuncs, outArray, sizeof(darray));
+        return NULL;
+    }
+
+    ctoolbox_memstats_on_alloc(&outArray->stats, sizeof(darray));
+    ctoolbox_memstats_on_alloc(&outArray->stats, outArray->capacity * elementSize);
+
+    return outArray;
+}
+
+CTOOLBOX_API darray* darray_init_inline(size_t elementSize, size_t inlineCapacity, const ctoolbox_memfuncs* memfuncs)
+{
+    if (elementSize == 0 || inlineCapacity == 0) return NULL;
+    if (inlineCapacity > (SIZE_MAX - DARRAY_HEADER_SIZE) / elementSize) return NULL;
+
+    size_t headerBytes = DARRAY_HEADER_SIZE + inlineCapacity * elementSize;
+    darray* outArray = ctoolbox_custom_malloc(memfuncs ? memfuncs : &CTOOLBOX_DEFAULT_MEMFUNCS, headerBytes);
+    if (!outArray) return NULL;
+
+    memset(outArray, 0, headerBytes);
+    outArray->elementSize = elementSize;
+    outArray->alignment = CTOOLBOX_DEFAULT_ALIGNMENT;
+    outArray->growth = DARRAY_GROWTH_FACTOR;
+    outArray->growthValue = 200;
+    outArray->inlineCapacity = inlineCapacity;
+    outArray->capacity = inlineCapacity;
+    outArray->data = darray_inline_data(outArray);
+
+    if (memfuncs) outArray->memfuncs = *memfuncs;
+    else outArray->memfuncs = CTOOLBOX_DEFAULT_MEMFUNCS;
+
+    ctoolbox_memstats_on_alloc(&outArray->stats, headerBytes);
+
+    return outArray;
+}
+
+CTOOLBOX_API void darray_destroy(darray* array)
+{
+    if(!array) return;
+    darray_storage_release(array);
+    ctoolbox_custom_free_sized(&array->memfuncs, array, darray_header_bytes(array));
+}
+
+CTOOLBOX_API ctoolbox_result darray_push_back(darray* array, const void* element)
+{
+    if (!array) return CTOOLBOX_ERROR_INVALID_PARAM;
+
+    // ensure capacity
+    if (array->size >= array->capacity) {
+        ctoolbox_result res = darray_grow(array, array->size + 1);
+        if (res != CTOOLBOX_SUCCESS) return res;
+    }
+
+    // add new element
+    memcpy((char*)array->data + (array->size * array->elementSize), element, array->elementSize);
+    array->size++;
+
+    return CTOOLBOX_SUCCESS;
+}
+
+CTOOLBOX_API ctoolbox_result darray_pop_back(darray* array, void* elementOut)
+{
+    if (!array || array->size == 0) return CTOOLBOX_ERROR_EMPTY;
+    if (elementOut) memcpy(elementOut, (char*)array->data + ((array->size - 1) * array->elementSize), array->elementSize);
+
+    array->size--;
+    return CTOOLBOX_SUCCESS;
+}
+
+CTOOLBOX_API void* darray_emplace_back(darray* array)
+{
+    return darray_emplace_back_n(array, 1);
+}
+
+CTOOLBOX_API void* darray_emplace_back_n(darray* array, size_t count)
+{
+    if (!array || count == 0 || count > SIZE_MAX - array->size) return NULL;
+    if (darray_grow(array, array->size + count) != CTOOLBOX_SUCCESS) return NULL;
+
+    void* slot = (char*)array->data + (array->size * array->elementSize);
+    array->size += count;
+    return slot;
+}
+
+CTOOLBOX_API void* darray_emplace_at(darray* array, size_t index)
+{
+    if (!array || index > array->size) return NULL;
+    if (darray_grow(array, array->size + 1) != CTOOLBOX_SUCCESS) return NULL;
+
+    // shift elements to make space
+    char* data = (char*)array->data;
+    if (index < array->size) {
+        memmove(data + ((index + 1) * array->elementSize), data + (index * array->elementSize), (array->size - index) * array->elementSize);
+    }
+
+    array->size++;
+    return data + (index * array->elementSize);
+}
+
+CTOOLBOX_API void* darray_peek(darray* array, size_t index)
+{
+    if (!array || index >= array->size || darray_make_writable(array) != CTOOLBOX_SUCCESS) return NULL;
+    return (char*)array->data + (index * array->elementSize);
+}
+
+CTOOLBOX_API void* darray_data(darray* array)
+{
+    if (!array || darray_make_writable(array) != CTOOLBOX_SUCCESS) return NULL;
+    return array->data;
+}
+
+CTOOLBOX_API const void* darray_const_peek(const darray* array, size_t index)
+{
+    if (!array || index >= array->size) return NULL;
+    return (char*)array->data + (index * array->elementSize);
+}
+
+CTOOLBOX_API const void* darray_const_data(const darray* array)
+{
+    return array ? array->data : NULL;
+}
+
+CTOOLBOX_API ctoolbox_result darray_get(const darray *array, size_t index, void* elementOut)
+ {
+    if (!array || !elementOut || index >= array->size) return CTOOLBOX_ERROR_INVALID_PARAM;
+    memcpy(elementOut, (char*)array->data + (index * array->elementSize), array->elementSize);
+    return CTOOLBOX_SUCCESS;
+}
+
+CTOOLBOX_API ctoolbox_result darray_set(darray* array, size_t index, const void* element)
+ {
+    if (!array || !element || index >= array->size) return CTOOLBOX_ERROR_INVALID_PARAM;
+
+    ctoolbox_result res = darray_make_writable(array);
+    if (res != CTOOLBOX_SUCCESS) return res;
+
+    memcpy((char*)array->data + (index * array->elementSize), element, array->elementSize);
+    return CTOOLBOX_SUCCESS;
+}
+
+CTOOLBOX_API ctoolbox_result darray_insert_at(darray* array, size_t index, const void* element)
+{
+    if (!array || !element || index > array->size) return CTOOLBOX_ERROR_INVALID_PARAM;
+
+    // ensure capacity
+    if (array->size >= array->capacity) {
+        ctoolbox_result result = darray_grow(array, array->size + 1);
+        if (result != CTOOLBOX_SUCCESS) return result;
+    }
+
+    // shift elements to make space
+    if (index < array->size) {
+        char* data = (char*)array->data;
+        memmove(data + ((index + 1) * array->elementSize), data + (index * array->elementSize), (array->size - index) * array->elementSize);
+    }
+
+    // insert new element
+    memcpy((char*)array->data + (index * array->elementSize), element, array->elementSize);
+    array->size++;
+    return CTOOLBOX_SUCCESS;
+}
+
+CTOOLBOX_API ctoolbox_result darray_remove_at(darray* array, size_t index, void* elementOut)
+{
+    if (!array || index >= array->size) {
+        return CTOOLBOX_ERROR_INVALID_PARAM;
+    }
+
+    if (array->size == 0) {
+        return CTOOLBOX_ERROR_EMPTY;
+    }
+
+    ctoolbox_result res = darray_make_writable(array);
+    if (res != CTOOLBOX_SUCCESS) return res;
+
+    // if the caller wants the removed element, copy it first
+    if (elementOut) {
+        memcpy(elementOut, (char*)array->data + (index * array->elementSize), array->elementSize);
+    }
+
+    // shift elements left to overwrite the removed element
+    if (index < array->size - 1) {
+        char* data = (char*)array->data;
+        memmove(data + (index * array->elementSize), data + ((index + 1) * array->elementSize), (array->size - index - 1) * array->elementSize);
+    }
+
+    array->size--;
+    return CTOOLBOX_SUCCESS;
+}
+
+CTOOLBOX_API ctoolbox_result darray_swap_remove(darray* array, size_t index, void* elementOut)
+{
+    if (!array || index >= array->size) return CTOOLBOX_ERROR_INVALID_PARAM;
+
+    ctoolbox_result res = darray_make_writable(array);
+    if (res != CTOOLBOX_SUCCESS) return res;
+
+    char* data = (char*)array->data;
+    if (elementOut) memcpy(elementOut, data + (index * array->elementSize), array->elementSize);
+
+    // the last element fills the hole
+    if (index < array->size - 1) memcpy(data + (index * array->elementSize), data + ((array->size - 1) * array->elementSize), array->elementSize);
+
+    array->size--;
+    return CTOOLBOX_SUCCESS;
+}
+
+CTOOLBOX_API size_t darray_remove_if(darray* array, darray_predicate_func predicate, void* user)
+{
+    if (!array || !predicate || darray_make_writable(array) != CTOOLBOX_SUCCESS) return 0;
+    return darray_compact(array, predicate, user, true);
+}
+
+CTOOLBOX_API size_t darray_retain(darray* array, darray_predicate_func predicate, void* user)
+{
+    if (!array || !predicate || darray_make_writable(array) != CTOOLBOX_SUCCESS) return 0;
+    return darray_compact(array, predicate, user, false);
+}
+
+CTOOLBOX_API ctoolbox_result darray_append(darray* array, const void* elements, size_t count)
+{
+    if (!array || (!elements && count > 0)) return CTOOLBOX_ERROR_INVALID_PARAM;
+    if (count == 0) return CTOOLBOX_SUCCESS;
+    if (count > SIZE_MAX - array->size) return CTOOLBOX_ERROR_MEMORY_ALLOC;
+
+    // elements may come from the array itself, which growing could move
+    const char* data = (const char*)array->data;
+    bool fromSelf = data && (const char*)elements >= data && (const char*)elements < data + array->size * array->elementSize;
+    size_t selfOffset = fromSelf ? (size_t)((const char*)elements - data) : 0;
+
+    ctoolbox_result result = darray_grow(array, array->size + count);
+    if (result != CTOOLBOX_SUCCESS) return result;
+
+    if (fromSelf) elements = (const char*)array->data + selfOffset;
+    memcpy((char*)array->data + (array->size * array->elementSize), elements, count * array->elementSize);
+    array->size += count;
+
+    return CTOOLBOX_SUCCESS;
+}
+
+CTOOLBOX_API ctoolbox_result darray_append_darray(darray* array, const darray* other)
+{
+    if (!array || !other || array->elementSize != other->elementSize) return CTOOLBOX_ERROR_INVALID_PARAM;
+    return darray_append(array, other->data, other->size);
+}
+
+CTOOLBOX_API ctoolbox_result darray_insert_range(darray* array, size_t index, const void* elements, size_t count)
+{
+    if (!array || (!elements && count > 0) || index > array->size) return CTOOLBOX_ERROR_INVALID_PARAM;
+    if (count == 0) return CTOOLBOX_SUCCESS;
+    if (count > SIZE_MAX - array->size) return CTOOLBOX_ERROR_MEMORY_ALLOC;
+
+    ctoolbox_result result = darray_grow(array, array->size + count);
+    if (result != CTOOLBOX_SUCCESS) return result;
+
+    // shift the tail once to make space for the whole block
+    char* data = (char*)array->data;
+    if (index < array->size) {
+        memmove(data + ((index + count) * array->elementSize), data + (index * array->elementSize), (array->size - index) * array->elementSize);
+    }
+
+    memcpy(data + (index * array->elementSize), elements, count * array->elementSize);
+    array->size += count;
+    return CTOOLBOX_SUCCESS;
+}
+
+CTOOLBOX_API ctoolbox_result darray_remove_range(darray* array, size_t index, size_t count, void* elementsOut)
+{
+    if (!array || index > array->size || count > array->size - index) return CTOOLBOX_ERROR_INVALID_PARAM;
+    if (count == 0) return CTOOLBOX_SUCCESS;
+
+    ctoolbox_result res = darray_make_writable(array);
+    if (res != CTOOLBOX_SUCCESS) return res;
+
+    char* data = (char*)array->data;
+    if (elementsOut) memcpy(elementsOut, data + (index * array->elementSize), count * array->elementSize);
+
+    // shift the tail once over the removed block
+    size_t tail = array->size - index - count;
+    if (tail > 0) {
+        memmove(data + (index * array->elementSize), data + ((index + count) * array->elementSize), tail * array->elementSize);
+    }
+
+    array->size -= count;
+    return CTOOLBOX_SUCCESS;
+}
+
+CTOOLBOX_API ctoolbox_result darray_resize(darray* array, size_t newSize)
+{
+    if (!array) return CTOOLBOX_ERROR_INVALID_PARAM;
+    if (newSize > array->capacity) {
+        ctoolbox_result res = darray_reserve(array, newSize);
+        if (res != CTOOLBOX_SUCCESS) return res;
+    }
+    
+    array->size = newSize;
+    return CTOOLBOX_SUCCESS;
+}
+
+CTOOLBOX_API ctoolbox_result darray_reserve(darray* array, size_t newCapacity)
+{
+    if (!array) return CTOOLBOX_ERROR_INVALID_PARAM;
+    if (newCapacity <= array->capacity) return CTOOLBOX_SUCCESS;
+
+    // a read-only map holds more elements than its capacity, none of them may be dropped
+    if (newCapacity < array->size) newCapacity = array->size;
+    if (newCapacity > SIZE_MAX / array->elementSize) return CTOOLBOX_ERROR_MEMORY_ALLOC;
+
+#if defined(DARRAY_MREMAP)
+    if (array->mappedBytes > 0 || (array->mapThreshold > 0 && newCapacity * array->elementSize > array->mapThreshold && array->alignment <= darray_page_size())) {
+        return darray_map_reserve(array, newCapacity);
+    }
+#endif
+
+    // inline and file storage can't be reallocated, the elements spill to the heap instead
+    if (darray_is_inline(array) || array->file) {
+        void* newData = ctoolbox_custom_aligned_malloc(&array->memfuncs, newCapacity * array->elementSize, array->alignment);
+        if (!newData) return CTOOLBOX_ERROR_MEMORY_ALLOC;
+
+        memcpy(newData, array->data, array->size * array->elementSize);
+        darray_storage_release(array);
+        ctoolbox_memstats_on_alloc(&array->stats, newCapacity * array->elementSize);
+        array->data = newData;
+        array->capacity = newCapacity;
+        return CTOOLBOX_SUCCESS;
+    }
+
+    // realloc when the allocator has it, otherwise allocate, copy and free, always keeping the alignment
+    size_t oldSizeBytes = array->capacity * array->elementSize;
+    void* newData = ctoolbox_custom_aligned_realloc(&array->memfuncs, array->data, oldSizeBytes, newCapacity * array->elementSize, array->alignment);
+    if (!newData) return CTOOLBOX_ERROR_MEMORY_ALLOC;
+
+    if (array->data) ctoolbox_memstats_on_realloc(&array->stats, oldSizeBytes, newCapacity * array->elementSize);
+    else ctoolbox_memstats_on_alloc(&array->stats, newCapacity * array->elementSize);
+
+    array->data = newData;
+    array->capacity = newCapacity;
+
+    return CTOOLBOX_SUCCESS;
+}
+
+CTOOLBOX_API ctoolbox_result darray_shrink_to_fit(darray* array)
+{
+    if (!array) return CTOOLBOX_ERROR_INVALID_PARAM;
+    if (array->size == array->capacity || darray_is_inline(array) || array->file) return CTOOLBOX_SUCCESS;
+
+    // elements that fit move back into the inline storage
+    if (array->inlineCapacity > 0 && array->size <= array->inlineCapacity) {
+        void* inlineData = darray_inline_data(array);
+        memcpy(inlineData, array->data, array->size * array->elementSize);
+        darray_storage_release(array);
+        array->data = inlineData;
+        array->capacity = array->inlineCapacity;
+        return CTOOLBOX_SUCCESS;
+    }
+
+    if (array->size == 0) {
+        darray_storage_release(array);
+        array->data = NULL;
+        array->capacity = 0;
+        return CTOOLBOX_SUCCESS;
+    }
+
+#if defined(DARRAY_MREMAP)
+    // mappings shrink in place down to whole pages
+    if (array->mappedBytes > 0) {
+        if (darray_page_round(array->size * array->elementSize, darray_page_size()) == array->mappedBytes) return CTOOLBOX_SUCCESS;
+        return darray_map_reserve(array, array->size);
+    }
+#endif
+
+    void* newData = ctoolbox_custom_aligned_malloc(&array->memfuncs, array->size * array->elementSize, array->alignment);
+    if (!newData) return CTOOLBOX_ERROR_MEMORY_ALLOC;
+
+    memcpy(newData, array->data, array->size * array->elementSize);
+    ctoolbox_custom_aligned_free_sized(&array->memfuncs, array->data, array->capacity * array->elementSize, array->alignment);
+    ctoolbox_memstats_on_alloc(&array->stats, array->size * array->elementSize);
+    ctoolbox_memstats_on_free(&array->stats, array->capacity * array->elementSize);
+    array->data = newData;
+    array->capacity = array->size;
+    return CTOOLBOX_SUCCESS;
+}
+
+CTOOLBOX_API size_t darray_size(const darray* array)
+ {
+    return array ? array->size : 0;
+}
+
+CTOOLBOX_API size_t darray_capacity(const darray* array)
+ {
+    return array ? array->capacity : 0;
+}
+
+CTOOLBOX_API bool darray_empty(const darray *array)
+ {
+    return array ? (array->size == 0) : true;
+}
+
+CTOOLBOX_API size_t darray_alignment(const darray* array)
+{
+    return array ? array->alignment : 0;
+}
+
+CTOOLBOX_API ctoolbox_result darray_set_growth(darray* array, darray_growth policy, size_t value)
+{
+    if (!array) return CTOOLBOX_ERROR_INVALID_PARAM;
+    if (policy == DARRAY_GROWTH_FACTOR && value <= 100) return CTOOLBOX_ERROR_INVALID_PARAM;
+    if (policy == DARRAY_GROWTH_LINEAR && value == 0) return CTOOLBOX_ERROR_INVALID_PARAM;
+    if (policy != DARRAY_GROWTH_FACTOR && policy != DARRAY_GROWTH_LINEAR && policy != DARRAY_GROWTH_PAGE) return CTOOLBOX_ERROR_INVALID_PARAM;
+
+    array->growth = policy;
+    array->growthValue = value;
+    return CTOOLBOX_SUCCESS;
+}
+
+CTOOLBOX_API ctoolbox_result darray_set_mapped(darray* array, size_t thresholdBytes)
+{
+    if (!array) return CTOOLBOX_ERROR_INVALID_PARAM;
+
+#if defined(DARRAY_MREMAP)
+    array->mapThreshold = thresholdBytes;
+    return CTOOLBOX_SUCCESS;
+#else
+    (void)thresholdBytes;
+    return CTOOLBOX_ERROR_UNSUPPORTED;
+#endif
+}
+
+CTOOLBOX_API ctoolbox_result darray_sort(darray* array, darray_compare_func compare)
+{
+    if (!array || !compare) return CTOOLBOX_ERROR_INVALID_PARAM;
+
+    ctoolbox_result res = darray_make_writable(array);
+    if (res != CTOOLBOX_SUCCESS) return res;
+
+    size_t depth = 0;
+    for (size_t n = array->size; n > 1; n >>= 1) depth += 2;
+    darray_intro_sort((char*)array->data, 0, array->size, depth, array->elementSize, compare);
+    return CTOOLBOX_SUCCESS;
+}
+
+CTOOLBOX_API ctoolbox_result darray_stable_sort(darray* array, darray_compare_func compare)
+{
+    if (!array || !compare) return CTOOLBOX_ERROR_INVALID_PARAM;
+    if (array->size < 2) return CTOOLBOX_SUCCESS;
+
+    ctoolbox_result res = darray_make_writable(array);
+    if (res != CTOOLBOX_SUCCESS) return res;
+
+    size_t bytes = array->size * array->elementSize;
+    char* scratch = darray_scratch_alloc(array, bytes);
+    if (!scratch) return CTOOLBOX_ERROR_MEMORY_ALLOC;
+
+    darray_merge_sort((char*)array->data, scratch, 0, array->size, array->elementSize, compare);
+    darray_scratch_free(array, scratch, bytes);
+    return CTOOLBOX_SUCCESS;
+}
+
+CTOOLBOX_API ctoolbox_result darray_parallel_sort(darray* array, threadpool* pool, darray_compare_func compare)
+{
+    if (!array || !compare) return CTOOLBOX_ERROR_INVALID_PARAM;
+
+    // a chunk per thread of the pool
+    size_t chunks = pool ? threadpool_thread_count(pool) : 1;
+    if (chunks > DARRAY_SORT_MAX_THREADS) chunks = DARRAY_SORT_MAX_THREADS;
+    if (chunks > array->size / DARRAY_SORT_RUN) chunks = array->size / DARRAY_SORT_RUN;
+    if (chunks < 2 || array->size < DARRAY_PARALLEL_SORT_THRESHOLD) return darray_stable_sort(array, compare);
+
+    ctoolbox_result res = darray_make_writable(array);
+    if (res != CTOOLBOX_SUCCESS) return res;
+
+    size_t bytes = array->size * array->elementSize;
+    char* scratch = darray_scratch_alloc(array, bytes);
+    if (!scratch) return CTOOLBOX_ERROR_MEMORY_ALLOC;
+
+    // every chunk is sorted on its own
+    size_t bounds[DARRAY_SORT_MAX_THREADS + 1];
+    darray_sort_task tasks[DARRAY_SORT_MAX_THREADS];
+    for (size_t i = 0; i <= chunks; i++) bounds[i] = array->size / chunks * i + (array->size % chunks) * i / chunks;
+
+    for (size_t i = 0; i < chunks; i++) {
+        darray_sort_task task = { (char*)array->data, scratch, bounds[i], bounds[i], bounds[i + 1], array->elementSize, compare };
+        tasks[i] = task;
+    }
+    res = threadpool_parallel_for(pool, chunks, 1, darray_sort_range, tasks);
+
+    // then adjacent chunks are merged pairwise, each pass halving the chunk count
+    char* src = (char*)array->data;
+    char* dst = scratch;
+    while (res == CTOOLBOX_SUCCESS && chunks > 1) {
+        size_t pairs = chunks / 2;
+        for (size_t i = 0; i < pairs; i++) {
+            darray_sort_task task = { src, dst, bounds[2 * i], bounds[2 * i + 1], bounds[2 * i + 2], array->elementSize, compare };
+            tasks[i] = task;
+        }
+
+        // an odd chunk out is carried over as is
+        if (chunks % 2) {
+            darray_sort_task task = { src, dst, bounds[chunks - 1], bounds[chunks], bounds[chunks], array->elementSize, compare };
+            tasks[pairs] = task;
+        }
+        res = threadpool_parallel_for(pool, pairs + chunks % 2, 1, darray_merge_range, tasks);
+        if (res != CTOOLBOX_SUCCESS) break;
+
+        for (size_t i = 0; i <= pairs; i++) bounds[i] = bounds[2 * i < chunks ? 2 * i : chunks];
+        bounds[pairs + chunks % 2] = array->size;
+        chunks = pairs + chunks % 2;
+
+        char* swap = src;
+        src = dst;
+        dst = swap;
+    }
+
+    // src holds every element even when a pass failed, only the order is lost
+    if (src != array->data) memcpy(array->data, src, bytes);
+    darray_scratch_free(array, scratch, bytes);
+    return res;
+}
+
+CTOOLBOX_API ctoolbox_result darray_radix_sort(darray* array, size_t keyOffset, size_t keySize, bool keySigned)
+{
+    if (!array) return CTOOLBOX_ERROR_INVALID_PARAM;
+    if (keySize != 1 && keySize != 2 && keySize != 4 && keySize != 8) return CTOOLBOX_ERROR_INVALID_PARAM;
+    if (keyOffset > array->elementSize || keySize > array->elementSize - keyOffset) return CTOOLBOX_ERROR_INVALID_PARAM;
+    if (array->size < 2) return CTOOLBOX_SUCCESS;
+
+    ctoolbox_result res = darray_make_writable(array);
+    if (res != CTOOLBOX_SUCCESS) return res;
+
+    // a single pass histograms every byte of the key
+    size_t counts[8][256];
+    memset(counts, 0, sizeof(counts[0]) * keySize);
+
+    const size_t elementSize = array->elementSize;
+    const char* data = (const char*)array->data;
+    for (size_t i = 0; i < array->size; i++) {
+        uint64_t key = darray_radix_key(data + i * elementSize + keyOffset, keySize, keySigned);
+        for (size_t b = 0; b < keySize; b++) counts[b][(key >> (b * 8)) & 0xff]++;
+    }
+
+    size_t bytes = array->size * elementSize;
+    char* scratch = NULL;
+    char* src = (char*)array->data;
+    char* dst = NULL;
+
+    for (size_t b = 0; b < keySize; b++) {
+        // bytes every key shares don't reorder anything
+        size_t offsets[256];
+        size_t total = 0;
+        bool skip = false;
+        for (size_t d = 0; d < 256; d++) {
+            if (counts[b][d] == array->size) skip = true;
+            offsets[d] = total;
+            total += counts[b][d];
+        }
+        if (skip) continue;
+
+        if (!scratch) {
+            scratch = darray_scratch_alloc(array, bytes);
+            if (!scratch) return CTOOLBOX_ERROR_MEMORY_ALLOC;
+            dst = scratch;
+        }
+
+        for (size_t i = 0; i < array->size; i++) {
+            const char* element = src + i * elementSize;
+            size_t digit = (darray_radix_key(element + keyOffset, keySize, keySigned) >> (b * 8)) & 0xff;
+            memcpy(dst + (offsets[digit]++) * elementSize, element, elementSize);
+        }
+
+        char* swap = src;
+        src = dst;
+        dst = swap;
+    }
+
+    if (!scratch) return CTOOLBOX_SUCCESS;
+    if (src != array->data) memcpy(array->data, src, bytes);
+    darray_scratch_free(array, scratch, bytes);
+    return CTOOLBOX_SUCCESS;
+}
+
+CTOOLBOX_API size_t darray_lower_bound(const darray* array, const void* key, darray_compare_func compare)
+{
+    if (!array || !key || !compare) return 0;
+
+    size_t lo = 0, hi = array->size;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (compare((const char*)array->data + mid * array->elementSize, key) < 0) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+CTOOLBOX_API size_t darray_upper_bound(const darray* array, const void* key, darray_compare_func compare)
+{
+    if (!array || !key || !compare) return 0;
+
+    size_t lo = 0, hi = array->size;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (compare((const char*)array->data + mid * array->elementSize, key) <= 0) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+CTOOLBOX_API ctoolbox_result darray_binary_search(const darray* array, const void* key, darray_compare_func compare, size_t* indexOut)
+{
+    if (!array || !key || !compare) return CTOOLBOX_ERROR_INVALID_PARAM;
+
+    size_t index = darray_lower_bound(array, key, compare);
+    if (index == array->size || compare((const char*)array->data + index * array->elementSize, key) != 0) return CTOOLBOX_ERROR_NOT_FOUND;
+
+    if (indexOut) *indexOut = index;
+    return CTOOLBOX_SUCCESS;
+}
+
+CTOOLBOX_API ctoolbox_result darray_find(const darray* array, const void* value, size_t* indexOut)
+{
+    if (!array || !value) return CTOOLBOX_ERROR_INVALID_PARAM;
+
+    size_t index = csimd_find(array->data, array->size, array->elementSize, value);
+    if (index == array->size) return CTOOLBOX_ERROR_NOT_FOUND;
+
+    if (indexOut) *indexOut = index;
+    return CTOOLBOX_SUCCESS;
+}
+
+CTOOLBOX_API size_t darray_count(const darray* array, const void* value)
+{
+    if (!array || !value) return 0;
+    return csimd_count(array->data, array->size, array->elementSize, value);
+}
+
+CTOOLBOX_API bool darray_contains(const darray* array, const void* value)
+{
+    if (!array || !value) return false;
+    return csimd_find(array->data, array->size, array->elementSize, value) < array->size;
+}
+
+CTOOLBOX_API ctoolbox_result darray_fill(darray* array, const void* value)
+{
+    if (!array || !value) return CTOOLBOX_ERROR_INVALID_PARAM;
+
+    ctoolbox_result res = darray_make_writable(array);
+    if (res != CTOOLBOX_SUCCESS) return res;
+
+    csimd_fill(array->data, array->size, array->elementSize, value);
+    return CTOOLBOX_SUCCESS;
+}
+
+CTOOLBOX_API bool darray_equal(const darray* a, const darray* b)
+{
+    if (!a || !b) return a == b;
+    if (a->elementSize != b->elementSize || a->size != b->size) return false;
+    return csimd_equal(a->data, b->data, a->size * a->elementSize);
+}
+
+CTOOLBOX_API ctoolbox_result darray_parallel_for_each(darray* array, threadpool* pool, darray_element_func func, void* user)
+{
+    if (!array || !func) return CTOOLBOX_ERROR_INVALID_PARAM;
+
+    ctoolbox_result res = darray_make_writable(array);
+    if (res != CTOOLBOX_SUCCESS) return res;
+
+    darray_parallel_context ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.data = (char*)array->data;
+    ctx.elementSize = array->elementSize;
+    ctx.each = func;
+    ctx.user = user;
+
+    if (!darray_parallel_worth(pool, array->size)) return darray_each_range(&ctx, 0, array->size);
+    return threadpool_parallel_for(pool, array->size, darray_parallel_chunk(pool, array->size, array->elementSize), darray_each_range, &ctx);
+}
+
+CTOOLBOX_API ctoolbox_result darray_parallel_transform(const darray* source, darray* destination, threadpool* pool, darray_transform_func func, void* user)
+{
+    if (!source || !destination || !func) return CTOOLBOX_ERROR_INVALID_PARAM;
+
+    ctoolbox_result res = darray_resize(destination, source->size);
+    if (res != CTOOLBOX_SUCCESS) return res;
+
+    darray_parallel_context ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.data = (char*)source->data;
+    ctx.output = (char*)destination->data;
+    ctx.elementSize = source->elementSize;
+    ctx.outputElementSize = destination->elementSize;
+    ctx.transform = func;
+    ctx.user = user;
+
+    if (!darray_parallel_worth(pool, source->size)) return darray_transform_range(&ctx, 0, source->size);
+
+    // chunks are sized on the wider of the two element types so both sides stay cached
+    size_t widest = source->elementSize > destination->elementSize ? source->elementSize : destination->elementSize;
+    return threadpool_parallel_for(pool, source->size, darray_parallel_chunk(pool, source->size, widest), darray_transform_range, &ctx);
+}
+
+CTOOLBOX_API ctoolbox_result darray_parallel_reduce(const darray* array, threadpool* pool, const void* identity, darray_combine_func combine, void* user, void* resultOut)
+{
+    if (!array || !identity || !combine || !resultOut) return CTOOLBOX_ERROR_INVALID_PARAM;
+
+    darray_parallel_context ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.data = (char*)array->data;
+    ctx.size = array->size;
+    ctx.elementSize = array->elementSize;
+    ctx.identity = identity;
+    ctx.combine = combine;
+    ctx.user = user;
+
+    // a single chunk folds straight into the result
+    if (!darray_parallel_worth(pool, array->size)) {
+        ctx.chunk = array->size;
+        ctx.partials = resultOut;
+        return darray_reduce_range(&ctx, 0, 1);
+    }
+
+    ctx.chunk = darray_parallel_chunk(pool, array->size, array->elementSize);
+    size_t chunkCount = array->size / ctx.chunk + (array->size % ctx.chunk != 0);
+    size_t bytes = chunkCount * array->elementSize;
+
+    // the partials aren't charged to the array's stats, a const array may be reduced from several threads at once
+    ctx.partials = ctoolbox_custom_aligned_malloc(&array->memfuncs, bytes, array->alignment);
+    if (!ctx.partials) return CTOOLBOX_ERROR_MEMORY_ALLOC;
+
+    ctoolbox_result res = threadpool_parallel_for(pool, chunkCount, 1, darray_reduce_range, &ctx);
+    if (res == CTOOLBOX_SUCCESS) {
+        memcpy(resultOut, identity, array->elementSize);
+        for (size_t c = 0; c < chunkCount; c++) combine(resultOut, ctx.partials + c * array->elementSize, user);
+    }
+
+    ctoolbox_custom_aligned_free_sized(&array->memfuncs, ctx.partials, bytes, array->alignment);
+    return res;
+}
+
+CTOOLBOX_API ctoolbox_result darray_parallel_scan(darray* array, threadpool* pool, const void* identity, darray_combine_func combine, void* user)
+{
+    if (!array || !identity || !combine) return CTOOLBOX_ERROR_INVALID_PARAM;
+    if (array->size == 0) return CTOOLBOX_SUCCESS;
+
+    ctoolbox_result res = darray_make_writable(array);
+    if (res != CTOOLBOX_SUCCESS) return res;
+
+    darray_parallel_context ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.data = (char*)array->data;
+    ctx.size = array->size;
+    ctx.elementSize = array->elementSize;
+    ctx.identity = identity;
+    ctx.combine = combine;
+    ctx.user = user;
+
+    bool parallel = darray_parallel_worth(pool, array->size);
+    ctx.chunk = parallel ? darray_parallel_chunk(pool, array->size, array->elementSize) : array->size;
+    size_t chunkCount = array->size / ctx.chunk + (array->size % ctx.chunk != 0);
+
+    // a partial per chunk plus the running carry and a spare element
+    size_t bytes = (chunkCount + 2) * array->elementSize;
+    ctx.partials = darray_scratch_alloc(array, bytes);
+    if (!ctx.partials) return CTOOLBOX_ERROR_MEMORY_ALLOC;
+
+    if (parallel) {
+        // first pass: each chunk's own fold, then serially what comes before each chunk
+        res = threadpool_parallel_for(pool, chunkCount, 1, darray_reduce_range, &ctx);
+        if (res != CTOOLBOX_SUCCESS) {
+            darray_scratch_free(array, ctx.partials, bytes);
+            return res;
+        }
+
+        char* carry = ctx.partials + chunkCount * array->elementSize;
+        char* total = carry + array->elementSize;
+        memcpy(carry, identity, array->elementSize);
+        for (size_t c = 0; c < chunkCount; c++) {
+            char* partial = ctx.partials + c * array->elementSize;
+            memcpy(total, partial, array->elementSize);
+            memcpy(partial, carry, array->elementSize);
+            combine(carry, total, user);
+        }
+
+        // second pass: every chunk scanned from its carry
+        res = threadpool_parallel_for(pool, chunkCount, 1, darray_scan_range, &ctx);
+    }
+    else {
+        memcpy(ctx.partials, identity, array->elementSize);
+        res = darray_scan_range(&ctx, 0, 1);
+    }
+
+    darray_scratch_free(array, ctx.partials, bytes);
+    return res;
+}
+
+CTOOLBOX_API ctoolbox_result darray_save(const darray* array, const char* path)
+{
+    if (!array || !path) return CTOOLBOX_ERROR_INVALID_PARAM;
+
+    darray_file_header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, DARRAY_FILE_MAGIC, sizeof(header.magic));
+    header.version = DARRAY_FILE_VERSION;
+    header.byteOrder = DARRAY_FILE_BYTE_ORDER;
+    header.elementSize = array->elementSize;
+    header.size = array->size;
+    header.alignment = array->alignment;
+
+    size_t dataAlignment = array->alignment > 64 ? array->alignment : 64;
+    header.dataOffset = (sizeof(header) + dataAlignment - 1) & ~(uint64_t)(dataAlignment - 1);
+
+    // the elements go to a file next to path that replaces it once complete, a failed save leaves path as it was
+    size_t pathLength = strlen(path);
+    size_t tempBytes = pathLength + sizeof(DARRAY_FILE_TEMP_SUFFIX);
+    char* tempPath = ctoolbox_custom_malloc(&array->memfuncs, tempBytes);
+    if (!tempPath) return CTOOLBOX_ERROR_MEMORY_ALLOC;
+
+    memcpy(tempPath, path, pathLength);
+    memcpy(tempPath + pathLength, DARRAY_FILE_TEMP_SUFFIX, sizeof(DARRAY_FILE_TEMP_SUFFIX));
+
+    FILE* file = fopen(tempPath, "wb");
+    bool written = file != NULL;
+    if (written) {
+        written = fwrite(&header, sizeof(header), 1, file) == 1;
+        for (size_t i = sizeof(header); written && i < header.dataOffset; i++) written = fputc(0, file) != EOF;
+        if (written && array->size > 0) written = fwrite(array->data, array->elementSize, array->size, file) == array->size;
+        if (fclose(file) != 0) written = false;
+
+        if (written) written = darray_file_replace(tempPath, path);
+        if (!written) remove(tempPath);
+    }
+
+    ctoolbox_custom_free_sized(&array->memfuncs, tempPath, tempBytes);
+    return written ? CTOOLBOX_SUCCESS : CTOOLBOX_ERROR_IO;
+}
+
+CTOOLBOX_API darray* darray_open_mapped(const char* path, darray_map_mode mode, const ctoolbox_memfuncs* memfuncs)
+{
+    if (!path) return NULL;
+
+    size_t fileBytes = 0;
+    char* file = darray_file_map(path, mode == DARRAY_MAP_COPY_ON_WRITE, &fileBytes);
+    if (!file) return NULL;
+
+    // nothing is deserialised, the header is only checked against the file
+    darray_file_header header;
+    bool valid = fileBytes >= sizeof(header);
+    if (valid) {
+        memcpy(&header, file, sizeof(header));
+        valid = memcmp(header.magic, DARRAY_FILE_MAGIC, sizeof(header.magic)) == 0 && header.version == DARRAY_FILE_VERSION && header.byteOrder == DARRAY_FILE_BYTE_ORDER;
+    }
+    if (valid) {
+        valid = header.elementSize > 0 && header.alignment > 0 && (header.alignment & (header.alignment - 1)) == 0 && header.alignment <= SIZE_MAX
+            && header.dataOffset >= sizeof(header) && header.dataOffset <= fileBytes && header.dataOffset % header.alignment == 0
+            && header.size <= (fileBytes - header.dataOffset) / header.elementSize
+            && ((uintptr_t)(file + header.dataOffset) & (uintptr_t)(header.alignment - 1)) == 0;
+    }
+
+    darray* outArray = valid ? ctoolbox_custom_malloc(memfuncs ? memfuncs : &CTOOLBOX_DEFAULT_MEMFUNCS, sizeof(darray)) : NULL;
+    if (!outArray) {
+        darray_file_unmap(file, fileBytes);
+        return NULL;
+    }
+
+    memset(outArray, 0, sizeof(darray));
+    outArray->data = file + header.dataOffset;
+    outArray->size = (size_t)header.size;
+    outArray->capacity = mode == DARRAY_MAP_COPY_ON_WRITE ? (size_t)header.size : 0;
+    outArray->elementSize = (size_t)header.elementSize;
+    outArray->alignment = header.alignment > CTOOLBOX_DEFAULT_ALIGNMENT ? (size_t)header.alignment : CTOOLBOX_DEFAULT_ALIGNMENT;
+    outArray->growth = DARRAY_GROWTH_FACTOR;
+    outArray->growthValue = 200;
+    outArray->file = file;
+    outArray->fileBytes = fileBytes;
+
+    if (memfuncs) outArray->memfuncs = *memfuncs;
+    else outArray->memfuncs = CTOOLBOX_DEFAULT_MEMFUNCS;
+
+    ctoolbox_memstats_on_alloc(&outArray->stats, sizeof(darray));
+    ctoolbox_memstats_on_alloc(&outArray->stats, fileBytes);
+
+    return outArray;
+}
+
+CTOOLBOX_API ctoolbox_result darray_memory_usage(const darray* array, ctoolbox_memstats* statsOut)
+{
+    if (!array || !statsOut) return CTOOLBOX_ERROR_INVALID_PARAM;
+    *statsOut = array->stats;
+    return CTOOLBOX_SUCCESS;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Segmented Array
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#if defined(_MSC_VER)
+    #include <intrin.h>
+#endif
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// internal
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#define SEGARRAY_FIRST_SEGMENT ((size_t)1 << SEGARRAY_FIRST_SEGMENT_SHIFT)
+#define SEGARRAY_MAX_SEGMENTS (sizeof(size_t) * 8 - SEGARRAY_FIRST_SEGMENT_SHIFT)
+
+// segment k holds SEGARRAY_FIRST_SEGMENT << k elements, so index + SEGARRAY_FIRST_SEGMENT has its segment in its top bit
+struct segarray
+{
+    void* segments[SEGARRAY_MAX_SEGMENTS];
+    size_t segmentCount;
+    size_t size;
+    size_t elementSize;
+    ctoolbox_memfuncs memfuncs;
+    ctoolbox_memstats stats;
+};
+
+static inline size_t segarray_log2(size_t value)
+{
+#if defined(_MSC_VER) && !defined(__clang__) && (defined(_M_X64) || defined(_M_ARM64))
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return index;
+#elif defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index;
+    _BitScanReverse(&index, (unsigned long)value);
+    return index;
+#else
+    return sizeof(size_t) * 8 - 1 - (size_t)(sizeof(size_t) == sizeof(unsigned long long) ? __builtin_clzll(value) : __builtin_clz((unsigned int)value));
+#endif
+}
+
+static inline size_t segarray_segment_length(size_t segment)
+{
+    return SEGARRAY_FIRST_SEGMENT << segment;
+}
+
+// elements the first segmentCount segments hold
+static inline size_t segarray_segments_capacity(size_t segmentCount)
+{
+    return (SEGARRAY_FIRST_SEGMENT << segmentCount) - SEGARRAY_FIRST_SEGMENT;
+}
+
+static inline char* segarray_address(const segarray* array, size_t index)
+{
+    size_t position = index + SEGARRAY_FIRST_SEGMENT;
+    size_t segment = segarray_log2(position) - SEGARRAY_FIRST_SEGMENT_SHIFT;
+    size_t offset = position - segarray_segment_length(segment);
+    return (char*)array->segments[segment] + offset * array->elementSize;
+}
+
+static ctoolbox_result segarray_add_segment(segarray* array)
+{
+    if (array->segmentCount == SEGARRAY_MAX_SEGMENTS) return CTOOLBOX_ERROR_FULL;
+
+    size_t length = segarray_segment_length(array->segmentCount);
+    if (length > SIZE_MAX / array->elementSize) return CTOOLBOX_ERROR_MEMORY_ALLOC;
+
+    void* segment = ctoolbox_custom_malloc(&array->memfuncs, length * array->elementSize);
+    if (!segment) return CTOOLBOX_ERROR_MEMORY_ALLOC;
+
+    ctoolbox_memstats_on_alloc(&array->stats, length * array->elementSize);
+    array->segments[array->segmentCount++] = segment;
+    return CTOOLBOX_SUCCESS;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// external
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+CTOOLBOX_API segarray* segarray_init(size_t elementSize)
+{
+    return segarray_init_memfuncs(elementSize, &CTOOLBOX_DEFAULT_MEMFUNCS);
+}
+
+CTOOLBOX_API segarray* segarray_init_memfuncs(size_t elementSize, const ctoolbox_memfuncs* memfuncs)
+{
+    if (elementSize == 0) return NULL;
+
+    segarray* outArray = ctoolbox_custom_malloc(memfuncs ? memfuncs : &CTOOLBOX_DEFAULT_MEMFUNCS, sizeof(segarray));
+    if (!outArray) return NULL;
+
+    memset(outArray, 0, sizeof(segarray));
+    outArray->elementSize = elementSize;
+
+    if (memfuncs) outArray->memfuncs = *memfuncs;
+    else outArray->memfuncs = CTOOLBOX_DEFAULT_MEMFUNCS;
+
+    ctoolbox_memstats_on_alloc(&outArray->stats, sizeof(segarray));
+
+    return outArray;
+}
+
+CTOOLBOX_API void segarray_destroy(segarray* array)
+{
+    if (!array) return;
+
+    for (size_t i = 0; i < array->segmentCount; i++) {
+        ctoolbox_custom_free_sized(&array->memfuncs, array->segments[i], segarray_segment_length(i) * array->elementSize);
+    }
+    ctoolbox_custom_free_sized(&array->memfuncs, array, sizeof(segarray));
+}
+
+CTOOLBOX_API ctoolbox_result segarray_push_back(segarray* array, const void* element)
+{
+    if (!array || !element) return CTOOLBOX_ERROR_INVALID_PARAM;
+
+    void* slot = segarray_emplace_back(array);
+    if (!slot) return CTOOLBOX_ERROR_MEMORY_ALLOC;
+
+    memcpy(slot, element, array->elementSize);
+    return CTOOLBOX_SUCCESS;
+}
+
+CTOOLBOX_API ctoolbox_result segarray_pop_back(segarray* array, void* elementOut)
+{
+    if (!array || array->size == 0) return CTOOLBOX_ERROR_EMPTY;
+    if (elementOut) memcpy(elementOut, segarray_address(array, array->size - 1), array->elementSize);
+
+    array->size--;
+    return CTOOLBOX_SUCCESS;
+}
+
+CTOOLBOX_API void* segarray_emplace_back(segarray* array)
+{
+    if (!array) return NULL;
+
+    // a full array gets one more segment, the existing ones stay where they are
+    if (array->size == segarray_segments_capacity(array->segmentCount) && segarray_add_segment(array) != CTOOLBOX_SUCCESS) return NULL;
+
+    return segarray_address(array, array->size++);
+}
+
+CTOOLBOX_API void* segarray_peek(segarray* array, size_t index)
+{
+    if (!array || index >= array->size) return NULL;
+    return segarray_address(array, index);
+}
+
+CTOOLBOX_API const void* segarray_const_peek(const segarray* array, size_t index)
+{
+    if (!array || index >= array->size) return NULL;
+    return segarray_address(array, index);
+}
+
+CTOOLBOX_API ctoolbox_result segarray_get(const segarray* array, size_t index, void* elementOut)
+{
+    if (!array || !elementOut) return CTOOLBOX_ERROR_INVALID_PARAM;
+    if (index >= array->size) return CTOOLBOX_ERROR_OUT_OF_BOUNDS;
+
+    memcpy(elementOut, segarray_address(array, index), array->elementSize);
+    return CTOOLBOX_SUCCESS;
+}
+
+CTOOLBOX_API ctoolbox_result segarray_set(segarray* array, size_t index, const void* element)
+{
+    if (!array || !element) return CTOOLBOX_ERROR_INVALID_PARAM;
+    if (index >= array->size) return CTOOLBOX_ERROR_OUT_OF_BOUNDS;
+
+    memcpy(segarray_address(array, index), element, array->elementSize);
+    return CTOOLBOX_SUCCESS;
+}
+
+CTOOLBOX_API ctoolbox_result segarray_reserve(segarray* array, size_t newCapacity)
+{
+    if (!array) return CTOOLBOX_ERROR_INVALID_PARAM;
+
+    while (segarray_segments_capacity(array->segmentCount) < newCapacity) {
+        ctoolbox_result res = segarray_add_segment(array);
+        if (res != CTOOLBOX_SUCCESS) return res;
+    }
+    return CTOOLBOX_SUCCESS;
+}
+
+CTOOLBOX_API ctoolbox_result segarray_shrink_to_fit(segarray* array)
+{
+    if (!array) return CTOOLBOX_ERROR_INVALID_PARAM;
+
+    while (array->segmentCount > 0 && segarray_segments_capacity(array->segmentCount - 1) >= array->size) {
+        size_t bytes = segarray_segment_length(array->segmentCount - 1) * array->elementSize;
+        ctoolbox_custom_free_sized(&array->memfuncs, array->segments[--array->segmentCount], bytes);
+        ctoolbox_memstats_on_free(&array->stats, bytes);
+    }
+    return CTOOLBOX_SUCCESS;
+}
+
+CTOOLBOX_API size_t segarray_size(const segarray* array)
+{
+    return array ? array->size : 0;
+}
+
+CTOOLBOX_API size_t segarray_capacity(const segarray* array)
+{
+    return array ? segarray_segments_capacity(array->segmentCount) : 0;
+}
+
+CTOOLBOX_API bool segarray_empty(const segarray* array)
+{
+    return array ? array->size == 0 : true;
+}
+
+CTOOLBOX_API ctoolbox_result segarray_memory_usage(const segarray* array, ctoolbox_memstats* statsOut)
+{
+    if (!array || !statsOut) return CTOOLBOX_ERROR_INVALID_PARAM;
+    *statsOut = array->stats;
+    return CTOOLBOX_SUCCESS;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Deque
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// internal
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// the darray is always resized to its whole capacity, the ring lives in it from head, wrapping at the end
+struct deque
+{
+    darray* buffer;
+    size_t head;
+    size_t count;
+    size_t elementSize;
+    ctoolbox_memfuncs memfuncs;
+};
+
+static inline char* deque_data(const deque* d)
+{
+    return (char*)((const darray_header*)d->buffer)->data;
+}
+
+static inline size_t deque_ring_capacity(const deque* d)
+{
+    return ((const darray_header*)d->buffer)->size;
+}
+
+// position in the buffer of the element at the index counted from the front
+static inline size_t deque_slot(const deque* d, size_t index)
+{
+    size_t slot = d->head + index;
+    size_t capacity = deque_ring_capacity(d);
+    return slot >= capacity ? slot - capacity : slot;
+}
+
+// grows the ring so it holds at least minCapacity elements, unwrapping it once
+static ctoolbox_result deque_grow(deque* d, size_t minCapacity)
+{
+    size_t oldCapacity = deque_ring_capacity(d);
+    if (minCapacity <= oldCapacity) return CTOOLBOX_SUCCESS;
+
+    size_t newCapacity = oldCapacity > SIZE_MAX / 2 ? minCapacity : oldCapacity * 2;
+    if (newCapacity < minCapacity) newCapacity = minCapacity;
+
+    ctoolbox_result res = darray_reserve(d->buffer, newCapacity);
+    if (res != CTOOLBOX_SUCCESS) return res;
+
+    // take whatever capacity the darray ended up with
+    newCapacity = darray_capacity(d->buffer);
+    darray_resize(d->buffer, newCapacity);
+
+    // the front part of a wrapped ring moves to the end of the grown buffer
+    if (d->head + d->count > oldCapacity) {
+        size_t frontCount = oldCapacity - d->head;
+        size_t newHead = newCapacity - frontCount;
+        char* data = deque_data(d);
+        memmove(data + newHead * d->elementSize, data + d->head * d->elementSize, frontCount * d->elementSize);
+        d->head = newHead;
+    }
+    return CTOOLBOX_SUCCESS;
+}
+
+// copies count elements starting at the slot into out, following the wrap
+static void deque_copy_out(const deque* d, size_t slot, void* out, size_t count)
+{
+    size_t capacity = deque_ring_capacity(d);
+    size_t first = capacity - slot < count ? capacity - slot : count;
+    memcpy(out, deque_data(d) + slot * d->elementSize, first * d->elementSize);
+    memcpy((char*)out + first * d->elementSize, deque_data(d), (count - first) * d->elementSize);
+}
+
+// copies count elements from in to the slot onwards, following the wrap
+static void deque_copy_in(deque* d, size_t slot, const void* in, size_t count)
+{
+    size_t capacity = deque_ring_capacity(d);
+    size_t first = capacity - slot < count ? capacity - slot : count;
+    memcpy(deque_data(d) + slot * d->elementSize, in, first * d->elementSize);
+    memcpy(deque_data(d), (const char*)in + first * d->elementSize, (count - first) * d->elementSize);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// external
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+CTOOLBOX_API deque* deque_init(size_t elementSize, size_t initialCapacity)
+{
+    return deque_init_memfuncs(elementSize, initialCapacity, &CTOOLBOX_DEFAULT_MEMFUNCS);
+}
+
+CTOOLBOX_API deque* deque_init_memfuncs(size_t elementSize, size_t initialCapacity, const ctoolbox_memfuncs* memfuncs)
+{
+    if (elementSize == 0) return NULL;
+
+    deque* outDeque = ctoolbox_custom_malloc(memfuncs ? memfuncs : &CTOOLBOX_DEFAULT_MEMFUNCS, sizeof(deque));
+    if (!outDeque) return NULL;
+
+    memset(outDeque, 0, sizeof(deque));
+    outDeque->elementSize = elementSize;
+
+    if (memfuncs) outDeque->memfuncs = *memfuncs;
+    else outDeque->memfuncs = CTOOLBOX_DEFAULT_MEMFUNCS;
+
+    outDeque->buffer = darray_init_memfuncs(elementSize, initialCapacity, &outDeque->memfuncs);
+    if (!outDeque->buffer) {
+        ctoolbox_custom_free_sized(&outDeque->memfuncs, outDeque, sizeof(deque));
+        return NULL;
+    }
+    darray_resize(outDeque->buffer, darray_capacity(outDeque->buffer));
+
+    return outDeque;
+}
+
+CTOOLBOX_API void deque_destroy(deque* d)
+{
+    if (!d) return;
+
+    darray_destroy(d->buffer);
+    ctoolbox_custom_free_sized(&d->memfuncs, d, sizeof(deque));
+}
+
+CTOOLBOX_API ctoolbox_result deque_push_back(deque* d, const void* element)
+{
+    if (!d || !element) return CTOOLBOX_ERROR_INVALID_PARAM;
+
+    ctoolbox_result res = deque_grow(d, d->count + 1);
+    if (res != CTOOLBOX_SUCCESS) return res;
+
+    memcpy(deque_data(d) + deque_slot(d, d->count) * d->elementSize, element, d->elementSize);
+    d->count++;
+    return CTOOLBOX_SUCCESS;
+}
+
+CTOOLBOX_API ctoolbox_result deque_push_front(deque* d, const void* element)
+{
+    if (!d || !element) return CTOOLBOX_ERROR_INVALID_PARAM;
+
+    ctoolbox_result res = deque_grow(d, d->count + 1);
+    if (res != CTOOLBOX_SUCCESS) return res;
+
+    d->head = d->head == 0 ? deque_ring_capacity(d) - 1 : d->head - 1;
+    memcpy(deque_data(d) + d->head * d->elementSize, element, d->elementSize);
+    d->count++;
+    return CTOOLBOX_SUCCESS;
+}
+
+CTOOLBOX_API ctoolbox_result deque_pop_back(deque* d, void* elementOut)
+{
+    if (!d || d->count == 0) return CTOOLBOX_ERROR_EMPTY;
+
+    d->count--;
+    if (elementOut) memcpy(elementOut, deque_data(d) + deque_slot(d, d->count) * d->elementSize, d->elementSize);
+    return CTOOLBOX_SUCCESS;
+}
+
+CTOOLBOX_API ctoolbox_result deque_pop_front(deque* d, void* elementOut)
+{
+    if (!d || d->count == 0) return CTOOLBOX_ERROR_EMPTY;
+
+    if (elementOut) memcpy(elementOut, deque_data(d) + d->head * d->elementSize, d->elementSize);
+    d->head = deque_slot(d, 1);
+    d->count--;
+    return CTOOLBOX_SUCCESS;
+}
+
+CTOOLBOX_API ctoolbox_result deque_push_back_n(deque* d, const void* elements, size_t count)
+{
+    if (!d || (!elements && count > 0)) return CTOOLBOX_ERROR_INVALID_PARAM;
+    if (count == 0) return CTOOLBOX_SUCCESS;
+    if (count > SIZE_MAX - d->count) return CTOOLBOX_ERROR_MEMORY_ALLOC;
+
+    ctoolbox_result res = deque_grow(d, d->count + count);
+    if (res != CTOOLBOX_SUCCESS) return res;
+
+    deque_copy_in(d, deque_slot(d, d->count), elements, count);
+    d->count += count;
+    return CTOOLBOX_SUCCESS;
+}
+
+CTOOLBOX_API ctoolbox_result deque_pop_front_n(deque* d, void* elementsOut, size_t count)
+{
+    if (!d) return CTOOLBOX_ERROR_INVALID_PARAM;
+    if (count > d->count) return CTOOLBOX_ERROR_OUT_OF_BOUNDS;
+    if (count == 0) return CTOOLBOX_SUCCESS;
+
+    if (elementsOut) deque_copy_out(d, d->head, elementsOut, count);
+    d->head = deque_slot(d, count);
+    d->count -= count;
+    return CTOOLBOX_SUCCESS;
+}
+
+CTOOLBOX_API void* deque_peek(deque* d, size_t index)
+{
+    if (!d || index >= d->count) return NULL;
+    return deque_data(d) + deque_slot(d, index) * d->elementSize;
+}
+
+CTOOLBOX_API const void* deque_const_peek(const deque* d, size_t index)
+{
+    if (!d || index >= d->count) return NULL;
+    return deque_data(d) + deque_slot(d, index) * d->elementSize;
+}
+
+CTOOLBOX_API ctoolbox_result deque_get(const deque* d, size_t index, void* elementOut)
+{
+    if (!d || !elementOut) return CTOOLBOX_ERROR_INVALID_PARAM;
+    if (index >= d->count) return CTOOLBOX_ERROR_OUT_OF_BOUNDS;
+
+    memcpy(elementOut, deque_data(d) + deque_slot(d, index) * d->elementSize, d->elementSize);
+    return CTOOLBOX_SUCCESS;
+}
+
+CTOOLBOX_API ctoolbox_result deque_set(deque* d, size_t index, const void* element)
+{
+    if (!d || !element) return CTOOLBOX_ERROR_INVALID_PARAM;
+    if (index >= d->count) return CTOOLBOX_ERROR_OUT_OF_BOUNDS;
+
+    memcpy(deque_data(d) + deque_slot(d, index) * d->elementSize, element, d->elementSize);
+    return CTOOLBOX_SUCCESS;
+}
+
+CTOOLBOX_API ctoolbox_result deque_reserve(deque* d, size_t newCapacity)
+{
+    if (!d) return CTOOLBOX_ERROR_INVALID_PARAM;
+    return deque_grow(d, newCapacity);
+}
+
+CTOOLBOX_API void deque_clear(deque* d)
+{
+    if (!d) return;
+    d->head = 0;
+    d->count = 0;
+}
+
+CTOOLBOX_API size_t deque_size(const deque* d)
+{
+    return d ? d->count : 0;
+}
+
+CTOOLBOX_API size_t deque_capacity(const deque* d)
+{
+    return d ? deque_ring_capacity(d) : 0;
+}
+
+CTOOLBOX_API bool deque_empty(const deque* d)
+{
+    return d ? d->count == 0 : true;
+}
+
+CTOOLBOX_API ctoolbox_result deque_memory_usage(const deque* d, ctoolbox_memstats* statsOut)
+{
+    if (!d || !statsOut) return CTOOLBOX_ERROR_INVALID_PARAM;
+
+    ctoolbox_result res = darray_memory_usage(d->buffer, statsOut);
+    if (res != CTOOLBOX_SUCCESS) return res;
+
+    statsOut->liveBytes += sizeof(deque);
+    statsOut->peakBytes += sizeof(deque);
+    statsOut->allocCount++;
+    return CTOOLBOX_SUCCESS;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Concurrent Array
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// internal
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#define CDARRAY_FIRST_SEGMENT ((uint64_t)1 << CDARRAY_FIRST_SEGMENT_SHIFT)
+#define CDARRAY_MAX_SEGMENTS (sizeof(size_t) * 8 - CDARRAY_FIRST_SEGMENT_SHIFT)
+#define CDARRAY_ABANDONED ((void*)(uintptr_t)1)    // a segment that couldn't be allocated, its slots are skipped
+
+// segment k holds CDARRAY_FIRST_SEGMENT << k elements followed by a bitmap of the published ones
+struct cdarray
+{
+    void* volatile segments[CDARRAY_MAX_SEGMENTS];
+    volatile uint64_t claimed;      // next slot handed out
+    volatile uint64_t committed;    // published prefix last seen by cdarray_committed
+    size_t elementSize;
+    cthread_mutex lock;             // only taken to add segments, guards stats
+    ctoolbox_memfuncs memfuncs;
+    ctoolbox_memstats stats;
+};
+
+static inline size_t cdarray_log2(uint64_t value)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return index;
+#else
+    return 63 - (size_t)__builtin_clzll(value);
+#endif
+}
+
+static inline size_t cdarray_ctz(uint64_t value)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index;
+    _BitScanForward64(&index, value);
+    return index;
+#else
+    return (size_t)__builtin_ctzll(value);
+#endif
+}
+
+static inline size_t cdarray_segment_length(size_t segment)
+{
+    return (size_t)CDARRAY_FIRST_SEGMENT << segment;
+}
+
+// elements come first, the bitmap starts at the next 8 bytes boundary
+static inline size_t cdarray_bitmap_offset(const cdarray* array, size_t segment)
+{
+    return (cdarray_segment_length(segment) * array->elementSize + 7) & ~(size_t)7;
+}
+
+static inline size_t cdarray_segment_bytes(const cdarray* array, size_t segment)
+{
+    return cdarray_bitmap_offset(array, segment) + cdarray_segment_length(segment) / 8;
+}
+
+static inline void cdarray_locate(uint64_t index, size_t* segmentOut, size_t* offsetOut)
+{
+    uint64_t position = index + CDARRAY_FIRST_SEGMENT;
+    size_t segment = cdarray_log2(position) - CDARRAY_FIRST_SEGMENT_SHIFT;
+    *segmentOut = segment;
+    *offsetOut = (size_t)(position - ((uint64_t)CDARRAY_FIRST_SEGMENT << segment));
+}
+
+static inline volatile uint64_t* cdarray_bitmap(const cdarray* array, char* segment, size_t segmentIndex)
+{
+    return (volatile uint64_t*)(segment + cdarray_bitmap_offset(array, segmentIndex));
+}
+
+// returns the segment, adding it under the lock the first time it is needed, CDARRAY_ABANDONED if that failed
+static char* cdarray_segment(cdarray* array, size_t segmentIndex)
+{
+    char* segment = cthread_atomic_load_ptr(&array->segments[segmentIndex]);
+    if (segment) return segment;
+
+    cthread_mutex_lock(&array->lock);
+    segment = cthread_atomic_load_ptr(&array->segments[segmentIndex]);
+    if (!segment) {
+        size_t length = cdarray_segment_length(segmentIndex);
+        if (length <= (SIZE_MAX - 8 - length / 8) / array->elementSize) {
+            size_t bytes = cdarray_segment_bytes(array, segmentIndex);
+            segment = ctoolbox_custom_malloc(&array->memfuncs, bytes);
+            if (segment) {
+                memset(segment + cdarray_bitmap_offset(array, segmentIndex), 0, length / 8);
+                ctoolbox_memstats_on_alloc(&array->stats, bytes);
+            }
+        }
+
+        // slots may already be claimed in it, so a failed segment is given up rather than tried again later
+        if (!segment) segment = CDARRAY_ABANDONED;
+        cthread_atomic_store_ptr(&array->segments[segmentIndex], segment);
+    }
+    cthread_mutex_unlock(&array->lock);
+    return segment;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// external
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+CTOOLBOX_API cdarray* cdarray_init(size_t elementSize)
+{
+    return cdarray_init_memfuncs(elementSize, &CTOOLBOX_DEFAULT_MEMFUNCS);
+}
+
+CTOOLBOX_API cdarray* cdarray_init_memfuncs(size_t elementSize, const ctoolbox_memfuncs* memfuncs)
+{
+    if (elementSize == 0) return NULL;
+
+    cdarray* outArray = ctoolbox_custom_malloc(memfuncs ? memfuncs : &CTOOLBOX_DEFAULT_MEMFUNCS, sizeof(cdarray));
+    if (!outArray) return NULL;
+
+    memset(outArray, 0, sizeof(cdarray));
+    outArray->elementSize = elementSize;
+    cthread_mutex_init(&outArray->lock);
+
+    if (memfuncs) outArray->memfuncs = *memfuncs;
+    else outArray->memfuncs = CTOOLBOX_DEFAULT_MEMFUNCS;
+
+    ctoolbox_memstats_on_alloc(&outArray->stats, sizeof(cdarray));
+
+    return outArray;
+}
+
+CTOOLBOX_API void cdarray_destroy(cdarray* array)
+{
+    if (!array) return;
+
+    for (size_t i = 0; i < CDARRAY_MAX_SEGMENTS; i++) {
+        if (!array->segments[i] || array->segments[i] == CDARRAY_ABANDONED) continue;
+        ctoolbox_custom_free_sized(&array->memfuncs, array->segments[i], cdarray_segment_bytes(array, i));
+    }
+    cthread_mutex_destroy(&array->lock);
+    ctoolbox_custom_free_sized(&array->memfuncs, array, sizeof(cdarray));
+}
+
+CTOOLBOX_API ctoolbox_result cdarray_push_back(cdarray* array, const void* element, size_t* indexOut)
+{
+    if (!array || !element) return CTOOLBOX_ERROR_INVALID_PARAM;
+
+    size_t index;
+    void* slot = cdarray_claim(array, &index);
+    if (!slot) return CTOOLBOX_ERROR_MEMORY_ALLOC;
+
+    memcpy(slot, element, array->elementSize);
+    cdarray_commit(array, index);
+
+    if (indexOut) *indexOut = index;
+    return CTOOLBOX_SUCCESS;
+}
+
+CTOOLBOX_API void* cdarray_claim(cdarray* array, size_t* indexOut)
+{
+    if (!array) return NULL;
+
+    for (;;) {
+        uint64_t index = cthread_atomic_fetch_add(&array->claimed, 1);
+        if (index > SIZE_MAX - CDARRAY_FIRST_SEGMENT) return NULL;
+
+        size_t segmentIndex, offset;
+        cdarray_locate(index, &segmentIndex, &offset);
+
+        // the rest of a segment given up earlier is skipped at once, instead of failing once per slot
+        char* segment = cthread_atomic_load_ptr(&array->segments[segmentIndex]);
+        if (segment == CDARRAY_ABANDONED) {
+            uint64_t end = index - offset + cdarray_segment_length(segmentIndex);
+            uint64_t current = index + 1;
+            while (current < end && !cthread_atomic_compare_exchange(&array->claimed, &current, end));
+            continue;
+        }
+
+        // this slot is abandoned with its segment when the segment can't be allocated
+        if (!segment) segment = cdarray_segment(array, segmentIndex);
+        if (segment == CDARRAY_ABANDONED) return NULL;
+
+        if (indexOut) *indexOut = (size_t)index;
+        return segment + offset * array->elementSize;
+    }
+}
+
+CTOOLBOX_API void cdarray_commit(cdarray* array, size_t index)
+{
+    if (!array || index > SIZE_MAX - CDARRAY_FIRST_SEGMENT) return;
+
+    size_t segmentIndex, offset;
+    cdarray_locate(index, &segmentIndex, &offset);
+
+    char* segment = cthread_atomic_load_ptr(&array->segments[segmentIndex]);
+    if (!segment || segment == CDARRAY_ABANDONED) return;
+
+    // the element's bytes are written before its bit is visible
+    cthread_atomic_fetch_or(cdarray_bitmap(array, segment, segmentIndex) + offset / 64, (uint64_t)1 << (offset % 64));
+}
+
+CTOOLBOX_API size_t cdarray_committed(cdarray* array)
+{
+    if (!array) return 0;
+
+    // walk the published bits past the last known prefix, a word at a time
+    uint64_t start = cthread_atomic_load(&array->committed);
+    uint64_t committed = start;
+    uint64_t claimed = cthread_atomic_load(&array->claimed);
+    while (committed < claimed) {
+        size_t segmentIndex, offset;
+        cdarray_locate(committed, &segmentIndex, &offset);
+
+        char* segment = cthread_atomic_load_ptr(&array->segments[segmentIndex]);
+        if (!segment) break;
+
+        // nothing in a given up segment will ever be published, the prefix steps over it
+        if (segment == CDARRAY_ABANDONED) {
+            committed += cdarray_segment_length(segmentIndex) - offset;
+            continue;
+        }
+
+        uint64_t word = cthread_atomic_load(cdarray_bitmap(array, segment, segmentIndex) + offset / 64);
+        uint64_t unpublished = ~word >> (offset % 64);
+        size_t run = unpublished ? cdarray_ctz(unpublished) : 64 - offset % 64;
+        if (run == 0) break;
+
+        committed += run;
+    }
+    if (committed > claimed) committed = claimed;
+
+    // readers racing here only ever move the prefix forward
+    while (start < committed && !cthread_atomic_compare_exchange(&array->committed, &start, committed));
+    return (size_t)(start > committed ? start : committed);
+}
+
+CTOOLBOX_API const void* cdarray_const_peek(const cdarray* array, size_t index)
+{
+    if (!array || index > SIZE_MAX - CDARRAY_FIRST_SEGMENT) return NULL;
+
+    size_t segmentIndex, offset;
+    cdarray_locate(index, &segmentIndex, &offset);
+
+    char* segment = cthread_atomic_load_ptr(&array->segments[segmentIndex]);
+    if (!segment || segment == CDARRAY_ABANDONED) return NULL;
+
+    uint64_t word = cthread_atomic_load(cdarray_bitmap(array, segment, segmentIndex) + offset / 64);
+    if (!(word & ((uint64_t)1 << (offset % 64)))) return NULL;
+
+    return segment + offset * array->elementSize;
+}
+
+CTOOLBOX_API ctoolbox_result cdarray_get(const cdarray* array, size_t index, void* elementOut)
+{
+    if (!array || !elementOut) return CTOOLBOX_ERROR_INVALID_PARAM;
+
+    const void* element = cdarray_const_peek(array, index);
+    if (!element) return CTOOLBOX_ERROR_NOT_FOUND;
+
+    memcpy(elementOut, element, array->elementSize);
+    return CTOOLBOX_SUCCESS;
+}
+
+CTOOLBOX_API size_t cdarray_size(const cdarray* array)
+{
+    return array ? (size_t)cthread_atomic_load(&array->claimed) : 0;
+}
+
+CTOOLBOX_API ctoolbox_result cdarray_memory_usage(cdarray* array, ctoolbox_memstats* statsOut)
+{
+    if (!array || !statsOut) return CTOOLBOX_ERROR_INVALID_PARAM;
+
+    cthread_mutex_lock(&array->lock);
+    *statsOut = array->stats;
+    cthread_mutex_unlock(&array->lock);
+    return CTOOLBOX_SUCCESS;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Structure of Arrays
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// internal
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+typedef struct soarray_column_info
+{
+    char* data;
+    size_t elementSize;
+} soarray_column_info;
+
+// every column lives in one block, one after the other, each starting on a SOARRAY_COLUMN_ALIGNMENT boundary
+struct soarray
+{
+    void* block;
+    size_t blockBytes;
+    size_t size;
+    size_t capacity;
+    size_t columnCount;
+    ctoolbox_memfuncs memfuncs;
+    ctoolbox_memstats stats;
+    soarray_column_info columns[];
+};
+
+static inline size_t soarray_header_bytes(size_t columnCount)
+{
+    return sizeof(soarray) + columnCount * sizeof(soarray_column_info);
+}
+
+// bytes of a block holding capacity rows, 0 on overflow
+static size_t soarray_block_bytes(const soarray* array, size_t capacity)
+{
+    size_t bytes = 0;
+    for (size_t i = 0; i < array->columnCount; i++) {
+        size_t elementSize = array->columns[i].elementSize;
+        if (capacity > SIZE_MAX / elementSize) return 0;
+
+        size_t columnBytes = (capacity * elementSize + (SOARRAY_COLUMN_ALIGNMENT - 1)) & ~(size_t)(SOARRAY_COLUMN_ALIGNMENT - 1);
+        if (columnBytes < capacity * elementSize || columnBytes > SIZE_MAX - bytes) return 0;
+        bytes += columnBytes;
+    }
+    return bytes;
+}
+
+// moves every column into a block for newCapacity rows, keeping the first size rows
+static ctoolbox_result soarray_relocate(soarray* array, size_t newCapacity)
+{
+    size_t newBytes = soarray_block_bytes(array, newCapacity);
+    if (newBytes == 0 && newCapacity > 0) return CTOOLBOX_ERROR_MEMORY_ALLOC;
+
+    char* newBlock = NULL;
+    if (newBytes > 0) {
+        newBlock = ctoolbox_custom_aligned_malloc(&array->memfuncs, newBytes, SOARRAY_COLUMN_ALIGNMENT);
+        if (!newBlock) return CTOOLBOX_ERROR_MEMORY_ALLOC;
+    }
+
+    char* column = newBlock;
+    for (size_t i = 0; i < array->columnCount; i++) {
+        size_t elementSize = array->columns[i].elementSize;
+        if (array->size > 0) memcpy(column, array->columns[i].data, array->size * elementSize);
+
+        array->columns[i].data = column;
+        if (column) column += (newCapacity * elementSize + (SOARRAY_COLUMN_ALIGNMENT - 1)) & ~(size_t)(SOARRAY_COLUMN_ALIGNMENT - 1);
+    }
+
+    if (newBlock) ctoolbox_memstats_on_alloc(&array->stats, newBytes);
+    if (array->block) {
+        ctoolbox_custom_aligned_free_sized(&array->memfuncs, array->block, array->blockBytes, SOARRAY_COLUMN_ALIGNMENT);
+        ctoolbox_memstats_on_free(&array->stats, array->blockBytes);
+    }
+
+    array->block = newBlock;
+    array->blockBytes = newBytes;
+    array->capacity = newCapacity;
+    return CTOOLBOX_SUCCESS;
+}
+
+// doubles the capacity until it holds minCapacity rows
+static ctoolbox_result soarray_grow(soarray* array, size_t minCapacity)
+{
+    if (minCapacity <= array->capacity) return CTOOLBOX_SUCCESS;
+
+    size_t newCapacity = array->capacity > 0 ? array->capacity : 1;
+    while (newCapacity < minCapacity) {
+        if (newCapacity > SIZE_MAX / 2) {
+            newCapacity = minCapacity;
+            break;
+        }
+        newCapacity *= 2;
+    }
+    return soarray_relocate(array, newCapacity);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// external
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+CTOOLBOX_API soarray* soarray_init(const size_t* columnSizes, size_t columnCount, size_t initialCapacity)
+{
+    return soarray_init_memfuncs(columnSizes, columnCount, initialCapacity, &CTOOLBOX_DEFAULT_MEMFUNCS);
+}
+
+CTOOLBOX_API soarray* soarray_init_memfuncs(const size_t* columnSizes, size_t columnCount, size_t initialCapacity, const ctoolbox_memfuncs* memfuncs)
+{
+    if (!columnSizes || columnCount == 0) return NULL;
+    if (columnCount > (SIZE_MAX - sizeof(soarray)) / sizeof(soarray_column_info)) return NULL;
+    for (size_t i = 0; i < columnCount; i++) {
+        if (columnSizes[i] == 0) return NULL;
+    }
+
+    soarray* outArray = ctoolbox_custom_malloc(memfuncs ? memfuncs : &CTOOLBOX_DEFAULT_MEMFUNCS, soarray_header_bytes(columnCount));
+    if (!outArray) return NULL;
+
+    memset(outArray, 0, soarray_header_bytes(columnCount));
+    outArray->columnCount = columnCount;
+    for (size_t i = 0; i < columnCount; i++) outArray->columns[i].elementSize = columnSizes[i];
+
+    if (memfuncs) outArray->memfuncs = *memfuncs;
+    else outArray->memfuncs = CTOOLBOX_DEFAULT_MEMFUNCS;
+
+    ctoolbox_memstats_on_alloc(&outArray->stats, soarray_header_bytes(columnCount));
+
+    if (initialCapacity > 0 && soarray_relocate(outArray, initialCapacity) != CTOOLBOX_SUCCESS) {
+        ctoolbox_custom_free_sized(&outArray->memfuncs, outArray, soarray_header_bytes(columnCount));
+        return NULL;
+    }
+
+    return outArray;
+}
+
+CTOOLBOX_API void soarray_destroy(soarray* array)
+{
+    if (!array) return;
+
+    if (array->block) ctoolbox_custom_aligned_free_sized(&array->memfuncs, array->block, array->blockBytes, SOARRAY_COLUMN_ALIGNMENT);
+    ctoolbox_custom_free_sized(&array->memfuncs, array, soarray_header_bytes(array->columnCount));
+}
+
+CTOOLBOX_API ctoolbox_result soarray_push_back(soarray* array, const void* const* fields)
+{
+    if (!array) return CTOOLBOX_ERROR_INVALID_PARAM;
+
+    size_t index;
+    ctoolbox_result res = soarray_emplace_back(array, &index);
+    if (res != CTOOLBOX_SUCCESS) return res;
+
+    for (size_t i = 0; i < array->columnCount; i++) {
+        void* field = array->columns[i].data + index * array->columns[i].elementSize;
+        if (fields && fields[i]) memcpy(field, fields[i], array->columns[i].elementSize);
+        else memset(field, 0, array->columns[i].elementSize);
+    }
+    return CTOOLBOX_SUCCESS;
+}
+
+CTOOLBOX_API ctoolbox_result soarray_emplace_back(soarray* array, size_t* indexOut)
+{
+    if (!array) return CTOOLBOX_ERROR_INVALID_PARAM;
+    if (array->size == SIZE_MAX) return CTOOLBOX_ERROR_MEMORY_ALLOC;
+
+    ctoolbox_result res = soarray_grow(array, array->size + 1);
+    if (res != CTOOLBOX_SUCCESS) return res;
+
+    if (indexOut) *indexOut = array->size;
+    array->size++;
+    return CTOOLBOX_SUCCESS;
+}
+
+CTOOLBOX_API ctoolbox_result soarray_pop_back(soarray* array, void* const* fieldsOut)
+{
+    if (!array || array->size == 0) return CTOOLBOX_ERROR_EMPTY;
+
+    array->size--;
+    if (fieldsOut) {
+        for (size_t i = 0; i < array->columnCount; i++) {
+            if (fieldsOut[i]) memcpy(fieldsOut[i], array->columns[i].data + array->size * array->columns[i].elementSize, array->columns[i].elementSize);
+        }
+    }
+    return CTOOLBOX_SUCCESS;
+}
+
+CTOOLBOX_API ctoolbox_result soarray_get(const soarray* array, size_t index, void* const* fieldsOut)
+{
+    if (!array || !fieldsOut) return CTOOLBOX_ERROR_INVALID_PARAM;
+    if (index >= array->size) return CTOOLBOX_ERROR_OUT_OF_BOUNDS;
+
+    for (size_t i = 0; i < array->columnCount; i++) {
+        if (fieldsOut[i]) memcpy(fieldsOut[i], array->columns[i].data + index * array->columns[i].elementSize, array->columns[i].elementSize);
+    }
+    return CTOOLBOX_SUCCESS;
+}
+
+CTOOLBOX_API ctoolbox_result soarray_set(soarray* array, size_t index, const void* const* fields)
+{
+    if (!array || !fields) return CTOOLBOX_ERROR_INVALID_PARAM;
+    if (index >= array->size) return CTOOLBOX_ERROR_OUT_OF_BOUNDS;
+
+    for (size_t i = 0; i < array->columnCount; i++) {
+        if (fields[i]) memcpy(array->columns[i].data + index * array->columns[i].elementSize, fields[i], array->columns[i].elementSize);
+    }
+    return CTOOLBOX_SUCCESS;
+}
+
+CTOOLBOX_API ctoolbox_result soarray_swap_remove(soarray* array, size_t index)
+{
+    if (!array) return CTOOLBOX_ERROR_INVALID_PARAM;
+    if (index >= array->size) return CTOOLBOX_ERROR_OUT_OF_BOUNDS;
+
+    array->size--;
+    if (index != array->size) {
+        for (size_t i = 0; i < array->columnCount; i++) {
+            size_t elementSize = array->columns[i].elementSize;
+            memcpy(array->columns[i].data + index * elementSize, array->columns[i].data + array->size * elementSize, elementSize);
+        }
+    }
+    return CTOOLBOX_SUCCESS;
+}
+
+CTOOLBOX_API void* soarray_column(soarray* array, size_t column)
+{
+    if (!array || column >= array->columnCount) return NULL;
+    return array->columns[column].data;
+}
+
+CTOOLBOX_API const void* soarray_const_column(const soarray* array, size_t column)
+{
+    if (!array || column >= array->columnCount) return NULL;
+    return array->columns[column].data;
+}
+
+CTOOLBOX_API void* soarray_peek(soarray* array, size_t column, size_t index)
+{
+    if (!array || column >= array->columnCount || index >= array->size) return NULL;
+    return array->columns[column].data + index * array->columns[column].elementSize;
+}
+
+CTOOLBOX_API const void* soarray_const_peek(const soarray* array, size_t column, size_t index)
+{
+    if (!array || column >= array->columnCount || index >= array->size) return NULL;
+    return array->columns[column].data + index * array->columns[column].elementSize;
+}
+
+CTOOLBOX_API size_t soarray_column_count(const soarray* array)
+{
+    return array ? array->columnCount : 0;
+}
+
+CTOOLBOX_API size_t soarray_column_size(const soarray* array, size_t column)
+{
+    if (!array || column >= array->columnCount) return 0;
+    return array->columns[column].elementSize;
+}
+
+CTOOLBOX_API ctoolbox_result soarray_resize(soarray* array, size_t newSize)
+{
+    if (!array) return CTOOLBOX_ERROR_INVALID_PARAM;
+
+    ctoolbox_result res = soarray_grow(array, newSize);
+    if (res != CTOOLBOX_SUCCESS) return res;
+
+    array->size = newSize;
+    return CTOOLBOX_SUCCESS;
+}
+
+CTOOLBOX_API ctoolbox_result soarray_reserve(soarray* array, size_t newCapacity)
+{
+    if (!array) return CTOOLBOX_ERROR_INVALID_PARAM;
+    if (newCapacity <= array->capacity) return CTOOLBOX_SUCCESS;
+    return soarray_relocate(array, newCapacity);
+}
+
+CTOOLBOX_API ctoolbox_result soarray_shrink_to_fit(soarray* array)
+{
+    if (!array) return CTOOLBOX_ERROR_INVALID_PARAM;
+    if (array->size == array->capacity) return CTOOLBOX_SUCCESS;
+    return soarray_relocate(array, array->size);
+}
+
+CTOOLBOX_API size_t soarray_size(const soarray* array)
+{
+    return array ? array->size : 0;
+}
+
+CTOOLBOX_API size_t soarray_capacity(const soarray* array)
+{
+    return array ? array->capacity : 0;
+}
+
+CTOOLBOX_API bool soarray_empty(const soarray* array)
+{
+    return array ? array->size == 0 : true;
+}
+
+CTOOLBOX_API ctoolbox_result soarray_memory_usage(const soarray* array, ctoolbox_memstats* statsOut)
+{
+    if (!array || !statsOut) return CTOOLBOX_ERROR_INVALID_PARAM;
+    *statsOut = array->stats;
+    return CTOOLBOX_SUCCESS;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// ID Generator
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#if defined(_MSC_VER)
+    #include <intrin.h>
+#endif
+
+// ids live in pages of 64 words, so a single summary word tells which of the page's words are full
+#define IDGEN_PAGE_WORDS        64
+#define IDGEN_PAGE_IDS          (IDGEN_PAGE_WORDS * 64)
+// pages are reached through chunks of IDGEN_CHUNK_PAGES, the whole 32 bits range fits in IDGEN_MAX_CHUNKS
+#define IDGEN_CHUNK_PAGES       1024
+#define IDGEN_CHUNK_WORDS       (IDGEN_CHUNK_PAGES / 64)
+#define IDGEN_CHUNK_IDS         ((uint64_t)IDGEN_PAGE_IDS * IDGEN_CHUNK_PAGES)
+#define IDGEN_MAX_CHUNKS        1024
+#define IDGEN_MAX_CHUNK_WORDS   (IDGEN_MAX_CHUNKS / 64)
+
+typedef struct idgen_page
+{
+    uint64_t bits[IDGEN_PAGE_WORDS];    // bitset representing used IDs
+    uint64_t full_words;                // a bit per full word of bits
+    uint32_t count;
+} idgen_page;
+
+typedef struct idgen_chunk
+{
+    idgen_page* pages[IDGEN_CHUNK_PAGES];
+    uint64_t full_pages[IDGEN_CHUNK_WORDS];
+    uint32_t page_count;                // pages allocated
+    uint32_t full_count;                // pages full
+} idgen_chunk;
+
+// missing chunks and pages hold no id, they are allocated on the first id registered in them and released once empty
+struct idgen
+{
+    uint32_t current_id;
+    uint32_t start_id;
+    uint32_t end_id;          // last id handed out, inclusive so the range can reach UINT32_MAX
+    uint64_t count;
+    uint32_t chunk_count;
+    idgen_chunk** chunks;
+    uint64_t full_chunks[IDGEN_MAX_CHUNK_WORDS];
+    size_t alignment;         // alignment of the bitset pages
+    ctoolbox_memfuncs memfuncs;
+    ctoolbox_memstats stats;
+};
+
+// macros for bit manipulation
+#define BIT_INDEX(id, base)   ((id) - (base))
+#define BIT_WORD(i)           ((i) >> 6)          // divide by 64
+#define BIT_MASK(i)           ((uint64_t)1 << ((i) & 63u))
+#define BIT_FULL              (~(uint64_t)0)
+
+static inline uint32_t bit_ctz(uint64_t value)
 {
-    if (!array || index >= array->size) return NULL;
-    return (char*)array->data + (index * array->elementSize);
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index;
+    _BitScanForward64(&index, value);
+    return index;
+#else
+    return (uint32_t)__builtin_ctzll(value);
+#endif
 }
 
-CTOOLBOX_API const void* darray_const_data(const darray* array)
+// first clear bit at or after bit in count words, count * 64 if there is none
+static inline uint64_t bit_find_clear(const uint64_t* words, uint32_t count, uint64_t bit)
 {
-    return array ? array->data : NULL;
-}
-
-CTOOLBOX_API ctoolbox_result darray_get(const darray *array, size_t index, void* elementOut)
- {
-    if (!array || !elementOut || index >= array->size) return CTOOLBOX_ERROR_INVALID_PARAM;
-    memcpy(elementOut, (char*)array->data + (index * array->elementSize), array->elementSize);
-    return CTOOLBOX_SUCCESS;
-}
+    uint64_t word = BIT_WORD(bit);
+    if (word >= count) return (uint64_t)count * 64;
 
-CTOOLBOX_API ctoolbox_result darray_set(darray* array, size_t index, const void* element)
- {
-    if (!array || !element || index >= array->size) return CTOOLBOX_ERROR_INVALID_PARAM;
-    memcpy((char*)array->data + (index * array->elementSize), element, array->elementSize);
-    return CTOOLBOX_SUCCESS;
+    uint64_t free_bits = ~words[word] & (BIT_FULL << (bit & 63u));
+    while (!free_bits) {
+        if (++word == count) return (uint64_t)count * 64;
+        free_bits = ~words[word];
+    }
+    return word * 64 + bit_ctz(free_bits);
 }
 
-CTOOLBOX_API ctoolbox_result darray_insert_at(darray* array, size_t index, const void* element)
+// first free offset of the page at or after offset, IDGEN_PAGE_IDS if there is none
+static uint64_t page_find_free(const idgen_page* page, uint64_t offset)
 {
-    if (!array || !element || index > array->size) return CTOOLBOX_ERROR_INVALID_PARAM;
-
-    // ensure capacity
-    if (array->size >= array->capacity) {
-        ctoolbox_result result = darray_reserve(array, array->capacity * 2);
-        if (result != CTOOLBOX_SUCCESS) return result;
-    }
+    if (!page) return offset;
 
-    // shift elements to make space
-    if (index < array->size) {
-        char* data = (char*)array->data;
-        memmove(data + ((index + 1) * array->elementSize), data + (index * array->elementSize), (array->size - index) * array->elementSize);
-    }
+    uint64_t word = BIT_WORD(offset);
+    uint64_t free_bits = ~page->bits[word] & (BIT_FULL << (offset & 63u));
+    if (free_bits) return word * 64 + bit_ctz(free_bits);
 
-    // insert new element
-    memcpy((char*)array->data + (index * array->elementSize), element, array->elementSize);
-    array->size++;
-    return CTOOLBOX_SUCCESS;
+    word = bit_find_clear(&page->full_words, 1, word + 1);
+    if (word == IDGEN_PAGE_WORDS) return IDGEN_PAGE_IDS;
+    return word * 64 + bit_ctz(~page->bits[word]);
 }
 
-CTOOLBOX_API ctoolbox_result darray_remove_at(darray* array, size_t index, void* elementOut)
+// first free offset of the chunk at or after offset, IDGEN_CHUNK_IDS if there is none
+static uint64_t chunk_find_free(const idgen_chunk* chunk, uint64_t offset)
 {
-    if (!array || index >= array->size) {
-        return CTOOLBOX_ERROR_INVALID_PARAM;
-    }
+    if (!chunk) return offset;
 
-    if (array->size == 0) {
-        return CTOOLBOX_ERROR_EMPTY;
-    }
+    uint64_t page = offset / IDGEN_PAGE_IDS;
+    uint64_t found = page_find_free(chunk->pages[page], offset % IDGEN_PAGE_IDS);
+    if (found < IDGEN_PAGE_IDS) return page * IDGEN_PAGE_IDS + found;
 
-    // if the caller wants the removed element, copy it first
-    if (elementOut) {
-        memcpy(elementOut, (char*)array->data + (index * array->elementSize), array->elementSize);
-    }
+    // a page that isn't full always has a free id
+    page = bit_find_clear(chunk->full_pages, IDGEN_CHUNK_WORDS, page + 1);
+    if (page == IDGEN_CHUNK_PAGES) return IDGEN_CHUNK_IDS;
+    return page * IDGEN_PAGE_IDS + page_find_free(chunk->pages[page], 0);
+}
 
-    // shift elements left to overwrite the removed element
-    if (index < array->size - 1) {
-        char* data = (char*)array->data;
-        memmove(data + (index * array->elementSize), data + ((index + 1) * array->elementSize), (array->size - index - 1) * array->elementSize);
+// first free index at or after idx, skipping full words, pages and chunks through their summaries, the range size if there is none
+static uint64_t bit_find_free(const idgen* gen, uint64_t idx)
+{
+    uint64_t range = (uint64_t)gen->end_id - gen->start_id + 1;
+    if (idx >= range) return range;
+
+    uint64_t chunk = idx / IDGEN_CHUNK_IDS;
+    uint64_t found = chunk_find_free(gen->chunks[chunk], idx % IDGEN_CHUNK_IDS);
+    if (found == IDGEN_CHUNK_IDS) {
+        chunk = bit_find_clear(gen->full_chunks, IDGEN_MAX_CHUNK_WORDS, chunk + 1);
+        if (chunk >= gen->chunk_count) return range;
+        found = chunk_find_free(gen->chunks[chunk], 0);
     }
 
-    array->size--;
-    return CTOOLBOX_SUCCESS;
+    // the last page and chunk may reach past the range
+    found += chunk * IDGEN_CHUNK_IDS;
+    return found < range ? found : range;
 }
 
-CTOOLBOX_API ctoolbox_result darray_resize(darray* array, size_t newSize)
+static inline bool bit_test(const idgen* gen, uint32_t idx)
 {
-    if (!array) return CTOOLBOX_ERROR_INVALID_PARAM;
-    if (newSize > array->capacity) {
-        ctoolbox_result res = darray_reserve(array, newSize);
-        if (res != CTOOLBOX_SUCCESS) return res;
-    }
-    
-    array->size = newSize;
-    return CTOOLBOX_SUCCESS;
+    const idgen_chunk* chunk = gen->chunks[idx / IDGEN_CHUNK_IDS];
+    if (!chunk) return false;
+
+    const idgen_page* page = chunk->pages[(idx / IDGEN_PAGE_IDS) % IDGEN_CHUNK_PAGES];
+    return page && (page->bits[BIT_WORD(idx % IDGEN_PAGE_IDS)] & BIT_MASK(idx));
 }
 
-CTOOLBOX_API ctoolbox_result darray_reserve(darray* array, size_t newCapacity)
+// marks a free id used, allocating its chunk and page if needed, false if they can't be allocated
+static bool bit_set(idgen* gen, uint32_t idx)
 {
-    if (!array) return CTOOLBOX_ERROR_INVALID_PARAM;
-    if (newCapacity <= array->capacity) return CTOOLBOX_SUCCESS;
-
-    size_t newSizeBytes = newCapacity * array->elementSize;
-    size_t oldSizeBytes = array->size * array->elementSize;
+    uint32_t chunk_index = (uint32_t)(idx / IDGEN_CHUNK_IDS);
+    uint32_t page_index = (idx / IDGEN_PAGE_IDS) % IDGEN_CHUNK_PAGES;
 
-    void* newData = NULL;
+    idgen_chunk* chunk = gen->chunks[chunk_index];
+    if (!chunk) {
+        chunk = ctoolbox_custom_calloc(&gen->memfuncs, 1, sizeof(idgen_chunk));
+        if (!chunk) return false;
 
-    // try realloc directly
-    if (array->memfuncs.realloc_fn) {
-        newData = ctoolbox_custom_realloc(&array->memfuncs, array->data, newSizeBytes);
-        if (!newData) return CTOOLBOX_ERROR_MEMORY_ALLOC;
-    } 
+        ctoolbox_memstats_on_alloc(&gen->stats, sizeof(idgen_chunk));
+        gen->chunks[chunk_index] = chunk;
+    }
 
-    // fallback: allocate, copy and free
-    else {
-        newData = ctoolbox_custom_malloc(&array->memfuncs, newSizeBytes);
-        if (!newData) return CTOOLBOX_ERROR_MEMORY_ALLOC;
+    idgen_page* page = chunk->pages[page_index];
+    if (!page) {
+        page = ctoolbox_custom_aligned_malloc(&gen->memfuncs, sizeof(idgen_page), gen->alignment);
+        if (!page) {
+            // a chunk made for this id alone goes away again
+            if (chunk->page_count == 0) {
+                ctoolbox_custom_free_sized(&gen->memfuncs, chunk, sizeof(idgen_chunk));
+                ctoolbox_memstats_on_free(&gen->stats, sizeof(idgen_chunk));
+                gen->chunks[chunk_index] = NULL;
+            }
+            return false;
+        }
 
-        memcpy(newData, array->data, oldSizeBytes);
-        ctoolbox_custom_free(&array->memfuncs, array->data);
+        memset(page, 0, sizeof(idgen_page));
+        ctoolbox_memstats_on_alloc(&gen->stats, sizeof(idgen_page));
+        chunk->pages[page_index] = page;
+        chunk->page_count++;
     }
 
-    array->data = newData;
-    array->capacity = newCapacity;
+    // a word, page or chunk filling up sets its bit in the summary above it
+    uint32_t word = BIT_WORD(idx % IDGEN_PAGE_IDS);
+    page->bits[word] |= BIT_MASK(idx);
+    page->count++;
+    if (page->bits[word] != BIT_FULL) return true;
 
-    return CTOOLBOX_SUCCESS;
+    page->full_words |= BIT_MASK(word);
+    if (page->count != IDGEN_PAGE_IDS) return true;
+
+    chunk->full_pages[BIT_WORD(page_index)] |= BIT_MASK(page_index);
+    if (++chunk->full_count != IDGEN_CHUNK_PAGES) return true;
+
+    gen->full_chunks[BIT_WORD(chunk_index)] |= BIT_MASK(chunk_index);
+    return true;
 }
 
-CTOOLBOX_API ctoolbox_result darray_shrink_to_fit(darray* array)
+// marks a used id free, releasing its page and chunk once they hold no id
+static void bit_clear(idgen* gen, uint32_t idx)
 {
-    if (!array) return CTOOLBOX_ERROR_INVALID_PARAM;
-    if (array->size == array->capacity) return CTOOLBOX_SUCCESS;
+    uint32_t chunk_index = (uint32_t)(idx / IDGEN_CHUNK_IDS);
+    uint32_t page_index = (idx / IDGEN_PAGE_IDS) % IDGEN_CHUNK_PAGES;
+    idgen_chunk* chunk = gen->chunks[chunk_index];
+    idgen_page* page = chunk->pages[page_index];
 
-    if (array->size == 0) {
-        ctoolbox_custom_free(&array->memfuncs, array->data);
-        array->data = NULL;
-        array->capacity = 0;
-        return CTOOLBOX_SUCCESS;
+    // whatever was full no longer is
+    if (page->count == IDGEN_PAGE_IDS) {
+        if (chunk->full_count-- == IDGEN_CHUNK_PAGES) gen->full_chunks[BIT_WORD(chunk_index)] &= ~BIT_MASK(chunk_index);
+        chunk->full_pages[BIT_WORD(page_index)] &= ~BIT_MASK(page_index);
     }
 
-    void* newData = ctoolbox_custom_malloc(&array->memfuncs, array->size * array->elementSize);
-    if (!newData) return CTOOLBOX_ERROR_MEMORY_ALLOC;
+    uint32_t word = BIT_WORD(idx % IDGEN_PAGE_IDS);
+    page->full_words &= ~BIT_MASK(word);
+    page->bits[word] &= ~BIT_MASK(idx);
+    if (--page->count > 0) return;
 
-    memcpy(newData, array->data, array->size * array->elementSize);
-    ctoolbox_custom_free(&array->memfuncs, array->data);
-    array->data = newData;
-    array->capacity = array->size;
-    return CTOOLBOX_SUCCESS;
-}
+    ctoolbox_custom_aligned_free_sized(&gen->memfuncs, page, sizeof(idgen_page), gen->alignment);
+    ctoolbox_memstats_on_free(&gen->stats, sizeof(idgen_page));
+    chunk->pages[page_index] = NULL;
+    if (--chunk->page_count > 0) return;
 
-CTOOLBOX_API size_t darray_size(const darray* array)
- {
-    return array ? array->size : 0;
+    ctoolbox_custom_free_sized(&gen->memfuncs, chunk, sizeof(idgen_chunk));
+    ctoolbox_memstats_on_free(&gen->stats, sizeof(idgen_chunk));
+    gen->chunks[chunk_index] = NULL;
 }
 
-CTOOLBOX_API size_t darray_capacity(const darray* array)
- {
-    return array ? array->capacity : 0;
-}
+// releases every page and chunk
+static void bit_release(idgen* gen)
+{
+    for (uint32_t c = 0; c < gen->chunk_count; c++) {
+        idgen_chunk* chunk = gen->chunks[c];
+        if (!chunk) continue;
 
-CTOOLBOX_API bool darray_empty(const darray *array)
- {
-    return array ? (array->size == 0) : true;
+        for (uint32_t p = 0; p < IDGEN_CHUNK_PAGES; p++) {
+            if (!chunk->pages[p]) continue;
+            ctoolbox_custom_aligned_free_sized(&gen->memfuncs, chunk->pages[p], sizeof(idgen_page), gen->alignment);
+            ctoolbox_memstats_on_free(&gen->stats, sizeof(idgen_page));
+        }
+        ctoolbox_custom_free_sized(&gen->memfuncs, chunk, sizeof(idgen_chunk));
+        ctoolbox_memstats_on_free(&gen->stats, sizeof(idgen_chunk));
+        gen->chunks[c] = NULL;
+    }
+    memset(gen->full_chunks, 0, sizeof(gen->full_chunks));
 }
 
-////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-// ID Generator
-////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// generations use the bits a handle leaves them, starting at 1 so no handle equals IDGEN_HANDLE_NULL, 0 marks a retired slot
+#define IDGEN_GENERATION_MAX    ((uint32_t)(((uint64_t)1 << (IDGEN_HANDLE_BITS - IDGEN_HANDLE_INDEX_BITS)) - 1))
+#define IDGEN_GENERATION_RETIRED 0
+// slot i is id i + 1 of the handles' own idgen, whose range bounds the slots as much as the handle bits do
+#define IDGEN_SLOT_LIMIT        (((uint64_t)1 << IDGEN_HANDLE_INDEX_BITS) < IDGEN_MAX_SAFE_IDS ? (uint32_t)((uint64_t)1 << IDGEN_HANDLE_INDEX_BITS) : (uint32_t)(IDGEN_MAX_SAFE_IDS - 1))
 
-struct idgen
+// the idgen tells which slots are in use and hands out the lowest free one, the slots only keep their generations
+struct idgen_handles
 {
-    uint32_t current_id;
-    uint32_t start_id;
-    uint32_t max_id;
+    idgen* ids;
+    uint32_t* generations;
+    uint32_t slot_count;      // slots handed out at least once
+    uint32_t capacity;
     uint32_t count;
-    uint32_t bitset_size;     // number of uint32_t words
-    uint32_t* used_bits;      // bitset representing used IDs
-    const ctoolbox_memfuncs* memfuncs;
+    ctoolbox_memfuncs memfuncs;
+    ctoolbox_memstats stats;  // the handles and their generations, the idgen keeps its own
 };
 
-// macros for bit manipulation
-#define BIT_INDEX(id, base)   ((id) - (base))
-#define BIT_WORD(i)           ((i) >> 5)          // divide by 32
-#define BIT_MASK(i)           (1u << ((i) & 31u))
-
-static inline bool bit_test(uint32_t* bits, uint32_t bitset_size, uint32_t idx)
+static bool handles_grow(idgen_handles* handles, uint32_t index)
 {
-    uint32_t word = BIT_WORD(idx);
-    if (word >= bitset_size) return false;
-    return bits[word] & BIT_MASK(idx);
-}
+    uint32_t new_capacity = handles->capacity ? handles->capacity : 16;
+    while (new_capacity <= index) new_capacity = new_capacity > IDGEN_SLOT_LIMIT / 2 ? IDGEN_SLOT_LIMIT : new_capacity * 2;
+    if ((uint64_t)new_capacity * sizeof(uint32_t) > SIZE_MAX) return false;
 
-static inline void bit_set(uint32_t* bits, uint32_t bitset_size, uint32_t idx)
-{
-    uint32_t word = BIT_WORD(idx);
-    if (word >= bitset_size) return;
-    bits[word] |= BIT_MASK(idx);
+    size_t old_bytes = handles->capacity * sizeof(uint32_t);
+    size_t new_bytes = new_capacity * sizeof(uint32_t);
+    uint32_t* generations = handles->generations
+        ? ctoolbox_custom_realloc_sized(&handles->memfuncs, handles->generations, old_bytes, new_bytes)
+        : ctoolbox_custom_malloc(&handles->memfuncs, new_bytes);
+    if (!generations) return false;
+
+    if (handles->generations) ctoolbox_memstats_on_realloc(&handles->stats, old_bytes, new_bytes);
+    else ctoolbox_memstats_on_alloc(&handles->stats, new_bytes);
+
+    handles->generations = generations;
+    handles->capacity = new_capacity;
+    return true;
 }
 
-static inline void bit_clear(uint32_t* bits, uint32_t bitset_size, uint32_t idx)
+static inline bool handles_live(const idgen_handles* handles, uint32_t index)
 {
-    uint32_t word = BIT_WORD(idx);
-    if (word >= bitset_size) return;
-    bits[word] &= ~BIT_MASK(idx);
+    return handles->generations[index] != IDGEN_GENERATION_RETIRED && idgen_is_registered(handles->ids, index + 1);
 }
 
-/////////////////////////////////////////////////////////////////////////////////////////////////////////////
-/// external
-/////////////////////////////////////////////////////////////////////////////////////////////////////////////
-
-CTOOLBOX_API idgen* idgen_create(uint32_t start_id)
+// bumps the generation of a slot leaving use and gives it back to the idgen, a slot out of generations stays registered so no stale handle can match it again
+static void handles_release(idgen_handles* handles, uint32_t index)
 {
-    return idgen_create_memfuncs(start_id, &CTOOLBOX_DEFAULT_MEMFUNCS);
+    if (handles->generations[index] == IDGEN_GENERATION_MAX) {
+        handles->generations[index] = IDGEN_GENERATION_RETIRED;
+        return;
+    }
+
+    handles->generations[index]++;
+    idgen_unregister(handles->ids, index + 1);
 }
 
-CTOOLBOX_API idgen* idgen_create_memfuncs(uint32_t start_id, const ctoolbox_memfuncs* memfuncs)
+// any range, idgen_create keeps accepting a start id of 0 as it always has
+static idgen* idgen_create_internal(uint32_t start_id, uint32_t end_id, size_t alignment, const ctoolbox_memfuncs* memfuncs)
 {
     const ctoolbox_memfuncs* actual_memfuncs = memfuncs ? memfuncs : &CTOOLBOX_DEFAULT_MEMFUNCS;
-    if (start_id >= IDGEN_MAX_SAFE_IDS) return NULL;
+    if (start_id > end_id) return NULL;
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0) return NULL;
 
     idgen* gen = ctoolbox_custom_malloc(actual_memfuncs, sizeof(idgen));
     if (!gen)  return NULL;
@@ -327,75 +5079,105 @@ CTOOLBOX_API idgen* idgen_create_memfuncs(uint32_t start_id, const ctoolbox_memf
     memset(gen, 0, sizeof(*gen));
     gen->start_id = start_id;
     gen->current_id = start_id;
-    gen->max_id = IDGEN_MAX_SAFE_IDS;
-    gen->memfuncs = actual_memfuncs;
-
-    gen->bitset_size = (IDGEN_MAX_SAFE_IDS + 31u) / 32u;
-    if (gen->bitset_size == 0) {
-        gen->bitset_size = 1;
-    }
+    gen->end_id = end_id;
+    gen->memfuncs = *actual_memfuncs;
+    gen->alignment = alignment;
 
-    gen->used_bits = ctoolbox_custom_malloc(actual_memfuncs, gen->bitset_size * sizeof(uint32_t));
-    if (!gen->used_bits) {
-        ctoolbox_custom_free(actual_memfuncs, gen);
+    // only the chunk directory is allocated up front, a pointer per 4M ids
+    gen->chunk_count = (uint32_t)(((uint64_t)end_id - start_id + IDGEN_CHUNK_IDS) / IDGEN_CHUNK_IDS);
+    gen->chunks = ctoolbox_custom_calloc(&gen->memfuncs, gen->chunk_count, sizeof(idgen_chunk*));
+    if (!gen->chunks) {
+        ctoolbox_custom_free_sized(&gen->memfuncs, gen, sizeof(idgen));
         return NULL;
     }
 
-    memset(gen->used_bits, 0, gen->bitset_size * sizeof(uint32_t));
+    ctoolbox_memstats_on_alloc(&gen->stats, sizeof(idgen));
+    ctoolbox_memstats_on_alloc(&gen->stats, gen->chunk_count * sizeof(idgen_chunk*));
     return gen;
 }
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/// external
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+CTOOLBOX_API idgen* idgen_create(uint32_t start_id)
+{
+    return idgen_create_memfuncs(start_id, &CTOOLBOX_DEFAULT_MEMFUNCS);
+}
+
+CTOOLBOX_API idgen* idgen_create_memfuncs(uint32_t start_id, const ctoolbox_memfuncs* memfuncs)
+{
+    return idgen_create_aligned(start_id, CTOOLBOX_DEFAULT_ALIGNMENT, memfuncs);
+}
+
+CTOOLBOX_API idgen* idgen_create_aligned(uint32_t start_id, size_t alignment, const ctoolbox_memfuncs* memfuncs)
+{
+    if (start_id >= IDGEN_MAX_SAFE_IDS) return NULL;
+    return idgen_create_internal(start_id, IDGEN_MAX_SAFE_IDS - 1, alignment, memfuncs);
+}
+
+CTOOLBOX_API idgen* idgen_create_range(uint32_t start_id, uint32_t end_id, size_t alignment, const ctoolbox_memfuncs* memfuncs)
+{
+    // 0 is what idgen_next returns once exhausted, it can't be an id too
+    if (start_id == 0) return NULL;
+    return idgen_create_internal(start_id, end_id, alignment, memfuncs);
+}
+
 void idgen_destroy(idgen* gen)
 {
     if (!gen) return;
-    const ctoolbox_memfuncs* mem = gen->memfuncs;
-    if (gen->used_bits) ctoolbox_custom_free(mem, gen->used_bits);
-    ctoolbox_custom_free(mem, gen);
+    bit_release(gen);
+
+    ctoolbox_memfuncs mem = gen->memfuncs;
+    ctoolbox_custom_free_sized(&mem, gen->chunks, gen->chunk_count * sizeof(idgen_chunk*));
+    ctoolbox_custom_free_sized(&mem, gen, sizeof(idgen));
 }
 
 CTOOLBOX_API uint32_t idgen_next(idgen* gen)
 {
-    if (!gen) return 0;
+    uint32_t id;
+    return idgen_try_next(gen, &id) ? id : 0;
+}
+
+CTOOLBOX_API bool idgen_try_next(idgen* gen, uint32_t* id_out)
+{
+    if (!gen || !id_out) return false;
 
-    uint32_t range = gen->max_id - gen->start_id;
-    for (uint32_t i = 0; i < range; i++) {
-        uint32_t candidate = gen->current_id + i;
-        if (candidate >= gen->max_id)
-            candidate = gen->start_id + (candidate - gen->max_id);
+    // first free id from the cursor on, then from the start of the range
+    uint64_t range = (uint64_t)gen->end_id - gen->start_id + 1;
+    uint64_t idx = bit_find_free(gen, BIT_INDEX(gen->current_id, gen->start_id));
+    if (idx == range) idx = bit_find_free(gen, 0);
+    if (idx == range) return false;
 
-        uint32_t idx = BIT_INDEX(candidate, gen->start_id);
-        if (!bit_test(gen->used_bits, gen->bitset_size, idx)) {  // Add bounds check
-            bit_set(gen->used_bits, gen->bitset_size, idx);      // Add bounds check
-            gen->count++;
-            gen->current_id = candidate + 1;
-            if (gen->current_id >= gen->max_id)
-                gen->current_id = gen->start_id;
-            return candidate;
-        }
-    }
-    return 0;
+    if (!bit_set(gen, (uint32_t)idx)) return false;
+    gen->count++;
+
+    uint32_t candidate = gen->start_id + (uint32_t)idx;
+    gen->current_id = candidate == gen->end_id ? gen->start_id : candidate + 1;
+    *id_out = candidate;
+    return true;
 }
 
 CTOOLBOX_API bool idgen_register(idgen* gen, uint32_t id)
 {
-    if (!gen || id < gen->start_id || id >= gen->max_id) return false;
+    if (!gen || id < gen->start_id || id > gen->end_id) return false;
 
     uint32_t idx = BIT_INDEX(id, gen->start_id);
-    if (bit_test(gen->used_bits, gen->bitset_size, idx)) return false;  // Add bounds check
+    if (bit_test(gen, idx)) return false;
 
-    bit_set(gen->used_bits, gen->bitset_size, idx);  // Add bounds check
+    if (!bit_set(gen, idx)) return false;
     gen->count++;
     return true;
 }
 
 CTOOLBOX_API bool idgen_unregister(idgen* gen, uint32_t id)
 {
-    if (!gen || id < gen->start_id || id >= gen->max_id) return false;
+    if (!gen || id < gen->start_id || id > gen->end_id) return false;
 
     uint32_t idx = BIT_INDEX(id, gen->start_id);
-    if (!bit_test(gen->used_bits, gen->bitset_size, idx)) return false;
+    if (!bit_test(gen, idx)) return false;
 
-    bit_clear(gen->used_bits, gen->bitset_size, idx);
+    bit_clear(gen, idx);
     gen->count--;
 
     // move current_id back for better reuse
@@ -406,24 +5188,153 @@ CTOOLBOX_API bool idgen_unregister(idgen* gen, uint32_t id)
 
 CTOOLBOX_API bool idgen_is_registered(idgen* gen, uint32_t id)
 {
-    if (!gen || id < gen->start_id || id >= gen->max_id) return false;
+    if (!gen || id < gen->start_id || id > gen->end_id) return false;
     uint32_t idx = BIT_INDEX(id, gen->start_id);
-    return bit_test(gen->used_bits, gen->bitset_size, idx);
+    return bit_test(gen, idx);
 }
 
 CTOOLBOX_API uint32_t idgen_count(idgen* gen)
 {
-    return gen ? gen->count : 0;
+    if (!gen) return 0;
+    return gen->count > UINT32_MAX ? UINT32_MAX : (uint32_t)gen->count;
 }
 
 CTOOLBOX_API void idgen_reset(idgen* gen)
 {
     if (!gen) return;
-    memset(gen->used_bits, 0, gen->bitset_size * sizeof(uint32_t));
+    bit_release(gen);
     gen->count = 0;
     gen->current_id = gen->start_id;
 }
 
+CTOOLBOX_API ctoolbox_result idgen_memory_usage(const idgen* gen, ctoolbox_memstats* statsOut)
+{
+    if (!gen || !statsOut) return CTOOLBOX_ERROR_INVALID_PARAM;
+    *statsOut = gen->stats;
+    return CTOOLBOX_SUCCESS;
+}
+
+CTOOLBOX_API idgen_handles* idgen_handles_create(uint32_t initial_capacity)
+{
+    return idgen_handles_create_memfuncs(initial_capacity, &CTOOLBOX_DEFAULT_MEMFUNCS);
+}
+
+CTOOLBOX_API idgen_handles* idgen_handles_create_memfuncs(uint32_t initial_capacity, const ctoolbox_memfuncs* memfuncs)
+{
+    const ctoolbox_memfuncs* actual_memfuncs = memfuncs ? memfuncs : &CTOOLBOX_DEFAULT_MEMFUNCS;
+
+    idgen_handles* handles = ctoolbox_custom_malloc(actual_memfuncs, sizeof(idgen_handles));
+    if (!handles) return NULL;
+
+    memset(handles, 0, sizeof(*handles));
+    handles->memfuncs = *actual_memfuncs;
+    handles->ids = idgen_create_range(1, IDGEN_SLOT_LIMIT, CTOOLBOX_DEFAULT_ALIGNMENT, &handles->memfuncs);
+    if (!handles->ids) {
+        ctoolbox_custom_free_sized(&handles->memfuncs, handles, sizeof(idgen_handles));
+        return NULL;
+    }
+    ctoolbox_memstats_on_alloc(&handles->stats, sizeof(idgen_handles));
+
+    if (initial_capacity > 0) {
+        handles->capacity = initial_capacity < IDGEN_SLOT_LIMIT ? initial_capacity : IDGEN_SLOT_LIMIT;
+        handles->generations = ctoolbox_custom_malloc(&handles->memfuncs, handles->capacity * sizeof(uint32_t));
+        if (!handles->generations) {
+            idgen_destroy(handles->ids);
+            ctoolbox_custom_free_sized(&handles->memfuncs, handles, sizeof(idgen_handles));
+            return NULL;
+        }
+        ctoolbox_memstats_on_alloc(&handles->stats, handles->capacity * sizeof(uint32_t));
+    }
+
+    return handles;
+}
+
+CTOOLBOX_API void idgen_handles_destroy(idgen_handles* handles)
+{
+    if (!handles) return;
+
+    ctoolbox_memfuncs mem = handles->memfuncs;
+    idgen_destroy(handles->ids);
+    ctoolbox_custom_free_sized(&mem, handles->generations, handles->capacity * sizeof(uint32_t));
+    ctoolbox_custom_free_sized(&mem, handles, sizeof(idgen_handles));
+}
+
+CTOOLBOX_API idgen_handle idgen_handles_alloc(idgen_handles* handles)
+{
+    if (!handles) return IDGEN_HANDLE_NULL;
+
+    uint32_t id;
+    if (!idgen_try_next(handles->ids, &id)) return IDGEN_HANDLE_NULL;
+
+    // the lowest free slot, at most one past the slots handed out so far
+    uint32_t index = id - 1;
+    if (index >= handles->slot_count) {
+        if (index >= handles->capacity && !handles_grow(handles, index)) {
+            idgen_unregister(handles->ids, id);
+            return IDGEN_HANDLE_NULL;
+        }
+        for (uint32_t i = handles->slot_count; i <= index; i++) handles->generations[i] = 1;
+        handles->slot_count = index + 1;
+    }
+
+    handles->count++;
+    return ((idgen_handle)handles->generations[index] << IDGEN_HANDLE_INDEX_BITS) | index;
+}
+
+CTOOLBOX_API bool idgen_handles_free(idgen_handles* handles, idgen_handle handle)
+{
+    if (!idgen_handles_valid(handles, handle)) return false;
+
+    handles_release(handles, IDGEN_HANDLE_INDEX(handle));
+    handles->count--;
+    return true;
+}
+
+CTOOLBOX_API bool idgen_handles_valid(const idgen_handles* handles, idgen_handle handle)
+{
+    if (!handles) return false;
+
+    uint32_t index = IDGEN_HANDLE_INDEX(handle);
+    if (index >= handles->slot_count) return false;
+
+    return handles->generations[index] == IDGEN_HANDLE_GENERATION(handle) && handles_live(handles, index);
+}
+
+CTOOLBOX_API uint32_t idgen_handles_count(const idgen_handles* handles)
+{
+    return handles ? handles->count : 0;
+}
+
+CTOOLBOX_API uint32_t idgen_handles_slot_count(const idgen_handles* handles)
+{
+    return handles ? handles->slot_count : 0;
+}
+
+CTOOLBOX_API void idgen_handles_reset(idgen_handles* handles)
+{
+    if (!handles) return;
+
+    for (uint32_t i = 0; i < handles->slot_count; i++) {
+        if (handles_live(handles, i)) handles_release(handles, i);
+    }
+    handles->count = 0;
+}
+
+CTOOLBOX_API ctoolbox_result idgen_handles_memory_usage(const idgen_handles* handles, ctoolbox_memstats* statsOut)
+{
+    if (!handles || !statsOut) return CTOOLBOX_ERROR_INVALID_PARAM;
+
+    ctoolbox_memstats ids;
+    idgen_memory_usage(handles->ids, &ids);
+    *statsOut = handles->stats;
+    statsOut->liveBytes += ids.liveBytes;
+    statsOut->peakBytes += ids.peakBytes;
+    statsOut->allocCount += ids.allocCount;
+    statsOut->reallocCount += ids.reallocCount;
+    statsOut->freeCount += ids.freeCount;
+    return CTOOLBOX_SUCCESS;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Static Hashtable
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -434,15 +5345,19 @@ CTOOLBOX_API void idgen_reset(idgen* gen)
 
 struct shash 
 {
-    char* key;
     void* value;
     struct shash* next;
+    bool pooled;        // from the slab, otherwise straight from the memory functions
 };
 
+// a slab only pays off once the entries fill a page of it, smaller tables allocate each entry on its own
 struct shashtable
 {
     shash* buckets[SHASHTABLE_SIZE];
+    slab* entries;                  // NULL until the entries outgrow a slab page
+    size_t plainBytes;              // entries allocated outside the slab
     ctoolbox_memfuncs memfuncs;
+    ctoolbox_memstats stats;        // the table and the entries outside the slab
     size_t count;  // Track total entries
 };
 
@@ -459,18 +5374,50 @@ CTOOLBOX_API unsigned long shash_djb2_hash(const char *str)
     return hash % SHASHTABLE_SIZE;
 }
 
-CTOOLBOX_API ctoolbox_result shash_strdup(const ctoolbox_memfuncs* fun, const char* src, char** output)
+static inline size_t shash_alloc_size(size_t keyLength)
 {
-    if (!fun || !src || !output) return CTOOLBOX_ERROR_INVALID_PARAM;
-    
-    size_t len = strlen(src);
-    char* str = (char*)ctoolbox_custom_malloc(fun, len + 1);
-    if (!str) return CTOOLBOX_ERROR_MEMORY_ALLOC;
-    
-    memcpy(str, src, len + 1);
-    *output = str;
-    
-    return CTOOLBOX_SUCCESS;
+    return sizeof(shash) + keyLength + 1;
+}
+
+// the key is stored right after the entry, both come from one allocation
+static inline char* shash_key(const shash* entry)
+{
+    return (char*)(entry + 1);
+}
+
+static shash* shash_alloc(shashtable* table, size_t size)
+{
+    if (!table->entries && table->plainBytes + size < SLAB_PAGE_SIZE) {
+        shash* entry = ctoolbox_custom_malloc(&table->memfuncs, size);
+        if (!entry) return NULL;
+
+        entry->pooled = false;
+        table->plainBytes += size;
+        ctoolbox_memstats_on_alloc(&table->stats, size);
+        return entry;
+    }
+
+    if (!table->entries) {
+        table->entries = slab_init_memfuncs(&table->memfuncs);
+        if (!table->entries) return NULL;
+    }
+
+    shash* entry = (shash*)slab_alloc(table->entries, size);
+    if (entry) entry->pooled = true;
+    return entry;
+}
+
+static void shash_free(shashtable* table, shash* entry)
+{
+    size_t size = shash_alloc_size(strlen(shash_key(entry)));
+    if (entry->pooled) {
+        slab_free(table->entries, entry, size);
+        return;
+    }
+
+    table->plainBytes -= size;
+    ctoolbox_custom_free_sized(&table->memfuncs, entry, size);
+    ctoolbox_memstats_on_free(&table->stats, size);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -485,6 +5432,7 @@ CTOOLBOX_API shashtable* shashtable_init()
 CTOOLBOX_API shashtable* shashtable_init_memfuncs(const ctoolbox_memfuncs* memfuncs)
 {
     shashtable* outHashtable = ctoolbox_custom_malloc(memfuncs ? memfuncs : &CTOOLBOX_DEFAULT_MEMFUNCS, sizeof(shashtable));
+    if (!outHashtable) return NULL;
 
     for (int i = 0; i < SHASHTABLE_SIZE; i++) {
         outHashtable->buckets[i] = NULL;
@@ -493,6 +5441,11 @@ CTOOLBOX_API shashtable* shashtable_init_memfuncs(const ctoolbox_memfuncs* memfu
     if (memfuncs) outHashtable->memfuncs = *memfuncs;
     else outHashtable->memfuncs = CTOOLBOX_DEFAULT_MEMFUNCS;
 
+    outHashtable->entries = NULL;
+    outHashtable->plainBytes = 0;
+    memset(&outHashtable->stats, 0, sizeof(outHashtable->stats));
+    ctoolbox_memstats_on_alloc(&outHashtable->stats, sizeof(shashtable));
+
     outHashtable->count = 0;
     return outHashtable;
 }
@@ -501,16 +5454,17 @@ CTOOLBOX_API void shashtable_destroy(shashtable* table)
 {
     if (!table) return;
 
-    for (int i = 0; i < SHASHTABLE_SIZE; i++) {
-        shash* entry = table->buckets[i];
-        while (entry) {
-            shash* next = entry->next;
-            ctoolbox_custom_free(&table->memfuncs, entry->key);
-            ctoolbox_custom_free(&table->memfuncs, entry);
-            entry = next;
+    // entries in the slab go with it, only those allocated before it are walked to
+    for (int i = 0; i < SHASHTABLE_SIZE && table->plainBytes; i++) {
+        shash* current = table->buckets[i];
+        while (current) {
+            shash* next = current->next;
+            if (!current->pooled) shash_free(table, current);
+            current = next;
         }
     }
-    ctoolbox_custom_free(&table->memfuncs, table);
+    slab_destroy(table->entries);
+    ctoolbox_custom_free_sized(&table->memfuncs, table, sizeof(shashtable));
 }
 
 CTOOLBOX_API ctoolbox_result shashtable_insert(shashtable *table, const char* key, void* value)
@@ -523,27 +5477,21 @@ CTOOLBOX_API ctoolbox_result shashtable_insert(shashtable *table, const char* ke
     // check if key already exists
     shash* current = table->buckets[index];
     while (current) {
-        if (strcmp(current->key, key) == 0) {
+        if (strcmp(shash_key(current), key) == 0) {
             current->value = value;
             return CTOOLBOX_SUCCESS;
         }
         current = current->next;
     }
 
-    // create new entry
-    shash* new_entry = (shash*)ctoolbox_custom_malloc(&table->memfuncs, sizeof(shash));
+    // create new entry with the key copied right after it
+    size_t keyLength = strlen(key);
+    shash* new_entry = shash_alloc(table, shash_alloc_size(keyLength));
     if (!new_entry) return CTOOLBOX_ERROR_MEMORY_ALLOC;
 
-    new_entry->key = NULL;
     new_entry->value = value;
     new_entry->next = NULL;
-
-    // duplicate key
-    ctoolbox_result result = shash_strdup(&table->memfuncs, key, &new_entry->key);
-    if (result != CTOOLBOX_SUCCESS) {
-        ctoolbox_custom_free(&table->memfuncs, new_entry);
-        return result;
-    }
+    memcpy(shash_key(new_entry), key, keyLength + 1);
 
     // insert at beginning of chain (simplest)
     new_entry->next = table->buckets[index];
@@ -562,12 +5510,11 @@ CTOOLBOX_API ctoolbox_result shashtable_delete(shashtable* table, const char* ke
     shash* prev = NULL;
 
     while (current) {
-        if (strcmp(current->key, key) == 0) {
+        if (strcmp(shash_key(current), key) == 0) {
             if (prev) prev->next = current->next;
             else table->buckets[index] = current->next;
 
-            ctoolbox_custom_free(&table->memfuncs, current->key);
-            ctoolbox_custom_free(&table->memfuncs, current);
+            shash_free(table, current);
             table->count--;
 
             return CTOOLBOX_SUCCESS;
@@ -587,7 +5534,7 @@ CTOOLBOX_API void* shashtable_lookup(shashtable* table, const char* key)
     const shash* current = table->buckets[index];
 
     while (current) {
-        if (strcmp(current->key, key) == 0) return current->value;
+        if (strcmp(shash_key(current), key) == 0) return current->value;
         current = current->next;
     }
 
@@ -604,3 +5551,23 @@ CTOOLBOX_API size_t shashtable_count(shashtable* table)
     return table ? table->count : 0;
 }
 
+CTOOLBOX_API ctoolbox_result shashtable_memory_usage(shashtable* table, ctoolbox_memstats* statsOut)
+{
+    if (!table || !statsOut) return CTOOLBOX_ERROR_INVALID_PARAM;
+
+    *statsOut = table->stats;
+    if (!table->entries) return CTOOLBOX_SUCCESS;
+
+    // the slab's figures on top, its peak and the table's may not have come at the same time
+    ctoolbox_memstats slabStats;
+    ctoolbox_result result = slab_memory_usage(table->entries, &slabStats);
+    if (result != CTOOLBOX_SUCCESS) return result;
+
+    statsOut->liveBytes += slabStats.liveBytes;
+    statsOut->peakBytes += slabStats.peakBytes;
+    statsOut->allocCount += slabStats.allocCount;
+    statsOut->reallocCount += slabStats.reallocCount;
+    statsOut->freeCount += slabStats.freeCount;
+    return CTOOLBOX_SUCCESS;
+}
+
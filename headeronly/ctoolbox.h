@@ -35,7 +35,9 @@ typedef enum ctoolbox_result
     CTOOLBOX_ERROR_OUT_OF_BOUNDS,
     CTOOLBOX_ERROR_EMPTY,
     CTOOLBOX_ERROR_NOT_FOUND,
-    CTOOLBOX_ERROR_FULL
+    CTOOLBOX_ERROR_FULL,
+    CTOOLBOX_ERROR_UNSUPPORTED,
+    CTOOLBOX_ERROR_IO
 } ctoolbox_result;
 
 /// @brief callback for custom allocation memories
@@ -43,19 +45,57 @@ typedef void* (*malloc_func)(size_t size);
 typedef void* (*calloc_func)(size_t num, size_t size);
 typedef void (*free_func)(void* ptr);
 typedef void* (*realloc_func)(void* ptr, size_t newSize);
+typedef void* (*aligned_malloc_func)(size_t size, size_t alignment);
+typedef void (*aligned_free_func)(void* ptr);
+typedef void (*free_sized_func)(void* ptr, size_t size);
 
-/// @brief bundle-up the memory functions into one structure
+/// @brief alignment requested by the library when it has no stricter requirement
+#ifndef CTOOLBOX_DEFAULT_ALIGNMENT
+    #define CTOOLBOX_DEFAULT_ALIGNMENT (2 * sizeof(void*))
+#endif
+
+/// @brief context-carrying callbacks, user is the pointer stored in ctoolbox_memfuncs and alignment is a power of two
+/// @brief size on free and oldSize on realloc are the size of the block when the caller knows it, 0 otherwise
+typedef void* (*alloc_ctx_func)(void* user, size_t size, size_t alignment);
+typedef void* (*realloc_ctx_func)(void* user, void* ptr, size_t oldSize, size_t newSize, size_t alignment);
+typedef void (*free_ctx_func)(void* user, void* ptr, size_t size);
+
+/// @brief bundle-up the memory functions into one structure, context-carrying callbacks take precedence when set
 typedef struct ctoolbox_memfuncs
 {
     malloc_func malloc_fn;
     calloc_func calloc_fn;
     free_func free_fn;
     realloc_func realloc_fn;
+    aligned_malloc_func aligned_malloc_fn;
+    aligned_free_func aligned_free_fn;
+    free_sized_func free_sized_fn;      // sdallocx/free_sized style, used instead of free_fn when the size is known
+    alloc_ctx_func alloc_ctx_fn;
+    realloc_ctx_func realloc_ctx_fn;
+    free_ctx_func free_ctx_fn;
+    void* user;
 } ctoolbox_memfuncs;
 
 /// @brief export memory functions
 CTOOLBOX_API extern const ctoolbox_memfuncs CTOOLBOX_DEFAULT_MEMFUNCS;
 
+/// @brief memory accounting of an allocator or a container
+typedef struct ctoolbox_memstats
+{
+    size_t liveBytes;       // bytes currently allocated
+    size_t peakBytes;       // highest liveBytes seen
+    size_t allocCount;      // allocations made
+    size_t reallocCount;    // reallocations made
+    size_t freeCount;       // blocks released
+} ctoolbox_memstats;
+
+/// @brief tracking allocator, accounts everything allocated through the memory functions it wraps
+typedef struct ctoolbox_tracker
+{
+    ctoolbox_memfuncs inner;
+    ctoolbox_memstats stats;
+} ctoolbox_tracker;
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // functions
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -73,9 +113,279 @@ CTOOLBOX_API void* ctoolbox_custom_calloc(const ctoolbox_memfuncs* fun, size_t n
 /// @brief custom free call, overrides default free with an optional custom function provided by the user
 CTOOLBOX_API void ctoolbox_custom_free(const ctoolbox_memfuncs* fun, void* ptr);
 
+/// @brief custom sized free call, size must be the one the block was allocated with, 0 when unknown
+CTOOLBOX_API void ctoolbox_custom_free_sized(const ctoolbox_memfuncs* fun, void* ptr, size_t size);
+
 /// @brief custom realloc call, overrides default realloc with an optional custom function provided by the user
+/// @brief context-carrying callbacks get no old size, those unable to find it on their own fail, see ctoolbox_custom_realloc_sized
 CTOOLBOX_API void* ctoolbox_custom_realloc(const ctoolbox_memfuncs* fun, void* ptr, size_t newSize);
 
+/// @brief custom sized realloc call, oldSize must be the size the block was allocated with, 0 when unknown
+/// @brief oldSize is only forwarded to context-carrying callbacks, which need it to move the block themselves
+CTOOLBOX_API void* ctoolbox_custom_realloc_sized(const ctoolbox_memfuncs* fun, void* ptr, size_t oldSize, size_t newSize);
+
+/// @brief custom aligned malloc call, alignment must be a power of two and the block released with ctoolbox_custom_aligned_free
+CTOOLBOX_API void* ctoolbox_custom_aligned_malloc(const ctoolbox_memfuncs* fun, size_t size, size_t alignment);
+
+/// @brief custom aligned free call, alignment must match the one used to allocate the block
+CTOOLBOX_API void ctoolbox_custom_aligned_free(const ctoolbox_memfuncs* fun, void* ptr, size_t alignment);
+
+/// @brief custom aligned sized free call, size and alignment must be the ones the block was allocated with
+CTOOLBOX_API void ctoolbox_custom_aligned_free_sized(const ctoolbox_memfuncs* fun, void* ptr, size_t size, size_t alignment);
+
+/// @brief custom aligned realloc call, the new block keeps the alignment, falls back to allocate, copy and free
+CTOOLBOX_API void* ctoolbox_custom_aligned_realloc(const ctoolbox_memfuncs* fun, void* ptr, size_t oldSize, size_t newSize, size_t alignment);
+
+/// @brief accounts an allocation of bytes into stats
+CTOOLBOX_API void ctoolbox_memstats_on_alloc(ctoolbox_memstats* stats, size_t bytes);
+
+/// @brief accounts a reallocation from oldBytes to newBytes into stats
+CTOOLBOX_API void ctoolbox_memstats_on_realloc(ctoolbox_memstats* stats, size_t oldBytes, size_t newBytes);
+
+/// @brief accounts the release of bytes into stats
+CTOOLBOX_API void ctoolbox_memstats_on_free(ctoolbox_memstats* stats, size_t bytes);
+
+/// @brief initializes the tracker on top of the inner memory functions, NULL wraps the default ones
+CTOOLBOX_API void ctoolbox_tracker_init(ctoolbox_tracker* tracker, const ctoolbox_memfuncs* inner);
+
+/// @brief returns memory functions that allocate through the tracker, which must outlive whatever uses them
+CTOOLBOX_API ctoolbox_memfuncs ctoolbox_tracker_memfuncs(ctoolbox_tracker* tracker);
+
+#ifdef __cplusplus
+}
+#endif
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Arena Allocator
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// @brief default amount of bytes each arena chunk holds
+#ifndef ARENA_CHUNK_SIZE
+    #define ARENA_CHUNK_SIZE 65536
+#endif
+
+/// @brief opaque arena (bump) allocator structure
+typedef struct arena arena;
+
+/// @brief position inside the arena, everything allocated after it can be released with arena_rollback
+typedef struct arena_marker
+{
+    void* chunk;
+    size_t offset;
+} arena_marker;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// functions
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// @brief creates the arena, chunkSize of 0 uses ARENA_CHUNK_SIZE
+CTOOLBOX_API arena* arena_init(size_t chunkSize);
+
+/// @brief creates the arena with custom memory allocation functions for its chunks
+CTOOLBOX_API arena* arena_init_memfuncs(size_t chunkSize, const ctoolbox_memfuncs* memfuncs);
+
+/// @brief destroys the arena and everything allocated from it
+CTOOLBOX_API void arena_destroy(arena* a);
+
+/// @brief bumps a block of size bytes with the given power of two alignment, 0 uses CTOOLBOX_DEFAULT_ALIGNMENT
+CTOOLBOX_API void* arena_alloc(arena* a, size_t size, size_t alignment);
+
+/// @brief bumps a zero-initialized block of num * size bytes
+CTOOLBOX_API void* arena_calloc(arena* a, size_t num, size_t size);
+
+/// @brief returns the current position of the arena
+CTOOLBOX_API arena_marker arena_mark(const arena* a);
+
+/// @brief releases everything allocated after the marker was taken
+CTOOLBOX_API void arena_rollback(arena* a, arena_marker marker);
+
+/// @brief releases everything allocated from the arena, keeping its first chunk around
+CTOOLBOX_API void arena_reset(arena* a);
+
+/// @brief returns how many bytes were handed out, including alignment padding
+CTOOLBOX_API size_t arena_used(const arena* a);
+
+/// @brief returns how many bytes the arena currently holds in chunks
+CTOOLBOX_API size_t arena_reserved(const arena* a);
+
+/// @brief returns memory functions that allocate from the arena, to be used with the *_init_memfuncs calls
+/// @brief frees are no-ops, containers living in the arena are released by arena_reset/arena_destroy without being destroyed
+/// @brief reallocs must carry the old size (ctoolbox_custom_realloc_sized), as the library containers do
+CTOOLBOX_API ctoolbox_memfuncs arena_memfuncs(arena* a);
+
+#ifdef __cplusplus
+}
+#endif
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Slab Allocator
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// @brief size in bytes of each slab, must be a power of two since slabs are aligned to it
+#ifndef SLAB_PAGE_SIZE
+    #define SLAB_PAGE_SIZE 4096
+#endif
+
+/// @brief number of size classes, objects bigger than SLAB_MAX_OBJECT_SIZE go straight to the memory functions
+#define SLAB_CLASS_COUNT 8
+#define SLAB_MAX_OBJECT_SIZE 256
+
+/// @brief opaque slab allocator structure
+typedef struct slab slab;
+
+/// @brief occupancy of one size class
+typedef struct slab_stats
+{
+    size_t objectSize;      // size of the objects in this class
+    size_t objectsPerSlab;  // how many objects fit in one slab
+    size_t slabCount;       // slabs currently allocated
+    size_t usedObjects;     // objects currently handed out
+    float occupancy;        // usedObjects / (slabCount * objectsPerSlab), 0 without slabs
+} slab_stats;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// functions
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// @brief creates the slab allocator
+CTOOLBOX_API slab* slab_init();
+
+/// @brief creates the slab allocator with custom memory allocation functions for its slabs
+CTOOLBOX_API slab* slab_init_memfuncs(const ctoolbox_memfuncs* memfuncs);
+
+/// @brief destroys the slab allocator and every object still allocated from it
+CTOOLBOX_API void slab_destroy(slab* s);
+
+/// @brief allocates an object of size bytes from the smallest size class that fits it
+CTOOLBOX_API void* slab_alloc(slab* s, size_t size);
+
+/// @brief releases an object, size must be the one it was allocated with
+CTOOLBOX_API void slab_free(slab* s, void* ptr, size_t size);
+
+/// @brief returns the occupancy of the size class at classIndex, in [0, SLAB_CLASS_COUNT)
+CTOOLBOX_API ctoolbox_result slab_get_stats(const slab* s, size_t classIndex, slab_stats* statsOut);
+
+/// @brief returns memory functions that allocate from the slab, to be used with the *_init_memfuncs calls
+/// @brief blocks are 16 bytes aligned, frees without the block size walk the objects bigger than SLAB_MAX_OBJECT_SIZE to find it
+CTOOLBOX_API ctoolbox_memfuncs slab_memfuncs(slab* s);
+
+/// @brief returns the memory the slab allocator holds, slabs and objects bigger than SLAB_MAX_OBJECT_SIZE included
+CTOOLBOX_API ctoolbox_result slab_memory_usage(const slab* s, ctoolbox_memstats* statsOut);
+
+#ifdef __cplusplus
+}
+#endif
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Thread Caching Allocator
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// @brief blocks each thread keeps per size class, half of them go back to the shared pool when it overflows
+#ifndef TCACHE_BIN_CAPACITY
+    #define TCACHE_BIN_CAPACITY 64
+#endif
+
+/// @brief blocks the shared pool keeps per size class, the rest go back to the memory functions
+#ifndef TCACHE_SHARED_CAPACITY
+    #define TCACHE_SHARED_CAPACITY 1024
+#endif
+
+/// @brief power of two size classes from 16 bytes up to TCACHE_MAX_BLOCK_SIZE, bigger blocks are not cached
+#define TCACHE_CLASS_COUNT 8
+#define TCACHE_MAX_BLOCK_SIZE 2048
+
+/// @brief opaque thread caching allocator structure
+typedef struct tcache tcache;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// functions
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// @brief creates the thread caching allocator
+CTOOLBOX_API tcache* tcache_init();
+
+/// @brief creates the thread caching allocator on top of custom memory allocation functions, which must be thread-safe
+CTOOLBOX_API tcache* tcache_init_memfuncs(const ctoolbox_memfuncs* memfuncs);
+
+/// @brief destroys the allocator and every cached block, no thread may be using it anymore
+CTOOLBOX_API void tcache_destroy(tcache* cache);
+
+/// @brief allocates a block from the calling thread's cache, may be called from any thread
+CTOOLBOX_API void* tcache_alloc(tcache* cache, size_t size);
+
+/// @brief returns a block to the calling thread's cache, size must be the one it was allocated with
+CTOOLBOX_API void tcache_free(tcache* cache, void* ptr, size_t size);
+
+/// @brief moves the calling thread's cached blocks to the shared pool, exiting threads do it on their own
+CTOOLBOX_API void tcache_flush(tcache* cache);
+
+/// @brief returns memory functions that allocate through the cache, to be used with the *_init_memfuncs calls
+/// @brief blocks are 16 bytes aligned and every free and realloc must carry the block size, as the library containers do
+CTOOLBOX_API ctoolbox_memfuncs tcache_memfuncs(tcache* cache);
+
+#ifdef __cplusplus
+}
+#endif
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Thread Pool
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// @brief tasks each queue holds, splits that don't fit run on the thread that made them
+#ifndef THREADPOOL_QUEUE_CAPACITY
+    #define THREADPOOL_QUEUE_CAPACITY 256
+#endif
+
+/// @brief opaque work-stealing thread pool structure
+typedef struct threadpool threadpool;
+
+/// @brief processes the indices in [begin, end), context is passed through untouched, anything but CTOOLBOX_SUCCESS fails the call
+typedef ctoolbox_result (*threadpool_range_func)(void* context, size_t begin, size_t end);
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// functions
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// @brief initializes the thread pool with threadCount workers, one less than the logical processors if 0 since callers help
+CTOOLBOX_API threadpool* threadpool_init(size_t threadCount);
+
+/// @brief initializes the thread pool with custom memory allocation functions
+CTOOLBOX_API threadpool* threadpool_init_memfuncs(size_t threadCount, const ctoolbox_memfuncs* memfuncs);
+
+/// @brief stops and joins the workers, no parallel call may be running
+CTOOLBOX_API void threadpool_destroy(threadpool* pool);
+
+/// @brief returns how many threads run a parallel call, the workers and the calling thread
+CTOOLBOX_API size_t threadpool_thread_count(const threadpool* pool);
+
+/// @brief calls func over [0, count) split in ranges of at most grain indices, returning once every range is done
+/// @brief idle workers steal the biggest pending ranges, the calling thread works too, any thread may call it
+/// @brief returns the first failure a range reported, the ranges not started by then are skipped
+CTOOLBOX_API ctoolbox_result threadpool_parallel_for(threadpool* pool, size_t count, size_t grain, threadpool_range_func func, void* context);
+
+/// @brief returns the memory the thread pool allocated, its header included
+CTOOLBOX_API ctoolbox_result threadpool_memory_usage(const threadpool* pool, ctoolbox_memstats* statsOut);
+
 #ifdef __cplusplus
 }
 #endif
@@ -85,9 +395,74 @@ CTOOLBOX_API void* ctoolbox_custom_realloc(const ctoolbox_memfuncs* fun, void* p
 // Dynamic Array
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+
+/// @brief arrays with fewer elements are sorted on the calling thread by darray_parallel_sort
+#ifndef DARRAY_PARALLEL_SORT_THRESHOLD
+    #define DARRAY_PARALLEL_SORT_THRESHOLD 65536
+#endif
+
+/// @brief most chunks darray_parallel_sort splits the work into, one per thread of the pool
+#ifndef DARRAY_SORT_MAX_THREADS
+    #define DARRAY_SORT_MAX_THREADS 64
+#endif
+
+/// @brief runs shorter than this are insertion sorted before merging
+#ifndef DARRAY_SORT_RUN
+    #define DARRAY_SORT_RUN 16
+#endif
+
+/// @brief arrays with fewer elements are processed on the calling thread by darray_parallel_for_each, transform, reduce and scan
+#ifndef DARRAY_PARALLEL_THRESHOLD
+    #define DARRAY_PARALLEL_THRESHOLD 16384
+#endif
+
+/// @brief bytes of elements each parallel task works on, 0 to use half of a core's L2 cache as queried at run time
+#ifndef DARRAY_PARALLEL_CHUNK_BYTES
+    #define DARRAY_PARALLEL_CHUNK_BYTES 0
+#endif
+
 /// @brief opaque dynamic array structure
 typedef struct darray darray;
 
+/// @brief how the array grows when it runs out of capacity
+typedef enum darray_growth
+{
+    DARRAY_GROWTH_FACTOR = 0,   // multiplies the capacity by value percent, 200 (doubling) by default
+    DARRAY_GROWTH_LINEAR,       // adds value elements at a time
+    DARRAY_GROWTH_PAGE          // adds value bytes at a time (a page if 0), keeping the storage a whole number of pages
+} darray_growth;
+
+/// @brief how darray_open_mapped maps the file
+typedef enum darray_map_mode
+{
+    DARRAY_MAP_READ_ONLY = 0,   // pages are shared with the file, the first write moves the elements to the heap
+    DARRAY_MAP_COPY_ON_WRITE    // written pages become private copies, the file is never modified
+} darray_map_mode;
+
+/// @brief compares two elements like qsort's comparator, negative when a goes before b
+typedef int (*darray_compare_func)(const void* a, const void* b);
+
+/// @brief tests an element, user is passed through untouched
+typedef bool (*darray_predicate_func)(const void* element, void* user);
+
+/// @brief visits an element in place, user is passed through untouched
+typedef void (*darray_element_func)(void* element, void* user);
+
+/// @brief writes the transformed element into elementOut, user is passed through untouched
+typedef void (*darray_transform_func)(const void* element, void* elementOut, void* user);
+
+/// @brief folds element into accumulator, both of the array's element type, must be associative
+typedef void (*darray_combine_func)(void* accumulator, const void* element, void* user);
+
+/// @brief leading fields of every darray, exposed only so the typed wrappers below can inline their fast paths
+typedef struct darray_header
+{
+    void* data;
+    size_t size;
+    size_t capacity;
+    size_t elementSize;
+} darray_header;
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // functions
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -102,6 +477,12 @@ CTOOLBOX_API darray* darray_init(size_t elementSize, size_t initialCapacity);
 /// @brief initializes the dynamic array with custom memory allocation functions
 CTOOLBOX_API darray* darray_init_memfuncs(size_t elementSize, size_t initialCapacity, const ctoolbox_memfuncs* memfuncs);
 
+/// @brief initializes the dynamic array with its storage aligned to alignment bytes (power of two) across growth
+CTOOLBOX_API darray* darray_init_aligned(size_t elementSize, size_t initialCapacity, size_t alignment, const ctoolbox_memfuncs* memfuncs);
+
+/// @brief initializes a darray whose first inlineCapacity elements live in the same allocation as the container, spilling to the heap once outgrown
+CTOOLBOX_API darray* darray_init_inline(size_t elementSize, size_t inlineCapacity, const ctoolbox_memfuncs* memfuncs);
+
 /// @brief destroys the dynamic array, but not the content itself, be-warned
 CTOOLBOX_API void darray_destroy(darray* array);
 
@@ -111,6 +492,22 @@ CTOOLBOX_API ctoolbox_result darray_push_back(darray* array, const void* element
 /// @brief removes an item from the array's back, not freeing it
 CTOOLBOX_API ctoolbox_result darray_pop_back(darray* array, void* elementOut);
 
+/// @brief reserves a slot at the array's back and returns it uninitialized for in-place construction, NULL on failure
+CTOOLBOX_API void* darray_emplace_back(darray* array);
+
+/// @brief reserves count contiguous slots at the array's back and returns the first one uninitialized, NULL on failure
+CTOOLBOX_API void* darray_emplace_back_n(darray* array, size_t count);
+
+/// @brief opens a slot at a given position, shifting the tail, and returns it uninitialized, NULL on failure
+CTOOLBOX_API void* darray_emplace_at(darray* array, size_t index);
+
+/// @brief writable access to the element at a given index, valid until the array grows or shrinks
+CTOOLBOX_API void* darray_peek(darray* array, size_t index);
+
+/// @brief writable access to the data underneath the array, valid until the array grows or shrinks
+/// @brief a read-only mapped array moves to the heap first, the const accessors read it in place
+CTOOLBOX_API void* darray_data(darray* array);
+
 /// @brief sees what is underneath a given index on the array
 CTOOLBOX_API const void* darray_const_peek(const darray* array, size_t index);
 
@@ -129,6 +526,27 @@ CTOOLBOX_API ctoolbox_result darray_insert_at(darray* array, size_t index, const
 /// @brief removes an item from a given position on the array
 CTOOLBOX_API ctoolbox_result darray_remove_at(darray* array, size_t index, void* elementOut);
 
+/// @brief removes the element at the index in O(1) by moving the last element into its place, the order isn't kept
+CTOOLBOX_API ctoolbox_result darray_swap_remove(darray* array, size_t index, void* elementOut);
+
+/// @brief removes every element the predicate accepts in a single pass keeping the order of the rest, returns how many were removed
+CTOOLBOX_API size_t darray_remove_if(darray* array, darray_predicate_func predicate, void* user);
+
+/// @brief keeps only the elements the predicate accepts in a single pass keeping their order, returns how many were removed
+CTOOLBOX_API size_t darray_retain(darray* array, darray_predicate_func predicate, void* user);
+
+/// @brief appends count elements to the array's back, growing the storage at most once
+CTOOLBOX_API ctoolbox_result darray_append(darray* array, const void* elements, size_t count);
+
+/// @brief appends every element of other to the array's back, both must have the same element size
+CTOOLBOX_API ctoolbox_result darray_append_darray(darray* array, const darray* other);
+
+/// @brief inserts count elements at a given position, shifting the tail once, elements must not point into the array
+CTOOLBOX_API ctoolbox_result darray_insert_range(darray* array, size_t index, const void* elements, size_t count);
+
+/// @brief removes count elements starting at a given position, copying them into elementsOut if provided
+CTOOLBOX_API ctoolbox_result darray_remove_range(darray* array, size_t index, size_t count, void* elementsOut);
+
 /// @brief resizes the array to a new size
 CTOOLBOX_API ctoolbox_result darray_resize(darray* array, size_t newSize);
 
@@ -141,12 +559,535 @@ CTOOLBOX_API ctoolbox_result darray_shrink_to_fit(darray* array);
 /// @brief returns the array's current size
 CTOOLBOX_API size_t darray_size(const darray* array);
 
-/// @brief returns the array's current max capacity
+/// @brief returns the array's current max capacity, 0 for an array still mapped read-only
 CTOOLBOX_API size_t darray_capacity(const darray* array);
 
 /// @brief returns if the array is currently empty
 CTOOLBOX_API bool darray_empty(const darray* array);
 
+/// @brief returns the alignment of the array's storage
+CTOOLBOX_API size_t darray_alignment(const darray* array);
+
+/// @brief sets how the array grows from now on, value is interpreted as described in darray_growth
+CTOOLBOX_API ctoolbox_result darray_set_growth(darray* array, darray_growth policy, size_t value);
+
+/// @brief once the storage grows past thresholdBytes it moves to an anonymous mapping grown with mremap, pages are remapped instead of copied
+/// @brief mapped storage bypasses the memory functions, 0 disables it for future growth, linux only, CTOOLBOX_ERROR_UNSUPPORTED elsewhere
+CTOOLBOX_API ctoolbox_result darray_set_mapped(darray* array, size_t thresholdBytes);
+
+/// @brief sorts the array in place without allocating, equal elements may be reordered
+/// @brief introsort with whole-word swaps for 4, 8 and 16 bytes elements, heapsort bounds the worst case to O(n log n)
+CTOOLBOX_API ctoolbox_result darray_sort(darray* array, darray_compare_func compare);
+
+/// @brief sorts the array keeping equal elements in order, using a scratch buffer as big as the array
+CTOOLBOX_API ctoolbox_result darray_stable_sort(darray* array, darray_compare_func compare);
+
+/// @brief stable sort split across the threads of the pool, arrays under DARRAY_PARALLEL_SORT_THRESHOLD or without a pool are sorted on the caller
+CTOOLBOX_API ctoolbox_result darray_parallel_sort(darray* array, threadpool* pool, darray_compare_func compare);
+
+/// @brief stable LSD radix sort on the 1, 2, 4 or 8 bytes integer key found keyOffset bytes into each element, no comparator involved
+CTOOLBOX_API ctoolbox_result darray_radix_sort(darray* array, size_t keyOffset, size_t keySize, bool keySigned);
+
+/// @brief returns the index of the first element of the sorted array not ordered before key, or the size if there is none
+CTOOLBOX_API size_t darray_lower_bound(const darray* array, const void* key, darray_compare_func compare);
+
+/// @brief returns the index of the first element of the sorted array ordered after key, or the size if there is none
+CTOOLBOX_API size_t darray_upper_bound(const darray* array, const void* key, darray_compare_func compare);
+
+/// @brief finds an element equal to key in the sorted array, CTOOLBOX_ERROR_NOT_FOUND if there is none
+CTOOLBOX_API ctoolbox_result darray_binary_search(const darray* array, const void* key, darray_compare_func compare, size_t* indexOut);
+
+/// @brief finds the first element equal to value byte for byte, vectorised for 1, 2, 4 and 8 bytes elements, CTOOLBOX_ERROR_NOT_FOUND if there is none
+CTOOLBOX_API ctoolbox_result darray_find(const darray* array, const void* value, size_t* indexOut);
+
+/// @brief returns how many elements are equal to value byte for byte
+CTOOLBOX_API size_t darray_count(const darray* array, const void* value);
+
+/// @brief returns whether an element is equal to value byte for byte
+CTOOLBOX_API bool darray_contains(const darray* array, const void* value);
+
+/// @brief copies value into every element of the array
+CTOOLBOX_API ctoolbox_result darray_fill(darray* array, const void* value);
+
+/// @brief returns whether both arrays hold the same number of elements with the same bytes
+CTOOLBOX_API bool darray_equal(const darray* a, const darray* b);
+
+/// @brief calls func on every element, split in cache sized chunks across the pool, on the caller if pool is NULL
+CTOOLBOX_API ctoolbox_result darray_parallel_for_each(darray* array, threadpool* pool, darray_element_func func, void* user);
+
+/// @brief resizes destination to the size of source and writes func of every source element at the same index, in parallel like darray_parallel_for_each
+CTOOLBOX_API ctoolbox_result darray_parallel_transform(const darray* source, darray* destination, threadpool* pool, darray_transform_func func, void* user);
+
+/// @brief folds every element into resultOut starting from identity, each chunk is reduced on its own then the chunk results in order
+/// @brief the chunk results come from the array's memory functions but aren't counted in its darray_memory_usage, the array is only read
+CTOOLBOX_API ctoolbox_result darray_parallel_reduce(const darray* array, threadpool* pool, const void* identity, darray_combine_func combine, void* user, void* resultOut);
+
+/// @brief replaces every element with the fold of the elements up to it (inclusive prefix scan) in two parallel passes over the chunks
+CTOOLBOX_API ctoolbox_result darray_parallel_scan(darray* array, threadpool* pool, const void* identity, darray_combine_func combine, void* user);
+
+/// @brief writes the elements to path in a versioned format with the data aligned like the array, elements must be plain data
+/// @brief path is only replaced once the whole file is written, CTOOLBOX_ERROR_IO when it can't be
+CTOOLBOX_API ctoolbox_result darray_save(const darray* array, const char* path);
+
+/// @brief opens a file written by darray_save as a darray backed by the file pages themselves, loaded on demand without deserialising
+/// @brief growing the array or, when mapped read-only, writing to it moves the elements to the heap, returns NULL if the file can't be mapped or isn't valid
+CTOOLBOX_API darray* darray_open_mapped(const char* path, darray_map_mode mode, const ctoolbox_memfuncs* memfuncs);
+
+/// @brief returns the memory the array allocated, its header included
+CTOOLBOX_API ctoolbox_result darray_memory_usage(const darray* array, ctoolbox_memstats* statsOut);
+
+#ifdef __cplusplus
+}
+#endif
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// typed arrays
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// @brief generates darray_<name>_* functions with a compile time element size, e.g. DARRAY_DEFINE(u32, uint32_t)
+/// @brief the fast paths are inlined, growth and errors go through darray.c so the results match the untyped calls
+/// @brief at() doesn't check its arguments
+#define DARRAY_DEFINE(name, type)                                                                                   \
+    static inline darray* darray_##name##_init(size_t initialCapacity)                                              \
+    {                                                                                                               \
+        return darray_init(sizeof(type), initialCapacity);                                                          \
+    }                                                                                                               \
+                                                                                                                    \
+    static inline type* darray_##name##_data(darray* array)                                                         \
+    {                                                                                                               \
+        return (type*)darray_data(array);                                                                           \
+    }                                                                                                               \
+                                                                                                                    \
+    static inline type darray_##name##_at(const darray* array, size_t index)                                        \
+    {                                                                                                               \
+        return ((const type*)((const darray_header*)array)->data)[index];                                           \
+    }                                                                                                               \
+                                                                                                                    \
+    static inline ctoolbox_result darray_##name##_push_back(darray* array, type value)                              \
+    {                                                                                                               \
+        darray_header* header = (darray_header*)array;                                                              \
+        if (header && header->size < header->capacity) {                                                            \
+            ((type*)header->data)[header->size++] = value;                                                          \
+            return CTOOLBOX_SUCCESS;                                                                                \
+        }                                                                                                           \
+                                                                                                                    \
+        return darray_push_back(array, &value);                                                                     \
+    }                                                                                                               \
+                                                                                                                    \
+    static inline ctoolbox_result darray_##name##_pop_back(darray* array, type* elementOut)                         \
+    {                                                                                                               \
+        darray_header* header = (darray_header*)array;                                                              \
+        if (!header || header->size == 0) return darray_pop_back(array, elementOut);                                \
+        header->size--;                                                                                             \
+        if (elementOut) *elementOut = ((type*)header->data)[header->size];                                          \
+        return CTOOLBOX_SUCCESS;                                                                                    \
+    }                                                                                                               \
+                                                                                                                    \
+    static inline ctoolbox_result darray_##name##_get(const darray* array, size_t index, type* elementOut)          \
+    {                                                                                                               \
+        const darray_header* header = (const darray_header*)array;                                                  \
+        if (!header || !elementOut || index >= header->size) return darray_get(array, index, elementOut);           \
+        *elementOut = ((const type*)header->data)[index];                                                           \
+        return CTOOLBOX_SUCCESS;                                                                                    \
+    }                                                                                                               \
+                                                                                                                    \
+    static inline ctoolbox_result darray_##name##_set(darray* array, size_t index, type value)                      \
+    {                                                                                                               \
+        darray_header* header = (darray_header*)array;                                                              \
+        if (!header || index >= header->size || index >= header->capacity) {                                        \
+            return darray_set(array, index, &value);                                                                \
+        }                                                                                                           \
+        ((type*)header->data)[index] = value;                                                                       \
+        return CTOOLBOX_SUCCESS;                                                                                    \
+    }
+
+#ifdef __cplusplus
+#include <type_traits>
+
+namespace ctoolbox
+{
+    /// @brief owning darray of trivially copyable T, with the element size known at compile time
+    template<typename T>
+    class typed_darray
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "darray moves elements with memcpy");
+
+    public:
+
+        explicit typed_darray(size_t initialCapacity = 0, const ctoolbox_memfuncs* memfuncs = nullptr)
+            : mArray(darray_init_aligned(sizeof(T), initialCapacity, alignof(T), memfuncs)) {}
+
+        ~typed_darray() { darray_destroy(mArray); }
+
+        typed_darray(const typed_darray&) = delete;
+        typed_darray& operator=(const typed_darray&) = delete;
+
+        typed_darray(typed_darray&& other) noexcept : mArray(other.mArray) { other.mArray = nullptr; }
+
+        typed_darray& operator=(typed_darray&& other) noexcept
+        {
+            if (this != &other) {
+                darray_destroy(mArray);
+                mArray = other.mArray;
+                other.mArray = nullptr;
+            }
+            return *this;
+        }
+
+        /// @brief false when the underlying darray couldn't be allocated
+        bool valid() const { return mArray != nullptr; }
+
+        /// @brief the underlying darray, for the C api
+        darray* handle() const { return mArray; }
+
+        ctoolbox_result push_back(const T& value)
+        {
+            darray_header* header = reinterpret_cast<darray_header*>(mArray);
+            if (header && header->size < header->capacity) {
+                static_cast<T*>(header->data)[header->size++] = value;
+                return CTOOLBOX_SUCCESS;
+            }
+
+            return darray_push_back(mArray, &value);
+        }
+
+        ctoolbox_result pop_back(T* elementOut = nullptr)
+        {
+            darray_header* header = reinterpret_cast<darray_header*>(mArray);
+            if (!header || header->size == 0) return darray_pop_back(mArray, elementOut);
+            header->size--;
+            if (elementOut) *elementOut = static_cast<T*>(header->data)[header->size];
+            return CTOOLBOX_SUCCESS;
+        }
+
+        ctoolbox_result reserve(size_t newCapacity) { return darray_reserve(mArray, newCapacity); }
+        ctoolbox_result resize(size_t newSize) { return darray_resize(mArray, newSize); }
+
+        size_t size() const { return mArray ? header()->size : 0; }
+        size_t capacity() const { return mArray ? header()->capacity : 0; }
+        bool empty() const { return size() == 0; }
+
+        /// @brief unchecked element access
+        T& operator[](size_t index) { return data()[index]; }
+        const T& operator[](size_t index) const { return data()[index]; }
+
+        T* data() { return mArray ? static_cast<T*>(header()->data) : nullptr; }
+        const T* data() const { return mArray ? static_cast<const T*>(header()->data) : nullptr; }
+
+        T* begin() { return data(); }
+        T* end() { return data() + size(); }
+        const T* begin() const { return data(); }
+        const T* end() const { return data() + size(); }
+
+    private:
+
+        const darray_header* header() const { return reinterpret_cast<const darray_header*>(mArray); }
+
+    private:
+
+        darray* mArray;
+    };
+}
+#endif
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Segmented Array
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// @brief log2 of the element count of the first segment, each following segment doubles the previous one
+#ifndef SEGARRAY_FIRST_SEGMENT_SHIFT
+    #define SEGARRAY_FIRST_SEGMENT_SHIFT 4
+#endif
+
+/// @brief opaque segmented array structure
+typedef struct segarray segarray;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// functions
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// @brief initializes the segmented array, elements never move once stored so their addresses stay valid until popped
+CTOOLBOX_API segarray* segarray_init(size_t elementSize);
+
+/// @brief initializes the segmented array with custom memory allocation functions
+CTOOLBOX_API segarray* segarray_init_memfuncs(size_t elementSize, const ctoolbox_memfuncs* memfuncs);
+
+/// @brief destroys the segmented array, but not the content itself
+CTOOLBOX_API void segarray_destroy(segarray* array);
+
+/// @brief pushes an element into the array's back, growing by a new segment without copying when full
+CTOOLBOX_API ctoolbox_result segarray_push_back(segarray* array, const void* element);
+
+/// @brief pops the element at the array's back, copying it into elementOut if not NULL
+CTOOLBOX_API ctoolbox_result segarray_pop_back(segarray* array, void* elementOut);
+
+/// @brief appends an uninitialized element and returns its address, stable until popped, NULL on failure
+CTOOLBOX_API void* segarray_emplace_back(segarray* array);
+
+/// @brief returns the address of the element at the index, stable until popped, NULL if out of bounds
+CTOOLBOX_API void* segarray_peek(segarray* array, size_t index);
+
+/// @brief returns the address of the element at the index, NULL if out of bounds
+CTOOLBOX_API const void* segarray_const_peek(const segarray* array, size_t index);
+
+/// @brief copies the element at the index into elementOut
+CTOOLBOX_API ctoolbox_result segarray_get(const segarray* array, size_t index, void* elementOut);
+
+/// @brief overwrites the element at the index
+CTOOLBOX_API ctoolbox_result segarray_set(segarray* array, size_t index, const void* element);
+
+/// @brief allocates the segments needed to hold newCapacity elements
+CTOOLBOX_API ctoolbox_result segarray_reserve(segarray* array, size_t newCapacity);
+
+/// @brief releases the segments no element lives in
+CTOOLBOX_API ctoolbox_result segarray_shrink_to_fit(segarray* array);
+
+/// @brief returns the number of elements
+CTOOLBOX_API size_t segarray_size(const segarray* array);
+
+/// @brief returns how many elements the allocated segments hold
+CTOOLBOX_API size_t segarray_capacity(const segarray* array);
+
+/// @brief returns whether the array holds no element
+CTOOLBOX_API bool segarray_empty(const segarray* array);
+
+/// @brief returns the memory the array allocated, its header included
+CTOOLBOX_API ctoolbox_result segarray_memory_usage(const segarray* array, ctoolbox_memstats* statsOut);
+
+#ifdef __cplusplus
+}
+#endif
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Deque
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// @brief opaque double-ended queue structure
+typedef struct deque deque;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// functions
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// @brief initializes the deque, a ring buffer kept in a darray
+CTOOLBOX_API deque* deque_init(size_t elementSize, size_t initialCapacity);
+
+/// @brief initializes the deque with custom memory allocation functions
+CTOOLBOX_API deque* deque_init_memfuncs(size_t elementSize, size_t initialCapacity, const ctoolbox_memfuncs* memfuncs);
+
+/// @brief destroys the deque, but not the content itself
+CTOOLBOX_API void deque_destroy(deque* d);
+
+/// @brief pushes an element into the deque's back
+CTOOLBOX_API ctoolbox_result deque_push_back(deque* d, const void* element);
+
+/// @brief pushes an element into the deque's front
+CTOOLBOX_API ctoolbox_result deque_push_front(deque* d, const void* element);
+
+/// @brief pops the element at the deque's back, copying it into elementOut if not NULL
+CTOOLBOX_API ctoolbox_result deque_pop_back(deque* d, void* elementOut);
+
+/// @brief pops the element at the deque's front, copying it into elementOut if not NULL
+CTOOLBOX_API ctoolbox_result deque_pop_front(deque* d, void* elementOut);
+
+/// @brief pushes count elements into the deque's back, growing the storage at most once
+CTOOLBOX_API ctoolbox_result deque_push_back_n(deque* d, const void* elements, size_t count);
+
+/// @brief pops count elements from the deque's front in order, copying them into elementsOut if not NULL
+CTOOLBOX_API ctoolbox_result deque_pop_front_n(deque* d, void* elementsOut, size_t count);
+
+/// @brief returns the address of the element at the index counted from the front, NULL if out of bounds
+CTOOLBOX_API void* deque_peek(deque* d, size_t index);
+
+/// @brief returns the address of the element at the index counted from the front, NULL if out of bounds
+CTOOLBOX_API const void* deque_const_peek(const deque* d, size_t index);
+
+/// @brief copies the element at the index counted from the front into elementOut
+CTOOLBOX_API ctoolbox_result deque_get(const deque* d, size_t index, void* elementOut);
+
+/// @brief overwrites the element at the index counted from the front
+CTOOLBOX_API ctoolbox_result deque_set(deque* d, size_t index, const void* element);
+
+/// @brief grows the storage to hold at least newCapacity elements
+CTOOLBOX_API ctoolbox_result deque_reserve(deque* d, size_t newCapacity);
+
+/// @brief removes every element, keeping the storage
+CTOOLBOX_API void deque_clear(deque* d);
+
+/// @brief returns the number of elements
+CTOOLBOX_API size_t deque_size(const deque* d);
+
+/// @brief returns how many elements the storage holds
+CTOOLBOX_API size_t deque_capacity(const deque* d);
+
+/// @brief returns whether the deque holds no element
+CTOOLBOX_API bool deque_empty(const deque* d);
+
+/// @brief returns the memory the deque allocated, its header included
+CTOOLBOX_API ctoolbox_result deque_memory_usage(const deque* d, ctoolbox_memstats* statsOut);
+
+#ifdef __cplusplus
+}
+#endif
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Concurrent Array
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// @brief log2 of the element count of the first segment, each following segment doubles the previous one, at least 6
+#ifndef CDARRAY_FIRST_SEGMENT_SHIFT
+    #define CDARRAY_FIRST_SEGMENT_SHIFT 8
+#endif
+
+/// @brief opaque concurrent append-only array structure
+typedef struct cdarray cdarray;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// functions
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// @brief initializes the concurrent array, appends and reads may come from any thread, elements never move
+CTOOLBOX_API cdarray* cdarray_init(size_t elementSize);
+
+/// @brief initializes the concurrent array with custom memory allocation functions, which must be thread-safe
+CTOOLBOX_API cdarray* cdarray_init_memfuncs(size_t elementSize, const ctoolbox_memfuncs* memfuncs);
+
+/// @brief destroys the concurrent array, no other thread may be using it
+CTOOLBOX_API void cdarray_destroy(cdarray* array);
+
+/// @brief appends a copy of the element and publishes it, writing its index into indexOut if not NULL
+CTOOLBOX_API ctoolbox_result cdarray_push_back(cdarray* array, const void* element, size_t* indexOut);
+
+/// @brief claims the next slot with an atomic fetch-and-add and returns its address to be written in place
+/// @brief NULL when the segment holding the slot can't be allocated, the segment is then given up: its slots are never readable
+/// @brief and cdarray_committed steps over them, later claims move on to the next segment
+/// @brief the slot stays invisible to readers until cdarray_commit is called with its index
+CTOOLBOX_API void* cdarray_claim(cdarray* array, size_t* indexOut);
+
+/// @brief publishes a slot returned by cdarray_claim
+CTOOLBOX_API void cdarray_commit(cdarray* array, size_t index);
+
+/// @brief returns how many elements from the front are published, every index below it can be read safely unless its segment was given up
+CTOOLBOX_API size_t cdarray_committed(cdarray* array);
+
+/// @brief returns the address of the element at the index, NULL if it isn't published
+CTOOLBOX_API const void* cdarray_const_peek(const cdarray* array, size_t index);
+
+/// @brief copies the element at the index into elementOut, CTOOLBOX_ERROR_NOT_FOUND if it isn't published
+CTOOLBOX_API ctoolbox_result cdarray_get(const cdarray* array, size_t index, void* elementOut);
+
+/// @brief returns how many slots were claimed, published, unpublished or given up
+CTOOLBOX_API size_t cdarray_size(const cdarray* array);
+
+/// @brief returns the memory the array allocated, its header included
+CTOOLBOX_API ctoolbox_result cdarray_memory_usage(cdarray* array, ctoolbox_memstats* statsOut);
+
+#ifdef __cplusplus
+}
+#endif
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Structure of Arrays
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// @brief alignment of every column's first element, a cache line so columns never share one
+#ifndef SOARRAY_COLUMN_ALIGNMENT
+    #define SOARRAY_COLUMN_ALIGNMENT 64
+#endif
+
+/// @brief opaque structure-of-arrays container
+typedef struct soarray soarray;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// functions
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// @brief initializes the container with columnCount columns, column i holding elements of columnSizes[i] bytes
+CTOOLBOX_API soarray* soarray_init(const size_t* columnSizes, size_t columnCount, size_t initialCapacity);
+
+/// @brief initializes the container with custom memory allocation functions
+CTOOLBOX_API soarray* soarray_init_memfuncs(const size_t* columnSizes, size_t columnCount, size_t initialCapacity, const ctoolbox_memfuncs* memfuncs);
+
+/// @brief destroys the container, but not the content itself
+CTOOLBOX_API void soarray_destroy(soarray* array);
+
+/// @brief appends a row, fields holds one pointer per column, a NULL fields or field zero-fills that column
+CTOOLBOX_API ctoolbox_result soarray_push_back(soarray* array, const void* const* fields);
+
+/// @brief appends an uninitialized row to be written in place through the columns, writing its index into indexOut if not NULL
+CTOOLBOX_API ctoolbox_result soarray_emplace_back(soarray* array, size_t* indexOut);
+
+/// @brief removes the last row, copying each column's field into fieldsOut[i] when fieldsOut and fieldsOut[i] are not NULL
+CTOOLBOX_API ctoolbox_result soarray_pop_back(soarray* array, void* const* fieldsOut);
+
+/// @brief copies each column's field of the row into fieldsOut[i], NULL entries are skipped
+CTOOLBOX_API ctoolbox_result soarray_get(const soarray* array, size_t index, void* const* fieldsOut);
+
+/// @brief overwrites each column's field of the row with fields[i], NULL entries are left untouched
+CTOOLBOX_API ctoolbox_result soarray_set(soarray* array, size_t index, const void* const* fields);
+
+/// @brief removes the row in O(1) by moving the last row into its place, the order isn't kept
+CTOOLBOX_API ctoolbox_result soarray_swap_remove(soarray* array, size_t index);
+
+/// @brief writable access to a column's contiguous elements, valid until the container grows or shrinks
+CTOOLBOX_API void* soarray_column(soarray* array, size_t column);
+
+/// @brief access to a column's contiguous elements, valid until the container grows or shrinks
+CTOOLBOX_API const void* soarray_const_column(const soarray* array, size_t column);
+
+/// @brief writable access to a column's field of the row, NULL if out of bounds
+CTOOLBOX_API void* soarray_peek(soarray* array, size_t column, size_t index);
+
+/// @brief access to a column's field of the row, NULL if out of bounds
+CTOOLBOX_API const void* soarray_const_peek(const soarray* array, size_t column, size_t index);
+
+/// @brief returns the number of columns
+CTOOLBOX_API size_t soarray_column_count(const soarray* array);
+
+/// @brief returns the element size of a column, 0 if out of bounds
+CTOOLBOX_API size_t soarray_column_size(const soarray* array, size_t column);
+
+/// @brief resizes every column to newSize rows, new rows are uninitialized
+CTOOLBOX_API ctoolbox_result soarray_resize(soarray* array, size_t newSize);
+
+/// @brief reserves room for newCapacity rows in every column with a single allocation
+CTOOLBOX_API ctoolbox_result soarray_reserve(soarray* array, size_t newCapacity);
+
+/// @brief reallocates the columns into the smallest block holding the rows
+CTOOLBOX_API ctoolbox_result soarray_shrink_to_fit(soarray* array);
+
+/// @brief returns the number of rows
+CTOOLBOX_API size_t soarray_size(const soarray* array);
+
+/// @brief returns how many rows the columns hold before growing
+CTOOLBOX_API size_t soarray_capacity(const soarray* array);
+
+/// @brief returns whether the container holds no row
+CTOOLBOX_API bool soarray_empty(const soarray* array);
+
+/// @brief returns the memory the container allocated, its header included
+CTOOLBOX_API ctoolbox_result soarray_memory_usage(const soarray* array, ctoolbox_memstats* statsOut);
+
 #ifdef __cplusplus
 }
 #endif
@@ -157,9 +1098,32 @@ CTOOLBOX_API bool darray_empty(const darray* array);
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 #ifndef IDGEN_MAX_SAFE_IDS
-#define IDGEN_MAX_SAFE_IDS 16777216 // maximum of 16.7 million IDs (~2MB memory usage)
+#define IDGEN_MAX_SAFE_IDS 16777216 // maximum of 16.7 million IDs (~2MB memory usage when all in use, pages are allocated on demand)
 #endif // IDGEN_MAX_SAFE_IDS
 
+#ifndef IDGEN_HANDLE_BITS
+#define IDGEN_HANDLE_BITS 64 // width of a generational handle, 32 or 64
+#endif // IDGEN_HANDLE_BITS
+
+#ifndef IDGEN_HANDLE_INDEX_BITS
+#define IDGEN_HANDLE_INDEX_BITS (IDGEN_HANDLE_BITS / 2) // low bits of a handle holding the slot index, the high ones hold its generation
+#endif // IDGEN_HANDLE_INDEX_BITS
+
+#if IDGEN_HANDLE_BITS == 32
+typedef uint32_t idgen_handle;
+#else
+typedef uint64_t idgen_handle;
+#endif
+
+/// @brief never returned by idgen_handles_alloc, always invalid
+#define IDGEN_HANDLE_NULL ((idgen_handle)0)
+
+/// @brief slot index of a handle, dense enough to index a side array
+#define IDGEN_HANDLE_INDEX(handle) ((uint32_t)((handle) & (((idgen_handle)1 << IDGEN_HANDLE_INDEX_BITS) - 1)))
+
+/// @brief generation of a handle, bumped each time its slot is freed
+#define IDGEN_HANDLE_GENERATION(handle) ((uint32_t)((handle) >> IDGEN_HANDLE_INDEX_BITS))
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // functions
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -172,24 +1136,84 @@ extern "C" {
 /// @brief opaque id generator structure
 typedef struct idgen idgen;
 
-/// @brief initializes generator, set to UINT32_MAX for full range
+/// @brief opaque generational handle allocator structure
+typedef struct idgen_handles idgen_handles;
+
+/// @brief initializes generator handing out ids from start_id up to IDGEN_MAX_SAFE_IDS - 1
 CTOOLBOX_API idgen* idgen_create(uint32_t start_id);
 
 /// @brief initializes generator with custom allocation functions
 CTOOLBOX_API idgen* idgen_create_memfuncs(uint32_t start_id, const ctoolbox_memfuncs* memfuncs);
 
+/// @brief initializes generator with its bitset pages aligned to alignment bytes (power of two)
+CTOOLBOX_API idgen* idgen_create_aligned(uint32_t start_id, size_t alignment, const ctoolbox_memfuncs* memfuncs);
+
+/// @brief initializes generator handing out ids from start_id to end_id inclusive, up to the full 32 bits range (e.g. 1 to UINT32_MAX)
+/// @brief start_id must be at least 1 since idgen_next returns 0 once exhausted, NULL otherwise
+/// @brief the bitset is allocated in pages as ids get registered, so a wide range costs nothing until it is used
+CTOOLBOX_API idgen* idgen_create_range(uint32_t start_id, uint32_t end_id, size_t alignment, const ctoolbox_memfuncs* memfuncs);
+
 /// @brief releases the resources of the id generator
 CTOOLBOX_API void idgen_destroy(idgen* gen);
 
 /// @brief generate next ID, returns 0 if exhausted
 CTOOLBOX_API uint32_t idgen_next(idgen* gen);
 
+/// @brief generate next ID into id_out, returns false if exhausted, for generators created with a start_id of 0
+CTOOLBOX_API bool idgen_try_next(idgen* gen, uint32_t* id_out);
+
 /// @brief register an id
 CTOOLBOX_API bool idgen_register(idgen* gen, uint32_t id);
 
 /// @brief unregister an id
 CTOOLBOX_API bool idgen_unregister(idgen* gen, uint32_t id);
 
+/// @brief check if an ID is currently registered
+CTOOLBOX_API bool idgen_is_registered(idgen* gen, uint32_t id);
+
+/// @brief get the number of currently registered IDs, saturating at UINT32_MAX
+CTOOLBOX_API uint32_t idgen_count(idgen* gen);
+
+/// @brief resets generator to initial state, releasing every bitset page
+CTOOLBOX_API void idgen_reset(idgen* gen);
+
+/// @brief returns the memory the generator allocated, its bitset included
+CTOOLBOX_API ctoolbox_result idgen_memory_usage(const idgen* gen, ctoolbox_memstats* statsOut);
+
+/// @brief initializes a generational handle allocator, freed slots are reused with a new generation so stale handles stay invalid
+CTOOLBOX_API idgen_handles* idgen_handles_create(uint32_t initial_capacity);
+
+/// @brief initializes a generational handle allocator with custom allocation functions
+CTOOLBOX_API idgen_handles* idgen_handles_create_memfuncs(uint32_t initial_capacity, const ctoolbox_memfuncs* memfuncs);
+
+/// @brief releases the resources of the handle allocator
+CTOOLBOX_API void idgen_handles_destroy(idgen_handles* handles);
+
+/// @brief hands out a handle on the lowest free slot, found through the bitset summaries of the allocator's idgen, IDGEN_HANDLE_NULL if exhausted
+CTOOLBOX_API idgen_handle idgen_handles_alloc(idgen_handles* handles);
+
+/// @brief frees a live handle in O(1), returns false if it is stale or was never handed out
+CTOOLBOX_API bool idgen_handles_free(idgen_handles* handles, idgen_handle handle);
+
+/// @brief check in O(1) if the handle is live, a freed handle stays invalid even once its slot is reused
+CTOOLBOX_API bool idgen_handles_valid(const idgen_handles* handles, idgen_handle handle);
+
+/// @brief get the number of live handles
+CTOOLBOX_API uint32_t idgen_handles_count(const idgen_handles* handles);
+
+/// @brief get the number of slots created so far, every handle index is below it
+CTOOLBOX_API uint32_t idgen_handles_slot_count(const idgen_handles* handles);
+
+/// @brief frees every live handle, keeping the slots and their generations
+CTOOLBOX_API void idgen_handles_reset(idgen_handles* handles);
+
+/// @brief returns the memory the handle allocator allocated, its generations and idgen included
+CTOOLBOX_API ctoolbox_result idgen_handles_memory_usage(const idgen_handles* handles, ctoolbox_memstats* statsOut);
+
+#ifdef __cplusplus
+}
+#endif
+
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Static Hashtable
@@ -238,6 +1262,9 @@ CTOOLBOX_API bool shashtable_contains(shashtable* table, const char* key);
 /// @brief returns how many entries exists in the hashtable
 CTOOLBOX_API size_t shashtable_count(shashtable* table);
 
+/// @brief returns the memory the hashtable allocated, its entries included
+CTOOLBOX_API ctoolbox_result shashtable_memory_usage(shashtable* table, ctoolbox_memstats* statsOut);
+
 #ifdef __cplusplus
 }
 #endif
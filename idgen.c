@@ -2,57 +2,298 @@
 
 #include <stdlib.h>
 #include <string.h>
+#if defined(_MSC_VER)
+    #include <intrin.h>
+#endif
 
+// ids live in pages of 64 words, so a single summary word tells which of the page's words are full
+#define IDGEN_PAGE_WORDS        64
+#define IDGEN_PAGE_IDS          (IDGEN_PAGE_WORDS * 64)
+// pages are reached through chunks of IDGEN_CHUNK_PAGES, the whole 32 bits range fits in IDGEN_MAX_CHUNKS
+#define IDGEN_CHUNK_PAGES       1024
+#define IDGEN_CHUNK_WORDS       (IDGEN_CHUNK_PAGES / 64)
+#define IDGEN_CHUNK_IDS         ((uint64_t)IDGEN_PAGE_IDS * IDGEN_CHUNK_PAGES)
+#define IDGEN_MAX_CHUNKS        1024
+#define IDGEN_MAX_CHUNK_WORDS   (IDGEN_MAX_CHUNKS / 64)
+
+typedef struct idgen_page
+{
+    uint64_t bits[IDGEN_PAGE_WORDS];    // bitset representing used IDs
+    uint64_t full_words;                // a bit per full word of bits
+    uint32_t count;
+} idgen_page;
+
+typedef struct idgen_chunk
+{
+    idgen_page* pages[IDGEN_CHUNK_PAGES];
+    uint64_t full_pages[IDGEN_CHUNK_WORDS];
+    uint32_t page_count;                // pages allocated
+    uint32_t full_count;                // pages full
+} idgen_chunk;
+
+// missing chunks and pages hold no id, they are allocated on the first id registered in them and released once empty
 struct idgen
 {
     uint32_t current_id;
     uint32_t start_id;
-    uint32_t max_id;
-    uint32_t count;
-    uint32_t bitset_size;     // number of uint32_t words
-    uint32_t* used_bits;      // bitset representing used IDs
-    const ctoolbox_memfuncs* memfuncs;
+    uint32_t end_id;          // last id handed out, inclusive so the range can reach UINT32_MAX
+    uint64_t count;
+    uint32_t chunk_count;
+    idgen_chunk** chunks;
+    uint64_t full_chunks[IDGEN_MAX_CHUNK_WORDS];
+    size_t alignment;         // alignment of the bitset pages
+    ctoolbox_memfuncs memfuncs;
+    ctoolbox_memstats stats;
 };
 
 // macros for bit manipulation
 #define BIT_INDEX(id, base)   ((id) - (base))
-#define BIT_WORD(i)           ((i) >> 5)          // divide by 32
-#define BIT_MASK(i)           (1u << ((i) & 31u))
+#define BIT_WORD(i)           ((i) >> 6)          // divide by 64
+#define BIT_MASK(i)           ((uint64_t)1 << ((i) & 63u))
+#define BIT_FULL              (~(uint64_t)0)
 
-static inline bool bit_test(uint32_t* bits, uint32_t bitset_size, uint32_t idx)
+static inline uint32_t bit_ctz(uint64_t value)
 {
-    uint32_t word = BIT_WORD(idx);
-    if (word >= bitset_size) return false;
-    return bits[word] & BIT_MASK(idx);
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index;
+    _BitScanForward64(&index, value);
+    return index;
+#else
+    return (uint32_t)__builtin_ctzll(value);
+#endif
 }
 
-static inline void bit_set(uint32_t* bits, uint32_t bitset_size, uint32_t idx)
+// first clear bit at or after bit in count words, count * 64 if there is none
+static inline uint64_t bit_find_clear(const uint64_t* words, uint32_t count, uint64_t bit)
 {
-    uint32_t word = BIT_WORD(idx);
-    if (word >= bitset_size) return;
-    bits[word] |= BIT_MASK(idx);
+    uint64_t word = BIT_WORD(bit);
+    if (word >= count) return (uint64_t)count * 64;
+
+    uint64_t free_bits = ~words[word] & (BIT_FULL << (bit & 63u));
+    while (!free_bits) {
+        if (++word == count) return (uint64_t)count * 64;
+        free_bits = ~words[word];
+    }
+    return word * 64 + bit_ctz(free_bits);
 }
 
-static inline void bit_clear(uint32_t* bits, uint32_t bitset_size, uint32_t idx)
+// first free offset of the page at or after offset, IDGEN_PAGE_IDS if there is none
+static uint64_t page_find_free(const idgen_page* page, uint64_t offset)
 {
-    uint32_t word = BIT_WORD(idx);
-    if (word >= bitset_size) return;
-    bits[word] &= ~BIT_MASK(idx);
+    if (!page) return offset;
+
+    uint64_t word = BIT_WORD(offset);
+    uint64_t free_bits = ~page->bits[word] & (BIT_FULL << (offset & 63u));
+    if (free_bits) return word * 64 + bit_ctz(free_bits);
+
+    word = bit_find_clear(&page->full_words, 1, word + 1);
+    if (word == IDGEN_PAGE_WORDS) return IDGEN_PAGE_IDS;
+    return word * 64 + bit_ctz(~page->bits[word]);
 }
 
-/////////////////////////////////////////////////////////////////////////////////////////////////////////////
-/// external
-/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// first free offset of the chunk at or after offset, IDGEN_CHUNK_IDS if there is none
+static uint64_t chunk_find_free(const idgen_chunk* chunk, uint64_t offset)
+{
+    if (!chunk) return offset;
 
-CTOOLBOX_API idgen* idgen_create(uint32_t start_id)
+    uint64_t page = offset / IDGEN_PAGE_IDS;
+    uint64_t found = page_find_free(chunk->pages[page], offset % IDGEN_PAGE_IDS);
+    if (found < IDGEN_PAGE_IDS) return page * IDGEN_PAGE_IDS + found;
+
+    // a page that isn't full always has a free id
+    page = bit_find_clear(chunk->full_pages, IDGEN_CHUNK_WORDS, page + 1);
+    if (page == IDGEN_CHUNK_PAGES) return IDGEN_CHUNK_IDS;
+    return page * IDGEN_PAGE_IDS + page_find_free(chunk->pages[page], 0);
+}
+
+// first free index at or after idx, skipping full words, pages and chunks through their summaries, the range size if there is none
+static uint64_t bit_find_free(const idgen* gen, uint64_t idx)
 {
-    return idgen_create_memfuncs(start_id, &CTOOLBOX_DEFAULT_MEMFUNCS);
+    uint64_t range = (uint64_t)gen->end_id - gen->start_id + 1;
+    if (idx >= range) return range;
+
+    uint64_t chunk = idx / IDGEN_CHUNK_IDS;
+    uint64_t found = chunk_find_free(gen->chunks[chunk], idx % IDGEN_CHUNK_IDS);
+    if (found == IDGEN_CHUNK_IDS) {
+        chunk = bit_find_clear(gen->full_chunks, IDGEN_MAX_CHUNK_WORDS, chunk + 1);
+        if (chunk >= gen->chunk_count) return range;
+        found = chunk_find_free(gen->chunks[chunk], 0);
+    }
+
+    // the last page and chunk may reach past the range
+    found += chunk * IDGEN_CHUNK_IDS;
+    return found < range ? found : range;
 }
 
-CTOOLBOX_API idgen* idgen_create_memfuncs(uint32_t start_id, const ctoolbox_memfuncs* memfuncs)
+static inline bool bit_test(const idgen* gen, uint32_t idx)
+{
+    const idgen_chunk* chunk = gen->chunks[idx / IDGEN_CHUNK_IDS];
+    if (!chunk) return false;
+
+    const idgen_page* page = chunk->pages[(idx / IDGEN_PAGE_IDS) % IDGEN_CHUNK_PAGES];
+    return page && (page->bits[BIT_WORD(idx % IDGEN_PAGE_IDS)] & BIT_MASK(idx));
+}
+
+// marks a free id used, allocating its chunk and page if needed, false if they can't be allocated
+static bool bit_set(idgen* gen, uint32_t idx)
+{
+    uint32_t chunk_index = (uint32_t)(idx / IDGEN_CHUNK_IDS);
+    uint32_t page_index = (idx / IDGEN_PAGE_IDS) % IDGEN_CHUNK_PAGES;
+
+    idgen_chunk* chunk = gen->chunks[chunk_index];
+    if (!chunk) {
+        chunk = ctoolbox_custom_calloc(&gen->memfuncs, 1, sizeof(idgen_chunk));
+        if (!chunk) return false;
+
+        ctoolbox_memstats_on_alloc(&gen->stats, sizeof(idgen_chunk));
+        gen->chunks[chunk_index] = chunk;
+    }
+
+    idgen_page* page = chunk->pages[page_index];
+    if (!page) {
+        page = ctoolbox_custom_aligned_malloc(&gen->memfuncs, sizeof(idgen_page), gen->alignment);
+        if (!page) {
+            // a chunk made for this id alone goes away again
+            if (chunk->page_count == 0) {
+                ctoolbox_custom_free_sized(&gen->memfuncs, chunk, sizeof(idgen_chunk));
+                ctoolbox_memstats_on_free(&gen->stats, sizeof(idgen_chunk));
+                gen->chunks[chunk_index] = NULL;
+            }
+            return false;
+        }
+
+        memset(page, 0, sizeof(idgen_page));
+        ctoolbox_memstats_on_alloc(&gen->stats, sizeof(idgen_page));
+        chunk->pages[page_index] = page;
+        chunk->page_count++;
+    }
+
+    // a word, page or chunk filling up sets its bit in the summary above it
+    uint32_t word = BIT_WORD(idx % IDGEN_PAGE_IDS);
+    page->bits[word] |= BIT_MASK(idx);
+    page->count++;
+    if (page->bits[word] != BIT_FULL) return true;
+
+    page->full_words |= BIT_MASK(word);
+    if (page->count != IDGEN_PAGE_IDS) return true;
+
+    chunk->full_pages[BIT_WORD(page_index)] |= BIT_MASK(page_index);
+    if (++chunk->full_count != IDGEN_CHUNK_PAGES) return true;
+
+    gen->full_chunks[BIT_WORD(chunk_index)] |= BIT_MASK(chunk_index);
+    return true;
+}
+
+// marks a used id free, releasing its page and chunk once they hold no id
+static void bit_clear(idgen* gen, uint32_t idx)
+{
+    uint32_t chunk_index = (uint32_t)(idx / IDGEN_CHUNK_IDS);
+    uint32_t page_index = (idx / IDGEN_PAGE_IDS) % IDGEN_CHUNK_PAGES;
+    idgen_chunk* chunk = gen->chunks[chunk_index];
+    idgen_page* page = chunk->pages[page_index];
+
+    // whatever was full no longer is
+    if (page->count == IDGEN_PAGE_IDS) {
+        if (chunk->full_count-- == IDGEN_CHUNK_PAGES) gen->full_chunks[BIT_WORD(chunk_index)] &= ~BIT_MASK(chunk_index);
+        chunk->full_pages[BIT_WORD(page_index)] &= ~BIT_MASK(page_index);
+    }
+
+    uint32_t word = BIT_WORD(idx % IDGEN_PAGE_IDS);
+    page->full_words &= ~BIT_MASK(word);
+    page->bits[word] &= ~BIT_MASK(idx);
+    if (--page->count > 0) return;
+
+    ctoolbox_custom_aligned_free_sized(&gen->memfuncs, page, sizeof(idgen_page), gen->alignment);
+    ctoolbox_memstats_on_free(&gen->stats, sizeof(idgen_page));
+    chunk->pages[page_index] = NULL;
+    if (--chunk->page_count > 0) return;
+
+    ctoolbox_custom_free_sized(&gen->memfuncs, chunk, sizeof(idgen_chunk));
+    ctoolbox_memstats_on_free(&gen->stats, sizeof(idgen_chunk));
+    gen->chunks[chunk_index] = NULL;
+}
+
+// releases every page and chunk
+static void bit_release(idgen* gen)
+{
+    for (uint32_t c = 0; c < gen->chunk_count; c++) {
+        idgen_chunk* chunk = gen->chunks[c];
+        if (!chunk) continue;
+
+        for (uint32_t p = 0; p < IDGEN_CHUNK_PAGES; p++) {
+            if (!chunk->pages[p]) continue;
+            ctoolbox_custom_aligned_free_sized(&gen->memfuncs, chunk->pages[p], sizeof(idgen_page), gen->alignment);
+            ctoolbox_memstats_on_free(&gen->stats, sizeof(idgen_page));
+        }
+        ctoolbox_custom_free_sized(&gen->memfuncs, chunk, sizeof(idgen_chunk));
+        ctoolbox_memstats_on_free(&gen->stats, sizeof(idgen_chunk));
+        gen->chunks[c] = NULL;
+    }
+    memset(gen->full_chunks, 0, sizeof(gen->full_chunks));
+}
+
+// generations use the bits a handle leaves them, starting at 1 so no handle equals IDGEN_HANDLE_NULL, 0 marks a retired slot
+#define IDGEN_GENERATION_MAX    ((uint32_t)(((uint64_t)1 << (IDGEN_HANDLE_BITS - IDGEN_HANDLE_INDEX_BITS)) - 1))
+#define IDGEN_GENERATION_RETIRED 0
+// slot i is id i + 1 of the handles' own idgen, whose range bounds the slots as much as the handle bits do
+#define IDGEN_SLOT_LIMIT        (((uint64_t)1 << IDGEN_HANDLE_INDEX_BITS) < IDGEN_MAX_SAFE_IDS ? (uint32_t)((uint64_t)1 << IDGEN_HANDLE_INDEX_BITS) : (uint32_t)(IDGEN_MAX_SAFE_IDS - 1))
+
+// the idgen tells which slots are in use and hands out the lowest free one, the slots only keep their generations
+struct idgen_handles
+{
+    idgen* ids;
+    uint32_t* generations;
+    uint32_t slot_count;      // slots handed out at least once
+    uint32_t capacity;
+    uint32_t count;
+    ctoolbox_memfuncs memfuncs;
+    ctoolbox_memstats stats;  // the handles and their generations, the idgen keeps its own
+};
+
+static bool handles_grow(idgen_handles* handles, uint32_t index)
+{
+    uint32_t new_capacity = handles->capacity ? handles->capacity : 16;
+    while (new_capacity <= index) new_capacity = new_capacity > IDGEN_SLOT_LIMIT / 2 ? IDGEN_SLOT_LIMIT : new_capacity * 2;
+    if ((uint64_t)new_capacity * sizeof(uint32_t) > SIZE_MAX) return false;
+
+    size_t old_bytes = handles->capacity * sizeof(uint32_t);
+    size_t new_bytes = new_capacity * sizeof(uint32_t);
+    uint32_t* generations = handles->generations
+        ? ctoolbox_custom_realloc_sized(&handles->memfuncs, handles->generations, old_bytes, new_bytes)
+        : ctoolbox_custom_malloc(&handles->memfuncs, new_bytes);
+    if (!generations) return false;
+
+    if (handles->generations) ctoolbox_memstats_on_realloc(&handles->stats, old_bytes, new_bytes);
+    else ctoolbox_memstats_on_alloc(&handles->stats, new_bytes);
+
+    handles->generations = generations;
+    handles->capacity = new_capacity;
+    return true;
+}
+
+static inline bool handles_live(const idgen_handles* handles, uint32_t index)
+{
+    return handles->generations[index] != IDGEN_GENERATION_RETIRED && idgen_is_registered(handles->ids, index + 1);
+}
+
+// bumps the generation of a slot leaving use and gives it back to the idgen, a slot out of generations stays registered so no stale handle can match it again
+static void handles_release(idgen_handles* handles, uint32_t index)
+{
+    if (handles->generations[index] == IDGEN_GENERATION_MAX) {
+        handles->generations[index] = IDGEN_GENERATION_RETIRED;
+        return;
+    }
+
+    handles->generations[index]++;
+    idgen_unregister(handles->ids, index + 1);
+}
+
+// any range, idgen_create keeps accepting a start id of 0 as it always has
+static idgen* idgen_create_internal(uint32_t start_id, uint32_t end_id, size_t alignment, const ctoolbox_memfuncs* memfuncs)
 {
     const ctoolbox_memfuncs* actual_memfuncs = memfuncs ? memfuncs : &CTOOLBOX_DEFAULT_MEMFUNCS;
-    if (start_id >= IDGEN_MAX_SAFE_IDS) return NULL;
+    if (start_id > end_id) return NULL;
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0) return NULL;
 
     idgen* gen = ctoolbox_custom_malloc(actual_memfuncs, sizeof(idgen));
     if (!gen)  return NULL;
@@ -60,75 +301,105 @@ CTOOLBOX_API idgen* idgen_create_memfuncs(uint32_t start_id, const ctoolbox_memf
     memset(gen, 0, sizeof(*gen));
     gen->start_id = start_id;
     gen->current_id = start_id;
-    gen->max_id = IDGEN_MAX_SAFE_IDS;
-    gen->memfuncs = actual_memfuncs;
-
-    gen->bitset_size = (IDGEN_MAX_SAFE_IDS + 31u) / 32u;
-    if (gen->bitset_size == 0) {
-        gen->bitset_size = 1;
-    }
+    gen->end_id = end_id;
+    gen->memfuncs = *actual_memfuncs;
+    gen->alignment = alignment;
 
-    gen->used_bits = ctoolbox_custom_malloc(actual_memfuncs, gen->bitset_size * sizeof(uint32_t));
-    if (!gen->used_bits) {
-        ctoolbox_custom_free(actual_memfuncs, gen);
+    // only the chunk directory is allocated up front, a pointer per 4M ids
+    gen->chunk_count = (uint32_t)(((uint64_t)end_id - start_id + IDGEN_CHUNK_IDS) / IDGEN_CHUNK_IDS);
+    gen->chunks = ctoolbox_custom_calloc(&gen->memfuncs, gen->chunk_count, sizeof(idgen_chunk*));
+    if (!gen->chunks) {
+        ctoolbox_custom_free_sized(&gen->memfuncs, gen, sizeof(idgen));
         return NULL;
     }
 
-    memset(gen->used_bits, 0, gen->bitset_size * sizeof(uint32_t));
+    ctoolbox_memstats_on_alloc(&gen->stats, sizeof(idgen));
+    ctoolbox_memstats_on_alloc(&gen->stats, gen->chunk_count * sizeof(idgen_chunk*));
     return gen;
 }
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/// external
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+CTOOLBOX_API idgen* idgen_create(uint32_t start_id)
+{
+    return idgen_create_memfuncs(start_id, &CTOOLBOX_DEFAULT_MEMFUNCS);
+}
+
+CTOOLBOX_API idgen* idgen_create_memfuncs(uint32_t start_id, const ctoolbox_memfuncs* memfuncs)
+{
+    return idgen_create_aligned(start_id, CTOOLBOX_DEFAULT_ALIGNMENT, memfuncs);
+}
+
+CTOOLBOX_API idgen* idgen_create_aligned(uint32_t start_id, size_t alignment, const ctoolbox_memfuncs* memfuncs)
+{
+    if (start_id >= IDGEN_MAX_SAFE_IDS) return NULL;
+    return idgen_create_internal(start_id, IDGEN_MAX_SAFE_IDS - 1, alignment, memfuncs);
+}
+
+CTOOLBOX_API idgen* idgen_create_range(uint32_t start_id, uint32_t end_id, size_t alignment, const ctoolbox_memfuncs* memfuncs)
+{
+    // 0 is what idgen_next returns once exhausted, it can't be an id too
+    if (start_id == 0) return NULL;
+    return idgen_create_internal(start_id, end_id, alignment, memfuncs);
+}
+
 void idgen_destroy(idgen* gen)
 {
     if (!gen) return;
-    const ctoolbox_memfuncs* mem = gen->memfuncs;
-    if (gen->used_bits) ctoolbox_custom_free(mem, gen->used_bits);
-    ctoolbox_custom_free(mem, gen);
+    bit_release(gen);
+
+    ctoolbox_memfuncs mem = gen->memfuncs;
+    ctoolbox_custom_free_sized(&mem, gen->chunks, gen->chunk_count * sizeof(idgen_chunk*));
+    ctoolbox_custom_free_sized(&mem, gen, sizeof(idgen));
 }
 
 CTOOLBOX_API uint32_t idgen_next(idgen* gen)
 {
-    if (!gen) return 0;
+    uint32_t id;
+    return idgen_try_next(gen, &id) ? id : 0;
+}
 
-    uint32_t range = gen->max_id - gen->start_id;
-    for (uint32_t i = 0; i < range; i++) {
-        uint32_t candidate = gen->current_id + i;
-        if (candidate >= gen->max_id)
-            candidate = gen->start_id + (candidate - gen->max_id);
-
-        uint32_t idx = BIT_INDEX(candidate, gen->start_id);
-        if (!bit_test(gen->used_bits, gen->bitset_size, idx)) {  // Add bounds check
-            bit_set(gen->used_bits, gen->bitset_size, idx);      // Add bounds check
-            gen->count++;
-            gen->current_id = candidate + 1;
-            if (gen->current_id >= gen->max_id)
-                gen->current_id = gen->start_id;
-            return candidate;
-        }
-    }
-    return 0;
+CTOOLBOX_API bool idgen_try_next(idgen* gen, uint32_t* id_out)
+{
+    if (!gen || !id_out) return false;
+
+    // first free id from the cursor on, then from the start of the range
+    uint64_t range = (uint64_t)gen->end_id - gen->start_id + 1;
+    uint64_t idx = bit_find_free(gen, BIT_INDEX(gen->current_id, gen->start_id));
+    if (idx == range) idx = bit_find_free(gen, 0);
+    if (idx == range) return false;
+
+    if (!bit_set(gen, (uint32_t)idx)) return false;
+    gen->count++;
+
+    uint32_t candidate = gen->start_id + (uint32_t)idx;
+    gen->current_id = candidate == gen->end_id ? gen->start_id : candidate + 1;
+    *id_out = candidate;
+    return true;
 }
 
 CTOOLBOX_API bool idgen_register(idgen* gen, uint32_t id)
 {
-    if (!gen || id < gen->start_id || id >= gen->max_id) return false;
+    if (!gen || id < gen->start_id || id > gen->end_id) return false;
 
     uint32_t idx = BIT_INDEX(id, gen->start_id);
-    if (bit_test(gen->used_bits, gen->bitset_size, idx)) return false;  // Add bounds check
+    if (bit_test(gen, idx)) return false;
 
-    bit_set(gen->used_bits, gen->bitset_size, idx);  // Add bounds check
+    if (!bit_set(gen, idx)) return false;
     gen->count++;
     return true;
 }
 
 CTOOLBOX_API bool idgen_unregister(idgen* gen, uint32_t id)
 {
-    if (!gen || id < gen->start_id || id >= gen->max_id) return false;
+    if (!gen || id < gen->start_id || id > gen->end_id) return false;
 
     uint32_t idx = BIT_INDEX(id, gen->start_id);
-    if (!bit_test(gen->used_bits, gen->bitset_size, idx)) return false;
+    if (!bit_test(gen, idx)) return false;
 
-    bit_clear(gen->used_bits, gen->bitset_size, idx);
+    bit_clear(gen, idx);
     gen->count--;
 
     // move current_id back for better reuse
@@ -139,20 +410,149 @@ CTOOLBOX_API bool idgen_unregister(idgen* gen, uint32_t id)
 
 CTOOLBOX_API bool idgen_is_registered(idgen* gen, uint32_t id)
 {
-    if (!gen || id < gen->start_id || id >= gen->max_id) return false;
+    if (!gen || id < gen->start_id || id > gen->end_id) return false;
     uint32_t idx = BIT_INDEX(id, gen->start_id);
-    return bit_test(gen->used_bits, gen->bitset_size, idx);
+    return bit_test(gen, idx);
 }
 
 CTOOLBOX_API uint32_t idgen_count(idgen* gen)
 {
-    return gen ? gen->count : 0;
+    if (!gen) return 0;
+    return gen->count > UINT32_MAX ? UINT32_MAX : (uint32_t)gen->count;
 }
 
 CTOOLBOX_API void idgen_reset(idgen* gen)
 {
     if (!gen) return;
-    memset(gen->used_bits, 0, gen->bitset_size * sizeof(uint32_t));
+    bit_release(gen);
     gen->count = 0;
     gen->current_id = gen->start_id;
 }
+
+CTOOLBOX_API ctoolbox_result idgen_memory_usage(const idgen* gen, ctoolbox_memstats* statsOut)
+{
+    if (!gen || !statsOut) return CTOOLBOX_ERROR_INVALID_PARAM;
+    *statsOut = gen->stats;
+    return CTOOLBOX_SUCCESS;
+}
+
+CTOOLBOX_API idgen_handles* idgen_handles_create(uint32_t initial_capacity)
+{
+    return idgen_handles_create_memfuncs(initial_capacity, &CTOOLBOX_DEFAULT_MEMFUNCS);
+}
+
+CTOOLBOX_API idgen_handles* idgen_handles_create_memfuncs(uint32_t initial_capacity, const ctoolbox_memfuncs* memfuncs)
+{
+    const ctoolbox_memfuncs* actual_memfuncs = memfuncs ? memfuncs : &CTOOLBOX_DEFAULT_MEMFUNCS;
+
+    idgen_handles* handles = ctoolbox_custom_malloc(actual_memfuncs, sizeof(idgen_handles));
+    if (!handles) return NULL;
+
+    memset(handles, 0, sizeof(*handles));
+    handles->memfuncs = *actual_memfuncs;
+    handles->ids = idgen_create_range(1, IDGEN_SLOT_LIMIT, CTOOLBOX_DEFAULT_ALIGNMENT, &handles->memfuncs);
+    if (!handles->ids) {
+        ctoolbox_custom_free_sized(&handles->memfuncs, handles, sizeof(idgen_handles));
+        return NULL;
+    }
+    ctoolbox_memstats_on_alloc(&handles->stats, sizeof(idgen_handles));
+
+    if (initial_capacity > 0) {
+        handles->capacity = initial_capacity < IDGEN_SLOT_LIMIT ? initial_capacity : IDGEN_SLOT_LIMIT;
+        handles->generations = ctoolbox_custom_malloc(&handles->memfuncs, handles->capacity * sizeof(uint32_t));
+        if (!handles->generations) {
+            idgen_destroy(handles->ids);
+            ctoolbox_custom_free_sized(&handles->memfuncs, handles, sizeof(idgen_handles));
+            return NULL;
+        }
+        ctoolbox_memstats_on_alloc(&handles->stats, handles->capacity * sizeof(uint32_t));
+    }
+
+    return handles;
+}
+
+CTOOLBOX_API void idgen_handles_destroy(idgen_handles* handles)
+{
+    if (!handles) return;
+
+    ctoolbox_memfuncs mem = handles->memfuncs;
+    idgen_destroy(handles->ids);
+    ctoolbox_custom_free_sized(&mem, handles->generations, handles->capacity * sizeof(uint32_t));
+    ctoolbox_custom_free_sized(&mem, handles, sizeof(idgen_handles));
+}
+
+CTOOLBOX_API idgen_handle idgen_handles_alloc(idgen_handles* handles)
+{
+    if (!handles) return IDGEN_HANDLE_NULL;
+
+    uint32_t id;
+    if (!idgen_try_next(handles->ids, &id)) return IDGEN_HANDLE_NULL;
+
+    // the lowest free slot, at most one past the slots handed out so far
+    uint32_t index = id - 1;
+    if (index >= handles->slot_count) {
+        if (index >= handles->capacity && !handles_grow(handles, index)) {
+            idgen_unregister(handles->ids, id);
+            return IDGEN_HANDLE_NULL;
+        }
+        for (uint32_t i = handles->slot_count; i <= index; i++) handles->generations[i] = 1;
+        handles->slot_count = index + 1;
+    }
+
+    handles->count++;
+    return ((idgen_handle)handles->generations[index] << IDGEN_HANDLE_INDEX_BITS) | index;
+}
+
+CTOOLBOX_API bool idgen_handles_free(idgen_handles* handles, idgen_handle handle)
+{
+    if (!idgen_handles_valid(handles, handle)) return false;
+
+    handles_release(handles, IDGEN_HANDLE_INDEX(handle));
+    handles->count--;
+    return true;
+}
+
+CTOOLBOX_API bool idgen_handles_valid(const idgen_handles* handles, idgen_handle handle)
+{
+    if (!handles) return false;
+
+    uint32_t index = IDGEN_HANDLE_INDEX(handle);
+    if (index >= handles->slot_count) return false;
+
+    return handles->generations[index] == IDGEN_HANDLE_GENERATION(handle) && handles_live(handles, index);
+}
+
+CTOOLBOX_API uint32_t idgen_handles_count(const idgen_handles* handles)
+{
+    return handles ? handles->count : 0;
+}
+
+CTOOLBOX_API uint32_t idgen_handles_slot_count(const idgen_handles* handles)
+{
+    return handles ? handles->slot_count : 0;
+}
+
+CTOOLBOX_API void idgen_handles_reset(idgen_handles* handles)
+{
+    if (!handles) return;
+
+    for (uint32_t i = 0; i < handles->slot_count; i++) {
+        if (handles_live(handles, i)) handles_release(handles, i);
+    }
+    handles->count = 0;
+}
+
+CTOOLBOX_API ctoolbox_result idgen_handles_memory_usage(const idgen_handles* handles, ctoolbox_memstats* statsOut)
+{
+    if (!handles || !statsOut) return CTOOLBOX_ERROR_INVALID_PARAM;
+
+    ctoolbox_memstats ids;
+    idgen_memory_usage(handles->ids, &ids);
+    *statsOut = handles->stats;
+    statsOut->liveBytes += ids.liveBytes;
+    statsOut->peakBytes += ids.peakBytes;
+    statsOut->allocCount += ids.allocCount;
+    statsOut->reallocCount += ids.reallocCount;
+    statsOut->freeCount += ids.freeCount;
+    return CTOOLBOX_SUCCESS;
+}
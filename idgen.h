@@ -4,9 +4,32 @@
 #include "context.h"
 
 #ifndef IDGEN_MAX_SAFE_IDS
-#define IDGEN_MAX_SAFE_IDS 16777216 // maximum of 16.7 million IDs (~2MB memory usage)
+#define IDGEN_MAX_SAFE_IDS 16777216 // maximum of 16.7 million IDs (~2MB memory usage when all in use, pages are allocated on demand)
 #endif // IDGEN_MAX_SAFE_IDS
 
+#ifndef IDGEN_HANDLE_BITS
+#define IDGEN_HANDLE_BITS 64 // width of a generational handle, 32 or 64
+#endif // IDGEN_HANDLE_BITS
+
+#ifndef IDGEN_HANDLE_INDEX_BITS
+#define IDGEN_HANDLE_INDEX_BITS (IDGEN_HANDLE_BITS / 2) // low bits of a handle holding the slot index, the high ones hold its generation
+#endif // IDGEN_HANDLE_INDEX_BITS
+
+#if IDGEN_HANDLE_BITS == 32
+typedef uint32_t idgen_handle;
+#else
+typedef uint64_t idgen_handle;
+#endif
+
+/// @brief never returned by idgen_handles_alloc, always invalid
+#define IDGEN_HANDLE_NULL ((idgen_handle)0)
+
+/// @brief slot index of a handle, dense enough to index a side array
+#define IDGEN_HANDLE_INDEX(handle) ((uint32_t)((handle) & (((idgen_handle)1 << IDGEN_HANDLE_INDEX_BITS) - 1)))
+
+/// @brief generation of a handle, bumped each time its slot is freed
+#define IDGEN_HANDLE_GENERATION(handle) ((uint32_t)((handle) >> IDGEN_HANDLE_INDEX_BITS))
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // functions
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -19,18 +42,32 @@ extern "C" {
 /// @brief opaque id generator structure
 typedef struct idgen idgen;
 
-/// @brief initializes generator, set to UINT32_MAX for full range
+/// @brief opaque generational handle allocator structure
+typedef struct idgen_handles idgen_handles;
+
+/// @brief initializes generator handing out ids from start_id up to IDGEN_MAX_SAFE_IDS - 1
 CTOOLBOX_API idgen* idgen_create(uint32_t start_id);
 
 /// @brief initializes generator with custom allocation functions
 CTOOLBOX_API idgen* idgen_create_memfuncs(uint32_t start_id, const ctoolbox_memfuncs* memfuncs);
 
+/// @brief initializes generator with its bitset pages aligned to alignment bytes (power of two)
+CTOOLBOX_API idgen* idgen_create_aligned(uint32_t start_id, size_t alignment, const ctoolbox_memfuncs* memfuncs);
+
+/// @brief initializes generator handing out ids from start_id to end_id inclusive, up to the full 32 bits range (e.g. 1 to UINT32_MAX)
+/// @brief start_id must be at least 1 since idgen_next returns 0 once exhausted, NULL otherwise
+/// @brief the bitset is allocated in pages as ids get registered, so a wide range costs nothing until it is used
+CTOOLBOX_API idgen* idgen_create_range(uint32_t start_id, uint32_t end_id, size_t alignment, const ctoolbox_memfuncs* memfuncs);
+
 /// @brief releases the resources of the id generator
 CTOOLBOX_API void idgen_destroy(idgen* gen);
 
 /// @brief generate next ID, returns 0 if exhausted
 CTOOLBOX_API uint32_t idgen_next(idgen* gen);
 
+/// @brief generate next ID into id_out, returns false if exhausted, for generators created with a start_id of 0
+CTOOLBOX_API bool idgen_try_next(idgen* gen, uint32_t* id_out);
+
 /// @brief register an id
 CTOOLBOX_API bool idgen_register(idgen* gen, uint32_t id);
 
@@ -40,12 +77,45 @@ CTOOLBOX_API bool idgen_unregister(idgen* gen, uint32_t id);
 /// @brief check if an ID is currently registered
 CTOOLBOX_API bool idgen_is_registered(idgen* gen, uint32_t id);
 
-/// @brief get the number of currently registered IDs
+/// @brief get the number of currently registered IDs, saturating at UINT32_MAX
 CTOOLBOX_API uint32_t idgen_count(idgen* gen);
 
-/// @brief resets generator to initial state
+/// @brief resets generator to initial state, releasing every bitset page
 CTOOLBOX_API void idgen_reset(idgen* gen);
 
+/// @brief returns the memory the generator allocated, its bitset included
+CTOOLBOX_API ctoolbox_result idgen_memory_usage(const idgen* gen, ctoolbox_memstats* statsOut);
+
+/// @brief initializes a generational handle allocator, freed slots are reused with a new generation so stale handles stay invalid
+CTOOLBOX_API idgen_handles* idgen_handles_create(uint32_t initial_capacity);
+
+/// @brief initializes a generational handle allocator with custom allocation functions
+CTOOLBOX_API idgen_handles* idgen_handles_create_memfuncs(uint32_t initial_capacity, const ctoolbox_memfuncs* memfuncs);
+
+/// @brief releases the resources of the handle allocator
+CTOOLBOX_API void idgen_handles_destroy(idgen_handles* handles);
+
+/// @brief hands out a handle on the lowest free slot, found through the bitset summaries of the allocator's idgen, IDGEN_HANDLE_NULL if exhausted
+CTOOLBOX_API idgen_handle idgen_handles_alloc(idgen_handles* handles);
+
+/// @brief frees a live handle in O(1), returns false if it is stale or was never handed out
+CTOOLBOX_API bool idgen_handles_free(idgen_handles* handles, idgen_handle handle);
+
+/// @brief check in O(1) if the handle is live, a freed handle stays invalid even once its slot is reused
+CTOOLBOX_API bool idgen_handles_valid(const idgen_handles* handles, idgen_handle handle);
+
+/// @brief get the number of live handles
+CTOOLBOX_API uint32_t idgen_handles_count(const idgen_handles* handles);
+
+/// @brief get the number of slots created so far, every handle index is below it
+CTOOLBOX_API uint32_t idgen_handles_slot_count(const idgen_handles* handles);
+
+/// @brief frees every live handle, keeping the slots and their generations
+CTOOLBOX_API void idgen_handles_reset(idgen_handles* handles);
+
+/// @brief returns the memory the handle allocator allocated, its generations and idgen included
+CTOOLBOX_API ctoolbox_result idgen_handles_memory_usage(const idgen_handles* handles, ctoolbox_memstats* statsOut);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,215 @@
+#include "segarray.h"
+
+#include <string.h>
+#if defined(_MSC_VER)
+    #include <intrin.h>
+#endif
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// internal
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#define SEGARRAY_FIRST_SEGMENT ((size_t)1 << SEGARRAY_FIRST_SEGMENT_SHIFT)
+#define SEGARRAY_MAX_SEGMENTS (sizeof(size_t) * 8 - SEGARRAY_FIRST_SEGMENT_SHIFT)
+
+// segment k holds SEGARRAY_FIRST_SEGMENT << k elements, so index + SEGARRAY_FIRST_SEGMENT has its segment in its top bit
+struct segarray
+{
+    void* segments[SEGARRAY_MAX_SEGMENTS];
+    size_t segmentCount;
+    size_t size;
+    size_t elementSize;
+    ctoolbox_memfuncs memfuncs;
+    ctoolbox_memstats stats;
+};
+
+static inline size_t segarray_log2(size_t value)
+{
+#if defined(_MSC_VER) && !defined(__clang__) && (defined(_M_X64) || defined(_M_ARM64))
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return index;
+#elif defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index;
+    _BitScanReverse(&index, (unsigned long)value);
+    return index;
+#else
+    return sizeof(size_t) * 8 - 1 - (size_t)(sizeof(size_t) == sizeof(unsigned long long) ? __builtin_clzll(value) : __builtin_clz((unsigned int)value));
+#endif
+}
+
+static inline size_t segarray_segment_length(size_t segment)
+{
+    return SEGARRAY_FIRST_SEGMENT << segment;
+}
+
+// elements the first segmentCount segments hold
+static inline size_t segarray_segments_capacity(size_t segmentCount)
+{
+    return (SEGARRAY_FIRST_SEGMENT << segmentCount) - SEGARRAY_FIRST_SEGMENT;
+}
+
+static inline char* segarray_address(const segarray* array, size_t index)
+{
+    size_t position = index + SEGARRAY_FIRST_SEGMENT;
+    size_t segment = segarray_log2(position) - SEGARRAY_FIRST_SEGMENT_SHIFT;
+    size_t offset = position - segarray_segment_length(segment);
+    return (char*)array->segments[segment] + offset * array->elementSize;
+}
+
+static ctoolbox_result segarray_add_segment(segarray* array)
+{
+    if (array->segmentCount == SEGARRAY_MAX_SEGMENTS) return CTOOLBOX_ERROR_FULL;
+
+    size_t length = segarray_segment_length(array->segmentCount);
+    if (length > SIZE_MAX / array->elementSize) return CTOOLBOX_ERROR_MEMORY_ALLOC;
+
+    void* segment = ctoolbox_custom_malloc(&array->memfuncs, length * array->elementSize);
+    if (!segment) return CTOOLBOX_ERROR_MEMORY_ALLOC;
+
+    ctoolbox_memstats_on_alloc(&array->stats, length * array->elementSize);
+    array->segments[array->segmentCount++] = segment;
+    return CTOOLBOX_SUCCESS;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// external
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+CTOOLBOX_API segarray* segarray_init(size_t elementSize)
+{
+    return segarray_init_memfuncs(elementSize, &CTOOLBOX_DEFAULT_MEMFUNCS);
+}
+
+CTOOLBOX_API segarray* segarray_init_memfuncs(size_t elementSize, const ctoolbox_memfuncs* memfuncs)
+{
+    if (elementSize == 0) return NULL;
+
+    segarray* outArray = ctoolbox_custom_malloc(memfuncs ? memfuncs : &CTOOLBOX_DEFAULT_MEMFUNCS, sizeof(segarray));
+    if (!outArray) return NULL;
+
+    memset(outArray, 0, sizeof(segarray));
+    outArray->elementSize = elementSize;
+
+    if (memfuncs) outArray->memfuncs = *memfuncs;
+    else outArray->memfuncs = CTOOLBOX_DEFAULT_MEMFUNCS;
+
+    ctoolbox_memstats_on_alloc(&outArray->stats, sizeof(segarray));
+
+    return outArray;
+}
+
+CTOOLBOX_API void segarray_destroy(segarray* array)
+{
+    if (!array) return;
+
+    for (size_t i = 0; i < array->segmentCount; i++) {
+        ctoolbox_custom_free_sized(&array->memfuncs, array->segments[i], segarray_segment_length(i) * array->elementSize);
+    }
+    ctoolbox_custom_free_sized(&array->memfuncs, array, sizeof(segarray));
+}
+
+CTOOLBOX_API ctoolbox_result segarray_push_back(segarray* array, const void* element)
+{
+    if (!array || !element) return CTOOLBOX_ERROR_INVALID_PARAM;
+
+    void* slot = segarray_emplace_back(array);
+    if (!slot) return CTOOLBOX_ERROR_MEMORY_ALLOC;
+
+    memcpy(slot, element, array->elementSize);
+    return CTOOLBOX_SUCCESS;
+}
+
+CTOOLBOX_API ctoolbox_result segarray_pop_back(segarray* array, void* elementOut)
+{
+    if (!array || array->size == 0) return CTOOLBOX_ERROR_EMPTY;
+    if (elementOut) memcpy(elementOut, segarray_address(array, array->size - 1), array->elementSize);
+
+    array->size--;
+    return CTOOLBOX_SUCCESS;
+}
+
+CTOOLBOX_API void* segarray_emplace_back(segarray* array)
+{
+    if (!array) return NULL;
+
+    // a full array gets one more segment, the existing ones stay where they are
+    if (array->size == segarray_segments_capacity(array->segmentCount) && segarray_add_segment(array) != CTOOLBOX_SUCCESS) return NULL;
+
+    return segarray_address(array, array->size++);
+}
+
+CTOOLBOX_API void* segarray_peek(segarray* array, size_t index)
+{
+    if (!array || index >= array->size) return NULL;
+    return segarray_address(array, index);
+}
+
+CTOOLBOX_API const void* segarray_const_peek(const segarray* array, size_t index)
+{
+    if (!array || index >= array->size) return NULL;
+    return segarray_address(array, index);
+}
+
+CTOOLBOX_API ctoolbox_result segarray_get(const segarray* array, size_t index, void* elementOut)
+{
+    if (!array || !elementOut) return CTOOLBOX_ERROR_INVALID_PARAM;
+    if (index >= array->size) return CTOOLBOX_ERROR_OUT_OF_BOUNDS;
+
+    memcpy(elementOut, segarray_address(array, index), array->elementSize);
+    return CTOOLBOX_SUCCESS;
+}
+
+CTOOLBOX_API ctoolbox_result segarray_set(segarray* array, size_t index, const void* element)
+{
+    if (!array || !element) return CTOOLBOX_ERROR_INVALID_PARAM;
+    if (index >= array->size) return CTOOLBOX_ERROR_OUT_OF_BOUNDS;
+
+    memcpy(segarray_address(array, index), element, array->elementSize);
+    return CTOOLBOX_SUCCESS;
+}
+
+CTOOLBOX_API ctoolbox_result segarray_reserve(segarray* array, size_t newCapacity)
+{
+    if (!array) return CTOOLBOX_ERROR_INVALID_PARAM;
+
+    while (segarray_segments_capacity(array->segmentCount) < newCapacity) {
+        ctoolbox_result res = segarray_add_segment(array);
+        if (res != CTOOLBOX_SUCCESS) return res;
+    }
+    return CTOOLBOX_SUCCESS;
+}
+
+CTOOLBOX_API ctoolbox_result segarray_shrink_to_fit(segarray* array)
+{
+    if (!array) return CTOOLBOX_ERROR_INVALID_PARAM;
+
+    while (array->segmentCount > 0 && segarray_segments_capacity(array->segmentCount - 1) >= array->size) {
+        size_t bytes = segarray_segment_length(array->segmentCount - 1) * array->elementSize;
+        ctoolbox_custom_free_sized(&array->memfuncs, array->segments[--array->segmentCount], bytes);
+        ctoolbox_memstats_on_free(&array->stats, bytes);
+    }
+    return CTOOLBOX_SUCCESS;
+}
+
+CTOOLBOX_API size_t segarray_size(const segarray* array)
+{
+    return array ? array->size : 0;
+}
+
+CTOOLBOX_API size_t segarray_capacity(const segarray* array)
+{
+    return array ? segarray_segments_capacity(array->segmentCount) : 0;
+}
+
+CTOOLBOX_API bool segarray_empty(const segarray* array)
+{
+    return array ? array->size == 0 : true;
+}
+
+CTOOLBOX_API ctoolbox_result segarray_memory_usage(const segarray* array, ctoolbox_memstats* statsOut)
+{
+    if (!array || !statsOut) return CTOOLBOX_ERROR_INVALID_PARAM;
+    *statsOut = array->stats;
+    return CTOOLBOX_SUCCESS;
+}
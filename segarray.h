@@ -0,0 +1,74 @@
+#ifndef SEGARRAY_INCLUDED
+#define SEGARRAY_INCLUDED
+
+#include "context.h"
+
+/// @brief log2 of the element count of the first segment, each following segment doubles the previous one
+#ifndef SEGARRAY_FIRST_SEGMENT_SHIFT
+    #define SEGARRAY_FIRST_SEGMENT_SHIFT 4
+#endif
+
+/// @brief opaque segmented array structure
+typedef struct segarray segarray;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// functions
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// @brief initializes the segmented array, elements never move once stored so their addresses stay valid until popped
+CTOOLBOX_API segarray* segarray_init(size_t elementSize);
+
+/// @brief initializes the segmented array with custom memory allocation functions
+CTOOLBOX_API segarray* segarray_init_memfuncs(size_t elementSize, const ctoolbox_memfuncs* memfuncs);
+
+/// @brief destroys the segmented array, but not the content itself
+CTOOLBOX_API void segarray_destroy(segarray* array);
+
+/// @brief pushes an element into the array's back, growing by a new segment without copying when full
+CTOOLBOX_API ctoolbox_result segarray_push_back(segarray* array, const void* element);
+
+/// @brief pops the element at the array's back, copying it into elementOut if not NULL
+CTOOLBOX_API ctoolbox_result segarray_pop_back(segarray* array, void* elementOut);
+
+/// @brief appends an uninitialized element and returns its address, stable until popped, NULL on failure
+CTOOLBOX_API void* segarray_emplace_back(segarray* array);
+
+/// @brief returns the address of the element at the index, stable until popped, NULL if out of bounds
+CTOOLBOX_API void* segarray_peek(segarray* array, size_t index);
+
+/// @brief returns the address of the element at the index, NULL if out of bounds
+CTOOLBOX_API const void* segarray_const_peek(const segarray* array, size_t index);
+
+/// @brief copies the element at the index into elementOut
+CTOOLBOX_API ctoolbox_result segarray_get(const segarray* array, size_t index, void* elementOut);
+
+/// @brief overwrites the element at the index
+CTOOLBOX_API ctoolbox_result segarray_set(segarray* array, size_t index, const void* element);
+
+/// @brief allocates the segments needed to hold newCapacity elements
+CTOOLBOX_API ctoolbox_result segarray_reserve(segarray* array, size_t newCapacity);
+
+/// @brief releases the segments no element lives in
+CTOOLBOX_API ctoolbox_result segarray_shrink_to_fit(segarray* array);
+
+/// @brief returns the number of elements
+CTOOLBOX_API size_t segarray_size(const segarray* array);
+
+/// @brief returns how many elements the allocated segments hold
+CTOOLBOX_API size_t segarray_capacity(const segarray* array);
+
+/// @brief returns whether the array holds no element
+CTOOLBOX_API bool segarray_empty(const segarray* array);
+
+/// @brief returns the memory the array allocated, its header included
+CTOOLBOX_API ctoolbox_result segarray_memory_usage(const segarray* array, ctoolbox_memstats* statsOut);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SEGARRAY_INCLUDED
@@ -1,4 +1,5 @@
 #include "shashtable.h"
+#include "slab.h"
 
 #include <string.h>
 
@@ -8,15 +9,19 @@
 
 struct shash 
 {
-    char* key;
     void* value;
     struct shash* next;
+    bool pooled;        // from the slab, otherwise straight from the memory functions
 };
 
+// a slab only pays off once the entries fill a page of it, smaller tables allocate each entry on its own
 struct shashtable
 {
     shash* buckets[SHASHTABLE_SIZE];
+    slab* entries;                  // NULL until the entries outgrow a slab page
+    size_t plainBytes;              // entries allocated outside the slab
     ctoolbox_memfuncs memfuncs;
+    ctoolbox_memstats stats;        // the table and the entries outside the slab
     size_t count;  // Track total entries
 };
 
@@ -33,18 +38,50 @@ CTOOLBOX_API unsigned long shash_djb2_hash(const char *str)
     return hash % SHASHTABLE_SIZE;
 }
 
-CTOOLBOX_API ctoolbox_result shash_strdup(const ctoolbox_memfuncs* fun, const char* src, char** output)
+static inline size_t shash_alloc_size(size_t keyLength)
 {
-    if (!fun || !src || !output) return CTOOLBOX_ERROR_INVALID_PARAM;
-    
-    size_t len = strlen(src);
-    char* str = (char*)ctoolbox_custom_malloc(fun, len + 1);
-    if (!str) return CTOOLBOX_ERROR_MEMORY_ALLOC;
-    
-    memcpy(str, src, len + 1);
-    *output = str;
-    
-    return CTOOLBOX_SUCCESS;
+    return sizeof(shash) + keyLength + 1;
+}
+
+// the key is stored right after the entry, both come from one allocation
+static inline char* shash_key(const shash* entry)
+{
+    return (char*)(entry + 1);
+}
+
+static shash* shash_alloc(shashtable* table, size_t size)
+{
+    if (!table->entries && table->plainBytes + size < SLAB_PAGE_SIZE) {
+        shash* entry = ctoolbox_custom_malloc(&table->memfuncs, size);
+        if (!entry) return NULL;
+
+        entry->pooled = false;
+        table->plainBytes += size;
+        ctoolbox_memstats_on_alloc(&table->stats, size);
+        return entry;
+    }
+
+    if (!table->entries) {
+        table->entries = slab_init_memfuncs(&table->memfuncs);
+        if (!table->entries) return NULL;
+    }
+
+    shash* entry = (shash*)slab_alloc(table->entries, size);
+    if (entry) entry->pooled = true;
+    return entry;
+}
+
+static void shash_free(shashtable* table, shash* entry)
+{
+    size_t size = shash_alloc_size(strlen(shash_key(entry)));
+    if (entry->pooled) {
+        slab_free(table->entries, entry, size);
+        return;
+    }
+
+    table->plainBytes -= size;
+    ctoolbox_custom_free_sized(&table->memfuncs, entry, size);
+    ctoolbox_memstats_on_free(&table->stats, size);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -59,6 +96,7 @@ CTOOLBOX_API shashtable* shashtable_init()
 CTOOLBOX_API shashtable* shashtable_init_memfuncs(const ctoolbox_memfuncs* memfuncs)
 {
     shashtable* outHashtable = ctoolbox_custom_malloc(memfuncs ? memfuncs : &CTOOLBOX_DEFAULT_MEMFUNCS, sizeof(shashtable));
+    if (!outHashtable) return NULL;
 
     for (int i = 0; i < SHASHTABLE_SIZE; i++) {
         outHashtable->buckets[i] = NULL;
@@ -67,6 +105,11 @@ CTOOLBOX_API shashtable* shashtable_init_memfuncs(const ctoolbox_memfuncs* memfu
     if (memfuncs) outHashtable->memfuncs = *memfuncs;
     else outHashtable->memfuncs = CTOOLBOX_DEFAULT_MEMFUNCS;
 
+    outHashtable->entries = NULL;
+    outHashtable->plainBytes = 0;
+    memset(&outHashtable->stats, 0, sizeof(outHashtable->stats));
+    ctoolbox_memstats_on_alloc(&outHashtable->stats, sizeof(shashtable));
+
     outHashtable->count = 0;
     return outHashtable;
 }
@@ -75,16 +118,17 @@ CTOOLBOX_API void shashtable_destroy(shashtable* table)
 {
     if (!table) return;
 
-    for (int i = 0; i < SHASHTABLE_SIZE; i++) {
-        shash* entry = table->buckets[i];
-        while (entry) {
-            shash* next = entry->next;
-            ctoolbox_custom_free(&table->memfuncs, entry->key);
-            ctoolbox_custom_free(&table->memfuncs, entry);
-            entry = next;
+    // entries in the slab go with it, only those allocated before it are walked to
+    for (int i = 0; i < SHASHTABLE_SIZE && table->plainBytes; i++) {
+        shash* current = table->buckets[i];
+        while (current) {
+            shash* next = current->next;
+            if (!current->pooled) shash_free(table, current);
+            current = next;
         }
     }
-    ctoolbox_custom_free(&table->memfuncs, table);
+    slab_destroy(table->entries);
+    ctoolbox_custom_free_sized(&table->memfuncs, table, sizeof(shashtable));
 }
 
 CTOOLBOX_API ctoolbox_result shashtable_insert(shashtable *table, const char* key, void* value)
@@ -97,27 +141,21 @@ CTOOLBOX_API ctoolbox_result shashtable_insert(shashtable *table, const char* ke
     // check if key already exists
     shash* current = table->buckets[index];
     while (current) {
-        if (strcmp(current->key, key) == 0) {
+        if (strcmp(shash_key(current), key) == 0) {
             current->value = value;
             return CTOOLBOX_SUCCESS;
         }
         current = current->next;
     }
 
-    // create new entry
-    shash* new_entry = (shash*)ctoolbox_custom_malloc(&table->memfuncs, sizeof(shash));
+    // create new entry with the key copied right after it
+    size_t keyLength = strlen(key);
+    shash* new_entry = shash_alloc(table, shash_alloc_size(keyLength));
     if (!new_entry) return CTOOLBOX_ERROR_MEMORY_ALLOC;
 
-    new_entry->key = NULL;
     new_entry->value = value;
     new_entry->next = NULL;
-
-    // duplicate key
-    ctoolbox_result result = shash_strdup(&table->memfuncs, key, &new_entry->key);
-    if (result != CTOOLBOX_SUCCESS) {
-        ctoolbox_custom_free(&table->memfuncs, new_entry);
-        return result;
-    }
+    memcpy(shash_key(new_entry), key, keyLength + 1);
 
     // insert at beginning of chain (simplest)
     new_entry->next = table->buckets[index];
@@ -136,12 +174,11 @@ CTOOLBOX_API ctoolbox_result shashtable_delete(shashtable* table, const char* ke
     shash* prev = NULL;
 
     while (current) {
-        if (strcmp(current->key, key) == 0) {
+        if (strcmp(shash_key(current), key) == 0) {
             if (prev) prev->next = current->next;
             else table->buckets[index] = current->next;
 
-            ctoolbox_custom_free(&table->memfuncs, current->key);
-            ctoolbox_custom_free(&table->memfuncs, current);
+            shash_free(table, current);
             table->count--;
 
             return CTOOLBOX_SUCCESS;
@@ -161,7 +198,7 @@ CTOOLBOX_API void* shashtable_lookup(shashtable* table, const char* key)
     const shash* current = table->buckets[index];
 
     while (current) {
-        if (strcmp(current->key, key) == 0) return current->value;
+        if (strcmp(shash_key(current), key) == 0) return current->value;
         current = current->next;
     }
 
@@ -177,3 +214,23 @@ CTOOLBOX_API size_t shashtable_count(shashtable* table)
 {
     return table ? table->count : 0;
 }
+
+CTOOLBOX_API ctoolbox_result shashtable_memory_usage(shashtable* table, ctoolbox_memstats* statsOut)
+{
+    if (!table || !statsOut) return CTOOLBOX_ERROR_INVALID_PARAM;
+
+    *statsOut = table->stats;
+    if (!table->entries) return CTOOLBOX_SUCCESS;
+
+    // the slab's figures on top, its peak and the table's may not have come at the same time
+    ctoolbox_memstats slabStats;
+    ctoolbox_result result = slab_memory_usage(table->entries, &slabStats);
+    if (result != CTOOLBOX_SUCCESS) return result;
+
+    statsOut->liveBytes += slabStats.liveBytes;
+    statsOut->peakBytes += slabStats.peakBytes;
+    statsOut->allocCount += slabStats.allocCount;
+    statsOut->reallocCount += slabStats.reallocCount;
+    statsOut->freeCount += slabStats.freeCount;
+    return CTOOLBOX_SUCCESS;
+}
@@ -46,6 +46,9 @@ CTOOLBOX_API bool shashtable_contains(shashtable* table, const char* key);
 /// @brief returns how many entries exists in the hashtable
 CTOOLBOX_API size_t shashtable_count(shashtable* table);
 
+/// @brief returns the memory the hashtable allocated, its entries included
+CTOOLBOX_API ctoolbox_result shashtable_memory_usage(shashtable* table, ctoolbox_memstats* statsOut);
+
 #ifdef __cplusplus
 }
 #endif
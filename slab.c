@@ -0,0 +1,312 @@
+#include "slab.h"
+
+#include <string.h>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// internal
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// slab header, lives at the start of its SLAB_PAGE_SIZE aligned page so objects find it by masking their address
+typedef struct slab_page
+{
+    struct slab_page* prev;
+    struct slab_page* next;
+    void* freeList;         // objects released back into this slab
+    char* bump;             // objects never handed out start here
+    char* end;
+    uint32_t used;
+    uint32_t classIndex;
+} slab_page;
+
+// objects bigger than SLAB_MAX_OBJECT_SIZE, linked so slab_destroy can release them
+typedef struct slab_large
+{
+    struct slab_large* prev;
+    struct slab_large* next;
+    size_t size;
+    size_t padding; // keeps the object that follows the header aligned to 16 bytes
+} slab_large;
+
+typedef struct slab_class
+{
+    slab_page* partial;     // slabs with room for at least one object
+    slab_page* full;
+    size_t slabCount;
+    size_t used;
+} slab_class;
+
+struct slab
+{
+    slab_class classes[SLAB_CLASS_COUNT];
+    slab_large* large;
+    ctoolbox_memfuncs memfuncs;
+    ctoolbox_memstats stats;
+};
+
+#define SLAB_HEADER_SIZE ((sizeof(slab_page) + 15u) & ~(size_t)15u)
+
+static const size_t slab_class_sizes[SLAB_CLASS_COUNT] = { 16, 32, 48, 64, 96, 128, 192, 256 };
+
+// maps (size + 15) / 16 to its size class
+static const uint8_t slab_class_lookup[SLAB_MAX_OBJECT_SIZE / 16 + 1] = { 0, 0, 1, 2, 3, 4, 4, 5, 5, 6, 6, 6, 6, 7, 7, 7, 7 };
+
+static inline size_t slab_class_index(size_t size)
+{
+    return slab_class_lookup[(size + 15) >> 4];
+}
+
+static inline bool slab_page_full(const slab_page* page)
+{
+    return !page->freeList && page->bump >= page->end;
+}
+
+static inline void slab_list_remove(slab_page** list, slab_page* page)
+{
+    if (page->prev) page->prev->next = page->next;
+    else *list = page->next;
+    if (page->next) page->next->prev = page->prev;
+    page->prev = page->next = NULL;
+}
+
+static inline void slab_list_push(slab_page** list, slab_page* page)
+{
+    page->prev = NULL;
+    page->next = *list;
+    if (*list) (*list)->prev = page;
+    *list = page;
+}
+
+static slab_page* slab_page_create(slab* s, size_t classIndex)
+{
+    slab_page* page = ctoolbox_custom_aligned_malloc(&s->memfuncs, SLAB_PAGE_SIZE, SLAB_PAGE_SIZE);
+    if (!page) return NULL;
+
+    size_t objectSize = slab_class_sizes[classIndex];
+    size_t objectCount = (SLAB_PAGE_SIZE - SLAB_HEADER_SIZE) / objectSize;
+
+    page->prev = page->next = NULL;
+    page->freeList = NULL;
+    page->bump = (char*)page + SLAB_HEADER_SIZE;
+    page->end = page->bump + objectCount * objectSize;
+    page->used = 0;
+    page->classIndex = (uint32_t)classIndex;
+
+    slab_list_push(&s->classes[classIndex].partial, page);
+    s->classes[classIndex].slabCount++;
+    ctoolbox_memstats_on_alloc(&s->stats, SLAB_PAGE_SIZE);
+    return page;
+}
+
+// size of a block released or moved without it, large blocks are looked up in their list and anything else is a page object
+static size_t slab_block_size(const slab* s, const void* ptr)
+{
+    for (const slab_large* large = s->large; large; large = large->next) {
+        if (large + 1 == ptr) return large->size;
+    }
+
+    const slab_page* page = (const slab_page*)((uintptr_t)ptr & ~(uintptr_t)(SLAB_PAGE_SIZE - 1));
+    return slab_class_sizes[page->classIndex];
+}
+
+static void* slab_ctx_alloc(void* user, size_t size, size_t alignment)
+{
+    // objects are only 16 bytes aligned
+    if (alignment > 16) return NULL;
+    return slab_alloc((slab*)user, size);
+}
+
+static void* slab_ctx_realloc(void* user, void* ptr, size_t oldSize, size_t newSize, size_t alignment)
+{
+    if (ptr && oldSize == 0) oldSize = slab_block_size((slab*)user, ptr);
+
+    // staying in the same size class keeps the object where it is
+    if (ptr && oldSize <= SLAB_MAX_OBJECT_SIZE && newSize <= SLAB_MAX_OBJECT_SIZE && slab_class_index(oldSize) == slab_class_index(newSize)) {
+        return ptr;
+    }
+
+    void* newPtr = slab_ctx_alloc(user, newSize, alignment);
+    if (!newPtr) return NULL;
+
+    if (ptr) {
+        memcpy(newPtr, ptr, oldSize < newSize ? oldSize : newSize);
+        slab_free((slab*)user, ptr, oldSize);
+    }
+    return newPtr;
+}
+
+// ctoolbox_custom_free passes no size, masking the address of a large block would land on an unrelated page
+static void slab_ctx_free(void* user, void* ptr, size_t size)
+{
+    if (ptr && size == 0) size = slab_block_size((slab*)user, ptr);
+    slab_free((slab*)user, ptr, size);
+}
+
+static void slab_page_list_destroy(slab* s, slab_page* page)
+{
+    while (page) {
+        slab_page* next = page->next;
+        ctoolbox_custom_aligned_free_sized(&s->memfuncs, page, SLAB_PAGE_SIZE, SLAB_PAGE_SIZE);
+        page = next;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// external
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+CTOOLBOX_API slab* slab_init()
+{
+    return slab_init_memfuncs(&CTOOLBOX_DEFAULT_MEMFUNCS);
+}
+
+CTOOLBOX_API slab* slab_init_memfuncs(const ctoolbox_memfuncs* memfuncs)
+{
+    slab* outSlab = ctoolbox_custom_malloc(memfuncs ? memfuncs : &CTOOLBOX_DEFAULT_MEMFUNCS, sizeof(slab));
+    if (!outSlab) return NULL;
+
+    memset(outSlab, 0, sizeof(slab));
+
+    if (memfuncs) outSlab->memfuncs = *memfuncs;
+    else outSlab->memfuncs = CTOOLBOX_DEFAULT_MEMFUNCS;
+
+    ctoolbox_memstats_on_alloc(&outSlab->stats, sizeof(slab));
+
+    return outSlab;
+}
+
+CTOOLBOX_API void slab_destroy(slab* s)
+{
+    if (!s) return;
+
+    for (size_t i = 0; i < SLAB_CLASS_COUNT; i++) {
+        slab_page_list_destroy(s, s->classes[i].partial);
+        slab_page_list_destroy(s, s->classes[i].full);
+    }
+
+    slab_large* large = s->large;
+    while (large) {
+        slab_large* next = large->next;
+        ctoolbox_custom_free_sized(&s->memfuncs, large, sizeof(slab_large) + large->size);
+        large = next;
+    }
+    ctoolbox_custom_free_sized(&s->memfuncs, s, sizeof(slab));
+}
+
+CTOOLBOX_API void* slab_alloc(slab* s, size_t size)
+{
+    if (!s) return NULL;
+
+    if (size > SLAB_MAX_OBJECT_SIZE) {
+        if (size > SIZE_MAX - sizeof(slab_large)) return NULL;
+
+        slab_large* large = ctoolbox_custom_malloc(&s->memfuncs, sizeof(slab_large) + size);
+        if (!large) return NULL;
+
+        ctoolbox_memstats_on_alloc(&s->stats, sizeof(slab_large) + size);
+        large->prev = NULL;
+        large->next = s->large;
+        large->size = size;
+        large->padding = 0;
+        if (s->large) s->large->prev = large;
+        s->large = large;
+        return large + 1;
+    }
+
+    size_t classIndex = slab_class_index(size);
+    slab_class* cls = &s->classes[classIndex];
+
+    slab_page* page = cls->partial;
+    if (!page) {
+        page = slab_page_create(s, classIndex);
+        if (!page) return NULL;
+    }
+
+    void* object;
+    if (page->freeList) {
+        object = page->freeList;
+        page->freeList = *(void**)object;
+    }
+    else {
+        object = page->bump;
+        page->bump += slab_class_sizes[classIndex];
+    }
+
+    page->used++;
+    cls->used++;
+
+    if (slab_page_full(page)) {
+        slab_list_remove(&cls->partial, page);
+        slab_list_push(&cls->full, page);
+    }
+
+    return object;
+}
+
+CTOOLBOX_API void slab_free(slab* s, void* ptr, size_t size)
+{
+    if (!s || !ptr) return;
+
+    if (size > SLAB_MAX_OBJECT_SIZE) {
+        slab_large* large = (slab_large*)ptr - 1;
+        if (large->prev) large->prev->next = large->next;
+        else s->large = large->next;
+        if (large->next) large->next->prev = large->prev;
+
+        ctoolbox_memstats_on_free(&s->stats, sizeof(slab_large) + large->size);
+        ctoolbox_custom_free_sized(&s->memfuncs, large, sizeof(slab_large) + large->size);
+        return;
+    }
+
+    slab_page* page = (slab_page*)((uintptr_t)ptr & ~(uintptr_t)(SLAB_PAGE_SIZE - 1));
+    slab_class* cls = &s->classes[page->classIndex];
+    bool wasFull = slab_page_full(page);
+
+    *(void**)ptr = page->freeList;
+    page->freeList = ptr;
+    page->used--;
+    cls->used--;
+
+    if (wasFull) {
+        slab_list_remove(&cls->full, page);
+        slab_list_push(&cls->partial, page);
+    }
+
+    // release empty slabs, but keep the last one with room around to avoid thrashing
+    else if (page->used == 0 && (page->prev || page->next)) {
+        slab_list_remove(&cls->partial, page);
+        cls->slabCount--;
+        ctoolbox_memstats_on_free(&s->stats, SLAB_PAGE_SIZE);
+        ctoolbox_custom_aligned_free_sized(&s->memfuncs, page, SLAB_PAGE_SIZE, SLAB_PAGE_SIZE);
+    }
+}
+
+CTOOLBOX_API ctoolbox_result slab_get_stats(const slab* s, size_t classIndex, slab_stats* statsOut)
+{
+    if (!s || !statsOut || classIndex >= SLAB_CLASS_COUNT) return CTOOLBOX_ERROR_INVALID_PARAM;
+
+    const slab_class* cls = &s->classes[classIndex];
+    statsOut->objectSize = slab_class_sizes[classIndex];
+    statsOut->objectsPerSlab = (SLAB_PAGE_SIZE - SLAB_HEADER_SIZE) / statsOut->objectSize;
+    statsOut->slabCount = cls->slabCount;
+    statsOut->usedObjects = cls->used;
+    statsOut->occupancy = cls->slabCount ? (float)cls->used / (float)(cls->slabCount * statsOut->objectsPerSlab) : 0.0f;
+
+    return CTOOLBOX_SUCCESS;
+}
+
+CTOOLBOX_API ctoolbox_result slab_memory_usage(const slab* s, ctoolbox_memstats* statsOut)
+{
+    if (!s || !statsOut) return CTOOLBOX_ERROR_INVALID_PARAM;
+    *statsOut = s->stats;
+    return CTOOLBOX_SUCCESS;
+}
+
+CTOOLBOX_API ctoolbox_memfuncs slab_memfuncs(slab* s)
+{
+    ctoolbox_memfuncs memfuncs = { 0 };
+    memfuncs.alloc_ctx_fn = slab_ctx_alloc;
+    memfuncs.realloc_ctx_fn = slab_ctx_realloc;
+    memfuncs.free_ctx_fn = slab_ctx_free;
+    memfuncs.user = s;
+    return memfuncs;
+}
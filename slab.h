@@ -0,0 +1,65 @@
+#ifndef SLAB_INCLUDED
+#define SLAB_INCLUDED
+
+#include "context.h"
+
+/// @brief size in bytes of each slab, must be a power of two since slabs are aligned to it
+#ifndef SLAB_PAGE_SIZE
+    #define SLAB_PAGE_SIZE 4096
+#endif
+
+/// @brief number of size classes, objects bigger than SLAB_MAX_OBJECT_SIZE go straight to the memory functions
+#define SLAB_CLASS_COUNT 8
+#define SLAB_MAX_OBJECT_SIZE 256
+
+/// @brief opaque slab allocator structure
+typedef struct slab slab;
+
+/// @brief occupancy of one size class
+typedef struct slab_stats
+{
+    size_t objectSize;      // size of the objects in this class
+    size_t objectsPerSlab;  // how many objects fit in one slab
+    size_t slabCount;       // slabs currently allocated
+    size_t usedObjects;     // objects currently handed out
+    float occupancy;        // usedObjects / (slabCount * objectsPerSlab), 0 without slabs
+} slab_stats;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// functions
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// @brief creates the slab allocator
+CTOOLBOX_API slab* slab_init();
+
+/// @brief creates the slab allocator with custom memory allocation functions for its slabs
+CTOOLBOX_API slab* slab_init_memfuncs(const ctoolbox_memfuncs* memfuncs);
+
+/// @brief destroys the slab allocator and every object still allocated from it
+CTOOLBOX_API void slab_destroy(slab* s);
+
+/// @brief allocates an object of size bytes from the smallest size class that fits it
+CTOOLBOX_API void* slab_alloc(slab* s, size_t size);
+
+/// @brief releases an object, size must be the one it was allocated with
+CTOOLBOX_API void slab_free(slab* s, void* ptr, size_t size);
+
+/// @brief returns the occupancy of the size class at classIndex, in [0, SLAB_CLASS_COUNT)
+CTOOLBOX_API ctoolbox_result slab_get_stats(const slab* s, size_t classIndex, slab_stats* statsOut);
+
+/// @brief returns memory functions that allocate from the slab, to be used with the *_init_memfuncs calls
+/// @brief blocks are 16 bytes aligned, frees without the block size walk the objects bigger than SLAB_MAX_OBJECT_SIZE to find it
+CTOOLBOX_API ctoolbox_memfuncs slab_memfuncs(slab* s);
+
+/// @brief returns the memory the slab allocator holds, slabs and objects bigger than SLAB_MAX_OBJECT_SIZE included
+CTOOLBOX_API ctoolbox_result slab_memory_usage(const slab* s, ctoolbox_memstats* statsOut);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SLAB_INCLUDED
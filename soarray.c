@@ -0,0 +1,301 @@
+#include "soarray.h"
+
+#include <string.h>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// internal
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+typedef struct soarray_column_info
+{
+    char* data;
+    size_t elementSize;
+} soarray_column_info;
+
+// every column lives in one block, one after the other, each starting on a SOARRAY_COLUMN_ALIGNMENT boundary
+struct soarray
+{
+    void* block;
+    size_t blockBytes;
+    size_t size;
+    size_t capacity;
+    size_t columnCount;
+    ctoolbox_memfuncs memfuncs;
+    ctoolbox_memstats stats;
+    soarray_column_info columns[];
+};
+
+static inline size_t soarray_header_bytes(size_t columnCount)
+{
+    return sizeof(soarray) + columnCount * sizeof(soarray_column_info);
+}
+
+// bytes of a block holding capacity rows, 0 on overflow
+static size_t soarray_block_bytes(const soarray* array, size_t capacity)
+{
+    size_t bytes = 0;
+    for (size_t i = 0; i < array->columnCount; i++) {
+        size_t elementSize = array->columns[i].elementSize;
+        if (capacity > SIZE_MAX / elementSize) return 0;
+
+        size_t columnBytes = (capacity * elementSize + (SOARRAY_COLUMN_ALIGNMENT - 1)) & ~(size_t)(SOARRAY_COLUMN_ALIGNMENT - 1);
+        if (columnBytes < capacity * elementSize || columnBytes > SIZE_MAX - bytes) return 0;
+        bytes += columnBytes;
+    }
+    return bytes;
+}
+
+// moves every column into a block for newCapacity rows, keeping the first size rows
+static ctoolbox_result soarray_relocate(soarray* array, size_t newCapacity)
+{
+    size_t newBytes = soarray_block_bytes(array, newCapacity);
+    if (newBytes == 0 && newCapacity > 0) return CTOOLBOX_ERROR_MEMORY_ALLOC;
+
+    char* newBlock = NULL;
+    if (newBytes > 0) {
+        newBlock = ctoolbox_custom_aligned_malloc(&array->memfuncs, newBytes, SOARRAY_COLUMN_ALIGNMENT);
+        if (!newBlock) return CTOOLBOX_ERROR_MEMORY_ALLOC;
+    }
+
+    char* column = newBlock;
+    for (size_t i = 0; i < array->columnCount; i++) {
+        size_t elementSize = array->columns[i].elementSize;
+        if (array->size > 0) memcpy(column, array->columns[i].data, array->size * elementSize);
+
+        array->columns[i].data = column;
+        if (column) column += (newCapacity * elementSize + (SOARRAY_COLUMN_ALIGNMENT - 1)) & ~(size_t)(SOARRAY_COLUMN_ALIGNMENT - 1);
+    }
+
+    if (newBlock) ctoolbox_memstats_on_alloc(&array->stats, newBytes);
+    if (array->block) {
+        ctoolbox_custom_aligned_free_sized(&array->memfuncs, array->block, array->blockBytes, SOARRAY_COLUMN_ALIGNMENT);
+        ctoolbox_memstats_on_free(&array->stats, array->blockBytes);
+    }
+
+    array->block = newBlock;
+    array->blockBytes = newBytes;
+    array->capacity = newCapacity;
+    return CTOOLBOX_SUCCESS;
+}
+
+// doubles the capacity until it holds minCapacity rows
+static ctoolbox_result soarray_grow(soarray* array, size_t minCapacity)
+{
+    if (minCapacity <= array->capacity) return CTOOLBOX_SUCCESS;
+
+    size_t newCapacity = array->capacity > 0 ? array->capacity : 1;
+    while (newCapacity < minCapacity) {
+        if (newCapacity > SIZE_MAX / 2) {
+            newCapacity = minCapacity;
+            break;
+        }
+        newCapacity *= 2;
+    }
+    return soarray_relocate(array, newCapacity);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// external
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+CTOOLBOX_API soarray* soarray_init(const size_t* columnSizes, size_t columnCount, size_t initialCapacity)
+{
+    return soarray_init_memfuncs(columnSizes, columnCount, initialCapacity, &CTOOLBOX_DEFAULT_MEMFUNCS);
+}
+
+CTOOLBOX_API soarray* soarray_init_memfuncs(const size_t* columnSizes, size_t columnCount, size_t initialCapacity, const ctoolbox_memfuncs* memfuncs)
+{
+    if (!columnSizes || columnCount == 0) return NULL;
+    if (columnCount > (SIZE_MAX - sizeof(soarray)) / sizeof(soarray_column_info)) return NULL;
+    for (size_t i = 0; i < columnCount; i++) {
+        if (columnSizes[i] == 0) return NULL;
+    }
+
+    soarray* outArray = ctoolbox_custom_malloc(memfuncs ? memfuncs : &CTOOLBOX_DEFAULT_MEMFUNCS, soarray_header_bytes(columnCount));
+    if (!outArray) return NULL;
+
+    memset(outArray, 0, soarray_header_bytes(columnCount));
+    outArray->columnCount = columnCount;
+    for (size_t i = 0; i < columnCount; i++) outArray->columns[i].elementSize = columnSizes[i];
+
+    if (memfuncs) outArray->memfuncs = *memfuncs;
+    else outArray->memfuncs = CTOOLBOX_DEFAULT_MEMFUNCS;
+
+    ctoolbox_memstats_on_alloc(&outArray->stats, soarray_header_bytes(columnCount));
+
+    if (initialCapacity > 0 && soarray_relocate(outArray, initialCapacity) != CTOOLBOX_SUCCESS) {
+        ctoolbox_custom_free_sized(&outArray->memfuncs, outArray, soarray_header_bytes(columnCount));
+        return NULL;
+    }
+
+    return outArray;
+}
+
+CTOOLBOX_API void soarray_destroy(soarray* array)
+{
+    if (!array) return;
+
+    if (array->block) ctoolbox_custom_aligned_free_sized(&array->memfuncs, array->block, array->blockBytes, SOARRAY_COLUMN_ALIGNMENT);
+    ctoolbox_custom_free_sized(&array->memfuncs, array, soarray_header_bytes(array->columnCount));
+}
+
+CTOOLBOX_API ctoolbox_result soarray_push_back(soarray* array, const void* const* fields)
+{
+    if (!array) return CTOOLBOX_ERROR_INVALID_PARAM;
+
+    size_t index;
+    ctoolbox_result res = soarray_emplace_back(array, &index);
+    if (res != CTOOLBOX_SUCCESS) return res;
+
+    for (size_t i = 0; i < array->columnCount; i++) {
+        void* field = array->columns[i].data + index * array->columns[i].elementSize;
+        if (fields && fields[i]) memcpy(field, fields[i], array->columns[i].elementSize);
+        else memset(field, 0, array->columns[i].elementSize);
+    }
+    return CTOOLBOX_SUCCESS;
+}
+
+CTOOLBOX_API ctoolbox_result soarray_emplace_back(soarray* array, size_t* indexOut)
+{
+    if (!array) return CTOOLBOX_ERROR_INVALID_PARAM;
+    if (array->size == SIZE_MAX) return CTOOLBOX_ERROR_MEMORY_ALLOC;
+
+    ctoolbox_result res = soarray_grow(array, array->size + 1);
+    if (res != CTOOLBOX_SUCCESS) return res;
+
+    if (indexOut) *indexOut = array->size;
+    array->size++;
+    return CTOOLBOX_SUCCESS;
+}
+
+CTOOLBOX_API ctoolbox_result soarray_pop_back(soarray* array, void* const* fieldsOut)
+{
+    if (!array || array->size == 0) return CTOOLBOX_ERROR_EMPTY;
+
+    array->size--;
+    if (fieldsOut) {
+        for (size_t i = 0; i < array->columnCount; i++) {
+            if (fieldsOut[i]) memcpy(fieldsOut[i], array->columns[i].data + array->size * array->columns[i].elementSize, array->columns[i].elementSize);
+        }
+    }
+    return CTOOLBOX_SUCCESS;
+}
+
+CTOOLBOX_API ctoolbox_result soarray_get(const soarray* array, size_t index, void* const* fieldsOut)
+{
+    if (!array || !fieldsOut) return CTOOLBOX_ERROR_INVALID_PARAM;
+    if (index >= array->size) return CTOOLBOX_ERROR_OUT_OF_BOUNDS;
+
+    for (size_t i = 0; i < array->columnCount; i++) {
+        if (fieldsOut[i]) memcpy(fieldsOut[i], array->columns[i].data + index * array->columns[i].elementSize, array->columns[i].elementSize);
+    }
+    return CTOOLBOX_SUCCESS;
+}
+
+CTOOLBOX_API ctoolbox_result soarray_set(soarray* array, size_t index, const void* const* fields)
+{
+    if (!array || !fields) return CTOOLBOX_ERROR_INVALID_PARAM;
+    if (index >= array->size) return CTOOLBOX_ERROR_OUT_OF_BOUNDS;
+
+    for (size_t i = 0; i < array->columnCount; i++) {
+        if (fields[i]) memcpy(array->columns[i].data + index * array->columns[i].elementSize, fields[i], array->columns[i].elementSize);
+    }
+    return CTOOLBOX_SUCCESS;
+}
+
+CTOOLBOX_API ctoolbox_result soarray_swap_remove(soarray* array, size_t index)
+{
+    if (!array) return CTOOLBOX_ERROR_INVALID_PARAM;
+    if (index >= array->size) return CTOOLBOX_ERROR_OUT_OF_BOUNDS;
+
+    array->size--;
+    if (index != array->size) {
+        for (size_t i = 0; i < array->columnCount; i++) {
+            size_t elementSize = array->columns[i].elementSize;
+            memcpy(array->columns[i].data + index * elementSize, array->columns[i].data + array->size * elementSize, elementSize);
+        }
+    }
+    return CTOOLBOX_SUCCESS;
+}
+
+CTOOLBOX_API void* soarray_column(soarray* array, size_t column)
+{
+    if (!array || column >= array->columnCount) return NULL;
+    return array->columns[column].data;
+}
+
+CTOOLBOX_API const void* soarray_const_column(const soarray* array, size_t column)
+{
+    if (!array || column >= array->columnCount) return NULL;
+    return array->columns[column].data;
+}
+
+CTOOLBOX_API void* soarray_peek(soarray* array, size_t column, size_t index)
+{
+    if (!array || column >= array->columnCount || index >= array->size) return NULL;
+    return array->columns[column].data + index * array->columns[column].elementSize;
+}
+
+CTOOLBOX_API const void* soarray_const_peek(const soarray* array, size_t column, size_t index)
+{
+    if (!array || column >= array->columnCount || index >= array->size) return NULL;
+    return array->columns[column].data + index * array->columns[column].elementSize;
+}
+
+CTOOLBOX_API size_t soarray_column_count(const soarray* array)
+{
+    return array ? array->columnCount : 0;
+}
+
+CTOOLBOX_API size_t soarray_column_size(const soarray* array, size_t column)
+{
+    if (!array || column >= array->columnCount) return 0;
+    return array->columns[column].elementSize;
+}
+
+CTOOLBOX_API ctoolbox_result soarray_resize(soarray* array, size_t newSize)
+{
+    if (!array) return CTOOLBOX_ERROR_INVALID_PARAM;
+
+    ctoolbox_result res = soarray_grow(array, newSize);
+    if (res != CTOOLBOX_SUCCESS) return res;
+
+    array->size = newSize;
+    return CTOOLBOX_SUCCESS;
+}
+
+CTOOLBOX_API ctoolbox_result soarray_reserve(soarray* array, size_t newCapacity)
+{
+    if (!array) return CTOOLBOX_ERROR_INVALID_PARAM;
+    if (newCapacity <= array->capacity) return CTOOLBOX_SUCCESS;
+    return soarray_relocate(array, newCapacity);
+}
+
+CTOOLBOX_API ctoolbox_result soarray_shrink_to_fit(soarray* array)
+{
+    if (!array) return CTOOLBOX_ERROR_INVALID_PARAM;
+    if (array->size == array->capacity) return CTOOLBOX_SUCCESS;
+    return soarray_relocate(array, array->size);
+}
+
+CTOOLBOX_API size_t soarray_size(const soarray* array)
+{
+    return array ? array->size : 0;
+}
+
+CTOOLBOX_API size_t soarray_capacity(const soarray* array)
+{
+    return array ? array->capacity : 0;
+}
+
+CTOOLBOX_API bool soarray_empty(const soarray* array)
+{
+    return array ? array->size == 0 : true;
+}
+
+CTOOLBOX_API ctoolbox_result soarray_memory_usage(const soarray* array, ctoolbox_memstats* statsOut)
+{
+    if (!array || !statsOut) return CTOOLBOX_ERROR_INVALID_PARAM;
+    *statsOut = array->stats;
+    return CTOOLBOX_SUCCESS;
+}
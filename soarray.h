@@ -0,0 +1,92 @@
+#ifndef SOARRAY_INCLUDED
+#define SOARRAY_INCLUDED
+
+#include "context.h"
+
+/// @brief alignment of every column's first element, a cache line so columns never share one
+#ifndef SOARRAY_COLUMN_ALIGNMENT
+    #define SOARRAY_COLUMN_ALIGNMENT 64
+#endif
+
+/// @brief opaque structure-of-arrays container
+typedef struct soarray soarray;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// functions
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// @brief initializes the container with columnCount columns, column i holding elements of columnSizes[i] bytes
+CTOOLBOX_API soarray* soarray_init(const size_t* columnSizes, size_t columnCount, size_t initialCapacity);
+
+/// @brief initializes the container with custom memory allocation functions
+CTOOLBOX_API soarray* soarray_init_memfuncs(const size_t* columnSizes, size_t columnCount, size_t initialCapacity, const ctoolbox_memfuncs* memfuncs);
+
+/// @brief destroys the container, but not the content itself
+CTOOLBOX_API void soarray_destroy(soarray* array);
+
+/// @brief appends a row, fields holds one pointer per column, a NULL fields or field zero-fills that column
+CTOOLBOX_API ctoolbox_result soarray_push_back(soarray* array, const void* const* fields);
+
+/// @brief appends an uninitialized row to be written in place through the columns, writing its index into indexOut if not NULL
+CTOOLBOX_API ctoolbox_result soarray_emplace_back(soarray* array, size_t* indexOut);
+
+/// @brief removes the last row, copying each column's field into fieldsOut[i] when fieldsOut and fieldsOut[i] are not NULL
+CTOOLBOX_API ctoolbox_result soarray_pop_back(soarray* array, void* const* fieldsOut);
+
+/// @brief copies each column's field of the row into fieldsOut[i], NULL entries are skipped
+CTOOLBOX_API ctoolbox_result soarray_get(const soarray* array, size_t index, void* const* fieldsOut);
+
+/// @brief overwrites each column's field of the row with fields[i], NULL entries are left untouched
+CTOOLBOX_API ctoolbox_result soarray_set(soarray* array, size_t index, const void* const* fields);
+
+/// @brief removes the row in O(1) by moving the last row into its place, the order isn't kept
+CTOOLBOX_API ctoolbox_result soarray_swap_remove(soarray* array, size_t index);
+
+/// @brief writable access to a column's contiguous elements, valid until the container grows or shrinks
+CTOOLBOX_API void* soarray_column(soarray* array, size_t column);
+
+/// @brief access to a column's contiguous elements, valid until the container grows or shrinks
+CTOOLBOX_API const void* soarray_const_column(const soarray* array, size_t column);
+
+/// @brief writable access to a column's field of the row, NULL if out of bounds
+CTOOLBOX_API void* soarray_peek(soarray* array, size_t column, size_t index);
+
+/// @brief access to a column's field of the row, NULL if out of bounds
+CTOOLBOX_API const void* soarray_const_peek(const soarray* array, size_t column, size_t index);
+
+/// @brief returns the number of columns
+CTOOLBOX_API size_t soarray_column_count(const soarray* array);
+
+/// @brief returns the element size of a column, 0 if out of bounds
+CTOOLBOX_API size_t soarray_column_size(const soarray* array, size_t column);
+
+/// @brief resizes every column to newSize rows, new rows are uninitialized
+CTOOLBOX_API ctoolbox_result soarray_resize(soarray* array, size_t newSize);
+
+/// @brief reserves room for newCapacity rows in every column with a single allocation
+CTOOLBOX_API ctoolbox_result soarray_reserve(soarray* array, size_t newCapacity);
+
+/// @brief reallocates the columns into the smallest block holding the rows
+CTOOLBOX_API ctoolbox_result soarray_shrink_to_fit(soarray* array);
+
+/// @brief returns the number of rows
+CTOOLBOX_API size_t soarray_size(const soarray* array);
+
+/// @brief returns how many rows the columns hold before growing
+CTOOLBOX_API size_t soarray_capacity(const soarray* array);
+
+/// @brief returns whether the container holds no row
+CTOOLBOX_API bool soarray_empty(const soarray* array);
+
+/// @brief returns the memory the container allocated, its header included
+CTOOLBOX_API ctoolbox_result soarray_memory_usage(const soarray* array, ctoolbox_memstats* statsOut);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SOARRAY_INCLUDED
@@ -0,0 +1,424 @@
+#include "tcache.h"
+#include "cthread.h"
+
+#include <string.h>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// internal
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// how many caches a thread remembers at once, the least recently looked up one is forgotten first
+#define TCACHE_THREAD_SLOTS 4
+
+// cached blocks are chained through their first bytes
+typedef struct tcache_bin
+{
+    void* head;
+    size_t count;
+} tcache_bin;
+
+// blocks cached by a single thread, each thread owns at most one local per cache and gives it back on exit
+typedef struct tcache_local
+{
+    struct tcache_local* next;
+    uint64_t owner;                         // id of the owning thread, 0 once free for another thread to take
+    tcache_bin bins[TCACHE_CLASS_COUNT];
+} tcache_local;
+
+struct tcache
+{
+    uint64_t id;
+    cthread_mutex lock;                     // guards shared, locals and their owners
+    tcache_bin shared[TCACHE_CLASS_COUNT];
+    tcache_local* locals;                   // every local ever made, looked up by owner
+    struct tcache* prev;                    // live caches, for the threads to reach on exit
+    struct tcache* next;
+    ctoolbox_memfuncs memfuncs;
+};
+
+typedef struct tcache_slot
+{
+    uint64_t id;
+    tcache_local* local;
+} tcache_slot;
+
+// ids are never reused, so a slot left behind by a destroyed cache can't match a new one living at the same address
+static volatile uint64_t tcache_next_id = 0;
+static volatile uint64_t tcache_next_thread = 0;
+static CTHREAD_LOCAL tcache_slot tcache_slots[TCACHE_THREAD_SLOTS];
+static CTHREAD_LOCAL size_t tcache_slot_victim = 0;
+static CTHREAD_LOCAL uint64_t tcache_thread = 0;
+
+// live caches, taken before any cache lock
+static cthread_mutex tcache_registry_lock = CTHREAD_MUTEX_INITIALIZER;
+static tcache* tcache_registry = NULL;
+static cthread_key tcache_exit_key;
+static bool tcache_exit_key_ready = false;
+
+static inline size_t tcache_class_index(size_t size)
+{
+    size_t index = 0;
+    size_t classSize = 16;
+    while (classSize < size) {
+        classSize <<= 1;
+        index++;
+    }
+    return index;
+}
+
+static inline size_t tcache_class_size(size_t classIndex)
+{
+    return (size_t)16 << classIndex;
+}
+
+// detaches up to count blocks from the front of the bin, returning the chain and its last block
+static void* tcache_bin_take(tcache_bin* bin, size_t count, void** lastOut, size_t* takenOut)
+{
+    void* head = bin->head;
+    void* last = NULL;
+    size_t taken = 0;
+
+    for (void* block = head; block && taken < count; block = *(void**)block) {
+        last = block;
+        taken++;
+    }
+
+    if (last) {
+        bin->head = *(void**)last;
+        *(void**)last = NULL;
+    }
+    bin->count -= taken;
+    *lastOut = last;
+    *takenOut = taken;
+    return taken ? head : NULL;
+}
+
+// prepends a chain of count blocks ending at last to the bin
+static inline void tcache_bin_put(tcache_bin* bin, void* head, void* last, size_t count)
+{
+    *(void**)last = bin->head;
+    bin->head = head;
+    bin->count += count;
+}
+
+static void tcache_bin_release(tcache* cache, tcache_bin* bin, size_t classIndex)
+{
+    void* block = bin->head;
+    while (block) {
+        void* next = *(void**)block;
+        ctoolbox_custom_free_sized(&cache->memfuncs, block, tcache_class_size(classIndex));
+        block = next;
+    }
+    bin->head = NULL;
+    bin->count = 0;
+}
+
+// moves the count least recently freed blocks to the shared pool, whatever doesn't fit goes back to the memory functions
+static void tcache_return(tcache* cache, tcache_bin* bin, size_t classIndex, size_t count)
+{
+    // the most recently freed blocks stay, they are the ones still warm in this core's cache
+    tcache_bin cold = *bin;
+    void* last = NULL;
+    size_t kept = 0;
+    bin->head = tcache_bin_take(&cold, bin->count - count, &last, &kept);
+    bin->count = kept;
+    if (!cold.head) return;
+
+    cthread_mutex_lock(&cache->lock);
+    tcache_bin* shared = &cache->shared[classIndex];
+    size_t room = shared->count < TCACHE_SHARED_CAPACITY ? TCACHE_SHARED_CAPACITY - shared->count : 0;
+
+    size_t moved = 0;
+    void* head = tcache_bin_take(&cold, room, &last, &moved);
+    if (head) tcache_bin_put(shared, head, last, moved);
+    cthread_mutex_unlock(&cache->lock);
+
+    tcache_bin_release(cache, &cold, classIndex);
+}
+
+// grabs a batch of blocks from the shared pool into the thread bin
+static void tcache_refill(tcache* cache, tcache_bin* bin, size_t classIndex)
+{
+    void* last = NULL;
+    size_t taken = 0;
+
+    cthread_mutex_lock(&cache->lock);
+    void* head = tcache_bin_take(&cache->shared[classIndex], TCACHE_BIN_CAPACITY / 2, &last, &taken);
+    cthread_mutex_unlock(&cache->lock);
+
+    if (head) tcache_bin_put(bin, head, last, taken);
+}
+
+// moves every block of the local to the shared pool
+static void tcache_local_flush(tcache* cache, tcache_local* local)
+{
+    for (size_t i = 0; i < TCACHE_CLASS_COUNT; i++) {
+        tcache_return(cache, &local->bins[i], i, local->bins[i].count);
+    }
+}
+
+// flushes the local a forgotten slot points to, unless its cache was destroyed in the meantime
+static void tcache_slot_flush(const tcache_slot* slot)
+{
+    cthread_mutex_lock(&tcache_registry_lock);
+    for (tcache* cache = tcache_registry; cache; cache = cache->next) {
+        if (cache->id == slot->id) {
+            tcache_local_flush(cache, slot->local);
+            break;
+        }
+    }
+    cthread_mutex_unlock(&tcache_registry_lock);
+}
+
+// an exiting thread hands its blocks to the shared pools and its locals to the next threads
+static void CTHREAD_CALLBACK tcache_thread_exit(void* value)
+{
+    uint64_t thread = *(const uint64_t*)value;
+
+    // a free called later on during the exit starts over with a new id instead of using a released local
+    for (size_t i = 0; i < TCACHE_THREAD_SLOTS; i++) tcache_slots[i].id = 0;
+    tcache_thread = 0;
+
+    cthread_mutex_lock(&tcache_registry_lock);
+    for (tcache* cache = tcache_registry; cache; cache = cache->next) {
+        cthread_mutex_lock(&cache->lock);
+        tcache_local* local = cache->locals;
+        while (local && local->owner != thread) local = local->next;
+        cthread_mutex_unlock(&cache->lock);
+        if (!local) continue;
+
+        tcache_local_flush(cache, local);
+
+        cthread_mutex_lock(&cache->lock);
+        local->owner = 0;
+        cthread_mutex_unlock(&cache->lock);
+    }
+    cthread_mutex_unlock(&tcache_registry_lock);
+}
+
+// the calling thread's id, the first call registers it to be released on exit
+static uint64_t tcache_thread_id(void)
+{
+    if (tcache_thread == 0) {
+        tcache_thread = cthread_atomic_increment(&tcache_next_thread);
+        cthread_key_set(tcache_exit_key, &tcache_thread);
+    }
+    return tcache_thread;
+}
+
+// the thread slots remember the last caches used, the others are looked up among the cache locals by owner
+static tcache_local* tcache_local_get(tcache* cache)
+{
+    for (size_t i = 0; i < TCACHE_THREAD_SLOTS; i++) {
+        if (tcache_slots[i].id == cache->id) return tcache_slots[i].local;
+    }
+
+    uint64_t thread = tcache_thread_id();
+    tcache_local* local = NULL;
+    tcache_local* idle = NULL;
+
+    cthread_mutex_lock(&cache->lock);
+    for (tcache_local* it = cache->locals; it && !local; it = it->next) {
+        if (it->owner == thread) local = it;
+        else if (!idle && it->owner == 0) idle = it;
+    }
+    if (!local) local = idle;
+    if (local) local->owner = thread;
+    cthread_mutex_unlock(&cache->lock);
+
+    if (!local) {
+        local = ctoolbox_custom_calloc(&cache->memfuncs, 1, sizeof(tcache_local));
+        if (!local) return NULL;
+
+        local->owner = thread;
+        cthread_mutex_lock(&cache->lock);
+        local->next = cache->locals;
+        cache->locals = local;
+        cthread_mutex_unlock(&cache->lock);
+    }
+
+    // the forgotten local stays with this thread, but its blocks go where the other threads can use them
+    tcache_slot* slot = &tcache_slots[tcache_slot_victim];
+    tcache_slot_victim = (tcache_slot_victim + 1) % TCACHE_THREAD_SLOTS;
+    if (slot->id != 0) tcache_slot_flush(slot);
+
+    slot->id = cache->id;
+    slot->local = local;
+    return local;
+}
+
+static void* tcache_ctx_alloc(void* user, size_t size, size_t alignment)
+{
+    // blocks are only 16 bytes aligned
+    if (alignment > 16) return NULL;
+    return tcache_alloc((tcache*)user, size);
+}
+
+static void* tcache_ctx_realloc(void* user, void* ptr, size_t oldSize, size_t newSize, size_t alignment)
+{
+    // the size class of a block can't be told without its size
+    if (ptr && oldSize == 0) return NULL;
+
+    // staying in the same size class keeps the block where it is
+    if (ptr && oldSize <= TCACHE_MAX_BLOCK_SIZE && newSize <= TCACHE_MAX_BLOCK_SIZE && tcache_class_index(oldSize) == tcache_class_index(newSize)) {
+        return ptr;
+    }
+
+    tcache* cache = (tcache*)user;
+    if (ptr && oldSize > TCACHE_MAX_BLOCK_SIZE && newSize > TCACHE_MAX_BLOCK_SIZE) {
+        return ctoolbox_custom_realloc_sized(&cache->memfuncs, ptr, oldSize, newSize);
+    }
+
+    void* newPtr = tcache_ctx_alloc(user, newSize, alignment);
+    if (!newPtr) return NULL;
+
+    if (ptr) {
+        memcpy(newPtr, ptr, oldSize < newSize ? oldSize : newSize);
+        tcache_free(cache, ptr, oldSize);
+    }
+    return newPtr;
+}
+
+static void tcache_ctx_free(void* user, void* ptr, size_t size)
+{
+    tcache_free((tcache*)user, ptr, size);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// external
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+CTOOLBOX_API tcache* tcache_init()
+{
+    return tcache_init_memfuncs(&CTOOLBOX_DEFAULT_MEMFUNCS);
+}
+
+CTOOLBOX_API tcache* tcache_init_memfuncs(const ctoolbox_memfuncs* memfuncs)
+{
+    tcache* outCache = ctoolbox_custom_malloc(memfuncs ? memfuncs : &CTOOLBOX_DEFAULT_MEMFUNCS, sizeof(tcache));
+    if (!outCache) return NULL;
+
+    memset(outCache, 0, sizeof(tcache));
+    outCache->id = cthread_atomic_increment(&tcache_next_id);
+
+    if (memfuncs) outCache->memfuncs = *memfuncs;
+    else outCache->memfuncs = CTOOLBOX_DEFAULT_MEMFUNCS;
+
+    cthread_mutex_lock(&tcache_registry_lock);
+    if (!tcache_exit_key_ready) tcache_exit_key_ready = cthread_key_create(&tcache_exit_key, tcache_thread_exit);
+    if (!tcache_exit_key_ready) {
+        cthread_mutex_unlock(&tcache_registry_lock);
+        ctoolbox_custom_free_sized(&outCache->memfuncs, outCache, sizeof(tcache));
+        return NULL;
+    }
+
+    cthread_mutex_init(&outCache->lock);
+    outCache->next = tcache_registry;
+    if (tcache_registry) tcache_registry->prev = outCache;
+    tcache_registry = outCache;
+    cthread_mutex_unlock(&tcache_registry_lock);
+
+    return outCache;
+}
+
+CTOOLBOX_API void tcache_destroy(tcache* cache)
+{
+    if (!cache) return;
+
+    // exiting threads can't reach the cache anymore once it is off the registry
+    cthread_mutex_lock(&tcache_registry_lock);
+    if (cache->prev) cache->prev->next = cache->next;
+    else tcache_registry = cache->next;
+    if (cache->next) cache->next->prev = cache->prev;
+    cthread_mutex_unlock(&tcache_registry_lock);
+
+    tcache_local* local = cache->locals;
+    while (local) {
+        tcache_local* next = local->next;
+        for (size_t i = 0; i < TCACHE_CLASS_COUNT; i++) {
+            tcache_bin_release(cache, &local->bins[i], i);
+        }
+        ctoolbox_custom_free_sized(&cache->memfuncs, local, sizeof(tcache_local));
+        local = next;
+    }
+
+    for (size_t i = 0; i < TCACHE_CLASS_COUNT; i++) {
+        tcache_bin_release(cache, &cache->shared[i], i);
+    }
+
+    // forget the calling thread's slot, other threads' slots simply never match again
+    for (size_t i = 0; i < TCACHE_THREAD_SLOTS; i++) {
+        if (tcache_slots[i].id == cache->id) tcache_slots[i].id = 0;
+    }
+
+    cthread_mutex_destroy(&cache->lock);
+    ctoolbox_custom_free_sized(&cache->memfuncs, cache, sizeof(tcache));
+}
+
+CTOOLBOX_API void* tcache_alloc(tcache* cache, size_t size)
+{
+    if (!cache) return NULL;
+    if (size > TCACHE_MAX_BLOCK_SIZE) return ctoolbox_custom_malloc(&cache->memfuncs, size);
+
+    size_t classIndex = tcache_class_index(size);
+    tcache_local* local = tcache_local_get(cache);
+
+    if (local) {
+        tcache_bin* bin = &local->bins[classIndex];
+        if (!bin->head) tcache_refill(cache, bin, classIndex);
+
+        if (bin->head) {
+            void* block = bin->head;
+            bin->head = *(void**)block;
+            bin->count--;
+            return block;
+        }
+    }
+
+    return ctoolbox_custom_malloc(&cache->memfuncs, tcache_class_size(classIndex));
+}
+
+CTOOLBOX_API void tcache_free(tcache* cache, void* ptr, size_t size)
+{
+    if (!cache || !ptr) return;
+    if (size > TCACHE_MAX_BLOCK_SIZE) {
+        ctoolbox_custom_free_sized(&cache->memfuncs, ptr, size);
+        return;
+    }
+
+    size_t classIndex = tcache_class_index(size);
+    tcache_local* local = tcache_local_get(cache);
+    if (!local) {
+        ctoolbox_custom_free_sized(&cache->memfuncs, ptr, tcache_class_size(classIndex));
+        return;
+    }
+
+    tcache_bin* bin = &local->bins[classIndex];
+    *(void**)ptr = bin->head;
+    bin->head = ptr;
+    bin->count++;
+
+    if (bin->count > TCACHE_BIN_CAPACITY) tcache_return(cache, bin, classIndex, bin->count / 2);
+}
+
+CTOOLBOX_API void tcache_flush(tcache* cache)
+{
+    if (!cache) return;
+
+    for (size_t i = 0; i < TCACHE_THREAD_SLOTS; i++) {
+        if (tcache_slots[i].id != cache->id) continue;
+
+        tcache_local_flush(cache, tcache_slots[i].local);
+        return;
+    }
+}
+
+CTOOLBOX_API ctoolbox_memfuncs tcache_memfuncs(tcache* cache)
+{
+    ctoolbox_memfuncs memfuncs = { 0 };
+    memfuncs.alloc_ctx_fn = tcache_ctx_alloc;
+    memfuncs.realloc_ctx_fn = tcache_ctx_realloc;
+    memfuncs.free_ctx_fn = tcache_ctx_free;
+    memfuncs.user = cache;
+    return memfuncs;
+}
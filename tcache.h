@@ -0,0 +1,57 @@
+#ifndef TCACHE_INCLUDED
+#define TCACHE_INCLUDED
+
+#include "context.h"
+
+/// @brief blocks each thread keeps per size class, half of them go back to the shared pool when it overflows
+#ifndef TCACHE_BIN_CAPACITY
+    #define TCACHE_BIN_CAPACITY 64
+#endif
+
+/// @brief blocks the shared pool keeps per size class, the rest go back to the memory functions
+#ifndef TCACHE_SHARED_CAPACITY
+    #define TCACHE_SHARED_CAPACITY 1024
+#endif
+
+/// @brief power of two size classes from 16 bytes up to TCACHE_MAX_BLOCK_SIZE, bigger blocks are not cached
+#define TCACHE_CLASS_COUNT 8
+#define TCACHE_MAX_BLOCK_SIZE 2048
+
+/// @brief opaque thread caching allocator structure
+typedef struct tcache tcache;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// functions
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// @brief creates the thread caching allocator
+CTOOLBOX_API tcache* tcache_init();
+
+/// @brief creates the thread caching allocator on top of custom memory allocation functions, which must be thread-safe
+CTOOLBOX_API tcache* tcache_init_memfuncs(const ctoolbox_memfuncs* memfuncs);
+
+/// @brief destroys the allocator and every cached block, no thread may be using it anymore
+CTOOLBOX_API void tcache_destroy(tcache* cache);
+
+/// @brief allocates a block from the calling thread's cache, may be called from any thread
+CTOOLBOX_API void* tcache_alloc(tcache* cache, size_t size);
+
+/// @brief returns a block to the calling thread's cache, size must be the one it was allocated with
+CTOOLBOX_API void tcache_free(tcache* cache, void* ptr, size_t size);
+
+/// @brief moves the calling thread's cached blocks to the shared pool, exiting threads do it on their own
+CTOOLBOX_API void tcache_flush(tcache* cache);
+
+/// @brief returns memory functions that allocate through the cache, to be used with the *_init_memfuncs calls
+/// @brief blocks are 16 bytes aligned and every free and realloc must carry the block size, as the library containers do
+CTOOLBOX_API ctoolbox_memfuncs tcache_memfuncs(tcache* cache);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TCACHE_INCLUDED
@@ -0,0 +1,16 @@
+#ifndef CTOOLBOX_TEST_INCLUDED
+#define CTOOLBOX_TEST_INCLUDED
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/// @brief fails the test with the expression and its location when it doesn't hold, unlike assert it stays in release builds
+#define TEST_CHECK(expr)                                                                        \
+    do {                                                                                        \
+        if (!(expr)) {                                                                          \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #expr);            \
+            exit(EXIT_FAILURE);                                                                 \
+        }                                                                                       \
+    } while (0)
+
+#endif // CTOOLBOX_TEST_INCLUDED
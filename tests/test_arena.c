@@ -0,0 +1,153 @@
+#include "test.h"
+#include "arena.h"
+#include "darray.h"
+
+#include <string.h>
+
+static size_t liveChunks = 0;
+
+// plain callbacks counting what the arena holds from them
+static void* counting_malloc(size_t size)
+{
+    liveChunks++;
+    return malloc(size);
+}
+
+static void counting_free(void* ptr)
+{
+    if (ptr) liveChunks--;
+    free(ptr);
+}
+
+static void test_alignment(void)
+{
+    arena* a = arena_init(0);
+    TEST_CHECK(a);
+    TEST_CHECK(arena_reserved(a) == ARENA_CHUNK_SIZE && arena_used(a) == 0);
+
+    // each block starts on its alignment whatever came before it
+    static const size_t alignments[] = { 1, 2, 8, 16, 64, 256, 4096 };
+    for (size_t i = 0; i < sizeof(alignments) / sizeof(alignments[0]); i++) {
+        char* odd = arena_alloc(a, 3, 1);
+        char* block = arena_alloc(a, 10, alignments[i]);
+        TEST_CHECK(odd && block && ((uintptr_t)block & (alignments[i] - 1)) == 0);
+        TEST_CHECK(block >= odd + 3);
+    }
+    void* plain = arena_alloc(a, 5, 0);
+    TEST_CHECK(plain && ((uintptr_t)plain & (CTOOLBOX_DEFAULT_ALIGNMENT - 1)) == 0);
+    TEST_CHECK(arena_alloc(a, 5, 24) == NULL);
+    TEST_CHECK(arena_alloc(NULL, 5, 0) == NULL);
+
+    unsigned char* zeroed = arena_calloc(a, 100, 4);
+    TEST_CHECK(zeroed);
+    for (size_t i = 0; i < 400; i++) TEST_CHECK(zeroed[i] == 0);
+    TEST_CHECK(arena_calloc(a, SIZE_MAX / 2, 4) == NULL);
+
+    arena_destroy(a);
+}
+
+static void test_chunks(void)
+{
+    ctoolbox_memfuncs counting = { 0 };
+    counting.malloc_fn = counting_malloc;
+    counting.free_fn = counting_free;
+    arena* a = arena_init_memfuncs(1024, &counting);
+    TEST_CHECK(a && arena_reserved(a) == 1024);
+
+    // blocks that no longer fit open a new chunk, the older ones stay untouched
+    unsigned char* blocks[40];
+    for (size_t i = 0; i < 40; i++) {
+        blocks[i] = arena_alloc(a, 100, 1);
+        TEST_CHECK(blocks[i]);
+        memset(blocks[i], (int)i, 100);
+    }
+    TEST_CHECK(arena_reserved(a) == 4 * 1024);
+    TEST_CHECK(arena_used(a) == 40 * 100);
+    for (size_t i = 0; i < 40; i++) {
+        for (size_t j = 0; j < 100; j++) TEST_CHECK(blocks[i][j] == (unsigned char)i);
+    }
+
+    // a block bigger than a chunk gets a chunk of its own
+    unsigned char* big = arena_alloc(a, 5000, 64);
+    TEST_CHECK(big && ((uintptr_t)big & 63) == 0);
+    memset(big, 0xee, 5000);
+    TEST_CHECK(arena_reserved(a) >= 4 * 1024 + 5000);
+
+    // mark before a run of chunks, rolling back gives every chunk opened since back to the memory functions
+    size_t reserved = arena_reserved(a);
+    size_t used = arena_used(a);
+    size_t chunks = liveChunks;
+    arena_marker marker = arena_mark(a);
+    for (size_t i = 0; i < 30; i++) TEST_CHECK(arena_alloc(a, 600, 1));
+    TEST_CHECK(arena_reserved(a) > reserved && liveChunks > chunks);
+
+    arena_rollback(a, marker);
+    TEST_CHECK(arena_reserved(a) == reserved && arena_used(a) == used && liveChunks == chunks);
+    for (size_t j = 0; j < 5000; j++) TEST_CHECK(big[j] == 0xee);
+
+    // a marker inside the current chunk only moves its offset back
+    marker = arena_mark(a);
+    void* again = arena_alloc(a, 8, 1);
+    arena_rollback(a, marker);
+    TEST_CHECK(arena_alloc(a, 8, 1) == again);
+
+    // reset keeps the first chunk alone and starts over from its beginning
+    arena_reset(a);
+    TEST_CHECK(arena_reserved(a) == 1024 && arena_used(a) == 0 && liveChunks == 2);
+    TEST_CHECK(arena_alloc(a, 100, 1) == blocks[0]);
+
+    arena_destroy(a);
+    TEST_CHECK(liveChunks == 0);
+}
+
+static void test_memfuncs(void)
+{
+    arena* a = arena_init(4096);
+    TEST_CHECK(a);
+    ctoolbox_memfuncs mem = arena_memfuncs(a);
+
+    // the last block grows and shrinks in place, any other one moves with its content
+    unsigned char* last = ctoolbox_custom_malloc(&mem, 64);
+    TEST_CHECK(last);
+    memset(last, 7, 64);
+    TEST_CHECK(ctoolbox_custom_realloc_sized(&mem, last, 64, 1000) == last);
+    TEST_CHECK(arena_used(a) == 1000);
+    TEST_CHECK(ctoolbox_custom_realloc_sized(&mem, last, 1000, 200) == last);
+    TEST_CHECK(arena_used(a) == 200);
+
+    unsigned char* other = ctoolbox_custom_calloc(&mem, 10, 10);
+    TEST_CHECK(other && other[99] == 0);
+    unsigned char* moved = ctoolbox_custom_realloc_sized(&mem, last, 200, 300);
+    TEST_CHECK(moved && moved != last);
+    for (size_t i = 0; i < 64; i++) TEST_CHECK(moved[i] == 7);
+
+    // without the old size the arena can't tell how much to copy and refuses
+    TEST_CHECK(ctoolbox_custom_realloc(&mem, moved, 400) == NULL);
+
+    // frees give nothing back until the arena is reset
+    size_t used = arena_used(a);
+    ctoolbox_custom_free(&mem, moved);
+    ctoolbox_custom_free(&mem, other);
+    TEST_CHECK(arena_used(a) == used);
+
+    // a container living in the arena, released with it instead of one block at a time
+    darray* array = darray_init_memfuncs(sizeof(uint32_t), 1, &mem);
+    TEST_CHECK(array);
+    for (uint32_t i = 0; i < 5000; i++) TEST_CHECK(darray_push_back(array, &i) == CTOOLBOX_SUCCESS);
+    for (uint32_t i = 0; i < 5000; i++) TEST_CHECK(*(const uint32_t*)darray_const_peek(array, i) == i);
+    TEST_CHECK(darray_shrink_to_fit(array) == CTOOLBOX_SUCCESS);
+    TEST_CHECK(arena_used(a) >= used + 5000 * sizeof(uint32_t));
+    darray_destroy(array);
+
+    arena_reset(a);
+    TEST_CHECK(arena_used(a) == 0 && arena_reserved(a) == 4096);
+    arena_destroy(a);
+}
+
+int main(void)
+{
+    test_alignment();
+    test_chunks();
+    test_memfuncs();
+    return EXIT_SUCCESS;
+}
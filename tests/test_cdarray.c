@@ -0,0 +1,158 @@
+#include "test.h"
+#include "cdarray.h"
+#include "cthread.h"
+
+#include <string.h>
+
+// hands out allocations until its budget runs out
+typedef struct failing_allocator
+{
+    size_t budget;
+} failing_allocator;
+
+static void* failing_alloc(void* user, size_t size, size_t alignment)
+{
+    (void)alignment;
+    failing_allocator* allocator = user;
+    if (allocator->budget == 0) return NULL;
+    allocator->budget--;
+    return malloc(size);
+}
+
+static void failing_free(void* user, void* ptr, size_t size)
+{
+    (void)user;
+    (void)size;
+    free(ptr);
+}
+
+static void test_claim_failure(void)
+{
+    // the header and the first segment, nothing more
+    failing_allocator allocator = { 2 };
+    ctoolbox_memfuncs mem = { 0 };
+    mem.alloc_ctx_fn = failing_alloc;
+    mem.free_ctx_fn = failing_free;
+    mem.user = &allocator;
+
+    cdarray* array = cdarray_init_memfuncs(sizeof(uint32_t), &mem);
+    TEST_CHECK(array);
+
+    const uint32_t first = 1u << CDARRAY_FIRST_SEGMENT_SHIFT;
+    for (uint32_t i = 0; i < first; i++) TEST_CHECK(cdarray_push_back(array, &i, NULL) == CTOOLBOX_SUCCESS);
+
+    // the second segment can't be allocated, it is given up and the published prefix steps over its slots
+    const uint32_t second = 2 * first;
+    uint32_t value = first;
+    size_t index = 0;
+    TEST_CHECK(cdarray_push_back(array, &value, NULL) == CTOOLBOX_ERROR_MEMORY_ALLOC);
+    TEST_CHECK(cdarray_committed(array) == first + 1);
+    TEST_CHECK(cdarray_get(array, first, &value) == CTOOLBOX_ERROR_NOT_FOUND);
+
+    // with memory back, the next append skips the rest of the given up segment and lands in the third one
+    allocator.budget = 1;
+    value = 7;
+    TEST_CHECK(cdarray_push_back(array, &value, &index) == CTOOLBOX_SUCCESS);
+    TEST_CHECK(index == first + second);
+    TEST_CHECK(cdarray_size(array) == first + second + 1);
+    TEST_CHECK(cdarray_committed(array) == first + second + 1);
+    TEST_CHECK(cdarray_get(array, index, &value) == CTOOLBOX_SUCCESS && value == 7);
+    for (uint32_t i = 0; i < first; i++) {
+        TEST_CHECK(cdarray_get(array, i, &value) == CTOOLBOX_SUCCESS);
+        TEST_CHECK(value == i);
+    }
+    for (uint32_t i = first; i < first + second; i++) TEST_CHECK(cdarray_const_peek(array, i) == NULL);
+
+    // an index past what the array can address is ignored
+    cdarray_commit(array, SIZE_MAX);
+    TEST_CHECK(cdarray_const_peek(array, SIZE_MAX) == NULL);
+
+    cdarray_destroy(array);
+}
+
+static void test_claim_commit(void)
+{
+    cdarray* array = cdarray_init(sizeof(uint64_t));
+    TEST_CHECK(array);
+
+    // slots published out of order only extend the prefix once the gap is filled
+    size_t a, b;
+    uint64_t* slotA = cdarray_claim(array, &a);
+    uint64_t* slotB = cdarray_claim(array, &b);
+    TEST_CHECK(slotA && slotB && a == 0 && b == 1);
+    *slotB = 22;
+    cdarray_commit(array, b);
+
+    uint64_t value = 0;
+    TEST_CHECK(cdarray_committed(array) == 0);
+    TEST_CHECK(cdarray_get(array, a, &value) == CTOOLBOX_ERROR_NOT_FOUND);
+    TEST_CHECK(cdarray_const_peek(array, a) == NULL);
+    TEST_CHECK(cdarray_get(array, b, &value) == CTOOLBOX_SUCCESS && value == 22);
+
+    *slotA = 11;
+    cdarray_commit(array, a);
+    TEST_CHECK(cdarray_committed(array) == 2);
+    TEST_CHECK(*(const uint64_t*)cdarray_const_peek(array, a) == 11);
+    TEST_CHECK(cdarray_get(array, 2, &value) == CTOOLBOX_ERROR_NOT_FOUND);
+
+    cdarray_destroy(array);
+}
+
+enum { APPEND_THREADS = 4, APPENDS = 20000 };
+
+static void append_main(void* arg)
+{
+    cdarray* array = ((void**)arg)[0];
+    uint64_t thread = (uint64_t)(uintptr_t)((void**)arg)[1];
+    for (uint64_t i = 0; i < APPENDS; i++) {
+        uint64_t value = thread << 32 | i;
+        TEST_CHECK(cdarray_push_back(array, &value, NULL) == CTOOLBOX_SUCCESS);
+        TEST_CHECK(cdarray_committed(array) <= cdarray_size(array));
+    }
+}
+
+static void test_concurrent(void)
+{
+    ctoolbox_tracker tracker;
+    ctoolbox_tracker_init(&tracker, NULL);
+    ctoolbox_memfuncs mem = ctoolbox_tracker_memfuncs(&tracker);
+    cdarray* array = cdarray_init_memfuncs(sizeof(uint64_t), &mem);
+    TEST_CHECK(array);
+
+    cthread_thread threads[APPEND_THREADS];
+    void* args[APPEND_THREADS][2];
+    for (size_t i = 0; i < APPEND_THREADS; i++) {
+        args[i][0] = array;
+        args[i][1] = (void*)(uintptr_t)i;
+        TEST_CHECK(cthread_create(&threads[i], append_main, args[i]));
+    }
+    for (size_t i = 0; i < APPEND_THREADS; i++) cthread_join(&threads[i]);
+
+    // every append is published once, each thread's own appends in the order it made them
+    TEST_CHECK(cdarray_size(array) == APPEND_THREADS * APPENDS);
+    TEST_CHECK(cdarray_committed(array) == APPEND_THREADS * APPENDS);
+
+    uint64_t next[APPEND_THREADS] = { 0 };
+    for (size_t i = 0; i < APPEND_THREADS * APPENDS; i++) {
+        uint64_t value;
+        TEST_CHECK(cdarray_get(array, i, &value) == CTOOLBOX_SUCCESS);
+        size_t thread = (size_t)(value >> 32);
+        TEST_CHECK(thread < APPEND_THREADS);
+        TEST_CHECK((value & 0xffffffffu) == next[thread]);
+        next[thread]++;
+    }
+
+    ctoolbox_memstats stats;
+    TEST_CHECK(cdarray_memory_usage(array, &stats) == CTOOLBOX_SUCCESS);
+    TEST_CHECK(stats.liveBytes == tracker.stats.liveBytes);
+    cdarray_destroy(array);
+    TEST_CHECK(tracker.stats.liveBytes == 0);
+}
+
+int main(void)
+{
+    test_claim_failure();
+    test_claim_commit();
+    test_concurrent();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,381 @@
+#include "test.h"
+#include "darray.h"
+#include "idgen.h"
+#include "segarray.h"
+#include "deque.h"
+#include "soarray.h"
+#include "shashtable.h"
+#include "slab.h"
+
+#include <string.h>
+#include <stdio.h>
+
+#if defined(_WIN32) || defined(_WIN64)
+    #include <malloc.h>
+#endif
+
+static size_t plainBlocks = 0;
+
+// plain callbacks that aren't the C library ones, aligned requests are over-allocated on top of them
+static void* counting_malloc(size_t size)
+{
+    plainBlocks++;
+    return malloc(size);
+}
+
+static void counting_free(void* ptr)
+{
+    if (ptr) plainBlocks--;
+    free(ptr);
+}
+
+static size_t alignedBlocks = 0;
+
+static void* counting_aligned_malloc(size_t size, size_t alignment)
+{
+    void* ptr = NULL;
+    size_t actual = alignment < sizeof(void*) ? sizeof(void*) : alignment;
+#if defined(_WIN32) || defined(_WIN64)
+    ptr = _aligned_malloc(size, actual);
+#else
+    if (posix_memalign(&ptr, actual, size) != 0) ptr = NULL;
+#endif
+    if (ptr) alignedBlocks++;
+    return ptr;
+}
+
+static void counting_aligned_free(void* ptr)
+{
+    if (!ptr) return;
+    alignedBlocks--;
+#if defined(_WIN32) || defined(_WIN64)
+    _aligned_free(ptr);
+#else
+    free(ptr);
+#endif
+}
+
+// records the strictest alignment asked through the context-carrying callbacks
+typedef struct alignment_recorder
+{
+    size_t strictest;
+} alignment_recorder;
+
+static void* recording_alloc(void* user, size_t size, size_t alignment)
+{
+    alignment_recorder* recorder = user;
+    if (alignment > recorder->strictest) recorder->strictest = alignment;
+    return counting_aligned_malloc(size, alignment);
+}
+
+static void recording_free(void* user, void* ptr, size_t size)
+{
+    (void)user;
+    (void)size;
+    counting_aligned_free(ptr);
+}
+
+static void check_aligned_blocks(const ctoolbox_memfuncs* mem)
+{
+    static const size_t alignments[] = { 8, 16, 64, 256, 4096 };
+    for (size_t i = 0; i < sizeof(alignments) / sizeof(alignments[0]); i++) {
+        size_t alignment = alignments[i];
+        unsigned char* block = ctoolbox_custom_aligned_malloc(mem, 100, alignment);
+        TEST_CHECK(block && ((uintptr_t)block & (alignment - 1)) == 0);
+        for (size_t j = 0; j < 100; j++) block[j] = (unsigned char)j;
+
+        // growing keeps both the alignment and the content
+        block = ctoolbox_custom_aligned_realloc(mem, block, 100, 10000, alignment);
+        TEST_CHECK(block && ((uintptr_t)block & (alignment - 1)) == 0);
+        for (size_t j = 0; j < 100; j++) TEST_CHECK(block[j] == (unsigned char)j);
+        ctoolbox_custom_aligned_free_sized(mem, block, 10000, alignment);
+    }
+
+    TEST_CHECK(ctoolbox_custom_aligned_malloc(mem, 100, 0) == NULL);
+    TEST_CHECK(ctoolbox_custom_aligned_malloc(mem, 100, 48) == NULL);
+}
+
+static void test_aligned(void)
+{
+    check_aligned_blocks(&CTOOLBOX_DEFAULT_MEMFUNCS);
+
+    ctoolbox_memfuncs plain = { 0 };
+    plain.malloc_fn = counting_malloc;
+    plain.free_fn = counting_free;
+    check_aligned_blocks(&plain);
+    TEST_CHECK(plainBlocks == 0);
+
+    ctoolbox_memfuncs aligned = plain;
+    aligned.aligned_malloc_fn = counting_aligned_malloc;
+    aligned.aligned_free_fn = counting_aligned_free;
+    check_aligned_blocks(&aligned);
+    TEST_CHECK(alignedBlocks == 0);
+
+    // the storage stays aligned through growth, reserve and shrink_to_fit
+    darray* array = darray_init_aligned(sizeof(uint32_t), 1, 64, &plain);
+    TEST_CHECK(array && darray_alignment(array) == 64);
+    for (uint32_t i = 0; i < 1000; i++) {
+        TEST_CHECK(darray_push_back(array, &i) == CTOOLBOX_SUCCESS);
+        TEST_CHECK(((uintptr_t)darray_const_data(array) & 63) == 0);
+    }
+    TEST_CHECK(darray_reserve(array, 5000) == CTOOLBOX_SUCCESS && ((uintptr_t)darray_const_data(array) & 63) == 0);
+    TEST_CHECK(darray_resize(array, 10) == CTOOLBOX_SUCCESS && darray_shrink_to_fit(array) == CTOOLBOX_SUCCESS);
+    TEST_CHECK(((uintptr_t)darray_const_data(array) & 63) == 0);
+    for (uint32_t i = 0; i < 10; i++) TEST_CHECK(((const uint32_t*)darray_const_data(array))[i] == i);
+    darray_destroy(array);
+    TEST_CHECK(plainBlocks == 0);
+
+    TEST_CHECK(darray_init_aligned(sizeof(uint32_t), 1, 24, NULL) == NULL);
+
+    // the id bitset pages are asked with the generator's alignment
+    alignment_recorder recorder = { 0 };
+    ctoolbox_memfuncs recording = { 0 };
+    recording.alloc_ctx_fn = recording_alloc;
+    recording.free_ctx_fn = recording_free;
+    recording.user = &recorder;
+    idgen* gen = idgen_create_aligned(1, 128, &recording);
+    TEST_CHECK(gen);
+    TEST_CHECK(idgen_next(gen) == 1);
+    TEST_CHECK(recorder.strictest == 128);
+    idgen_destroy(gen);
+    TEST_CHECK(alignedBlocks == 0);
+    TEST_CHECK(idgen_create_aligned(1, 100, NULL) == NULL);
+}
+
+static void test_tracker(void)
+{
+    ctoolbox_tracker tracker;
+    ctoolbox_tracker_init(&tracker, NULL);
+    ctoolbox_memfuncs mem = ctoolbox_tracker_memfuncs(&tracker);
+
+    // every call is counted, the peak stays at the highest live figure
+    void* a = ctoolbox_custom_malloc(&mem, 100);
+    void* b = ctoolbox_custom_aligned_malloc(&mem, 300, 64);
+    TEST_CHECK(a && b && ((uintptr_t)b & 63) == 0);
+    TEST_CHECK(tracker.stats.liveBytes == 400 && tracker.stats.allocCount == 2);
+
+    a = ctoolbox_custom_realloc_sized(&mem, a, 100, 1000);
+    TEST_CHECK(a && tracker.stats.liveBytes == 1300 && tracker.stats.reallocCount == 1);
+    // the tracker keeps block sizes itself, an unsized realloc is accounted the same
+    a = ctoolbox_custom_realloc(&mem, a, 1000);
+    TEST_CHECK(a && tracker.stats.liveBytes == 1300 && tracker.stats.reallocCount == 2);
+    ctoolbox_custom_free(&mem, a);
+    TEST_CHECK(tracker.stats.liveBytes == 300 && tracker.stats.peakBytes == 1300 && tracker.stats.freeCount == 1);
+    ctoolbox_custom_aligned_free_sized(&mem, b, 300, 64);
+    TEST_CHECK(tracker.stats.liveBytes == 0 && tracker.stats.freeCount == 2);
+
+    // trackers stack, the outer one sees what the inner one forwards
+    ctoolbox_tracker outer;
+    ctoolbox_tracker_init(&outer, &mem);
+    ctoolbox_memfuncs outerMem = ctoolbox_tracker_memfuncs(&outer);
+    void* c = ctoolbox_custom_malloc(&outerMem, 50);
+    TEST_CHECK(c && outer.stats.liveBytes == 50 && tracker.stats.liveBytes >= 50);
+    ctoolbox_custom_free(&outerMem, c);
+    TEST_CHECK(outer.stats.liveBytes == 0 && tracker.stats.liveBytes == 0);
+}
+
+static void check_usage(ctoolbox_result res, const ctoolbox_memstats* stats, const ctoolbox_tracker* tracker)
+{
+    TEST_CHECK(res == CTOOLBOX_SUCCESS);
+    TEST_CHECK(stats->liveBytes == tracker->stats.liveBytes);
+}
+
+static void test_container_usage(void)
+{
+    // what each container reports matches what went through its memory functions
+    ctoolbox_tracker tracker;
+    ctoolbox_tracker_init(&tracker, NULL);
+    ctoolbox_memfuncs mem = ctoolbox_tracker_memfuncs(&tracker);
+    ctoolbox_memstats stats;
+
+    darray* array = darray_init_memfuncs(sizeof(uint32_t), 1, &mem);
+    for (uint32_t i = 0; i < 1000; i++) darray_push_back(array, &i);
+    darray_resize(array, 10);
+    darray_shrink_to_fit(array);
+    check_usage(darray_memory_usage(array, &stats), &stats, &tracker);
+    darray_destroy(array);
+    TEST_CHECK(tracker.stats.liveBytes == 0);
+
+    segarray* segments = segarray_init_memfuncs(sizeof(uint32_t), &mem);
+    for (uint32_t i = 0; i < 5000; i++) segarray_push_back(segments, &i);
+    check_usage(segarray_memory_usage(segments, &stats), &stats, &tracker);
+    segarray_destroy(segments);
+    TEST_CHECK(tracker.stats.liveBytes == 0);
+
+    deque* d = deque_init_memfuncs(sizeof(uint32_t), 2, &mem);
+    for (uint32_t i = 0; i < 1000; i++) deque_push_front(d, &i);
+    check_usage(deque_memory_usage(d, &stats), &stats, &tracker);
+    deque_destroy(d);
+    TEST_CHECK(tracker.stats.liveBytes == 0);
+
+    const size_t columns[] = { sizeof(uint32_t), sizeof(double) };
+    soarray* soa = soarray_init_memfuncs(columns, 2, 1, &mem);
+    for (uint32_t i = 0; i < 1000; i++) {
+        double value = i;
+        const void* fields[] = { &i, &value };
+        soarray_push_back(soa, fields);
+    }
+    check_usage(soarray_memory_usage(soa, &stats), &stats, &tracker);
+    soarray_destroy(soa);
+    TEST_CHECK(tracker.stats.liveBytes == 0);
+
+    // a few entries are allocated one by one, the slab only comes once they would fill a page of it
+    shashtable* table = shashtable_init_memfuncs(&mem);
+    char key[16];
+    for (int i = 0; i < 3; i++) {
+        snprintf(key, sizeof(key), "key%d", i);
+        shashtable_insert(table, key, NULL);
+    }
+    check_usage(shashtable_memory_usage(table, &stats), &stats, &tracker);
+    TEST_CHECK(stats.liveBytes < SLAB_PAGE_SIZE);
+    for (int i = 3; i < 500; i++) {
+        snprintf(key, sizeof(key), "key%d", i);
+        shashtable_insert(table, key, NULL);
+    }
+    check_usage(shashtable_memory_usage(table, &stats), &stats, &tracker);
+    shashtable_destroy(table);
+    TEST_CHECK(tracker.stats.liveBytes == 0);
+
+    idgen* gen = idgen_create_memfuncs(1, &mem);
+    for (uint32_t i = 0; i < 10000; i++) idgen_next(gen);
+    check_usage(idgen_memory_usage(gen, &stats), &stats, &tracker);
+    idgen_destroy(gen);
+    TEST_CHECK(tracker.stats.liveBytes == 0);
+
+    idgen_handles* handles = idgen_handles_create_memfuncs(4, &mem);
+    for (uint32_t i = 0; i < 1000; i++) idgen_handles_alloc(handles);
+    check_usage(idgen_handles_memory_usage(handles, &stats), &stats, &tracker);
+    idgen_handles_destroy(handles);
+    TEST_CHECK(tracker.stats.liveBytes == 0);
+}
+
+// remembers the size of each live block and checks every free and realloc is given that same size
+typedef struct size_checker
+{
+    void* blocks[4096];
+    size_t sizes[4096];
+    size_t count;
+} size_checker;
+
+static size_t size_checker_find(const size_checker* checker, const void* ptr)
+{
+    for (size_t i = 0; i < checker->count; i++) {
+        if (checker->blocks[i] == ptr) return i;
+    }
+    TEST_CHECK(!"block not allocated through the checker");
+    return 0;
+}
+
+static void* size_checker_alloc(void* user, size_t size, size_t alignment)
+{
+    size_checker* checker = user;
+    TEST_CHECK(checker->count < sizeof(checker->blocks) / sizeof(checker->blocks[0]));
+    void* ptr = counting_aligned_malloc(size ? size : 1, alignment);
+    checker->blocks[checker->count] = ptr;
+    checker->sizes[checker->count] = size;
+    checker->count++;
+    return ptr;
+}
+
+static void size_checker_free(void* user, void* ptr, size_t size)
+{
+    size_checker* checker = user;
+    size_t i = size_checker_find(checker, ptr);
+    TEST_CHECK(checker->sizes[i] == size);
+
+    checker->count--;
+    checker->blocks[i] = checker->blocks[checker->count];
+    checker->sizes[i] = checker->sizes[checker->count];
+    counting_aligned_free(ptr);
+}
+
+static void* size_checker_realloc(void* user, void* ptr, size_t oldSize, size_t newSize, size_t alignment)
+{
+    size_checker* checker = user;
+    void* newPtr = size_checker_alloc(user, newSize, alignment);
+    if (ptr) {
+        TEST_CHECK(checker->sizes[size_checker_find(checker, ptr)] == oldSize);
+        memcpy(newPtr, ptr, oldSize < newSize ? oldSize : newSize);
+        size_checker_free(user, ptr, oldSize);
+    }
+    return newPtr;
+}
+
+static int compare_u32(const void* a, const void* b)
+{
+    uint32_t x = *(const uint32_t*)a;
+    uint32_t y = *(const uint32_t*)b;
+    return (x > y) - (x < y);
+}
+
+static void test_sized_free(void)
+{
+    static size_checker checker;
+    ctoolbox_memfuncs mem = { 0 };
+    mem.alloc_ctx_fn = size_checker_alloc;
+    mem.realloc_ctx_fn = size_checker_realloc;
+    mem.free_ctx_fn = size_checker_free;
+    mem.user = &checker;
+
+    // every container hands each block back with the size it was allocated with
+    darray* array = darray_init_memfuncs(sizeof(uint32_t), 1, &mem);
+    for (uint32_t i = 0; i < 1000; i++) darray_push_back(array, &i);
+    darray_stable_sort(array, compare_u32);
+    darray_resize(array, 10);
+    darray_shrink_to_fit(array);
+    darray_destroy(array);
+
+    array = darray_init_inline(sizeof(uint32_t), 8, &mem);
+    for (uint32_t i = 0; i < 100; i++) darray_push_back(array, &i);
+    darray_destroy(array);
+
+    segarray* segments = segarray_init_memfuncs(sizeof(uint32_t), &mem);
+    for (uint32_t i = 0; i < 5000; i++) segarray_push_back(segments, &i);
+    segarray_destroy(segments);
+
+    deque* d = deque_init_memfuncs(sizeof(uint32_t), 2, &mem);
+    for (uint32_t i = 0; i < 1000; i++) deque_push_front(d, &i);
+    deque_destroy(d);
+
+    const size_t columns[] = { sizeof(uint32_t), sizeof(double) };
+    soarray* soa = soarray_init_memfuncs(columns, 2, 1, &mem);
+    for (uint32_t i = 0; i < 1000; i++) {
+        double value = i;
+        const void* fields[] = { &i, &value };
+        soarray_push_back(soa, fields);
+    }
+    soarray_destroy(soa);
+
+    shashtable* table = shashtable_init_memfuncs(&mem);
+    char key[16];
+    for (int i = 0; i < 500; i++) {
+        snprintf(key, sizeof(key), "key%d", i);
+        shashtable_insert(table, key, NULL);
+    }
+    for (int i = 0; i < 500; i += 2) {
+        snprintf(key, sizeof(key), "key%d", i);
+        shashtable_delete(table, key);
+    }
+    shashtable_destroy(table);
+
+    idgen* gen = idgen_create_memfuncs(1, &mem);
+    for (uint32_t i = 0; i < 10000; i++) idgen_next(gen);
+    idgen_reset(gen);
+    idgen_destroy(gen);
+
+    idgen_handles* handles = idgen_handles_create_memfuncs(4, &mem);
+    for (uint32_t i = 0; i < 1000; i++) idgen_handles_alloc(handles);
+    idgen_handles_destroy(handles);
+
+    TEST_CHECK(checker.count == 0);
+    TEST_CHECK(alignedBlocks == 0);
+}
+
+int main(void)
+{
+    test_aligned();
+    test_tracker();
+    test_container_usage();
+    test_sized_free();
+    return EXIT_SUCCESS;
+}
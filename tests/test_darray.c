@@ -0,0 +1,606 @@
+#include "test.h"
+#include "darray.h"
+#include "threadpool.h"
+
+#include <string.h>
+#include <stdio.h>
+
+DARRAY_DEFINE(u32, uint32_t)
+
+static void check_sequence(const darray* array, const uint32_t* expected, size_t count)
+{
+    TEST_CHECK(darray_size(array) == count);
+    for (size_t i = 0; i < count; i++) TEST_CHECK(darray_u32_at(array, i) == expected[i]);
+}
+
+static void test_bulk(void)
+{
+    const uint32_t values[] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+    darray* array = darray_u32_init(1);
+
+    TEST_CHECK(darray_append(array, values, 4) == CTOOLBOX_SUCCESS);
+    TEST_CHECK(darray_append(array, values, 0) == CTOOLBOX_SUCCESS);
+    TEST_CHECK(darray_append(array, NULL, 1) == CTOOLBOX_ERROR_INVALID_PARAM);
+    check_sequence(array, (const uint32_t[]){ 1, 2, 3, 4 }, 4);
+
+    // appending from the array itself survives the storage moving
+    TEST_CHECK(darray_shrink_to_fit(array) == CTOOLBOX_SUCCESS);
+    TEST_CHECK(darray_append(array, darray_const_data(array), 4) == CTOOLBOX_SUCCESS);
+    check_sequence(array, (const uint32_t[]){ 1, 2, 3, 4, 1, 2, 3, 4 }, 8);
+
+    TEST_CHECK(darray_insert_range(array, 2, values + 4, 3) == CTOOLBOX_SUCCESS);
+    check_sequence(array, (const uint32_t[]){ 1, 2, 5, 6, 7, 3, 4, 1, 2, 3, 4 }, 11);
+    TEST_CHECK(darray_insert_range(array, 11, values, 1) == CTOOLBOX_SUCCESS);
+    TEST_CHECK(darray_insert_range(array, 13, values, 1) == CTOOLBOX_ERROR_INVALID_PARAM);
+    check_sequence(array, (const uint32_t[]){ 1, 2, 5, 6, 7, 3, 4, 1, 2, 3, 4, 1 }, 12);
+
+    uint32_t removed[3];
+    TEST_CHECK(darray_remove_range(array, 1, 3, removed) == CTOOLBOX_SUCCESS);
+    TEST_CHECK(removed[0] == 2 && removed[1] == 5 && removed[2] == 6);
+    check_sequence(array, (const uint32_t[]){ 1, 7, 3, 4, 1, 2, 3, 4, 1 }, 9);
+    TEST_CHECK(darray_remove_range(array, 5, 5, NULL) == CTOOLBOX_ERROR_INVALID_PARAM);
+    TEST_CHECK(darray_remove_range(array, 5, 4, NULL) == CTOOLBOX_SUCCESS);
+    check_sequence(array, (const uint32_t[]){ 1, 7, 3, 4, 1 }, 5);
+
+    darray* other = darray_u32_init(4);
+    darray_append(other, values + 6, 2);
+    TEST_CHECK(darray_append_darray(array, other) == CTOOLBOX_SUCCESS);
+    check_sequence(array, (const uint32_t[]){ 1, 7, 3, 4, 1, 7, 8 }, 7);
+
+    darray* wider = darray_init(sizeof(uint64_t), 1);
+    TEST_CHECK(darray_append_darray(array, wider) == CTOOLBOX_ERROR_INVALID_PARAM);
+    darray_destroy(wider);
+    darray_destroy(other);
+    darray_destroy(array);
+}
+
+typedef struct emplace_item
+{
+    uint32_t id;
+    char name[12];
+} emplace_item;
+
+static void test_emplace(void)
+{
+    darray* array = darray_init(sizeof(emplace_item), 1);
+
+    // slots are constructed in place and stay where they were handed out until the array grows
+    for (uint32_t i = 0; i < 10; i++) {
+        emplace_item* item = darray_emplace_back(array);
+        TEST_CHECK(item);
+        item->id = i;
+        snprintf(item->name, sizeof(item->name), "item%u", (unsigned)i);
+    }
+
+    emplace_item* block = darray_emplace_back_n(array, 5);
+    TEST_CHECK(block);
+    for (uint32_t i = 0; i < 5; i++) block[i].id = 100 + i;
+    TEST_CHECK(darray_size(array) == 15);
+    TEST_CHECK(darray_emplace_back_n(array, 0) == NULL);
+
+    emplace_item* front = darray_emplace_at(array, 0);
+    TEST_CHECK(front);
+    front->id = 1000;
+    TEST_CHECK(darray_emplace_at(array, 17) == NULL);
+
+    const emplace_item* items = darray_const_data(array);
+    TEST_CHECK(darray_size(array) == 16);
+    TEST_CHECK(items[0].id == 1000 && items[1].id == 0 && strcmp(items[3].name, "item2") == 0 && items[15].id == 104);
+
+    // peek hands out writable elements
+    emplace_item* peeked = darray_peek(array, 5);
+    TEST_CHECK(peeked && peeked->id == 4);
+    peeked->id = 44;
+    TEST_CHECK(((const emplace_item*)darray_const_peek(array, 5))->id == 44);
+    TEST_CHECK(darray_peek(array, 16) == NULL && darray_const_peek(array, 16) == NULL);
+
+    emplace_item* data = darray_data(array);
+    data[15].id = 7;
+    TEST_CHECK(items == data && ((const emplace_item*)darray_const_peek(array, 15))->id == 7);
+
+    TEST_CHECK(darray_emplace_back(NULL) == NULL && darray_peek(NULL, 0) == NULL && darray_data(NULL) == NULL);
+    darray_destroy(array);
+}
+
+static size_t capacity_after_push(darray* array, size_t pushes)
+{
+    for (uint32_t i = 0; i < pushes; i++) darray_u32_push_back(array, i);
+    return darray_capacity(array);
+}
+
+static void test_growth(void)
+{
+    // doubling by default, then the factor, the linear step or whole pages
+    darray* array = darray_u32_init(1);
+    TEST_CHECK(capacity_after_push(array, 5) == 8);
+    TEST_CHECK(darray_set_growth(array, DARRAY_GROWTH_FACTOR, 150) == CTOOLBOX_SUCCESS);
+    TEST_CHECK(capacity_after_push(array, 4) == 12);
+    TEST_CHECK(darray_set_growth(array, DARRAY_GROWTH_LINEAR, 100) == CTOOLBOX_SUCCESS);
+    TEST_CHECK(capacity_after_push(array, 4) == 112);
+    TEST_CHECK(capacity_after_push(array, 200) == 312);
+    TEST_CHECK(darray_set_growth(array, DARRAY_GROWTH_PAGE, 0) == CTOOLBOX_SUCCESS);
+    size_t capacity = capacity_after_push(array, 1000);
+    TEST_CHECK(capacity >= darray_size(array) && capacity * sizeof(uint32_t) % 4096 == 0);
+    for (size_t i = 0; i < darray_size(array); i++) TEST_CHECK(darray_u32_at(array, i) == (i < 5 ? i : i < 9 ? i - 5 : i < 13 ? i - 9 : i < 213 ? i - 13 : i - 213));
+
+    TEST_CHECK(darray_set_growth(array, DARRAY_GROWTH_FACTOR, 100) == CTOOLBOX_ERROR_INVALID_PARAM);
+    TEST_CHECK(darray_set_growth(array, DARRAY_GROWTH_LINEAR, 0) == CTOOLBOX_ERROR_INVALID_PARAM);
+    TEST_CHECK(darray_set_growth(array, (darray_growth)7, 1) == CTOOLBOX_ERROR_INVALID_PARAM);
+    darray_destroy(array);
+
+    ctoolbox_tracker tracker;
+    ctoolbox_tracker_init(&tracker, NULL);
+    ctoolbox_memfuncs mem = ctoolbox_tracker_memfuncs(&tracker);
+    array = darray_init_memfuncs(sizeof(uint32_t), 1, &mem);
+
+#if defined(__linux__)
+    // past the threshold the storage leaves the memory functions for a mapping that grows in place
+    TEST_CHECK(darray_set_mapped(array, 64 * 1024) == CTOOLBOX_SUCCESS);
+    for (uint32_t i = 0; i < 1000000; i++) TEST_CHECK(darray_u32_push_back(array, i) == CTOOLBOX_SUCCESS);
+    for (uint32_t i = 0; i < 1000000; i++) TEST_CHECK(darray_u32_at(array, i) == i);
+    TEST_CHECK(tracker.stats.liveBytes < 64 * 1024);
+
+    ctoolbox_memstats stats;
+    darray_memory_usage(array, &stats);
+    TEST_CHECK(stats.liveBytes >= 1000000 * sizeof(uint32_t));
+
+    TEST_CHECK(darray_resize(array, 1000) == CTOOLBOX_SUCCESS && darray_shrink_to_fit(array) == CTOOLBOX_SUCCESS);
+    TEST_CHECK(darray_capacity(array) * sizeof(uint32_t) % 4096 == 0);
+    for (uint32_t i = 0; i < 1000; i++) TEST_CHECK(darray_u32_at(array, i) == i);
+#else
+    TEST_CHECK(darray_set_mapped(array, 64 * 1024) == CTOOLBOX_ERROR_UNSUPPORTED);
+#endif
+
+    darray_destroy(array);
+    TEST_CHECK(tracker.stats.liveBytes == 0);
+}
+
+static void test_inline(void)
+{
+    ctoolbox_tracker tracker;
+    ctoolbox_tracker_init(&tracker, NULL);
+    ctoolbox_memfuncs mem = ctoolbox_tracker_memfuncs(&tracker);
+
+    // the first elements share the container's allocation
+    darray* array = darray_init_inline(sizeof(uint32_t), 8, &mem);
+    TEST_CHECK(array && darray_capacity(array) == 8);
+    size_t headerBytes = tracker.stats.liveBytes;
+    for (uint32_t i = 0; i < 8; i++) TEST_CHECK(darray_u32_push_back(array, i) == CTOOLBOX_SUCCESS);
+    TEST_CHECK(tracker.stats.allocCount == 1);
+
+    // then spill to the heap, and come back once they fit again
+    for (uint32_t i = 8; i < 100; i++) TEST_CHECK(darray_u32_push_back(array, i) == CTOOLBOX_SUCCESS);
+    TEST_CHECK(tracker.stats.allocCount > 1 && darray_capacity(array) >= 100);
+    for (uint32_t i = 0; i < 100; i++) TEST_CHECK(darray_u32_at(array, i) == i);
+
+    TEST_CHECK(darray_resize(array, 6) == CTOOLBOX_SUCCESS && darray_shrink_to_fit(array) == CTOOLBOX_SUCCESS);
+    TEST_CHECK(darray_capacity(array) == 8 && tracker.stats.liveBytes == headerBytes);
+    for (uint32_t i = 0; i < 6; i++) TEST_CHECK(darray_u32_at(array, i) == i);
+
+    // inline storage is never released on its own
+    TEST_CHECK(darray_resize(array, 0) == CTOOLBOX_SUCCESS && darray_shrink_to_fit(array) == CTOOLBOX_SUCCESS);
+    TEST_CHECK(darray_capacity(array) == 8 && darray_u32_push_back(array, 9) == CTOOLBOX_SUCCESS);
+
+    ctoolbox_memstats stats;
+    darray_memory_usage(array, &stats);
+    TEST_CHECK(stats.liveBytes == tracker.stats.liveBytes);
+    darray_destroy(array);
+    TEST_CHECK(tracker.stats.liveBytes == 0);
+
+    TEST_CHECK(darray_init_inline(sizeof(uint32_t), 0, NULL) == NULL);
+    TEST_CHECK(darray_init_inline(0, 8, NULL) == NULL);
+}
+
+static void test_typed(void)
+{
+    darray* array = darray_u32_init(2);
+    TEST_CHECK(array);
+
+    for (uint32_t i = 0; i < 100; i++) TEST_CHECK(darray_u32_push_back(array, i * 3) == CTOOLBOX_SUCCESS);
+    TEST_CHECK(darray_size(array) == 100);
+    for (uint32_t i = 0; i < 100; i++) TEST_CHECK(darray_u32_at(array, i) == i * 3);
+
+    uint32_t value = 0;
+    TEST_CHECK(darray_u32_get(array, 10, &value) == CTOOLBOX_SUCCESS && value == 30);
+    TEST_CHECK(darray_u32_set(array, 10, 7) == CTOOLBOX_SUCCESS);
+    TEST_CHECK(darray_u32_data(array)[10] == 7);
+    TEST_CHECK(darray_u32_pop_back(array, &value) == CTOOLBOX_SUCCESS && value == 297);
+
+    // the typed calls fail exactly like the untyped ones they wrap
+    TEST_CHECK(darray_u32_get(array, 99, &value) == darray_get(array, 99, &value));
+    TEST_CHECK(darray_u32_get(array, 0, NULL) == darray_get(array, 0, NULL));
+    TEST_CHECK(darray_u32_get(NULL, 0, &value) == darray_get(NULL, 0, &value));
+    TEST_CHECK(darray_u32_set(array, 99, value) == darray_set(array, 99, &value));
+    TEST_CHECK(darray_u32_set(NULL, 0, value) == darray_set(NULL, 0, &value));
+    TEST_CHECK(darray_u32_push_back(NULL, value) == darray_push_back(NULL, &value));
+    TEST_CHECK(darray_u32_pop_back(NULL, &value) == darray_pop_back(NULL, &value));
+
+    TEST_CHECK(darray_resize(array, 0) == CTOOLBOX_SUCCESS);
+    TEST_CHECK(darray_u32_pop_back(array, &value) == darray_pop_back(array, &value));
+
+    darray_destroy(array);
+}
+
+typedef struct sort_record
+{
+    int64_t key;
+    uint32_t seq;
+} sort_record;
+
+static int compare_record(const void* a, const void* b)
+{
+    const sort_record* x = a;
+    const sort_record* y = b;
+    return (x->key > y->key) - (x->key < y->key);
+}
+
+static int compare_first_byte(const void* a, const void* b)
+{
+    return (int)*(const unsigned char*)a - (int)*(const unsigned char*)b;
+}
+
+// fills count records with keys from few distinct values so stability shows, shaped 0 random, 1 sorted, 2 reversed, 3 all equal
+static darray* make_records(size_t count, int shape)
+{
+    darray* array = darray_init(sizeof(sort_record), count ? count : 1);
+    uint64_t state = count * 31 + (uint64_t)shape;
+    for (size_t i = 0; i < count; i++) {
+        state = state * 6364136223846793005u + 1442695040888963407u;
+        sort_record record = { 0, (uint32_t)i };
+        if (shape == 0) record.key = (int64_t)(state >> 33) % 97 - 48;
+        else if (shape == 1) record.key = (int64_t)i;
+        else if (shape == 2) record.key = -(int64_t)i;
+        darray_push_back(array, &record);
+    }
+    return array;
+}
+
+static void check_records(const darray* array, size_t count, bool stable)
+{
+    TEST_CHECK(darray_size(array) == count);
+    const sort_record* records = darray_const_data(array);
+    for (size_t i = 1; i < count; i++) {
+        TEST_CHECK(records[i - 1].key <= records[i].key);
+        if (stable && records[i - 1].key == records[i].key) TEST_CHECK(records[i - 1].seq < records[i].seq);
+    }
+}
+
+static void test_sort(void)
+{
+    static const size_t counts[] = { 0, 1, 2, 15, 16, 17, 100, 1000, 70000, 200003 };
+    threadpool* pool = threadpool_init(3);
+    TEST_CHECK(pool);
+
+    for (size_t i = 0; i < sizeof(counts) / sizeof(counts[0]); i++) {
+        for (int shape = 0; shape < 4; shape++) {
+            darray* array = make_records(counts[i], shape);
+            TEST_CHECK(darray_sort(array, compare_record) == CTOOLBOX_SUCCESS);
+            check_records(array, counts[i], false);
+            darray_destroy(array);
+
+            array = make_records(counts[i], shape);
+            TEST_CHECK(darray_parallel_sort(array, pool, compare_record) == CTOOLBOX_SUCCESS);
+            check_records(array, counts[i], true);
+            darray_destroy(array);
+
+            array = make_records(counts[i], shape);
+            TEST_CHECK(darray_parallel_sort(array, NULL, compare_record) == CTOOLBOX_SUCCESS);
+            check_records(array, counts[i], true);
+            darray_destroy(array);
+        }
+    }
+    threadpool_destroy(pool);
+
+    // the swap specialisations and the generic path, keyed on the first byte so every byte has to move with it
+    static const size_t sizes[] = { 1, 3, 4, 8, 12, 16, 24 };
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        size_t elementSize = sizes[i];
+        darray* array = darray_init(elementSize, 1000);
+        unsigned char element[24];
+        for (size_t j = 0; j < 1000; j++) {
+            unsigned char key = (unsigned char)((j * 37) % 251);
+            memset(element, key, elementSize);
+            darray_push_back(array, element);
+        }
+        TEST_CHECK(darray_sort(array, compare_first_byte) == CTOOLBOX_SUCCESS);
+        const unsigned char* data = darray_const_data(array);
+        for (size_t j = 0; j < 1000; j++) {
+            for (size_t k = 1; k < elementSize; k++) TEST_CHECK(data[j * elementSize + k] == data[j * elementSize]);
+            if (j) TEST_CHECK(data[(j - 1) * elementSize] <= data[j * elementSize]);
+        }
+        darray_destroy(array);
+    }
+
+    TEST_CHECK(darray_sort(NULL, compare_record) == CTOOLBOX_ERROR_INVALID_PARAM);
+    TEST_CHECK(darray_parallel_sort(NULL, NULL, compare_record) == CTOOLBOX_ERROR_INVALID_PARAM);
+}
+
+static void test_search_kernels(void)
+{
+    // every vector width and tail length, the match at each position in turn, checked against a byte loop
+    static const size_t sizes[] = { 1, 2, 4, 8, 3, 12 };
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        size_t elementSize = sizes[s];
+        unsigned char needle[12], other[12];
+        memset(needle, 0x5a, sizeof(needle));
+        memset(other, 0x11, sizeof(other));
+        // shares its last byte with the needle so a partial match is never taken for a hit
+        if (elementSize > 1) other[elementSize - 1] = 0x5a;
+
+        for (size_t count = 0; count < 80; count++) {
+            darray* array = darray_init(elementSize, 1);
+            for (size_t i = 0; i < count; i++) darray_push_back(array, other);
+            size_t index = 0;
+            TEST_CHECK(darray_find(array, needle, &index) == CTOOLBOX_ERROR_NOT_FOUND);
+            TEST_CHECK(darray_count(array, needle) == 0 && !darray_contains(array, needle));
+            TEST_CHECK(darray_count(array, other) == count);
+
+            for (size_t at = 0; at < count; at++) {
+                darray_set(array, at, needle);
+                TEST_CHECK(darray_find(array, needle, &index) == CTOOLBOX_SUCCESS && index == at);
+                TEST_CHECK(darray_count(array, needle) == 1 && darray_contains(array, needle));
+                darray_set(array, at, other);
+            }
+
+            // fill writes each element whole, equal sees a single differing byte anywhere
+            darray* copy = darray_init(elementSize, 1);
+            darray_append_darray(copy, array);
+            TEST_CHECK(darray_equal(array, copy));
+            TEST_CHECK(darray_fill(copy, needle) == CTOOLBOX_SUCCESS);
+            TEST_CHECK(darray_count(copy, needle) == count);
+            TEST_CHECK(darray_equal(array, copy) == (count == 0));
+            for (size_t i = 0; i < count * elementSize; i++) {
+                const unsigned char* bytes = darray_const_data(copy);
+                TEST_CHECK(bytes[i] == 0x5a);
+            }
+            if (count > 0) {
+                darray_fill(copy, other);
+                ((unsigned char*)darray_data(copy))[count * elementSize - 1] ^= 1;
+                TEST_CHECK(!darray_equal(array, copy));
+            }
+
+            darray_destroy(copy);
+            darray_destroy(array);
+        }
+    }
+}
+
+typedef struct predicate_count
+{
+    size_t calls[64];
+} predicate_count;
+
+static bool is_multiple_of_three(const void* element, void* user)
+{
+    uint32_t value = *(const uint32_t*)element;
+    ((predicate_count*)user)->calls[value]++;
+    return value % 3 == 0;
+}
+
+static void test_remove_if(void)
+{
+    // runs of every length, each element has to reach the predicate exactly once
+    darray* array = darray_u32_init(64);
+    for (uint32_t i = 0; i < 64; i++) darray_u32_push_back(array, i);
+
+    predicate_count count = { { 0 } };
+    TEST_CHECK(darray_remove_if(array, is_multiple_of_three, &count) == 22);
+    TEST_CHECK(darray_size(array) == 42);
+    for (size_t i = 0; i < 64; i++) TEST_CHECK(count.calls[i] == 1);
+    for (size_t i = 0; i < 42; i++) TEST_CHECK(darray_u32_at(array, i) == (uint32_t)(i / 2 * 3 + 1 + i % 2));
+
+    memset(&count, 0, sizeof(count));
+    TEST_CHECK(darray_retain(array, is_multiple_of_three, &count) == 42);
+    TEST_CHECK(darray_size(array) == 0);
+    for (size_t i = 0; i < 64; i++) TEST_CHECK(count.calls[i] == (i % 3 ? 1u : 0u));
+
+    darray_destroy(array);
+}
+
+#define MAPPED_PATH "test_darray_mapped.bin"
+
+static int compare_u32_descending(const void* a, const void* b)
+{
+    uint32_t x = *(const uint32_t*)a;
+    uint32_t y = *(const uint32_t*)b;
+    return (x < y) - (x > y);
+}
+
+static darray* open_read_only(const darray* expected)
+{
+    darray* array = darray_open_mapped(MAPPED_PATH, DARRAY_MAP_READ_ONLY, NULL);
+    TEST_CHECK(array);
+    TEST_CHECK(darray_capacity(array) == 0);
+    TEST_CHECK(darray_equal(array, expected));
+    return array;
+}
+
+static void test_mapped(void)
+{
+    darray* saved = darray_u32_init(1000);
+    for (uint32_t i = 0; i < 1000; i++) darray_u32_push_back(saved, i);
+    TEST_CHECK(darray_save(saved, MAPPED_PATH) == CTOOLBOX_SUCCESS);
+
+    // the file pages are read in place, every write moves the elements to the heap first instead of faulting
+    darray* array = open_read_only(saved);
+    uint32_t value = 0;
+    TEST_CHECK(darray_pop_back(array, &value) == CTOOLBOX_SUCCESS && value == 999);
+    TEST_CHECK(darray_u32_push_back(array, 5000) == CTOOLBOX_SUCCESS);
+    TEST_CHECK(darray_size(array) == 1000 && darray_u32_at(array, 999) == 5000 && darray_u32_at(array, 998) == 998);
+    darray_destroy(array);
+
+    array = open_read_only(saved);
+    TEST_CHECK(darray_pop_back(array, NULL) == CTOOLBOX_SUCCESS);
+    value = 7;
+    TEST_CHECK(darray_insert_at(array, 0, &value) == CTOOLBOX_SUCCESS);
+    TEST_CHECK(darray_u32_at(array, 0) == 7 && darray_u32_at(array, 1) == 0 && darray_u32_at(array, 999) == 998);
+    darray_destroy(array);
+
+    array = open_read_only(saved);
+    TEST_CHECK(darray_u32_set(array, 5, 77) == CTOOLBOX_SUCCESS && darray_u32_at(array, 5) == 77);
+    TEST_CHECK(darray_capacity(array) >= darray_size(array));
+    darray_destroy(array);
+
+    array = open_read_only(saved);
+    TEST_CHECK(darray_set(array, 6, &value) == CTOOLBOX_SUCCESS && darray_u32_at(array, 6) == 7);
+    darray_destroy(array);
+
+    array = open_read_only(saved);
+    TEST_CHECK(darray_sort(array, compare_u32_descending) == CTOOLBOX_SUCCESS && darray_u32_at(array, 0) == 999);
+    darray_destroy(array);
+
+    array = open_read_only(saved);
+    TEST_CHECK(darray_stable_sort(array, compare_u32_descending) == CTOOLBOX_SUCCESS && darray_u32_at(array, 0) == 999);
+    darray_destroy(array);
+
+    array = open_read_only(saved);
+    TEST_CHECK(darray_radix_sort(array, 0, sizeof(uint32_t), false) == CTOOLBOX_SUCCESS && darray_u32_at(array, 0) == 0);
+    darray_destroy(array);
+
+    array = open_read_only(saved);
+    TEST_CHECK(darray_fill(array, &value) == CTOOLBOX_SUCCESS && darray_u32_at(array, 500) == 7);
+    darray_destroy(array);
+
+    array = open_read_only(saved);
+    TEST_CHECK(darray_remove_at(array, 0, &value) == CTOOLBOX_SUCCESS && value == 0 && darray_u32_at(array, 0) == 1);
+    TEST_CHECK(darray_swap_remove(array, 0, &value) == CTOOLBOX_SUCCESS && value == 1 && darray_u32_at(array, 0) == 999);
+    darray_destroy(array);
+
+    array = open_read_only(saved);
+    TEST_CHECK(darray_remove_range(array, 0, 10, NULL) == CTOOLBOX_SUCCESS && darray_u32_at(array, 0) == 10);
+    darray_destroy(array);
+
+    array = open_read_only(saved);
+    predicate_count count = { { 0 } };
+    darray_resize(array, 64);
+    TEST_CHECK(darray_remove_if(array, is_multiple_of_three, &count) == 22);
+    darray_destroy(array);
+
+    array = open_read_only(saved);
+    uint32_t* data = darray_data(array);
+    TEST_CHECK(data);
+    data[0] = 42;
+    TEST_CHECK(darray_u32_at(array, 0) == 42);
+    darray_destroy(array);
+
+    array = open_read_only(saved);
+    TEST_CHECK(darray_append(array, darray_const_peek(array, 3), 2) == CTOOLBOX_SUCCESS);
+    TEST_CHECK(darray_size(array) == 1002 && darray_u32_at(array, 1000) == 3 && darray_u32_at(array, 1001) == 4);
+    darray_destroy(array);
+
+    // copy-on-write pages are written in place and never reach the file
+    array = darray_open_mapped(MAPPED_PATH, DARRAY_MAP_COPY_ON_WRITE, NULL);
+    TEST_CHECK(array && darray_capacity(array) == darray_size(array));
+    TEST_CHECK(darray_u32_set(array, 0, 123) == CTOOLBOX_SUCCESS && darray_u32_at(array, 0) == 123);
+    darray_destroy(array);
+
+    array = open_read_only(saved);
+
+    // saving over a mapped file swaps in a new file, the mapping keeps the old content
+    darray* other = darray_u32_init(4);
+    for (uint32_t i = 0; i < 4; i++) darray_u32_push_back(other, i + 100);
+    TEST_CHECK(darray_save(other, MAPPED_PATH) == CTOOLBOX_SUCCESS);
+    TEST_CHECK(darray_equal(array, saved));
+    darray_destroy(array);
+
+    array = open_read_only(other);
+    darray_destroy(array);
+    TEST_CHECK(fopen(MAPPED_PATH ".tmp", "rb") == NULL);
+
+    // a file that can't be written is an I/O error and nothing is left behind
+    TEST_CHECK(darray_save(saved, "test_darray_missing_directory/array.bin") == CTOOLBOX_ERROR_IO);
+    TEST_CHECK(darray_save(NULL, MAPPED_PATH) == CTOOLBOX_ERROR_INVALID_PARAM);
+    array = open_read_only(other);
+    darray_destroy(array);
+
+    remove(MAPPED_PATH);
+    darray_destroy(other);
+    darray_destroy(saved);
+}
+
+static void double_element(void* element, void* user)
+{
+    (void)user;
+    *(uint64_t*)element *= 2;
+}
+
+static void narrow_element(const void* element, void* elementOut, void* user)
+{
+    (void)user;
+    *(uint32_t*)elementOut = (uint32_t)(*(const uint64_t*)element + 1);
+}
+
+static void add_element(void* accumulator, const void* element, void* user)
+{
+    (void)user;
+    *(uint64_t*)accumulator += *(const uint64_t*)element;
+}
+
+static void test_parallel(void)
+{
+    threadpool* pool = threadpool_init(3);
+    TEST_CHECK(pool);
+
+    // below and above DARRAY_PARALLEL_THRESHOLD, with and without a pool, every call matches the serial result
+    static const size_t counts[] = { 0, 1, 1000, DARRAY_PARALLEL_THRESHOLD, 100003 };
+    for (size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); c++) {
+        for (int usePool = 0; usePool < 2; usePool++) {
+            threadpool* p = usePool ? pool : NULL;
+            size_t count = counts[c];
+
+            ctoolbox_tracker tracker;
+            ctoolbox_tracker_init(&tracker, NULL);
+            ctoolbox_memfuncs mem = ctoolbox_tracker_memfuncs(&tracker);
+            darray* array = darray_init_memfuncs(sizeof(uint64_t), count, &mem);
+            for (uint64_t i = 0; i < count; i++) darray_push_back(array, &i);
+
+            TEST_CHECK(darray_parallel_for_each(array, p, double_element, NULL) == CTOOLBOX_SUCCESS);
+            for (size_t i = 0; i < count; i++) TEST_CHECK(*(const uint64_t*)darray_const_peek(array, i) == 2 * i);
+
+            darray* narrow = darray_init(sizeof(uint32_t), 1);
+            TEST_CHECK(darray_parallel_transform(array, narrow, p, narrow_element, NULL) == CTOOLBOX_SUCCESS);
+            TEST_CHECK(darray_size(narrow) == count);
+            for (size_t i = 0; i < count; i++) TEST_CHECK(*(const uint32_t*)darray_const_peek(narrow, i) == 2 * i + 1);
+            darray_destroy(narrow);
+
+            // the reduce partials stay out of the array's accounting, the scan ones are returned
+            ctoolbox_memstats before, after;
+            darray_memory_usage(array, &before);
+            uint64_t zero = 0, sum = 1;
+            TEST_CHECK(darray_parallel_reduce(array, p, &zero, add_element, NULL, &sum) == CTOOLBOX_SUCCESS);
+            TEST_CHECK(sum == (count ? (uint64_t)count * (count - 1) : 0));
+
+            TEST_CHECK(darray_parallel_scan(array, p, &zero, add_element, NULL) == CTOOLBOX_SUCCESS);
+            uint64_t running = 0;
+            for (size_t i = 0; i < count; i++) {
+                running += 2 * i;
+                TEST_CHECK(*(const uint64_t*)darray_const_peek(array, i) == running);
+            }
+            darray_memory_usage(array, &after);
+            TEST_CHECK(after.liveBytes == before.liveBytes);
+
+            darray_destroy(array);
+            TEST_CHECK(tracker.stats.liveBytes == 0);
+        }
+    }
+
+    uint64_t zero = 0;
+    TEST_CHECK(darray_parallel_scan(NULL, pool, &zero, add_element, NULL) == CTOOLBOX_ERROR_INVALID_PARAM);
+    TEST_CHECK(darray_parallel_reduce(NULL, pool, &zero, add_element, NULL, &zero) == CTOOLBOX_ERROR_INVALID_PARAM);
+    threadpool_destroy(pool);
+}
+
+int main(void)
+{
+    test_bulk();
+    test_emplace();
+    test_growth();
+    test_inline();
+    test_typed();
+    test_sort();
+    test_search_kernels();
+    test_remove_if();
+    test_mapped();
+    test_parallel();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,145 @@
+#include "test.h"
+#include "deque.h"
+
+#include <string.h>
+
+// plain array the deque is checked against, the front starts in the middle so both ends have room
+enum { MODEL_CAPACITY = 1 << 16 };
+
+typedef struct model
+{
+    uint32_t values[MODEL_CAPACITY];
+    size_t front;
+    size_t back;
+} model;
+
+static model reference;
+
+static void check_against_model(const deque* d)
+{
+    TEST_CHECK(deque_size(d) == reference.back - reference.front);
+    TEST_CHECK(deque_empty(d) == (reference.back == reference.front));
+    TEST_CHECK(deque_capacity(d) >= deque_size(d));
+    for (size_t i = 0; i < deque_size(d); i++) {
+        uint32_t value = 0;
+        TEST_CHECK(deque_get(d, i, &value) == CTOOLBOX_SUCCESS);
+        TEST_CHECK(value == reference.values[reference.front + i]);
+    }
+    TEST_CHECK(deque_const_peek(d, deque_size(d)) == NULL);
+}
+
+static void test_both_ends(void)
+{
+    deque* d = deque_init(sizeof(uint32_t), 4);
+    TEST_CHECK(d);
+    reference.front = reference.back = MODEL_CAPACITY / 2;
+
+    uint32_t value = 0;
+    TEST_CHECK(deque_pop_back(d, &value) != CTOOLBOX_SUCCESS);
+    TEST_CHECK(deque_pop_front(d, &value) != CTOOLBOX_SUCCESS);
+
+    // a fixed pseudo-random mix of pushes and pops keeps the head running around the ring and through growth
+    uint32_t state = 12345;
+    for (uint32_t step = 0; step < 20000; step++) {
+        state = state * 1103515245u + 12345u;
+        uint32_t op = (state >> 16) % 5;
+        size_t size = reference.back - reference.front;
+
+        if (op == 0 || op == 1) {
+            TEST_CHECK(deque_push_back(d, &step) == CTOOLBOX_SUCCESS);
+            reference.values[reference.back++] = step;
+        }
+        else if (op == 2) {
+            TEST_CHECK(deque_push_front(d, &step) == CTOOLBOX_SUCCESS);
+            reference.values[--reference.front] = step;
+        }
+        else if (op == 3 && size > 0) {
+            TEST_CHECK(deque_pop_back(d, &value) == CTOOLBOX_SUCCESS);
+            TEST_CHECK(value == reference.values[--reference.back]);
+        }
+        else if (size > 0) {
+            TEST_CHECK(deque_pop_front(d, &value) == CTOOLBOX_SUCCESS);
+            TEST_CHECK(value == reference.values[reference.front++]);
+        }
+        if (step % 997 == 0) check_against_model(d);
+    }
+    check_against_model(d);
+
+    deque_clear(d);
+    TEST_CHECK(deque_empty(d) && deque_capacity(d) > 0);
+    deque_destroy(d);
+}
+
+static void test_wraparound(void)
+{
+    deque* d = deque_init(sizeof(uint32_t), 8);
+    TEST_CHECK(d);
+    size_t capacity = deque_capacity(d);
+
+    // moving a half-full window around the ring never needs more storage
+    uint32_t next = 0, expected = 0;
+    for (size_t i = 0; i < capacity / 2; i++, next++) deque_push_back(d, &next);
+    for (size_t round = 0; round < capacity * 4; round++) {
+        uint32_t value = 0;
+        TEST_CHECK(deque_pop_front(d, &value) == CTOOLBOX_SUCCESS && value == expected++);
+        TEST_CHECK(deque_push_back(d, &next) == CTOOLBOX_SUCCESS);
+        next++;
+    }
+    TEST_CHECK(deque_capacity(d) == capacity);
+
+    // growing while wrapped keeps the order from front to back
+    for (; deque_size(d) < capacity * 3; next++) deque_push_back(d, &next);
+    for (size_t i = 0; i < deque_size(d); i++) TEST_CHECK(*(const uint32_t*)deque_const_peek(d, i) == expected + i);
+
+    // set goes through the same index mapping
+    uint32_t marker = 0xdeadbeef;
+    TEST_CHECK(deque_set(d, 1, &marker) == CTOOLBOX_SUCCESS);
+    TEST_CHECK(*(uint32_t*)deque_peek(d, 1) == marker);
+    TEST_CHECK(deque_set(d, deque_size(d), &marker) != CTOOLBOX_SUCCESS);
+
+    deque_destroy(d);
+}
+
+static void test_bulk(void)
+{
+    ctoolbox_tracker tracker;
+    ctoolbox_tracker_init(&tracker, NULL);
+    ctoolbox_memfuncs mem = ctoolbox_tracker_memfuncs(&tracker);
+
+    deque* d = deque_init_memfuncs(sizeof(uint32_t), 16, &mem);
+    TEST_CHECK(d);
+
+    uint32_t values[1000];
+    for (uint32_t i = 0; i < 1000; i++) values[i] = i;
+
+    // shift the head so the bulk push wraps, then grow past the capacity in one call
+    for (uint32_t i = 0; i < 10; i++) deque_push_back(d, &i);
+    TEST_CHECK(deque_pop_front_n(d, NULL, 10) == CTOOLBOX_SUCCESS);
+    TEST_CHECK(deque_push_back_n(d, values, 12) == CTOOLBOX_SUCCESS);
+
+    uint64_t growths = tracker.stats.allocCount + tracker.stats.reallocCount;
+    TEST_CHECK(deque_push_back_n(d, values + 12, 988) == CTOOLBOX_SUCCESS);
+    TEST_CHECK(tracker.stats.allocCount + tracker.stats.reallocCount <= growths + 1);
+    TEST_CHECK(deque_size(d) == 1000);
+
+    uint32_t out[1000];
+    memset(out, 0, sizeof(out));
+    TEST_CHECK(deque_pop_front_n(d, out, 1001) != CTOOLBOX_SUCCESS);
+    TEST_CHECK(deque_pop_front_n(d, out, 1000) == CTOOLBOX_SUCCESS);
+    TEST_CHECK(memcmp(out, values, sizeof(values)) == 0);
+    TEST_CHECK(deque_empty(d));
+
+    ctoolbox_memstats stats;
+    TEST_CHECK(deque_memory_usage(d, &stats) == CTOOLBOX_SUCCESS);
+    TEST_CHECK(stats.liveBytes == tracker.stats.liveBytes);
+    deque_destroy(d);
+    TEST_CHECK(tracker.stats.liveBytes == 0);
+}
+
+int main(void)
+{
+    test_both_ends();
+    test_wraparound();
+    test_bulk();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,287 @@
+#include "test.h"
+#include "idgen.h"
+
+#include <string.h>
+
+static void test_range(void)
+{
+    // 0 is the exhausted value of idgen_next, a range can't start there
+    TEST_CHECK(idgen_create_range(0, 100, CTOOLBOX_DEFAULT_ALIGNMENT, NULL) == NULL);
+    TEST_CHECK(idgen_create_range(10, 9, CTOOLBOX_DEFAULT_ALIGNMENT, NULL) == NULL);
+    TEST_CHECK(idgen_create_range(1, 100, 3, NULL) == NULL);
+
+    // a small range hands out each of its ids once, then wraps only to freed ones
+    idgen* gen = idgen_create_range(5, 9, CTOOLBOX_DEFAULT_ALIGNMENT, NULL);
+    TEST_CHECK(gen);
+    for (uint32_t id = 5; id <= 9; id++) TEST_CHECK(idgen_next(gen) == id);
+    TEST_CHECK(idgen_next(gen) == 0);
+    uint32_t id = 1;
+    TEST_CHECK(!idgen_try_next(gen, &id) && id == 1);
+    TEST_CHECK(idgen_count(gen) == 5);
+
+    TEST_CHECK(!idgen_register(gen, 4) && !idgen_register(gen, 10));
+    TEST_CHECK(idgen_unregister(gen, 7));
+    TEST_CHECK(idgen_next(gen) == 7);
+    idgen_destroy(gen);
+
+    // the ends of the full 32 bits range
+    gen = idgen_create_range(1, UINT32_MAX, CTOOLBOX_DEFAULT_ALIGNMENT, NULL);
+    TEST_CHECK(gen);
+    TEST_CHECK(idgen_next(gen) == 1);
+    TEST_CHECK(idgen_register(gen, UINT32_MAX));
+    TEST_CHECK(idgen_is_registered(gen, UINT32_MAX) && !idgen_is_registered(gen, UINT32_MAX - 1));
+    TEST_CHECK(idgen_register(gen, UINT32_MAX - 1));
+    TEST_CHECK(idgen_count(gen) == 3);
+    TEST_CHECK(idgen_unregister(gen, UINT32_MAX) && !idgen_unregister(gen, UINT32_MAX));
+    idgen_destroy(gen);
+
+    gen = idgen_create_range(UINT32_MAX - 1, UINT32_MAX, CTOOLBOX_DEFAULT_ALIGNMENT, NULL);
+    TEST_CHECK(idgen_next(gen) == UINT32_MAX - 1);
+    TEST_CHECK(idgen_next(gen) == UINT32_MAX);
+    TEST_CHECK(idgen_next(gen) == 0);
+    idgen_destroy(gen);
+
+    // a generator starting at 0 hands 0 out as an id, idgen_try_next tells it apart from exhaustion
+    gen = idgen_create(0);
+    TEST_CHECK(gen);
+    TEST_CHECK(idgen_try_next(gen, &id) && id == 0);
+    TEST_CHECK(idgen_try_next(gen, &id) && id == 1);
+    TEST_CHECK(!idgen_try_next(NULL, &id) && !idgen_try_next(gen, NULL));
+    TEST_CHECK(idgen_create(IDGEN_MAX_SAFE_IDS) == NULL);
+    idgen_destroy(gen);
+}
+
+// plain flags and a cursor idgen_next is checked against, a few pages' worth so the search crosses word and page edges
+enum { MODEL_START = 3, MODEL_END = 3 + 3 * 4096 + 100, MODEL_IDS = MODEL_END - MODEL_START + 1 };
+
+static bool model_used[MODEL_IDS];
+
+static uint32_t model_next(uint32_t* cursor)
+{
+    for (uint32_t pass = 0; pass < 2; pass++) {
+        for (uint32_t id = pass ? MODEL_START : *cursor; id <= MODEL_END; id++) {
+            if (model_used[id - MODEL_START]) continue;
+            model_used[id - MODEL_START] = true;
+            *cursor = id == MODEL_END ? MODEL_START : id + 1;
+            return id;
+        }
+    }
+    return 0;
+}
+
+static void test_search(void)
+{
+    idgen* gen = idgen_create_range(MODEL_START, MODEL_END, CTOOLBOX_DEFAULT_ALIGNMENT, NULL);
+    TEST_CHECK(gen);
+    memset(model_used, 0, sizeof(model_used));
+    uint32_t cursor = MODEL_START;
+
+    // dense first, every id in order
+    for (uint32_t id = MODEL_START; id <= MODEL_END; id++) TEST_CHECK(idgen_next(gen) == model_next(&cursor));
+    TEST_CHECK(idgen_next(gen) == 0 && model_next(&cursor) == 0);
+
+    // holes at word and page edges come back lowest first
+    static const uint32_t edges[] = { 63, 64, 4095, 4096, 4097, 8191, 2 * 4096 + 64, MODEL_IDS - 1 };
+    for (size_t i = sizeof(edges) / sizeof(edges[0]); i-- > 0;) {
+        TEST_CHECK(idgen_unregister(gen, MODEL_START + edges[i]));
+        model_used[edges[i]] = false;
+    }
+    for (size_t i = 0; i < sizeof(edges) / sizeof(edges[0]); i++) TEST_CHECK(idgen_next(gen) == MODEL_START + edges[i]);
+    TEST_CHECK(idgen_next(gen) == 0);
+    for (size_t i = 0; i < sizeof(edges) / sizeof(edges[0]); i++) model_used[edges[i]] = true;
+
+    // then fragmented, a fixed pseudo-random mix of frees, registers and nexts, the cursor wrapping to freed ids
+    uint32_t state = 2024;
+    for (uint32_t step = 0; step < 40000; step++) {
+        state = state * 1103515245u + 12345u;
+        uint32_t id = MODEL_START + (state >> 8) % MODEL_IDS;
+        uint32_t op = (state >> 4) % 4;
+        if (op == 0) {
+            TEST_CHECK(idgen_unregister(gen, id) == model_used[id - MODEL_START]);
+            if (id < cursor) cursor = id;
+            model_used[id - MODEL_START] = false;
+        }
+        else if (op == 1) {
+            TEST_CHECK(idgen_register(gen, id) == !model_used[id - MODEL_START]);
+            model_used[id - MODEL_START] = true;
+        }
+        else {
+            TEST_CHECK(idgen_next(gen) == model_next(&cursor));
+        }
+    }
+
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < MODEL_IDS; i++) {
+        TEST_CHECK(idgen_is_registered(gen, MODEL_START + i) == model_used[i]);
+        count += model_used[i];
+    }
+    TEST_CHECK(idgen_count(gen) == count);
+    idgen_destroy(gen);
+}
+
+static void test_full_chunk(void)
+{
+    // a chunk summarises 1024 pages of 4096 ids, filling one whole makes the search skip it from the top level
+    const uint32_t chunk = 4096u * 1024u;
+    idgen* gen = idgen_create_range(1, chunk + 10, CTOOLBOX_DEFAULT_ALIGNMENT, NULL);
+    TEST_CHECK(gen);
+    for (uint32_t id = 1; id <= chunk + 10; id++) TEST_CHECK(idgen_next(gen) == id);
+    TEST_CHECK(idgen_next(gen) == 0);
+
+    TEST_CHECK(idgen_unregister(gen, chunk + 5) && idgen_unregister(gen, 77));
+    TEST_CHECK(idgen_next(gen) == 77);
+    TEST_CHECK(idgen_next(gen) == chunk + 5);
+    TEST_CHECK(idgen_next(gen) == 0);
+    TEST_CHECK(idgen_count(gen) == chunk + 10);
+
+    idgen_reset(gen);
+    TEST_CHECK(idgen_count(gen) == 0 && idgen_next(gen) == 1);
+    idgen_destroy(gen);
+}
+
+static void test_pages(void)
+{
+    ctoolbox_tracker tracker;
+    ctoolbox_tracker_init(&tracker, NULL);
+    ctoolbox_memfuncs mem = ctoolbox_tracker_memfuncs(&tracker);
+
+    // creating a generator over the full default range allocates its header and chunk directory only
+    idgen* gen = idgen_create_memfuncs(1, &mem);
+    TEST_CHECK(gen);
+    ctoolbox_memstats stats;
+    TEST_CHECK(idgen_memory_usage(gen, &stats) == CTOOLBOX_SUCCESS);
+    size_t empty = stats.liveBytes;
+    TEST_CHECK(empty == tracker.stats.liveBytes);
+    TEST_CHECK(empty < 4096);
+
+    // the first id of a page allocates it, the ids sharing it cost nothing more
+    TEST_CHECK(idgen_register(gen, 5000000));
+    size_t firstPage = tracker.stats.liveBytes;
+    TEST_CHECK(firstPage > empty);
+    TEST_CHECK(idgen_register(gen, 5000001) && idgen_register(gen, 5000063));
+    TEST_CHECK(tracker.stats.liveBytes == firstPage);
+
+    // another page of the same chunk costs a page, less than the chunk and page the first id needed
+    TEST_CHECK(idgen_register(gen, 5000000 + 3 * 4096));
+    size_t page = tracker.stats.liveBytes - firstPage;
+    TEST_CHECK(page > 0 && page < firstPage - empty);
+
+    // an empty page goes away, the last one takes its chunk along
+    TEST_CHECK(idgen_unregister(gen, 5000000 + 3 * 4096));
+    TEST_CHECK(tracker.stats.liveBytes == firstPage);
+    TEST_CHECK(idgen_unregister(gen, 5000000) && idgen_unregister(gen, 5000001));
+    TEST_CHECK(tracker.stats.liveBytes == firstPage);
+    TEST_CHECK(idgen_unregister(gen, 5000063));
+    TEST_CHECK(tracker.stats.liveBytes == empty);
+    TEST_CHECK(!idgen_is_registered(gen, 5000063));
+
+    // reset releases every page at once
+    for (uint32_t i = 0; i < 10000; i++) TEST_CHECK(idgen_next(gen) == i + 1);
+    TEST_CHECK(tracker.stats.liveBytes > empty);
+    TEST_CHECK(idgen_memory_usage(gen, &stats) == CTOOLBOX_SUCCESS && stats.liveBytes == tracker.stats.liveBytes);
+    idgen_reset(gen);
+    TEST_CHECK(tracker.stats.liveBytes == empty);
+    TEST_CHECK(idgen_count(gen) == 0 && idgen_next(gen) == 1);
+
+    idgen_destroy(gen);
+    TEST_CHECK(tracker.stats.liveBytes == 0);
+}
+
+static void test_handles(void)
+{
+    idgen_handles* handles = idgen_handles_create(0);
+    TEST_CHECK(handles);
+    TEST_CHECK(!idgen_handles_valid(handles, IDGEN_HANDLE_NULL));
+
+    // fresh slots come in index order, first generation 1 so no handle is IDGEN_HANDLE_NULL
+    idgen_handle h[4];
+    for (uint32_t i = 0; i < 4; i++) {
+        h[i] = idgen_handles_alloc(handles);
+        TEST_CHECK(h[i] != IDGEN_HANDLE_NULL && idgen_handles_valid(handles, h[i]));
+        TEST_CHECK(IDGEN_HANDLE_INDEX(h[i]) == i && IDGEN_HANDLE_GENERATION(h[i]) == 1);
+    }
+    TEST_CHECK(idgen_handles_count(handles) == 4 && idgen_handles_slot_count(handles) == 4);
+
+    // a freed handle is stale for good, freeing it again does nothing
+    TEST_CHECK(idgen_handles_free(handles, h[2]));
+    TEST_CHECK(!idgen_handles_valid(handles, h[2]) && !idgen_handles_free(handles, h[2]));
+    TEST_CHECK(idgen_handles_free(handles, h[0]) && idgen_handles_free(handles, h[3]));
+    TEST_CHECK(idgen_handles_count(handles) == 1);
+
+    // freed slots come back lowest first with the next generation, the stale handles never match them
+    static const uint32_t order[] = { 0, 2, 3 };
+    for (size_t i = 0; i < 3; i++) {
+        idgen_handle reused = idgen_handles_alloc(handles);
+        TEST_CHECK(IDGEN_HANDLE_INDEX(reused) == order[i] && IDGEN_HANDLE_GENERATION(reused) == 2);
+        TEST_CHECK(idgen_handles_valid(handles, reused) && !idgen_handles_valid(handles, h[order[i]]));
+        TEST_CHECK(!idgen_handles_free(handles, h[order[i]]));
+        h[order[i]] = reused;
+    }
+    idgen_handle fresh = idgen_handles_alloc(handles);
+    TEST_CHECK(IDGEN_HANDLE_INDEX(fresh) == 4 && IDGEN_HANDLE_GENERATION(fresh) == 1);
+
+    // handles made up or from past the slots are rejected
+    TEST_CHECK(!idgen_handles_valid(handles, ((idgen_handle)1 << IDGEN_HANDLE_INDEX_BITS) | 5));
+    TEST_CHECK(!idgen_handles_valid(handles, ((idgen_handle)7 << IDGEN_HANDLE_INDEX_BITS) | 1));
+    TEST_CHECK(!idgen_handles_valid(NULL, h[1]) && !idgen_handles_free(NULL, h[1]));
+    TEST_CHECK(idgen_handles_alloc(NULL) == IDGEN_HANDLE_NULL);
+
+    // reset frees every live handle in index order, keeping the slots and their generations
+    idgen_handles_reset(handles);
+    TEST_CHECK(idgen_handles_count(handles) == 0 && idgen_handles_slot_count(handles) == 5);
+    for (uint32_t i = 0; i < 4; i++) TEST_CHECK(!idgen_handles_valid(handles, h[i]));
+    TEST_CHECK(!idgen_handles_valid(handles, fresh));
+    static const uint32_t generations[] = { 3, 2, 3, 3, 2 };
+    for (uint32_t i = 0; i < 5; i++) {
+        idgen_handle reused = idgen_handles_alloc(handles);
+        TEST_CHECK(IDGEN_HANDLE_INDEX(reused) == i && IDGEN_HANDLE_GENERATION(reused) == generations[i]);
+    }
+    TEST_CHECK(idgen_handles_slot_count(handles) == 5);
+
+    idgen_handles_destroy(handles);
+}
+
+static void test_handles_growth(void)
+{
+    ctoolbox_tracker tracker;
+    ctoolbox_tracker_init(&tracker, NULL);
+    ctoolbox_memfuncs mem = ctoolbox_tracker_memfuncs(&tracker);
+
+    idgen_handles* handles = idgen_handles_create_memfuncs(4, &mem);
+    TEST_CHECK(handles);
+
+    // the slots grow past the initial capacity, the handles already out stay valid
+    enum { HANDLES = 5000 };
+    static idgen_handle h[HANDLES];
+    for (uint32_t i = 0; i < HANDLES; i++) h[i] = idgen_handles_alloc(handles);
+    for (uint32_t i = 0; i < HANDLES; i++) TEST_CHECK(idgen_handles_valid(handles, h[i]) && IDGEN_HANDLE_INDEX(h[i]) == i);
+    TEST_CHECK(idgen_handles_count(handles) == HANDLES);
+
+    ctoolbox_memstats stats;
+    TEST_CHECK(idgen_handles_memory_usage(handles, &stats) == CTOOLBOX_SUCCESS);
+    TEST_CHECK(stats.liveBytes == tracker.stats.liveBytes);
+
+    // churn within the slots made allocates nothing
+    uint64_t allocations = tracker.stats.allocCount + tracker.stats.reallocCount;
+    for (uint32_t round = 0; round < 3; round++) {
+        for (uint32_t i = round; i < HANDLES; i += 3) TEST_CHECK(idgen_handles_free(handles, h[i]));
+        for (uint32_t i = round; i < HANDLES; i += 3) h[i] = idgen_handles_alloc(handles);
+    }
+    TEST_CHECK(tracker.stats.allocCount + tracker.stats.reallocCount == allocations);
+    TEST_CHECK(idgen_handles_slot_count(handles) == HANDLES);
+    for (uint32_t i = 0; i < HANDLES; i++) TEST_CHECK(idgen_handles_valid(handles, h[i]));
+
+    idgen_handles_destroy(handles);
+    TEST_CHECK(tracker.stats.liveBytes == 0);
+}
+
+int main(void)
+{
+    test_range();
+    test_search();
+    test_full_chunk();
+    test_pages();
+    test_handles();
+    test_handles_growth();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,116 @@
+#include "test.h"
+#include "segarray.h"
+
+enum { ELEMENTS = 5000 };
+
+static void test_stable_addresses(void)
+{
+    segarray* array = segarray_init(sizeof(uint32_t));
+    TEST_CHECK(array);
+    TEST_CHECK(segarray_empty(array));
+
+    // addresses taken early stay valid and unchanged while many segments are added behind them
+    const uint32_t* first = NULL;
+    const uint32_t* middle = NULL;
+    for (uint32_t i = 0; i < ELEMENTS; i++) {
+        TEST_CHECK(segarray_push_back(array, &i) == CTOOLBOX_SUCCESS);
+        if (i == 0) first = segarray_const_peek(array, 0);
+        if (i == 100) middle = segarray_const_peek(array, 100);
+    }
+    TEST_CHECK(segarray_size(array) == ELEMENTS);
+    TEST_CHECK(segarray_capacity(array) >= ELEMENTS);
+    TEST_CHECK(first == segarray_const_peek(array, 0) && *first == 0);
+    TEST_CHECK(middle == segarray_const_peek(array, 100) && *middle == 100);
+
+    // segments double, the capacity is always a sum of them
+    size_t capacity = segarray_capacity(array);
+    size_t segments = (size_t)1 << SEGARRAY_FIRST_SEGMENT_SHIFT;
+    size_t expected = 0;
+    while (expected < ELEMENTS) {
+        expected += segments;
+        segments *= 2;
+    }
+    TEST_CHECK(capacity == expected);
+
+    for (uint32_t i = 0; i < ELEMENTS; i++) {
+        uint32_t value = 0;
+        TEST_CHECK(segarray_get(array, i, &value) == CTOOLBOX_SUCCESS && value == i);
+    }
+    TEST_CHECK(segarray_const_peek(array, ELEMENTS) == NULL);
+
+    segarray_destroy(array);
+}
+
+static void test_access(void)
+{
+    segarray* array = segarray_init(sizeof(uint64_t));
+    TEST_CHECK(array);
+
+    uint64_t value = 0;
+    TEST_CHECK(segarray_pop_back(array, &value) != CTOOLBOX_SUCCESS);
+    TEST_CHECK(segarray_get(array, 0, &value) != CTOOLBOX_SUCCESS);
+    TEST_CHECK(segarray_set(array, 0, &value) != CTOOLBOX_SUCCESS);
+
+    for (uint64_t i = 0; i < 40; i++) {
+        uint64_t* slot = segarray_emplace_back(array);
+        TEST_CHECK(slot);
+        *slot = i * 3;
+    }
+
+    // set and get cross segment boundaries the same way
+    for (uint64_t i = 0; i < 40; i++) {
+        uint64_t doubled = i * 6;
+        TEST_CHECK(segarray_set(array, i, &doubled) == CTOOLBOX_SUCCESS);
+    }
+    for (uint64_t i = 40; i-- > 0;) {
+        TEST_CHECK(*(uint64_t*)segarray_peek(array, i) == i * 6);
+        TEST_CHECK(segarray_pop_back(array, &value) == CTOOLBOX_SUCCESS && value == i * 6);
+    }
+    TEST_CHECK(segarray_empty(array));
+    TEST_CHECK(segarray_pop_back(array, NULL) != CTOOLBOX_SUCCESS);
+
+    segarray_destroy(array);
+}
+
+static void test_memory(void)
+{
+    ctoolbox_tracker tracker;
+    ctoolbox_tracker_init(&tracker, NULL);
+    ctoolbox_memfuncs mem = ctoolbox_tracker_memfuncs(&tracker);
+
+    segarray* array = segarray_init_memfuncs(sizeof(uint32_t), &mem);
+    TEST_CHECK(array);
+
+    TEST_CHECK(segarray_reserve(array, 1000) == CTOOLBOX_SUCCESS);
+    size_t capacity = segarray_capacity(array);
+    TEST_CHECK(capacity >= 1000);
+
+    // filling up to the reserved capacity allocates nothing more
+    uint64_t allocations = tracker.stats.allocCount;
+    for (uint32_t i = 0; i < capacity; i++) TEST_CHECK(segarray_push_back(array, &i) == CTOOLBOX_SUCCESS);
+    TEST_CHECK(tracker.stats.allocCount == allocations);
+    TEST_CHECK(tracker.stats.reallocCount == 0);
+
+    ctoolbox_memstats stats;
+    TEST_CHECK(segarray_memory_usage(array, &stats) == CTOOLBOX_SUCCESS);
+    TEST_CHECK(stats.liveBytes == tracker.stats.liveBytes);
+
+    // shrinking releases only the segments past the last element
+    while (segarray_size(array) > 20) segarray_pop_back(array, NULL);
+    TEST_CHECK(segarray_shrink_to_fit(array) == CTOOLBOX_SUCCESS);
+    TEST_CHECK(segarray_capacity(array) >= 20 && segarray_capacity(array) < capacity);
+    TEST_CHECK(segarray_memory_usage(array, &stats) == CTOOLBOX_SUCCESS);
+    TEST_CHECK(stats.liveBytes == tracker.stats.liveBytes);
+    for (uint32_t i = 0; i < 20; i++) TEST_CHECK(*(const uint32_t*)segarray_const_peek(array, i) == i);
+
+    segarray_destroy(array);
+    TEST_CHECK(tracker.stats.liveBytes == 0);
+}
+
+int main(void)
+{
+    test_stable_addresses();
+    test_access();
+    test_memory();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,166 @@
+#include "test.h"
+#include "slab.h"
+#include "darray.h"
+
+#include <string.h>
+
+static void test_size_classes(void)
+{
+    slab* s = slab_init();
+    TEST_CHECK(s);
+
+    // every size up to SLAB_MAX_OBJECT_SIZE lands in a class big enough for it, and objects don't overlap
+    void* objects[SLAB_MAX_OBJECT_SIZE + 1];
+    for (size_t size = 0; size <= SLAB_MAX_OBJECT_SIZE; size++) {
+        objects[size] = slab_alloc(s, size);
+        TEST_CHECK(objects[size]);
+        TEST_CHECK(((uintptr_t)objects[size] & 15u) == 0);
+        memset(objects[size], (int)size, size);
+    }
+    for (size_t size = 0; size <= SLAB_MAX_OBJECT_SIZE; size++) {
+        for (size_t i = 0; i < size; i++) TEST_CHECK(((unsigned char*)objects[size])[i] == (unsigned char)size);
+    }
+
+    size_t used = 0;
+    for (size_t i = 0; i < SLAB_CLASS_COUNT; i++) {
+        slab_stats stats;
+        TEST_CHECK(slab_get_stats(s, i, &stats) == CTOOLBOX_SUCCESS);
+        TEST_CHECK(stats.slabCount == (stats.usedObjects + stats.objectsPerSlab - 1) / stats.objectsPerSlab);
+        TEST_CHECK(stats.occupancy > 0.0f && stats.occupancy <= 1.0f);
+        used += stats.usedObjects;
+    }
+    TEST_CHECK(used == SLAB_MAX_OBJECT_SIZE + 1);
+
+    slab_stats stats;
+    TEST_CHECK(slab_get_stats(s, SLAB_CLASS_COUNT, &stats) == CTOOLBOX_ERROR_INVALID_PARAM);
+
+    for (size_t size = 0; size <= SLAB_MAX_OBJECT_SIZE; size++) slab_free(s, objects[size], size);
+    for (size_t i = 0; i < SLAB_CLASS_COUNT; i++) {
+        TEST_CHECK(slab_get_stats(s, i, &stats) == CTOOLBOX_SUCCESS);
+        TEST_CHECK(stats.usedObjects == 0);
+    }
+
+    slab_destroy(s);
+}
+
+static void test_reuse_and_release(void)
+{
+    slab* s = slab_init();
+    TEST_CHECK(s);
+
+    // fill several slabs of one class, then empty them: all but the last one with room are released
+    enum { COUNT = 1000 };
+    void* objects[COUNT];
+    for (size_t i = 0; i < COUNT; i++) objects[i] = slab_alloc(s, 32);
+
+    slab_stats stats;
+    slab_get_stats(s, 1, &stats);
+    TEST_CHECK(stats.usedObjects == COUNT);
+    TEST_CHECK(stats.slabCount == (COUNT + stats.objectsPerSlab - 1) / stats.objectsPerSlab);
+
+    for (size_t i = 0; i < COUNT; i++) slab_free(s, objects[i], 32);
+    slab_get_stats(s, 1, &stats);
+    TEST_CHECK(stats.usedObjects == 0);
+    TEST_CHECK(stats.slabCount == 1);
+
+    // a freed object is handed out again
+    void* first = slab_alloc(s, 32);
+    slab_free(s, first, 32);
+    TEST_CHECK(slab_alloc(s, 32) == first);
+
+    slab_destroy(s);
+}
+
+static void test_large_versus_small_free(void)
+{
+    ctoolbox_tracker tracker;
+    ctoolbox_tracker_init(&tracker, NULL);
+    ctoolbox_memfuncs tracked = ctoolbox_tracker_memfuncs(&tracker);
+
+    slab* s = slab_init_memfuncs(&tracked);
+    TEST_CHECK(s);
+    ctoolbox_memstats empty;
+    slab_memory_usage(s, &empty);
+
+    // blocks above SLAB_MAX_OBJECT_SIZE go to the memory functions with a header, the others to the slabs
+    ctoolbox_memfuncs mem = slab_memfuncs(s);
+    void* small = ctoolbox_custom_malloc(&mem, 24);
+    void* large = ctoolbox_custom_malloc(&mem, 5000);
+    void* other = ctoolbox_custom_malloc(&mem, 300);
+    TEST_CHECK(small && large && other);
+    memset(small, 1, 24);
+    memset(large, 2, 5000);
+    memset(other, 3, 300);
+
+    slab_stats stats;
+    slab_get_stats(s, 1, &stats);
+    TEST_CHECK(stats.usedObjects == 1);
+
+    // ctoolbox_custom_free passes no size, the slab has to tell the large blocks from the page objects on its own
+    ctoolbox_custom_free(&mem, large);
+    ctoolbox_custom_free(&mem, small);
+    slab_get_stats(s, 1, &stats);
+    TEST_CHECK(stats.usedObjects == 0);
+
+    // ctoolbox_custom_realloc passes no size either, the content is kept, moving a large block down into a size class and a page object up
+    other = ctoolbox_custom_realloc(&mem, other, 100);
+    TEST_CHECK(other);
+    for (size_t i = 0; i < 100; i++) TEST_CHECK(((unsigned char*)other)[i] == 3);
+    other = ctoolbox_custom_realloc(&mem, other, 1000);
+    TEST_CHECK(other);
+    for (size_t i = 0; i < 100; i++) TEST_CHECK(((unsigned char*)other)[i] == 3);
+    ctoolbox_custom_free(&mem, other);
+
+    ctoolbox_memstats memory;
+    TEST_CHECK(slab_memory_usage(s, &memory) == CTOOLBOX_SUCCESS);
+    for (size_t i = 0; i < SLAB_CLASS_COUNT; i++) {
+        slab_get_stats(s, i, &stats);
+        TEST_CHECK(stats.usedObjects == 0);
+    }
+
+    // the slab keeps no large block once they are all freed
+    size_t slabBytes = 0;
+    for (size_t i = 0; i < SLAB_CLASS_COUNT; i++) {
+        slab_get_stats(s, i, &stats);
+        slabBytes += stats.slabCount * SLAB_PAGE_SIZE;
+    }
+    TEST_CHECK(memory.liveBytes == empty.liveBytes + slabBytes);
+
+    slab_destroy(s);
+    TEST_CHECK(tracker.stats.liveBytes == 0);
+}
+
+static void test_container_on_slab(void)
+{
+    slab* s = slab_init();
+    ctoolbox_memfuncs mem = slab_memfuncs(s);
+
+    // the array grows from page objects into large blocks and back through shrink_to_fit
+    darray* array = darray_init_memfuncs(sizeof(int), 1, &mem);
+    TEST_CHECK(array);
+    for (int i = 0; i < 1000; i++) TEST_CHECK(darray_push_back(array, &i) == CTOOLBOX_SUCCESS);
+    for (int i = 0; i < 1000; i++) {
+        int value;
+        TEST_CHECK(darray_get(array, (size_t)i, &value) == CTOOLBOX_SUCCESS);
+        TEST_CHECK(value == i);
+    }
+    TEST_CHECK(darray_resize(array, 4) == CTOOLBOX_SUCCESS);
+    TEST_CHECK(darray_shrink_to_fit(array) == CTOOLBOX_SUCCESS);
+    darray_destroy(array);
+
+    slab_stats stats;
+    for (size_t i = 0; i < SLAB_CLASS_COUNT; i++) {
+        slab_get_stats(s, i, &stats);
+        TEST_CHECK(stats.usedObjects == 0);
+    }
+    slab_destroy(s);
+}
+
+int main(void)
+{
+    test_size_classes();
+    test_reuse_and_release();
+    test_large_versus_small_free();
+    test_container_on_slab();
+    return EXIT_SUCCESS;
+}
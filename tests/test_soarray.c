@@ -0,0 +1,191 @@
+#include "test.h"
+#include "soarray.h"
+
+#include <string.h>
+
+// odd column sizes on purpose, every column must keep its own stride and alignment
+static const size_t COLUMN_SIZES[] = { sizeof(uint8_t), sizeof(uint64_t), 12 };
+enum { COLUMNS = 3, ROWS = 1000 };
+
+typedef struct wide
+{
+    unsigned char bytes[12];
+} wide;
+
+static void make_row(uint32_t i, uint8_t* a, uint64_t* b, wide* c)
+{
+    *a = (uint8_t)i;
+    *b = (uint64_t)i * 1000003u;
+    memset(c->bytes, (int)(i % 251), sizeof(c->bytes));
+}
+
+static void check_row(const soarray* array, size_t index, uint32_t i)
+{
+    uint8_t a, expectedA;
+    uint64_t b, expectedB;
+    wide c, expectedC;
+    make_row(i, &expectedA, &expectedB, &expectedC);
+
+    void* fields[COLUMNS] = { &a, &b, &c };
+    TEST_CHECK(soarray_get(array, index, fields) == CTOOLBOX_SUCCESS);
+    TEST_CHECK(a == expectedA && b == expectedB && memcmp(&c, &expectedC, sizeof(c)) == 0);
+}
+
+static void test_columns(void)
+{
+    ctoolbox_tracker tracker;
+    ctoolbox_tracker_init(&tracker, NULL);
+    ctoolbox_memfuncs mem = ctoolbox_tracker_memfuncs(&tracker);
+
+    soarray* array = soarray_init_memfuncs(COLUMN_SIZES, COLUMNS, 4, &mem);
+    TEST_CHECK(array);
+    TEST_CHECK(soarray_empty(array));
+    TEST_CHECK(soarray_column_count(array) == COLUMNS);
+    for (size_t i = 0; i < COLUMNS; i++) TEST_CHECK(soarray_column_size(array, i) == COLUMN_SIZES[i]);
+    TEST_CHECK(soarray_column_size(array, COLUMNS) == 0);
+
+    for (uint32_t i = 0; i < ROWS; i++) {
+        uint8_t a;
+        uint64_t b;
+        wide c;
+        make_row(i, &a, &b, &c);
+        const void* fields[COLUMNS] = { &a, &b, &c };
+        TEST_CHECK(soarray_push_back(array, fields) == CTOOLBOX_SUCCESS);
+    }
+
+    // every column grows with the others, one size and one capacity for all of them
+    TEST_CHECK(soarray_size(array) == ROWS);
+    TEST_CHECK(soarray_capacity(array) >= ROWS);
+
+    // each column is contiguous and aligned for its own element type
+    const uint8_t* as = soarray_const_column(array, 0);
+    const uint64_t* bs = soarray_const_column(array, 1);
+    const wide* cs = soarray_const_column(array, 2);
+    TEST_CHECK(as && bs && cs);
+    TEST_CHECK((uintptr_t)bs % sizeof(uint64_t) == 0);
+    TEST_CHECK(soarray_const_column(array, COLUMNS) == NULL);
+    for (uint32_t i = 0; i < ROWS; i++) {
+        TEST_CHECK(as[i] == (uint8_t)i && bs[i] == (uint64_t)i * 1000003u && cs[i].bytes[11] == i % 251);
+        TEST_CHECK(soarray_const_peek(array, 1, i) == &bs[i]);
+    }
+    TEST_CHECK(soarray_const_peek(array, 0, ROWS) == NULL);
+    TEST_CHECK(soarray_const_peek(array, COLUMNS, 0) == NULL);
+
+    ctoolbox_memstats stats;
+    TEST_CHECK(soarray_memory_usage(array, &stats) == CTOOLBOX_SUCCESS);
+    TEST_CHECK(stats.liveBytes == tracker.stats.liveBytes);
+
+    // shrinking keeps every column's content
+    TEST_CHECK(soarray_shrink_to_fit(array) == CTOOLBOX_SUCCESS);
+    TEST_CHECK(soarray_capacity(array) == ROWS);
+    for (uint32_t i = 0; i < ROWS; i += 37) check_row(array, i, i);
+
+    soarray_destroy(array);
+    TEST_CHECK(tracker.stats.liveBytes == 0);
+}
+
+static void test_rows(void)
+{
+    soarray* array = soarray_init(COLUMN_SIZES, COLUMNS, 0);
+    TEST_CHECK(array);
+
+    // a NULL fields zero-fills the row, a NULL field zero-fills only its column
+    TEST_CHECK(soarray_push_back(array, NULL) == CTOOLBOX_SUCCESS);
+    uint64_t b = 7;
+    const void* partial[COLUMNS] = { NULL, &b, NULL };
+    TEST_CHECK(soarray_push_back(array, partial) == CTOOLBOX_SUCCESS);
+    TEST_CHECK(*(const uint8_t*)soarray_const_peek(array, 0, 0) == 0);
+    TEST_CHECK(*(const uint64_t*)soarray_const_peek(array, 1, 0) == 0);
+    TEST_CHECK(*(const uint64_t*)soarray_const_peek(array, 1, 1) == 7);
+    TEST_CHECK(((const wide*)soarray_const_peek(array, 2, 1))->bytes[0] == 0);
+
+    // emplaced rows are written in place through the columns
+    size_t index = 0;
+    TEST_CHECK(soarray_emplace_back(array, &index) == CTOOLBOX_SUCCESS && index == 2);
+    uint8_t a;
+    wide c;
+    make_row(2, &a, &b, &c);
+    *(uint8_t*)soarray_peek(array, 0, 2) = a;
+    ((uint64_t*)soarray_column(array, 1))[2] = b;
+    *(wide*)soarray_peek(array, 2, 2) = c;
+    check_row(array, 2, 2);
+
+    // set skips NULL entries
+    for (uint32_t i = 0; i < 2; i++) {
+        make_row(i, &a, &b, &c);
+        const void* fields[COLUMNS] = { &a, &b, &c };
+        TEST_CHECK(soarray_set(array, i, fields) == CTOOLBOX_SUCCESS);
+    }
+    uint64_t marker = 0xfeed;
+    const void* only[COLUMNS] = { NULL, &marker, NULL };
+    TEST_CHECK(soarray_set(array, 1, only) == CTOOLBOX_SUCCESS);
+    TEST_CHECK(*(const uint8_t*)soarray_const_peek(array, 0, 1) == 1);
+    TEST_CHECK(*(const uint64_t*)soarray_const_peek(array, 1, 1) == marker);
+    TEST_CHECK(soarray_set(array, 3, only) != CTOOLBOX_SUCCESS);
+    make_row(1, &a, &b, &c);
+    const void* restore[COLUMNS] = { NULL, &b, NULL };
+    soarray_set(array, 1, restore);
+
+    // swap_remove moves the last row into the hole across all columns
+    for (uint32_t i = 3; i < 10; i++) {
+        make_row(i, &a, &b, &c);
+        const void* fields[COLUMNS] = { &a, &b, &c };
+        TEST_CHECK(soarray_push_back(array, fields) == CTOOLBOX_SUCCESS);
+    }
+    TEST_CHECK(soarray_swap_remove(array, 4) == CTOOLBOX_SUCCESS);
+    TEST_CHECK(soarray_size(array) == 9);
+    check_row(array, 4, 9);
+    check_row(array, 8, 8);
+    TEST_CHECK(soarray_swap_remove(array, 9) != CTOOLBOX_SUCCESS);
+
+    // pop_back hands back the last row, fieldsOut entries may be NULL
+    uint8_t poppedA = 0;
+    wide poppedC;
+    void* out[COLUMNS] = { &poppedA, NULL, &poppedC };
+    TEST_CHECK(soarray_pop_back(array, out) == CTOOLBOX_SUCCESS);
+    make_row(8, &a, &b, &c);
+    TEST_CHECK(poppedA == a && memcmp(&poppedC, &c, sizeof(c)) == 0);
+    TEST_CHECK(soarray_size(array) == 8);
+
+    // resize changes every column together, the rows kept are untouched
+    TEST_CHECK(soarray_resize(array, 100) == CTOOLBOX_SUCCESS);
+    TEST_CHECK(soarray_size(array) == 100 && soarray_capacity(array) >= 100);
+    check_row(array, 4, 9);
+    TEST_CHECK(soarray_resize(array, 3) == CTOOLBOX_SUCCESS);
+    for (uint32_t i = 0; i < 3; i++) check_row(array, i, i);
+    while (!soarray_empty(array)) TEST_CHECK(soarray_pop_back(array, NULL) == CTOOLBOX_SUCCESS);
+    TEST_CHECK(soarray_pop_back(array, NULL) != CTOOLBOX_SUCCESS);
+
+    soarray_destroy(array);
+}
+
+static void test_reserve(void)
+{
+    ctoolbox_tracker tracker;
+    ctoolbox_tracker_init(&tracker, NULL);
+    ctoolbox_memfuncs mem = ctoolbox_tracker_memfuncs(&tracker);
+
+    soarray* array = soarray_init_memfuncs(COLUMN_SIZES, COLUMNS, 0, &mem);
+    TEST_CHECK(array);
+
+    // all the columns live in one block, reserving them is a single allocation
+    uint64_t allocations = tracker.stats.allocCount + tracker.stats.reallocCount;
+    TEST_CHECK(soarray_reserve(array, 500) == CTOOLBOX_SUCCESS);
+    TEST_CHECK(tracker.stats.allocCount + tracker.stats.reallocCount == allocations + 1);
+    TEST_CHECK(soarray_capacity(array) >= 500);
+
+    allocations = tracker.stats.allocCount + tracker.stats.reallocCount;
+    for (uint32_t i = 0; i < 500; i++) TEST_CHECK(soarray_push_back(array, NULL) == CTOOLBOX_SUCCESS);
+    TEST_CHECK(tracker.stats.allocCount + tracker.stats.reallocCount == allocations);
+
+    soarray_destroy(array);
+    TEST_CHECK(tracker.stats.liveBytes == 0);
+}
+
+int main(void)
+{
+    test_columns();
+    test_rows();
+    test_reserve();
+    return EXIT_SUCCESS;
+}
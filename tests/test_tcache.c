@@ -0,0 +1,165 @@
+#include "test.h"
+#include "tcache.h"
+#include "cthread.h"
+
+#include <string.h>
+
+static void test_reuse(void)
+{
+    tcache* cache = tcache_init();
+    TEST_CHECK(cache);
+
+    // a freed block is the next one handed out for its class
+    void* block = tcache_alloc(cache, 100);
+    TEST_CHECK(block);
+    memset(block, 0xab, 100);
+    tcache_free(cache, block, 100);
+    TEST_CHECK(tcache_alloc(cache, 128) == block);
+    tcache_free(cache, block, 128);
+
+    // bigger blocks go straight to the memory functions
+    void* big = tcache_alloc(cache, TCACHE_MAX_BLOCK_SIZE + 1);
+    TEST_CHECK(big);
+    memset(big, 0xcd, TCACHE_MAX_BLOCK_SIZE + 1);
+    tcache_free(cache, big, TCACHE_MAX_BLOCK_SIZE + 1);
+
+    tcache_destroy(cache);
+}
+
+static void test_many_caches(void)
+{
+    // more caches than a thread remembers at once, each one accounted by its own tracker
+    enum { CACHES = 6, BLOCKS = 8 };
+    ctoolbox_tracker trackers[CACHES];
+    ctoolbox_memfuncs mem[CACHES];
+    tcache* caches[CACHES];
+    for (size_t i = 0; i < CACHES; i++) {
+        ctoolbox_tracker_init(&trackers[i], NULL);
+        mem[i] = ctoolbox_tracker_memfuncs(&trackers[i]);
+        caches[i] = tcache_init_memfuncs(&mem[i]);
+        TEST_CHECK(caches[i]);
+    }
+
+    ctoolbox_memstats settled[CACHES];
+    for (size_t round = 0; round < 1000; round++) {
+        for (size_t i = 0; i < CACHES; i++) {
+            void* blocks[BLOCKS];
+            for (size_t j = 0; j < BLOCKS; j++) blocks[j] = tcache_alloc(caches[i], 64);
+            for (size_t j = 0; j < BLOCKS; j++) tcache_free(caches[i], blocks[j], 64);
+        }
+
+        // the thread finds its bins again instead of making new ones, and takes its blocks back from the shared pool
+        if (round == 10) {
+            for (size_t i = 0; i < CACHES; i++) settled[i] = trackers[i].stats;
+        }
+    }
+
+    for (size_t i = 0; i < CACHES; i++) {
+        TEST_CHECK(trackers[i].stats.liveBytes == settled[i].liveBytes);
+        TEST_CHECK(trackers[i].stats.allocCount == settled[i].allocCount);
+        tcache_destroy(caches[i]);
+        TEST_CHECK(trackers[i].stats.liveBytes == 0);
+    }
+}
+
+typedef struct churn_context
+{
+    tcache* cache;
+    size_t blocks;
+} churn_context;
+
+static void churn_main(void* arg)
+{
+    churn_context* context = arg;
+    void* blocks[256];
+    for (size_t i = 0; i < context->blocks; i++) {
+        blocks[i] = tcache_alloc(context->cache, 64);
+        TEST_CHECK(blocks[i]);
+        memset(blocks[i], (int)i, 64);
+    }
+    for (size_t i = 0; i < context->blocks; i++) tcache_free(context->cache, blocks[i], 64);
+}
+
+static void test_thread_churn(void)
+{
+    ctoolbox_tracker tracker;
+    ctoolbox_tracker_init(&tracker, NULL);
+    ctoolbox_memfuncs mem = ctoolbox_tracker_memfuncs(&tracker);
+    tcache* cache = tcache_init_memfuncs(&mem);
+    TEST_CHECK(cache);
+
+    // one thread after another, each exit hands its bins and blocks over to the next thread
+    churn_context context = { cache, 200 };
+    ctoolbox_memstats first = { 0 };
+    for (size_t i = 0; i < 50; i++) {
+        cthread_thread thread;
+        TEST_CHECK(cthread_create(&thread, churn_main, &context));
+        cthread_join(&thread);
+        if (i == 0) first = tracker.stats;
+    }
+    TEST_CHECK(tracker.stats.liveBytes == first.liveBytes);
+    TEST_CHECK(tracker.stats.allocCount == first.allocCount);
+
+    tcache_destroy(cache);
+    TEST_CHECK(tracker.stats.liveBytes == 0);
+}
+
+typedef struct stress_context
+{
+    tcache* cache;
+    size_t seed;
+} stress_context;
+
+static void stress_main(void* arg)
+{
+    stress_context* context = arg;
+    ctoolbox_memfuncs mem = tcache_memfuncs(context->cache);
+    enum { LIVE = 128 };
+    unsigned char* blocks[LIVE] = { 0 };
+    size_t sizes[LIVE] = { 0 };
+    size_t state = context->seed;
+
+    for (size_t i = 0; i < 20000; i++) {
+        state = state * 6364136223846793005u + 1442695040888963407u;
+        size_t slot = (state >> 33) % LIVE;
+        if (blocks[slot]) {
+            for (size_t j = 0; j < sizes[slot]; j++) TEST_CHECK(blocks[slot][j] == (unsigned char)(slot + context->seed));
+            ctoolbox_custom_free_sized(&mem, blocks[slot], sizes[slot]);
+            blocks[slot] = NULL;
+        }
+        else {
+            sizes[slot] = 1 + (state >> 40) % (TCACHE_MAX_BLOCK_SIZE + 512);
+            blocks[slot] = ctoolbox_custom_malloc(&mem, sizes[slot]);
+            TEST_CHECK(blocks[slot]);
+            memset(blocks[slot], (int)(slot + context->seed), sizes[slot]);
+        }
+    }
+    for (size_t i = 0; i < LIVE; i++) ctoolbox_custom_free_sized(&mem, blocks[i], sizes[i]);
+}
+
+static void test_concurrent(void)
+{
+    tcache* cache = tcache_init();
+    TEST_CHECK(cache);
+
+    enum { THREADS = 4 };
+    cthread_thread threads[THREADS];
+    stress_context contexts[THREADS];
+    for (size_t i = 0; i < THREADS; i++) {
+        contexts[i].cache = cache;
+        contexts[i].seed = i + 1;
+        TEST_CHECK(cthread_create(&threads[i], stress_main, &contexts[i]));
+    }
+    for (size_t i = 0; i < THREADS; i++) cthread_join(&threads[i]);
+
+    tcache_destroy(cache);
+}
+
+int main(void)
+{
+    test_reuse();
+    test_many_caches();
+    test_thread_churn();
+    test_concurrent();
+    return EXIT_SUCCESS;
+}
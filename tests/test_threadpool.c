@@ -0,0 +1,107 @@
+#include "test.h"
+#include "threadpool.h"
+
+#include <string.h>
+
+typedef struct visit_context
+{
+    unsigned char* hits;
+    threadpool* pool;
+} visit_context;
+
+static ctoolbox_result visit_range(void* context, size_t begin, size_t end)
+{
+    visit_context* ctx = context;
+    for (size_t i = begin; i < end; i++) ctx->hits[i]++;
+    return CTOOLBOX_SUCCESS;
+}
+
+// every range starts a parallel call of its own over a slice of the hits
+static ctoolbox_result nested_range(void* context, size_t begin, size_t end)
+{
+    visit_context* ctx = context;
+    for (size_t i = begin; i < end; i++) {
+        visit_context inner = { ctx->hits + i * 1000, NULL };
+        ctoolbox_result res = threadpool_parallel_for(ctx->pool, 1000, 10, visit_range, &inner);
+        if (res != CTOOLBOX_SUCCESS) return res;
+    }
+    return CTOOLBOX_SUCCESS;
+}
+
+// visits like visit_range but fails the range holding the index 500
+static ctoolbox_result failing_range(void* context, size_t begin, size_t end)
+{
+    if (begin <= 500 && 500 < end) return CTOOLBOX_ERROR_FULL;
+    return visit_range(context, begin, end);
+}
+
+static void test_parallel_for(void)
+{
+    ctoolbox_tracker tracker;
+    ctoolbox_tracker_init(&tracker, NULL);
+    ctoolbox_memfuncs mem = ctoolbox_tracker_memfuncs(&tracker);
+    threadpool* pool = threadpool_init_memfuncs(3, &mem);
+    TEST_CHECK(pool);
+    TEST_CHECK(threadpool_thread_count(pool) == 4);
+
+    // every index is visited exactly once, whatever the grain
+    enum { COUNT = 100000 };
+    unsigned char* hits = malloc(COUNT);
+    static const size_t grains[] = { 0, 1, 7, 64, COUNT, COUNT * 2 };
+    for (size_t g = 0; g < sizeof(grains) / sizeof(grains[0]); g++) {
+        memset(hits, 0, COUNT);
+        visit_context context = { hits, pool };
+        TEST_CHECK(threadpool_parallel_for(pool, COUNT, grains[g], visit_range, &context) == CTOOLBOX_SUCCESS);
+        for (size_t i = 0; i < COUNT; i++) TEST_CHECK(hits[i] == 1);
+    }
+
+    // ranges may call back into the pool
+    memset(hits, 0, COUNT);
+    visit_context context = { hits, pool };
+    TEST_CHECK(threadpool_parallel_for(pool, COUNT / 1000, 1, nested_range, &context) == CTOOLBOX_SUCCESS);
+    for (size_t i = 0; i < COUNT; i++) TEST_CHECK(hits[i] == 1);
+
+    // a failing range is reported, the ranges not started by then are skipped
+    memset(hits, 0, COUNT);
+    TEST_CHECK(threadpool_parallel_for(pool, COUNT, 10, failing_range, &context) == CTOOLBOX_ERROR_FULL);
+    for (size_t i = 0; i < COUNT; i++) TEST_CHECK(hits[i] <= 1);
+    TEST_CHECK(hits[500] == 0);
+    TEST_CHECK(threadpool_parallel_for(pool, 100, 1000, failing_range, &context) == CTOOLBOX_SUCCESS);
+    TEST_CHECK(threadpool_parallel_for(pool, 1000, 1000, failing_range, &context) == CTOOLBOX_ERROR_FULL);
+
+    TEST_CHECK(threadpool_parallel_for(pool, 0, 1, visit_range, &context) == CTOOLBOX_SUCCESS);
+    TEST_CHECK(threadpool_parallel_for(NULL, COUNT, 1, visit_range, &context) == CTOOLBOX_ERROR_INVALID_PARAM);
+    TEST_CHECK(threadpool_parallel_for(pool, COUNT, 1, NULL, &context) == CTOOLBOX_ERROR_INVALID_PARAM);
+
+    ctoolbox_memstats stats;
+    TEST_CHECK(threadpool_memory_usage(pool, &stats) == CTOOLBOX_SUCCESS);
+    TEST_CHECK(stats.liveBytes == tracker.stats.liveBytes);
+    threadpool_destroy(pool);
+    TEST_CHECK(tracker.stats.liveBytes == 0);
+    free(hits);
+}
+
+static void test_single_thread(void)
+{
+    // the calling thread counts as one of the pool's threads, with 0 workers on a single processor
+    threadpool* pool = threadpool_init(1);
+    TEST_CHECK(pool);
+    TEST_CHECK(threadpool_thread_count(pool) == 2);
+    threadpool_destroy(pool);
+
+    pool = threadpool_init(0);
+    TEST_CHECK(pool && threadpool_thread_count(pool) >= 1);
+
+    unsigned char hits[1000] = { 0 };
+    visit_context context = { hits, pool };
+    TEST_CHECK(threadpool_parallel_for(pool, 1000, 3, visit_range, &context) == CTOOLBOX_SUCCESS);
+    for (size_t i = 0; i < 1000; i++) TEST_CHECK(hits[i] == 1);
+    threadpool_destroy(pool);
+}
+
+int main(void)
+{
+    test_parallel_for();
+    test_single_thread();
+    return EXIT_SUCCESS;
+}
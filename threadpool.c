@@ -0,0 +1,265 @@
+#include "threadpool.h"
+#include "cthread.h"
+
+#include <string.h>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// internal
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// a parallel call, lives on its caller's stack until remaining drops to 0
+typedef struct threadpool_job
+{
+    threadpool_range_func func;
+    void* context;
+    size_t grain;
+    volatile uint64_t remaining;    // indices not processed yet
+    volatile uint64_t result;       // first failure a range reported, CTOOLBOX_SUCCESS until then
+} threadpool_job;
+
+typedef struct threadpool_task
+{
+    threadpool_job* job;
+    size_t begin;
+    size_t end;
+} threadpool_task;
+
+// the owner pushes and pops at the back, thieves take the oldest and biggest ranges at the front
+typedef struct threadpool_queue
+{
+    cthread_mutex lock;
+    size_t head;
+    size_t count;
+    threadpool_task tasks[THREADPOOL_QUEUE_CAPACITY];
+} threadpool_queue;
+
+typedef struct threadpool_worker
+{
+    threadpool* pool;
+    size_t index;
+    cthread_thread thread;
+} threadpool_worker;
+
+// one queue per worker, the last one is shared by the threads calling threadpool_parallel_for
+struct threadpool
+{
+    threadpool_queue* queues;
+    threadpool_worker* workers;
+    size_t workerCount;
+    volatile uint64_t pending;      // tasks sitting in the queues
+    cthread_mutex lock;             // guards stop, taken before waking workers so none misses a push
+    cthread_cond wake;
+    bool stop;
+    ctoolbox_memfuncs memfuncs;
+    ctoolbox_memstats stats;
+};
+
+static bool threadpool_push(threadpool* pool, size_t queueIndex, threadpool_task task)
+{
+    threadpool_queue* queue = &pool->queues[queueIndex];
+
+    cthread_mutex_lock(&queue->lock);
+    bool pushed = queue->count < THREADPOOL_QUEUE_CAPACITY;
+    if (pushed) queue->tasks[(queue->head + queue->count++) % THREADPOOL_QUEUE_CAPACITY] = task;
+    cthread_mutex_unlock(&queue->lock);
+    if (!pushed) return false;
+
+    cthread_atomic_increment(&pool->pending);
+    cthread_mutex_lock(&pool->lock);
+    cthread_cond_signal(&pool->wake);
+    cthread_mutex_unlock(&pool->lock);
+    return true;
+}
+
+static bool threadpool_pop(threadpool_queue* queue, bool back, threadpool_task* taskOut)
+{
+    cthread_mutex_lock(&queue->lock);
+    bool popped = queue->count > 0;
+    if (popped && back) {
+        *taskOut = queue->tasks[(queue->head + --queue->count) % THREADPOOL_QUEUE_CAPACITY];
+    }
+    else if (popped) {
+        *taskOut = queue->tasks[queue->head];
+        queue->head = (queue->head + 1) % THREADPOOL_QUEUE_CAPACITY;
+        queue->count--;
+    }
+    cthread_mutex_unlock(&queue->lock);
+    return popped;
+}
+
+// takes from the thread's own queue first, then steals from the others in turn
+static bool threadpool_take(threadpool* pool, size_t queueIndex, threadpool_task* taskOut)
+{
+    if (cthread_atomic_load(&pool->pending) == 0) return false;
+
+    size_t queueCount = pool->workerCount + 1;
+    for (size_t i = 0; i < queueCount; i++) {
+        if (threadpool_pop(&pool->queues[(queueIndex + i) % queueCount], i > 0, taskOut)) {
+            cthread_atomic_fetch_add(&pool->pending, (uint64_t)0 - 1);
+            return true;
+        }
+    }
+    return false;
+}
+
+// keeps halving the range, leaving the back halves to be stolen, then processes what is left
+static void threadpool_run(threadpool* pool, size_t queueIndex, threadpool_task task)
+{
+    threadpool_job* job = task.job;
+    while (task.end - task.begin > job->grain) {
+        size_t middle = task.begin + (task.end - task.begin) / 2;
+        threadpool_task back = { job, middle, task.end };
+        if (!threadpool_push(pool, queueIndex, back)) break;
+        task.end = middle;
+    }
+
+    // once a range failed the rest of the job is only counted down
+    if (cthread_atomic_load(&job->result) == CTOOLBOX_SUCCESS) {
+        ctoolbox_result res = job->func(job->context, task.begin, task.end);
+        uint64_t expected = CTOOLBOX_SUCCESS;
+        if (res != CTOOLBOX_SUCCESS) cthread_atomic_compare_exchange(&job->result, &expected, (uint64_t)res);
+    }
+
+    // the job may be gone as soon as this reaches 0
+    cthread_atomic_fetch_add(&job->remaining, (uint64_t)0 - (task.end - task.begin));
+}
+
+static void threadpool_worker_main(void* arg)
+{
+    threadpool_worker* worker = arg;
+    threadpool* pool = worker->pool;
+
+    for (;;) {
+        threadpool_task task;
+        if (threadpool_take(pool, worker->index, &task)) {
+            threadpool_run(pool, worker->index, task);
+            continue;
+        }
+
+        cthread_mutex_lock(&pool->lock);
+        while (!pool->stop && cthread_atomic_load(&pool->pending) == 0) cthread_cond_wait(&pool->wake, &pool->lock);
+        bool stop = pool->stop;
+        cthread_mutex_unlock(&pool->lock);
+        if (stop) return;
+    }
+}
+
+static void threadpool_release(threadpool* pool, size_t startedCount)
+{
+    cthread_mutex_lock(&pool->lock);
+    pool->stop = true;
+    cthread_cond_broadcast(&pool->wake);
+    cthread_mutex_unlock(&pool->lock);
+
+    for (size_t i = 0; i < startedCount; i++) cthread_join(&pool->workers[i].thread);
+    for (size_t i = 0; i <= pool->workerCount; i++) cthread_mutex_destroy(&pool->queues[i].lock);
+
+    cthread_cond_destroy(&pool->wake);
+    cthread_mutex_destroy(&pool->lock);
+    ctoolbox_custom_free_sized(&pool->memfuncs, pool->workers, pool->workerCount * sizeof(threadpool_worker));
+    ctoolbox_custom_free_sized(&pool->memfuncs, pool->queues, (pool->workerCount + 1) * sizeof(threadpool_queue));
+    ctoolbox_custom_free_sized(&pool->memfuncs, pool, sizeof(threadpool));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// external
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+CTOOLBOX_API threadpool* threadpool_init(size_t threadCount)
+{
+    return threadpool_init_memfuncs(threadCount, &CTOOLBOX_DEFAULT_MEMFUNCS);
+}
+
+CTOOLBOX_API threadpool* threadpool_init_memfuncs(size_t threadCount, const ctoolbox_memfuncs* memfuncs)
+{
+    if (threadCount == 0) threadCount = cthread_hardware_concurrency() - 1;
+    if (threadCount > SIZE_MAX / sizeof(threadpool_queue) - 1) return NULL;
+
+    threadpool* outPool = ctoolbox_custom_malloc(memfuncs ? memfuncs : &CTOOLBOX_DEFAULT_MEMFUNCS, sizeof(threadpool));
+    if (!outPool) return NULL;
+
+    memset(outPool, 0, sizeof(threadpool));
+    outPool->workerCount = threadCount;
+
+    if (memfuncs) outPool->memfuncs = *memfuncs;
+    else outPool->memfuncs = CTOOLBOX_DEFAULT_MEMFUNCS;
+
+    size_t queueBytes = (threadCount + 1) * sizeof(threadpool_queue);
+    size_t workerBytes = threadCount * sizeof(threadpool_worker);
+    outPool->queues = ctoolbox_custom_malloc(&outPool->memfuncs, queueBytes);
+    outPool->workers = workerBytes ? ctoolbox_custom_malloc(&outPool->memfuncs, workerBytes) : NULL;
+    if (!outPool->queues || (workerBytes && !outPool->workers)) {
+        ctoolbox_custom_free_sized(&outPool->memfuncs, outPool->queues, queueBytes);
+        ctoolbox_custom_free_sized(&outPool->memfuncs, outPool->workers, workerBytes);
+        ctoolbox_custom_free_sized(&outPool->memfuncs, outPool, sizeof(threadpool));
+        return NULL;
+    }
+
+    ctoolbox_memstats_on_alloc(&outPool->stats, sizeof(threadpool));
+    ctoolbox_memstats_on_alloc(&outPool->stats, queueBytes);
+    if (workerBytes) ctoolbox_memstats_on_alloc(&outPool->stats, workerBytes);
+
+    cthread_mutex_init(&outPool->lock);
+    cthread_cond_init(&outPool->wake);
+    for (size_t i = 0; i <= threadCount; i++) {
+        outPool->queues[i].head = 0;
+        outPool->queues[i].count = 0;
+        cthread_mutex_init(&outPool->queues[i].lock);
+    }
+
+    for (size_t i = 0; i < threadCount; i++) {
+        outPool->workers[i].pool = outPool;
+        outPool->workers[i].index = i;
+        if (!cthread_create(&outPool->workers[i].thread, threadpool_worker_main, &outPool->workers[i])) {
+            threadpool_release(outPool, i);
+            return NULL;
+        }
+    }
+
+    return outPool;
+}
+
+CTOOLBOX_API void threadpool_destroy(threadpool* pool)
+{
+    if (!pool) return;
+    threadpool_release(pool, pool->workerCount);
+}
+
+CTOOLBOX_API size_t threadpool_thread_count(const threadpool* pool)
+{
+    return pool ? pool->workerCount + 1 : 0;
+}
+
+CTOOLBOX_API ctoolbox_result threadpool_parallel_for(threadpool* pool, size_t count, size_t grain, threadpool_range_func func, void* context)
+{
+    if (!pool || !func) return CTOOLBOX_ERROR_INVALID_PARAM;
+    if (count == 0) return CTOOLBOX_SUCCESS;
+    if (grain == 0) grain = 1;
+
+    if (pool->workerCount == 0 || count <= grain) return func(context, 0, count);
+
+    threadpool_job job;
+    job.func = func;
+    job.context = context;
+    job.grain = grain;
+    job.remaining = count;
+    job.result = CTOOLBOX_SUCCESS;
+
+    size_t queueIndex = pool->workerCount;
+    threadpool_task task = { &job, 0, count };
+    threadpool_run(pool, queueIndex, task);
+
+    // help with whatever is pending, this job's ranges or another caller's, until every range is done
+    while (cthread_atomic_load(&job.remaining) != 0) {
+        if (threadpool_take(pool, queueIndex, &task)) threadpool_run(pool, queueIndex, task);
+        else cthread_yield();
+    }
+    return (ctoolbox_result)cthread_atomic_load(&job.result);
+}
+
+CTOOLBOX_API ctoolbox_result threadpool_memory_usage(const threadpool* pool, ctoolbox_memstats* statsOut)
+{
+    if (!pool || !statsOut) return CTOOLBOX_ERROR_INVALID_PARAM;
+    *statsOut = pool->stats;
+    return CTOOLBOX_SUCCESS;
+}
@@ -0,0 +1,49 @@
+#ifndef THREADPOOL_INCLUDED
+#define THREADPOOL_INCLUDED
+
+#include "context.h"
+
+/// @brief tasks each queue holds, splits that don't fit run on the thread that made them
+#ifndef THREADPOOL_QUEUE_CAPACITY
+    #define THREADPOOL_QUEUE_CAPACITY 256
+#endif
+
+/// @brief opaque work-stealing thread pool structure
+typedef struct threadpool threadpool;
+
+/// @brief processes the indices in [begin, end), context is passed through untouched, anything but CTOOLBOX_SUCCESS fails the call
+typedef ctoolbox_result (*threadpool_range_func)(void* context, size_t begin, size_t end);
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// functions
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// @brief initializes the thread pool with threadCount workers, one less than the logical processors if 0 since callers help
+CTOOLBOX_API threadpool* threadpool_init(size_t threadCount);
+
+/// @brief initializes the thread pool with custom memory allocation functions
+CTOOLBOX_API threadpool* threadpool_init_memfuncs(size_t threadCount, const ctoolbox_memfuncs* memfuncs);
+
+/// @brief stops and joins the workers, no parallel call may be running
+CTOOLBOX_API void threadpool_destroy(threadpool* pool);
+
+/// @brief returns how many threads run a parallel call, the workers and the calling thread
+CTOOLBOX_API size_t threadpool_thread_count(const threadpool* pool);
+
+/// @brief calls func over [0, count) split in ranges of at most grain indices, returning once every range is done
+/// @brief idle workers steal the biggest pending ranges, the calling thread works too, any thread may call it
+/// @brief returns the first failure a range reported, the ranges not started by then are skipped
+CTOOLBOX_API ctoolbox_result threadpool_parallel_for(threadpool* pool, size_t count, size_t grain, threadpool_range_func func, void* context);
+
+/// @brief returns the memory the thread pool allocated, its header included
+CTOOLBOX_API ctoolbox_result threadpool_memory_usage(const threadpool* pool, ctoolbox_memstats* statsOut);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // THREADPOOL_INCLUDED
@@ -46,10 +46,18 @@ void fun_create_header(void)
         "#include <stdbool.h>\n\n"
     };
 
-    content_node_t context; context.start = 7; context.end = 78; context.filePath = "../context.h";
-    content_node_t darray; darray.start = 5; darray.end = 71; darray.filePath = "../darray.h";
-    content_node_t idgen; idgen.start = 5; idgen.end = 39; idgen.filePath = "../idgen.h";
-    content_node_t shashtable; shashtable.start = 5; shashtable.end = 52; shashtable.filePath = "../shashtable.h";
+    content_node_t context; context.start = 7; context.end = 153; context.filePath = "../context.h";
+    content_node_t arena; arena.start = 5; arena.end = 67; arena.filePath = "../arena.h";
+    content_node_t slab; slab.start = 5; slab.end = 64; slab.filePath = "../slab.h";
+    content_node_t tcache; tcache.start = 5; tcache.end = 56; tcache.filePath = "../tcache.h";
+    content_node_t threadpool; threadpool.start = 5; threadpool.end = 48; threadpool.filePath = "../threadpool.h";
+    content_node_t darray; darray.start = 5; darray.end = 400; darray.filePath = "../darray.h";
+    content_node_t segarray; segarray.start = 5; segarray.end = 73; segarray.filePath = "../segarray.h";
+    content_node_t deque; deque.start = 5; deque.end = 77; deque.filePath = "../deque.h";
+    content_node_t cdarray; cdarray.start = 5; cdarray.end = 61; cdarray.filePath = "../cdarray.h";
+    content_node_t soarray; soarray.start = 5; soarray.end = 91; soarray.filePath = "../soarray.h";
+    content_node_t idgen; idgen.start = 5; idgen.end = 122; idgen.filePath = "../idgen.h";
+    content_node_t shashtable; shashtable.start = 5; shashtable.end = 55; shashtable.filePath = "../shashtable.h";
 
     char footer[] = 
     {
@@ -67,9 +75,33 @@ void fun_create_header(void)
     fprintf(outputFile, "%s", SEPARATOR("Context"));
     fprintf_content_node(&context, outputFile);
 
+    fprintf(outputFile, "%s", SEPARATOR("Arena Allocator"));
+    fprintf_content_node(&arena, outputFile);
+
+    fprintf(outputFile, "%s", SEPARATOR("Slab Allocator"));
+    fprintf_content_node(&slab, outputFile);
+
+    fprintf(outputFile, "%s", SEPARATOR("Thread Caching Allocator"));
+    fprintf_content_node(&tcache, outputFile);
+
+    fprintf(outputFile, "%s", SEPARATOR("Thread Pool"));
+    fprintf_content_node(&threadpool, outputFile);
+
     fprintf(outputFile, "%s", SEPARATOR("Dynamic Array"));
     fprintf_content_node(&darray, outputFile);
 
+    fprintf(outputFile, "%s", SEPARATOR("Segmented Array"));
+    fprintf_content_node(&segarray, outputFile);
+
+    fprintf(outputFile, "%s", SEPARATOR("Deque"));
+    fprintf_content_node(&deque, outputFile);
+
+    fprintf(outputFile, "%s", SEPARATOR("Concurrent Array"));
+    fprintf_content_node(&cdarray, outputFile);
+
+    fprintf(outputFile, "%s", SEPARATOR("Structure of Arrays"));
+    fprintf_content_node(&soarray, outputFile);
+
     fprintf(outputFile, "%s", SEPARATOR("ID Generator"));
     fprintf_content_node(&idgen, outputFile);
 
@@ -85,6 +117,9 @@ void fun_create_source(void)
 {
     char header[] = 
     {
+        "#if !defined(_WIN32) && !defined(_WIN64) && !defined(_POSIX_C_SOURCE)\n"
+        "    #define _POSIX_C_SOURCE 200112L\n"
+        "#endif\n\n"
         "#include \"ctoolbox.h\"\n"
         "#include <stdlib.h>\n"
         "#include <string.h>\n\n"
@@ -92,19 +127,63 @@ void fun_create_source(void)
 
     FILE* outputFile = fopen("../headeronly/ctoolbox.c", "w");
 
-    content_node_t context; context.start = 3; context.end = 31; context.filePath = "../context.c";
-    content_node_t darray; darray.start = 5; darray.end = 233; darray.filePath = "../darray.c";
-    content_node_t idgen; idgen.start = 5; idgen.end = 159; idgen.filePath = "../idgen.c";
-    content_node_t shashtable; shashtable.start = 4; shashtable.end = 180; shashtable.filePath = "../shashtable.c";
+    content_node_t context; context.start = 8; context.end = 269; context.filePath = "../context.c";
+    content_node_t cthreadh; cthreadh.start = 5; cthreadh.end = 125; cthreadh.filePath = "../cthread.h";
+    content_node_t cthread; cthread.start = 2; cthread.end = 276; cthread.filePath = "../cthread.c";
+    content_node_t csimdh; csimdh.start = 5; csimdh.end = 33; csimdh.filePath = "../csimd.h";
+    content_node_t csimd; csimd.start = 4; csimd.end = 262; csimd.filePath = "../csimd.c";
+    content_node_t arena; arena.start = 4; arena.end = 217; arena.filePath = "../arena.c";
+    content_node_t slab; slab.start = 4; slab.end = 313; slab.filePath = "../slab.c";
+    content_node_t tcache; tcache.start = 5; tcache.end = 425; tcache.filePath = "../tcache.c";
+    content_node_t threadpool; threadpool.start = 5; threadpool.end = 266; threadpool.filePath = "../threadpool.c";
+    content_node_t darray; darray.start = 6; darray.end = 1539; darray.filePath = "../darray.c";
+    content_node_t segarray; segarray.start = 3; segarray.end = 216; segarray.filePath = "../segarray.c";
+    content_node_t deque; deque.start = 5; deque.end = 263; deque.filePath = "../deque.c";
+    content_node_t cdarray; cdarray.start = 5; cdarray.end = 278; cdarray.filePath = "../cdarray.c";
+    content_node_t soarray; soarray.start = 3; soarray.end = 302; soarray.filePath = "../soarray.c";
+    content_node_t idgen; idgen.start = 4; idgen.end = 559; idgen.filePath = "../idgen.c";
+    content_node_t shashtable; shashtable.start = 5; shashtable.end = 237; shashtable.filePath = "../shashtable.c";
 
     fprintf(outputFile, "%s", header);
 
     fprintf(outputFile, "%s", SEPARATOR("Context"));
     fprintf_content_node(&context, outputFile);
 
+    fprintf(outputFile, "%s", SEPARATOR("Threading"));
+    fprintf_content_node(&cthreadh, outputFile);
+    fprintf_content_node(&cthread, outputFile);
+
+    fprintf(outputFile, "%s", SEPARATOR("SIMD"));
+    fprintf_content_node(&csimdh, outputFile);
+    fprintf_content_node(&csimd, outputFile);
+
+    fprintf(outputFile, "%s", SEPARATOR("Arena Allocator"));
+    fprintf_content_node(&arena, outputFile);
+
+    fprintf(outputFile, "%s", SEPARATOR("Slab Allocator"));
+    fprintf_content_node(&slab, outputFile);
+
+    fprintf(outputFile, "%s", SEPARATOR("Thread Caching Allocator"));
+    fprintf_content_node(&tcache, outputFile);
+
+    fprintf(outputFile, "%s", SEPARATOR("Thread Pool"));
+    fprintf_content_node(&threadpool, outputFile);
+
     fprintf(outputFile, "%s", SEPARATOR("Dynamic Array"));
     fprintf_content_node(&darray, outputFile);
 
+    fprintf(outputFile, "%s", SEPARATOR("Segmented Array"));
+    fprintf_content_node(&segarray, outputFile);
+
+    fprintf(outputFile, "%s", SEPARATOR("Deque"));
+    fprintf_content_node(&deque, outputFile);
+
+    fprintf(outputFile, "%s", SEPARATOR("Concurrent Array"));
+    fprintf_content_node(&cdarray, outputFile);
+
+    fprintf(outputFile, "%s", SEPARATOR("Structure of Arrays"));
+    fprintf_content_node(&soarray, outputFile);
+
     fprintf(outputFile, "%s", SEPARATOR("ID Generator"));
     fprintf_content_node(&idgen, outputFile);
 